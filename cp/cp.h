@@ -160,9 +160,10 @@ void
 initialize_tables_on_dp(void);
 
 /**
- * Central working function of the control plane. Reads message from s11/pcap,
- * calls appropriate function to handle message, writes response
- * message (if any) to s11/pcap
+ * Central working function of the control plane. Waits for the s11/s5s8
+ * sockets to be readable, reads a batch of messages from them (or from
+ * pcap), calls appropriate function to handle each message, then writes
+ * the batch of response messages (if any) to s11/s5s8/pcap
  */
 void
 control_plane(void);
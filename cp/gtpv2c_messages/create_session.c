@@ -345,10 +345,26 @@ process_create_session_request(gtpv2c_header *gtpv2c_rx,
 
 	if (cause_res == 0) {
 		apn_req = &apn_list[apn_indx];
-		ret = acquire_ip(apn_req, &ue_ip);
-		if (ret) {
-			cause_res = GTPV2C_CAUSE_ALL_DYNAMIC_ADDRESSES_OCCUPIED;
+		if (csr->paa.header.len &&
+				(csr->paa.pdn_type == PDN_IP_TYPE_IPV4) &&
+				csr->paa.ip_type.ipv4.s_addr) {
+			/* Static UE address from the HSS, keep it out of the pool.
+			 * The pool is indexed in host order, ue_ip stays in
+			 * network order as acquire_ip returns it. */
+			struct in_addr static_ip = {
+				.s_addr = ntohl(csr->paa.ip_type.ipv4.s_addr)
+			};
+
+			ret = reserve_ip(apn_req, &static_ip);
+			if (ret)
+				cause_res = ret;
+			ue_ip = csr->paa.ip_type.ipv4;
 		} else {
+			ret = acquire_ip(apn_req, &ue_ip);
+			if (ret)
+				cause_res = GTPV2C_CAUSE_ALL_DYNAMIC_ADDRESSES_OCCUPIED;
+		}
+		if (!ret) {
 			primary_dns_ip = *apn_req->pdns;
 			secondary_dns_ip = *apn_req->sdns;
 		}
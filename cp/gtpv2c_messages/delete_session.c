@@ -152,8 +152,8 @@ delete_cp_context(ue_context **_context, ue_context *context,
 {
 	int i;
 
+	release_ip(pdn->apn_in_use, &pdn->ipv4);
 	for (i = 0; i < pdn->num_bearers; i++) {
-		release_ip(pdn->apn_in_use, &pdn->ipv4);
 		rte_free(pdn->eps_bearers[i]);
 		pdn->eps_bearers[i] = NULL;
 		context->eps_bearers[i] = NULL;
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+
+#include "ip_pool.h"
+
+#define IP_POOL_WORD(i)              ((i) / IP_POOL_WORD_BITS)
+#define IP_POOL_BIT(i)               (1ULL << ((i) % IP_POOL_WORD_BITS))
+
+/**
+ * Mark index in use; clear the parent bits of words left empty.
+ */
+static inline void
+ip_pool_clear(struct ip_pool *pool, uint32_t idx)
+{
+	uint32_t lvl;
+
+	for (lvl = 0; lvl < IP_POOL_LEVELS; lvl++) {
+		pool->level[lvl][IP_POOL_WORD(idx)] &= ~IP_POOL_BIT(idx);
+		if (pool->level[lvl][IP_POOL_WORD(idx)] != 0)
+			break;
+		idx = IP_POOL_WORD(idx);
+	}
+}
+
+/**
+ * Mark index free; set the parent bits of words no longer empty.
+ */
+static inline void
+ip_pool_set(struct ip_pool *pool, uint32_t idx)
+{
+	uint64_t was;
+	uint32_t lvl;
+
+	for (lvl = 0; lvl < IP_POOL_LEVELS; lvl++) {
+		was = pool->level[lvl][IP_POOL_WORD(idx)];
+		pool->level[lvl][IP_POOL_WORD(idx)] = was | IP_POOL_BIT(idx);
+		if (was != 0)
+			break;
+		idx = IP_POOL_WORD(idx);
+	}
+}
+
+/**
+ * First free index at or after idx.
+ *
+ * @return
+ *   \- index if found
+ *   \- -1 if none
+ */
+static int64_t
+ip_pool_next_free(struct ip_pool *pool, uint32_t idx)
+{
+	uint32_t lvl = 0;
+	uint64_t bits;
+
+	/* Climb until a word has a set bit at or after idx */
+	for (;;) {
+		if (idx >= pool->nb_bits[lvl])
+			return -1;
+		bits = pool->level[lvl][IP_POOL_WORD(idx)] &
+				(~0ULL << (idx % IP_POOL_WORD_BITS));
+		if (bits)
+			break;
+		if (lvl == IP_POOL_LEVELS - 1)
+			return -1;
+		idx = IP_POOL_WORD(idx) + 1;
+		lvl++;
+	}
+
+	/* Descend through the first set bit of each word */
+	idx = IP_POOL_WORD(idx) * IP_POOL_WORD_BITS + __builtin_ctzll(bits);
+	while (lvl-- > 0)
+		idx = idx * IP_POOL_WORD_BITS +
+				__builtin_ctzll(pool->level[lvl][idx]);
+
+	return idx;
+}
+
+static inline int
+ip_pool_is_free(struct ip_pool *pool, uint32_t idx)
+{
+	return !!(pool->level[0][IP_POOL_WORD(idx)] & IP_POOL_BIT(idx));
+}
+
+int
+ip_pool_init(struct ip_pool *pool, uint32_t hosts)
+{
+	uint32_t lvl, i, nb_words;
+
+	memset(pool, 0, sizeof(*pool));
+	if ((hosts == 0) || (hosts > IP_POOL_MAX_HOSTS))
+		return -1;
+
+	for (lvl = 0; lvl < IP_POOL_LEVELS; lvl++) {
+		pool->nb_bits[lvl] = lvl ?
+			RTE_ALIGN_CEIL(pool->nb_bits[lvl - 1], IP_POOL_WORD_BITS) /
+			IP_POOL_WORD_BITS : hosts;
+		nb_words = RTE_ALIGN_CEIL(pool->nb_bits[lvl], IP_POOL_WORD_BITS) /
+			IP_POOL_WORD_BITS;
+		pool->level[lvl] = rte_zmalloc_socket(NULL,
+				nb_words * sizeof(uint64_t),
+				RTE_CACHE_LINE_SIZE, rte_socket_id());
+		if (pool->level[lvl] == NULL) {
+			ip_pool_free(pool);
+			return -1;
+		}
+
+		/* Bits past the last address stay clear */
+		for (i = 0; i < pool->nb_bits[lvl] / IP_POOL_WORD_BITS; i++)
+			pool->level[lvl][i] = ~0ULL;
+		if (pool->nb_bits[lvl] % IP_POOL_WORD_BITS)
+			pool->level[lvl][i] = IP_POOL_BIT(pool->nb_bits[lvl]) - 1;
+	}
+
+	pool->hosts = hosts;
+	pool->nb_free = hosts;
+	return 0;
+}
+
+void
+ip_pool_free(struct ip_pool *pool)
+{
+	uint32_t lvl;
+
+	for (lvl = 0; lvl < IP_POOL_LEVELS; lvl++)
+		rte_free(pool->level[lvl]);
+	memset(pool, 0, sizeof(*pool));
+}
+
+int
+ip_pool_alloc(struct ip_pool *pool, uint32_t *idx)
+{
+	int64_t next;
+
+	if (pool->nb_free == 0)
+		return -1;
+
+	next = ip_pool_next_free(pool, pool->cursor);
+	if (next < 0)
+		next = ip_pool_next_free(pool, 0);
+	if (next < 0)
+		return -1;
+
+	ip_pool_clear(pool, next);
+	pool->nb_free--;
+	pool->cursor = (next + 1 == pool->hosts) ? 0 : next + 1;
+	*idx = next;
+	return 0;
+}
+
+int
+ip_pool_reserve(struct ip_pool *pool, uint32_t idx)
+{
+	if ((idx >= pool->hosts) || !ip_pool_is_free(pool, idx))
+		return -1;
+
+	ip_pool_clear(pool, idx);
+	pool->nb_free--;
+	return 0;
+}
+
+int
+ip_pool_release(struct ip_pool *pool, uint32_t idx)
+{
+	if ((idx >= pool->hosts) || ip_pool_is_free(pool, idx))
+		return -1;
+
+	ip_pool_set(pool, idx);
+	pool->nb_free++;
+	return 0;
+}
+
+uint32_t
+ip_pool_release_bulk(struct ip_pool *pool, const uint32_t *idx, uint32_t n)
+{
+	uint32_t i, released = 0;
+
+	for (i = 0; i < n; i++)
+		if (ip_pool_release(pool, idx[i]) == 0)
+			released++;
+
+	return released;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IP_POOL_H
+#define IP_POOL_H
+
+/**
+ * @file
+ *
+ * UE IP address index allocator. A pool is a tree of 64b words: a leaf
+ * bit is set when its address is free, an upper level bit is set when
+ * the word below it has a free bit. Allocate, reserve and release touch
+ * at most IP_POOL_LEVELS words up and down the tree whatever the pool
+ * occupancy.
+ *
+ * Not thread safe: a pool is only used from the control_plane thread.
+ */
+
+#include <stdint.h>
+
+/* Bits per tree word */
+#define IP_POOL_WORD_BITS            64
+
+/* Tree depth */
+#define IP_POOL_LEVELS               3
+
+/* Max addresses per pool: 64^3, i.e. a /14 */
+#define IP_POOL_MAX_HOSTS            (1U << 18)
+
+/**
+ * UE IP address pool; one per APN.
+ */
+struct ip_pool {
+	/** addresses in pool */
+	uint32_t hosts;
+	/** addresses free */
+	uint32_t nb_free;
+	/** next-fit cursor: index searched first by ip_pool_alloc */
+	uint32_t cursor;
+	/** bits per level: level 0 is the address bitmap */
+	uint32_t nb_bits[IP_POOL_LEVELS];
+	/** tree words per level */
+	uint64_t *level[IP_POOL_LEVELS];
+};
+
+/**
+ * Create pool with all addresses free.
+ *
+ * @param pool
+ *   pool to initialize
+ * @param hosts
+ *   number of addresses, at most IP_POOL_MAX_HOSTS
+ * @return
+ *   \- 0 if successful
+ *   \- -1 on invalid size or allocation failure
+ */
+int
+ip_pool_init(struct ip_pool *pool, uint32_t hosts);
+
+/**
+ * Release pool memory.
+ *
+ * @param pool
+ *   pool to release
+ */
+void
+ip_pool_free(struct ip_pool *pool);
+
+/**
+ * Allocate the first free address at or after the next-fit cursor,
+ * wrapping to the start of the pool.
+ *
+ * @param pool
+ *   pool to allocate from
+ * @param idx
+ *   address index allocated
+ * @return
+ *   \- 0 if successful
+ *   \- -1 if pool is depleted
+ */
+int
+ip_pool_alloc(struct ip_pool *pool, uint32_t *idx);
+
+/**
+ * Reserve a given address, e.g. a statically assigned UE address.
+ *
+ * @param pool
+ *   pool to reserve from
+ * @param idx
+ *   address index
+ * @return
+ *   \- 0 if successful
+ *   \- -1 if out of pool or already in use
+ */
+int
+ip_pool_reserve(struct ip_pool *pool, uint32_t idx);
+
+/**
+ * Return an allocated or reserved address to the pool.
+ *
+ * @param pool
+ *   pool the address belongs to
+ * @param idx
+ *   address index
+ * @return
+ *   \- 0 if successful
+ *   \- -1 if out of pool or already free
+ */
+int
+ip_pool_release(struct ip_pool *pool, uint32_t idx);
+
+/**
+ * Return many addresses to the pool, e.g. on peer restart.
+ *
+ * @param pool
+ *   pool the addresses belong to
+ * @param idx
+ *   address indexes
+ * @param n
+ *   number of addresses
+ * @return
+ *   number of addresses released; invalid or free indexes are skipped
+ */
+uint32_t
+ip_pool_release_bulk(struct ip_pool *pool, const uint32_t *idx, uint32_t n);
+
+#endif /* IP_POOL_H */
@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 
+#define _GNU_SOURCE	/* Expose recvmmsg() and sendmmsg() */
 #include <arpa/inet.h>
 #include <errno.h>
 #include <limits.h>
@@ -26,6 +27,8 @@
 #include <time.h>
 #include <ctype.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
 
 #include <rte_memory.h>
 #include <rte_memzone.h>
@@ -87,6 +90,12 @@
 
 #define OP_ID_HASH_SIZE     (1 << 18)
 
+/* GTPv2c messages read or written per system call */
+#define GTPV2C_BURST			(32)
+
+/* GTPv2c sockets watched by control_plane: s11 and s5s8 */
+#define GTPV2C_EPOLL_EVENTS		(2)
+
 enum cp_config spgw_cfg;
 int s11_fd = -1;
 int s11_pcap_fd = -1;
@@ -104,6 +113,28 @@ struct cp_params cp_params;
 pcap_dumper_t *pcap_dumper;
 pcap_t *pcap_reader;
 
+/**
+ * GTPv2c message batch for recvmmsg/sendmmsg.
+ */
+struct gtpv2c_batch {
+	struct mmsghdr msg[GTPV2C_BURST];
+	struct iovec iov[GTPV2C_BURST];
+	struct sockaddr_in addr[GTPV2C_BURST];
+	/** tx socket per message */
+	int fd[GTPV2C_BURST];
+	uint8_t buf[GTPV2C_BURST][MAX_GTPV2C_UDP_LEN];
+	uint32_t count;
+};
+
+static struct gtpv2c_batch gtpv2c_rx_batch;
+static struct gtpv2c_batch gtpv2c_tx_batch;
+static int cp_epoll_fd = -1;
+
+/* Set on the control_plane lcore while a rx batch is processed: the
+ * gtpv2c_send calls it makes are queued to gtpv2c_tx_batch. Other
+ * threads, e.g. the NB listener, keep sending directly. */
+static RTE_DEFINE_PER_LCORE(uint8_t, gtpv2c_tx_batching);
+
 /**
  * Setting/enable CP RTE LOG_LEVEL.
  */
@@ -461,6 +492,33 @@ init_s5s8_pgwc(void)
 	s5s8_sgwc_sockaddr.sin_addr = s5s8_sgwc_ip;
 }
 
+/**
+ * @brief
+ * Registers the GTPv2c sockets of this spgw_cfg with cp_epoll_fd
+ */
+static void
+init_gtpv2c_epoll(void)
+{
+	int fds[] = {s5s8_sgwc_fd, s5s8_pgwc_fd, s11_fd};
+	struct epoll_event ev = {0};
+	uint32_t i;
+
+	cp_epoll_fd = epoll_create1(0);
+	if (cp_epoll_fd < 0)
+		rte_exit(EXIT_FAILURE, "epoll_create1 error: %s\n",
+				strerror(errno));
+
+	for (i = 0; i < RTE_DIM(fds); i++) {
+		if (fds[i] < 0)
+			continue;
+		ev.events = EPOLLIN;
+		ev.data.fd = fds[i];
+		if (epoll_ctl(cp_epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) < 0)
+			rte_exit(EXIT_FAILURE, "epoll_ctl error on fd %d: %s\n",
+					fds[i], strerror(errno));
+	}
+}
+
 /**
  * @brief
  * Initializes Control Plane data structures, packet filters, and calls for the
@@ -486,6 +544,9 @@ init_cp(void)
 		break;
 	}
 
+	if (!pcap_reader)
+		init_gtpv2c_epoll();
+
 	iface_module_constructor();
 
 	if (signal(SIGINT, sig_handler) == SIG_ERR)
@@ -534,6 +595,73 @@ init_cp_params(void) {
 #endif /* SIMU_CP */
 }
 
+/**
+ * @brief
+ * Writes the queued gtpv2c messages, one sendmmsg per run of messages
+ * on the same socket to keep their order.
+ */
+static void
+gtpv2c_tx_flush(void)
+{
+	struct gtpv2c_batch *b = &gtpv2c_tx_batch;
+	uint32_t i = 0, j, n, sent;
+	int ret;
+
+	while (i < b->count) {
+		for (n = 1; (i + n < b->count) && (b->fd[i + n] == b->fd[i]); n++)
+			;
+
+		ret = sendmmsg(b->fd[i], &b->msg[i], n, 0);
+		if (ret <= 0) {
+			fprintf(stderr, "sendmmsg of %u GTPv2c Messages on fd %d "
+					"failed: %s\n", n, b->fd[i], strerror(errno));
+			i += n;
+			continue;
+		}
+
+		sent = ret;
+		for (j = i; j < i + sent; j++) {
+			if (b->msg[j].msg_len != b->iov[j].iov_len)
+				fprintf(stderr, "Transmitted Incomplete GTPv2c Message:"
+						"%zu of %u tx bytes\n",
+						b->iov[j].iov_len, b->msg[j].msg_len);
+		}
+		i += sent;
+	}
+	b->count = 0;
+}
+
+/**
+ * @brief
+ * Queues a gtpv2c message to gtpv2c_tx_batch, flushing it when full
+ */
+static void
+gtpv2c_tx_queue(int gtpv2c_if_fd, uint8_t *gtpv2c_tx_buf,
+		uint16_t gtpv2c_pyld_len, struct sockaddr *dest_addr,
+		socklen_t dest_addr_len)
+{
+	struct gtpv2c_batch *b = &gtpv2c_tx_batch;
+	uint32_t i;
+
+	if (b->count == GTPV2C_BURST)
+		gtpv2c_tx_flush();
+
+	i = b->count++;
+	memcpy(b->buf[i], gtpv2c_tx_buf, gtpv2c_pyld_len);
+	dest_addr_len = RTE_MIN(dest_addr_len,
+			(socklen_t) sizeof(b->addr[i]));
+	memcpy(&b->addr[i], dest_addr, dest_addr_len);
+	b->fd[i] = gtpv2c_if_fd;
+
+	b->iov[i].iov_base = b->buf[i];
+	b->iov[i].iov_len = gtpv2c_pyld_len;
+	memset(&b->msg[i], 0, sizeof(b->msg[i]));
+	b->msg[i].msg_hdr.msg_name = &b->addr[i];
+	b->msg[i].msg_hdr.msg_namelen = dest_addr_len;
+	b->msg[i].msg_hdr.msg_iov = &b->iov[i];
+	b->msg[i].msg_hdr.msg_iovlen = 1;
+}
+
 /**
  * @brief
  * Util to send or dump gtpv2c messages
@@ -546,6 +674,9 @@ gtpv2c_send(int gtpv2c_if_fd, uint8_t *gtpv2c_tx_buf,
 	int bytes_tx;
 	if (pcap_dumper) {
 		dump_pcap(gtpv2c_pyld_len, gtpv2c_tx_buf);
+	} else if (RTE_PER_LCORE(gtpv2c_tx_batching)) {
+		gtpv2c_tx_queue(gtpv2c_if_fd, gtpv2c_tx_buf, gtpv2c_pyld_len,
+				dest_addr, dest_addr_len);
 	} else {
 		bytes_tx = sendto(gtpv2c_if_fd, gtpv2c_tx_buf, gtpv2c_pyld_len, 0,
 			(struct sockaddr *) dest_addr, dest_addr_len);
@@ -613,97 +744,29 @@ socklen_t s11_mme_sockaddr_len = sizeof(s11_mme_sockaddr);
 socklen_t s5s8_sgwc_sockaddr_len = sizeof(s5s8_sgwc_sockaddr);
 socklen_t s5s8_pgwc_sockaddr_len = sizeof(s5s8_pgwc_sockaddr);
 
-void
-control_plane(void)
+/**
+ * @brief
+ * Process one received GTPv2c message. Only one of the s11/s5s8 lengths
+ * is positive; the caller sets the peer of the message in
+ * s11_mme_sockaddr or s5s8_sgwc_sockaddr before the call.
+ */
+static void
+process_gtpv2c_msg(gtpv2c_header *gtpv2c_s11_rx, int bytes_s11_rx,
+		gtpv2c_header *gtpv2c_s5s8_rx, int bytes_s5s8_rx)
 {
-	bzero(&s11_rx_buf, sizeof(s11_rx_buf));
-	bzero(&s11_tx_buf, sizeof(s11_tx_buf));
-	bzero(&s5s8_rx_buf, sizeof(s5s8_rx_buf));
-	bzero(&s5s8_tx_buf, sizeof(s5s8_tx_buf));
-	gtpv2c_header *gtpv2c_s11_rx = (gtpv2c_header *) s11_rx_buf;
 	gtpv2c_header *gtpv2c_s11_tx = (gtpv2c_header *) s11_tx_buf;
-	gtpv2c_header *gtpv2c_s5s8_rx = (gtpv2c_header *) s5s8_rx_buf;
 	gtpv2c_header *gtpv2c_s5s8_tx = (gtpv2c_header *) s5s8_tx_buf;
 
 	uint16_t payload_length;
 
 	uint8_t delay = 0; /*TODO move this when more implemented?*/
-	int bytes_pcap_rx = 0;
-	int bytes_s11_rx = 0;
-	int bytes_s5s8_rx = 0;
 	static uint8_t s11_msgcnt = 0;
 	static uint8_t s5s8_sgwc_msgcnt = 0;
 	static uint8_t s5s8_pgwc_msgcnt = 0;
 	int ret = 0;
 
-	if (pcap_reader) {
-		static struct pcap_pkthdr *pcap_rx_header;
-		const u_char *t;
-		const u_char **tmp = &t;
-		ret = pcap_next_ex(pcap_reader, &pcap_rx_header, tmp);
-		if (ret < 0) {
-			printf("Finished reading from pcap file"
-					" - exiting\n");
-			exit(0);
-		}
-		bytes_pcap_rx = pcap_rx_header->caplen
-				- (sizeof(struct ether_hdr)
-				+ sizeof(struct ipv4_hdr)
-				+ sizeof(struct udp_hdr));
-		memcpy(gtpv2c_s11_rx, *tmp
-				+ (sizeof(struct ether_hdr)
-				+ sizeof(struct ipv4_hdr)
-				+ sizeof(struct udp_hdr)), bytes_pcap_rx);
-	}
-
-	if ((spgw_cfg == SGWC) && !pcap_reader) {
-		bytes_s5s8_rx = recvfrom(s5s8_sgwc_fd, s5s8_rx_buf,
-				MAX_GTPV2C_UDP_LEN, MSG_DONTWAIT,
-				(struct sockaddr *) &s5s8_sgwc_sockaddr,
-				&s5s8_sgwc_sockaddr_len);
-		if (bytes_s5s8_rx == 0) {
-			fprintf(stderr, "SGWC_s5s8 recvfrom error:"
-					"\n\ton %s:%u - %s\n",
-					inet_ntoa(s5s8_sgwc_sockaddr.sin_addr),
-					s5s8_sgwc_sockaddr.sin_port,
-					strerror(errno));
-		}
-	}
-	if ((spgw_cfg == PGWC) && !pcap_reader) {
-		bytes_s5s8_rx = recvfrom(s5s8_pgwc_fd, s5s8_rx_buf,
-				MAX_GTPV2C_UDP_LEN, MSG_DONTWAIT,
-				(struct sockaddr *) &s5s8_sgwc_sockaddr,
-				&s5s8_sgwc_sockaddr_len);
-		if (bytes_s5s8_rx == 0) {
-			fprintf(stderr, "PGWC_s5s8 recvfrom error:"
-					"\n\ton %s:%u - %s\n",
-					inet_ntoa(s5s8_sgwc_sockaddr.sin_addr),
-					s5s8_sgwc_sockaddr.sin_port,
-					strerror(errno));
-		}
-	}
-	if (((spgw_cfg == SGWC) || (spgw_cfg == SPGWC)) && !pcap_reader) {
-			bytes_s11_rx = recvfrom(s11_fd, s11_rx_buf,
-					MAX_GTPV2C_UDP_LEN, MSG_DONTWAIT,
-					(struct sockaddr *) &s11_mme_sockaddr,
-					&s11_mme_sockaddr_len);
-		if (bytes_s11_rx == 0) {
-			fprintf(stderr, "SGWC|SPGWC_s11 recvfrom error:"
-					"\n\ton %s:%u - %s\n",
-					inet_ntoa(s11_mme_sockaddr.sin_addr),
-					s11_mme_sockaddr.sin_port,
-					strerror(errno));
-			return;
-		}
-	} else if(pcap_reader) {
-		bytes_s11_rx = bytes_pcap_rx;
-	}
-
-	if (
-		(bytes_s5s8_rx < 0) && (bytes_s11_rx < 0) &&
-		(errno == EAGAIN  || errno == EWOULDBLOCK)
-		)
-		return;
+	bzero(&s11_tx_buf, sizeof(s11_tx_buf));
+	bzero(&s5s8_tx_buf, sizeof(s5s8_tx_buf));
 
 	if ((spgw_cfg == SGWC) || (spgw_cfg == PGWC)) {
 		if ((bytes_s5s8_rx > 0) &&
@@ -1228,6 +1291,115 @@ control_plane(void)
 	}
 }
 
+/**
+ * @brief
+ * Reads up to GTPV2C_BURST messages from fd into gtpv2c_rx_batch
+ *
+ * @return
+ *   number of messages read
+ */
+static int
+gtpv2c_rx_burst(int fd)
+{
+	struct gtpv2c_batch *b = &gtpv2c_rx_batch;
+	int i, n;
+
+	for (i = 0; i < GTPV2C_BURST; i++) {
+		b->iov[i].iov_base = b->buf[i];
+		b->iov[i].iov_len = MAX_GTPV2C_UDP_LEN;
+		memset(&b->msg[i], 0, sizeof(b->msg[i]));
+		b->msg[i].msg_hdr.msg_name = &b->addr[i];
+		b->msg[i].msg_hdr.msg_namelen = sizeof(b->addr[i]);
+		b->msg[i].msg_hdr.msg_iov = &b->iov[i];
+		b->msg[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	n = recvmmsg(fd, b->msg, GTPV2C_BURST, MSG_DONTWAIT, NULL);
+	if (n < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			fprintf(stderr, "recvmmsg error on fd %d: %s\n",
+					fd, strerror(errno));
+		return 0;
+	}
+
+	return n;
+}
+
+/**
+ * @brief
+ * Replays up to GTPV2C_BURST messages of the pcap input as s11 messages
+ */
+static void
+control_plane_pcap(void)
+{
+	const uint32_t hdr_len = sizeof(struct ether_hdr)
+			+ sizeof(struct ipv4_hdr)
+			+ sizeof(struct udp_hdr);
+	struct pcap_pkthdr *pcap_rx_header;
+	const u_char *pkt;
+	int bytes_pcap_rx;
+	uint32_t i;
+
+	for (i = 0; i < GTPV2C_BURST; i++) {
+		if (pcap_next_ex(pcap_reader, &pcap_rx_header, &pkt) < 0) {
+			printf("Finished reading from pcap file"
+					" - exiting\n");
+			exit(0);
+		}
+		if ((pcap_rx_header->caplen <= hdr_len) ||
+				(pcap_rx_header->caplen - hdr_len > MAX_GTPV2C_UDP_LEN))
+			continue;
+
+		bytes_pcap_rx = pcap_rx_header->caplen - hdr_len;
+		memcpy(s11_rx_buf, pkt + hdr_len, bytes_pcap_rx);
+		process_gtpv2c_msg((gtpv2c_header *) s11_rx_buf, bytes_pcap_rx,
+				NULL, 0);
+	}
+}
+
+void
+control_plane(void)
+{
+	struct gtpv2c_batch *rx = &gtpv2c_rx_batch;
+	struct epoll_event events[GTPV2C_EPOLL_EVENTS];
+	int nfds, i, j, n, fd;
+
+	if (pcap_reader) {
+		control_plane_pcap();
+		return;
+	}
+
+	/* Sleep until either socket is readable */
+	nfds = epoll_wait(cp_epoll_fd, events, GTPV2C_EPOLL_EVENTS, -1);
+	if (nfds < 0) {
+		if (errno != EINTR)
+			fprintf(stderr, "epoll_wait error: %s\n", strerror(errno));
+		return;
+	}
+
+	RTE_PER_LCORE(gtpv2c_tx_batching) = 1;
+	for (i = 0; i < nfds; i++) {
+		fd = events[i].data.fd;
+		n = gtpv2c_rx_burst(fd);
+		for (j = 0; j < n; j++) {
+			if (rx->msg[j].msg_len == 0)
+				continue;
+			if (fd == s11_fd) {
+				s11_mme_sockaddr = rx->addr[j];
+				process_gtpv2c_msg((gtpv2c_header *) rx->buf[j],
+						rx->msg[j].msg_len, NULL, 0);
+			} else {
+				s5s8_sgwc_sockaddr = rx->addr[j];
+				process_gtpv2c_msg(NULL, 0,
+						(gtpv2c_header *) rx->buf[j],
+						rx->msg[j].msg_len);
+			}
+		}
+	}
+	gtpv2c_tx_flush();
+	RTE_PER_LCORE(gtpv2c_tx_batching) = 0;
+}
+
 /**
  * @brief Initializes the hash table used to account for NB messages by op_id
  */
@@ -1414,6 +1586,7 @@ main(int argc, char **argv)
 	}
 	for(i = 0; i < apn_count; i++) {
 		apn_list[i].ue_pool = &ue_pool_list[i];
+		init_ue_ip_pool(&apn_list[i]);
 		apn_list[i].pdns = &pdns_list[i];
 		apn_list[i].sdns = &sdns_list[i];
 		apn_list[i].tmr_trshld = &tmr_trshld_list[i];
@@ -152,9 +152,6 @@ set_apn_name(apn *an_apn, char *argstr)
 	} while (ptr != an_apn->apn_name_label);
 
 	an_apn->apn_idx = apn_count;
-	an_apn->ue_ipbf = rte_zmalloc_socket(NULL, CP_UE_BLOCK,
-									RTE_CACHE_LINE_SIZE, rte_socket_id());
-	memset(an_apn->ue_ipbf, UE_BUFF_MASK, CP_UE_BLOCK);
 	apn_count++;
 }
 
@@ -344,30 +341,34 @@ set_dl_ambr(const char *dl_ambr_str)
 	dl_ambr_count++;
 }
 
-static inline int ffs_bit(void *buf, int len)
+void
+init_ue_ip_pool(apn *an_apn)
 {
-	int num_long_chunks = len / 64;
-	for (int i = 0;i<num_long_chunks;i++) {
-		if (((unsigned long *)buf)[i] != 0)
-			return (i*64 + __builtin_ffsll(((unsigned long *)buf)[i])-1);
+	uint32_t hosts = an_apn->ue_pool->hosts;
+
+	if (hosts > IP_POOL_MAX_HOSTS) {
+		fprintf(stderr, "APN %u ip pool of %u hosts truncated to %u\n",
+				an_apn->apn_idx, hosts, IP_POOL_MAX_HOSTS);
+		hosts = IP_POOL_MAX_HOSTS;
 	}
-	return -1;
+	if (ip_pool_init(&an_apn->ip_pool, hosts) < 0)
+		rte_panic("@%s::Failure!!! alloc ip pool of %u hosts:"
+				"\n\t(%s:%d)\n",
+				__func__, hosts, __FILE__, __LINE__);
 }
 
 uint32_t
 acquire_ip(apn *apn_requested, struct in_addr *ipv4)
 {
-	int next_ip_index =
-				ffs_bit(apn_requested->ue_ipbf, CP_UE_BLOCK*8);
+	uint32_t next_ip_index;
 	ue_ippool *ue_net = apn_requested->ue_pool;
-	if ((next_ip_index < 0)||(next_ip_index >= ue_net->hosts)) {
+
+	if (ip_pool_alloc(&apn_requested->ip_pool, &next_ip_index) < 0) {
 		fprintf(stderr, "IP Pool depleted\n");
 		return GTPV2C_CAUSE_ALL_DYNAMIC_ADDRESSES_OCCUPIED;
 	}
 	ipv4->s_addr =
 				ntohl(htonl(ue_net->netid.s_addr) + next_ip_index);
-	apn_requested->ue_ipbf[next_ip_index/8] &=
-								~(1 << (next_ip_index %8));
 	return 0;
 }
 
@@ -375,8 +376,22 @@ uint32_t
 release_ip(apn *apn_used, struct in_addr *ipv4)
 {
 	uint32_t ip_index = ipv4->s_addr-htonl(apn_used->ue_pool->netid.s_addr);
-	apn_used->ue_ipbf[ip_index/8] |=
-								(1 << (ip_index %8));
+
+	if (ip_pool_release(&apn_used->ip_pool, ip_index) < 0) {
+		fprintf(stderr, "Release of unallocated UE IP index %u\n",
+				ip_index);
+		return GTPV2C_CAUSE_REQUEST_REJECTED;
+	}
+	return 0;
+}
+
+uint32_t
+reserve_ip(apn *apn_used, struct in_addr *ipv4)
+{
+	uint32_t ip_index = ipv4->s_addr-htonl(apn_used->ue_pool->netid.s_addr);
+
+	if (ip_pool_reserve(&apn_used->ip_pool, ip_index) < 0)
+		return GTPV2C_CAUSE_REQUEST_REJECTED;
 	return 0;
 }
 
@@ -40,6 +40,7 @@
 #include "gtpv2c_ie.h"
 #include "packet_filters.h"
 #include "interface.h"
+#include "ip_pool.h"
 
 #define SDF_FILTER_TABLE "sdf_filter_table"
 #define ADC_TABLE "adc_rule_table"
@@ -59,13 +60,6 @@
 #define MAX_BEARERS                  (11)
 #define MAX_FILTERS_PER_UE           (16)
 
-/* CP Session capacty: 65,536 i.e. 64K UEs.
- * __builtin_ffsll(...)::
- *         Scan Forward for bit set in 64b field == 8bytes
- * MAX UE SIZE == 64K/8 */
-#define CP_UE_BLOCK                  8192
-#define UE_BUFF_MASK                 255
-
 /* ASR- TMOPL VCCCCB-28
  * Many PDN connections for the same IMSI on a given APN not allowed
  * REQD: Many PDN connections same IMSI different APN
@@ -107,7 +101,7 @@ typedef struct apn_t {
 	ue_ippool *ue_pool;
 	struct in_addr *pdns;
 	struct in_addr *sdns;
-	unsigned char *ue_ipbf;
+	struct ip_pool ip_pool;   /* UE addresses of ue_pool */
 	uint64_t *tmr_trshld;     /* CDR timer threshold: Sec */
 	uint64_t *vol_trshld;     /* CDR volume threshold: MBytes*/
 	ambr_ie apn_ambr;         /* UL/DL AMBR values configured in cp cfg */
@@ -360,6 +354,15 @@ set_ul_ambr(const char *ul_ambr_str);
 void
 set_dl_ambr(const char *dl_ambr_str);
 
+/**
+ * Creates the address pool of an apn once its ue_pool is parsed. Pools
+ * larger than IP_POOL_MAX_HOSTS are truncated.
+ * @param an_apn
+ *   apn with ue_pool set
+ */
+void
+init_ue_ip_pool(apn *an_apn);
+
 /**
  * Simple ip-pool
  * @param ipv4
@@ -386,6 +389,21 @@ acquire_ip(apn *apn_requested, struct in_addr *ipv4);
 uint32_t
 release_ip(apn *apn_used, struct in_addr *ipv4);
 
+/**
+ * Reserve a static UE address, e.g. from the PAA of a Create Session
+ * Request, so acquire_ip does not hand it out until release_ip
+ * @param apn *
+ *   pointer to apn owning the address
+ * @param ipv4
+ *   ip address, host byte order as stored in pdn_connection
+ * @return
+ *   \- 0 if successful
+ *   \- > 0 if address is outside the pool or in use, corresponds to
+ *          3gpp specified cause error value
+ */
+uint32_t
+reserve_ip(apn *apn_used, struct in_addr *ipv4);
+
 /* For Debugging */
 /** print (with a column header) either context by the context and/or
  * iterating over hash
@@ -16,6 +16,7 @@
 
 #define _GNU_SOURCE     /* Expose declaration of tdestroy() */
 #include <search.h>
+#include <pthread.h>
 
 #include "acl_dp.h"
 #include "acl.h"
@@ -325,8 +326,23 @@ struct acl_search acl_search[MAX_PARAM][DP_MAX_LCORE];
 enum acl_cfg_tbl sdf_active_tbl = SDF_ACTIVE;
 enum acl_cfg_tbl adc_ul_active_tbl = ADC_UL_ACTIVE, adc_dl_active_tbl = ADC_DL_ACTIVE;
 enum acl_cfg_tbl config_tbl;
+static int config_socket;
 struct acl_rules_table acl_rules_table[MAX_PARAM];
 
+/* Active table of each rules param, flipped by the ACL builder thread */
+static enum acl_cfg_tbl *acl_active_tbl[MAX_PARAM] = {
+	&sdf_active_tbl,
+	&adc_ul_active_tbl,
+	&adc_dl_active_tbl,
+};
+/* Serializes rules table updates with the standby context reload */
+static pthread_mutex_t acl_rules_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t acl_rules_cond = PTHREAD_COND_INITIALIZER;
+/* Bitmask of acl_rules_params waiting for a standby rebuild */
+static uint32_t acl_rebuild_pending;
+/* Set while the builder thread works outside acl_rules_lock */
+static uint32_t acl_rebuild_busy;
+
 extern struct rte_hash *rte_sdf_pcc_hash;
 extern struct rte_hash *rte_adc_pcc_hash;
 
@@ -424,14 +440,8 @@ void acl_table_dump(struct acl_rules_table *t)
 static void add_single_rule(const void *nodep, const VISIT which, const int depth)
 {
 	struct acl4_rule *r;
-	/*
-	 * Check numa socket enable or disable based on
-	 * get or set socketid.
-	 */
-	int socketid = app.numa_on?rte_socket_id():0;
-
 	struct acl_config *pacl_config = &acl_config[config_tbl];
-	struct rte_acl_ctx *context = pacl_config->acx_ipv4[socketid];
+	struct rte_acl_ctx *context = pacl_config->acx_ipv4[config_socket];
 #pragma GCC diagnostic push  /* require GCC 4.6 */
 #pragma GCC diagnostic ignored "-Wcast-qual"
 	r = *(struct acl4_rule **) nodep;
@@ -451,14 +461,17 @@ static void add_single_rule(const void *nodep, const VISIT which, const int dept
  * Add rules from local table to rte acl rules table.
  * @param type
  *	table type.
+ * @param socketid
+ *	socket of the acl context to fill.
  *
  * @return
  *	void
  */
-static void add_rules_to_rte_acl(enum acl_cfg_tbl type)
+static void add_rules_to_rte_acl(enum acl_cfg_tbl type, int socketid)
 {
 	struct acl_rules_table *t = &acl_rules_table[type/2];
 	config_tbl = type;
+	config_socket = socketid;
 	twalk(t->root, t->add_entry);
 }
 /**
@@ -572,14 +585,19 @@ dp_rules_entry_delete(struct acl_rules_table *t,
 				struct acl4_rule *rule)
 {
 	void **p;
-	/* delete node from the tree */
-	p = tdelete(rule, &t->root, t->compare);
+	struct acl4_rule *old;
+
+	/* tdelete returns the parent node, fetch the entry first */
+	p = tfind(rule, &t->root, t->compare);
 	if (p == NULL) {
 		RTE_LOG_DP(INFO, DP, "Fail to delete acl rule id %d\n",
 						rule->data.userdata - ACL_DENY_SIGNATURE);
 		return -1;
 	}
-	rte_free(*p);
+	old = *p;
+	/* delete node from the tree */
+	tdelete(rule, &t->root, t->compare);
+	rte_free(old);
 	t->num_entries--;
 
 	return 0;
@@ -1214,52 +1232,70 @@ acl_config_init(struct acl_config *acl_config,
 }
 
 /**
- * To reset and build ACL table.
- *	This funciton reset the acl context rules,
- *	and add the new rules and build table.
- *	This should be called only for standby tables.
+ *	to get standby table id from active table.
  *
  * @param type
- *	table type to reset and build.
+ *	current active table id.
  *
  * @return
- *	- 0 on success
- *	- -1 on failure
+ *	standby table id
  */
 static int
-reset_and_build_rules(enum acl_cfg_tbl type)
+dp_acl_get_standby(enum acl_cfg_tbl type)
+{
+	return (type % 2)?(type - 1):(type + 1);
+}
+
+/**
+ * To reset and reload ACL table rules.
+ *	This funciton reset the acl context rules of every mapped socket
+ *	and add the rules from local memory.
+ *	This should be called only for standby tables, with acl_rules_lock
+ *	held.
+ *
+ * @param type
+ *	table type to reset.
+ *
+ * @return
+ *	number of rules loaded in the context.
+ */
+static uint32_t
+reset_rules(enum acl_cfg_tbl type)
 {
-	int dim = RTE_DIM(ipv4_defs);
-	struct rte_acl_config acl_build_param;
-	/*
-	 * Check numa socket enable or disable based on
-	 * get or set socketid.
-	 */
-	int socketid = app.numa_on?rte_socket_id():0;
-	/* struct rte_acl_param acl_param; */ //GCC_Security flag
-	/* char name[MAX_LEN]; */ ////GCC_Security flag
 	struct acl_config *pacl_config = &acl_config[type];
-	struct rte_acl_ctx *context = pacl_config->acx_ipv4[socketid];
+	int i;
 
-	if (socketid < 0) {
-		RTE_LOG_DP(ERR, ACL, "Invalid RTE socket Id: %d. \nExit.\n",
-			socketid);
-		return -1;
+	for (i = 0; i < NB_SOCKETS; i++) {
+		if (!pacl_config->mapped[i])
+			continue;
+		/* Delete all rules from the ACL context. */
+		rte_acl_reset_rules(pacl_config->acx_ipv4[i]);
+		add_rules_to_rte_acl(type, i);
 	}
+	return acl_rules_table[type/2].num_entries;
+}
 
-	/* --> GCC_Security flag */
-#if 0
-	sprintf(name, "ACLTable-%d", type);
-	acl_param.name = name;
-	acl_param.socket_id = socketid;
-	acl_param.rule_size = RTE_ACL_RULE_SZ(dim);
-	acl_param.max_rule_num = MAX_ACL_RULE_NUM;
-#endif
-	/* <-- GCC_Security flag */
-	/* Delete all rules from the ACL context. */
-	rte_acl_reset_rules(context);
-
-	add_rules_to_rte_acl(type);
+/**
+ * To build ACL table.
+ *	This funciton build the runtime trie of a standby table which
+ *	was loaded by reset_rules. It does not touch the rules table, so
+ *	it runs without acl_rules_lock held.
+ *
+ * @param type
+ *	table type to build.
+ * @param nb_rules
+ *	number of rules loaded in the context.
+ *
+ * @return
+ *	void
+ */
+static void
+build_rules(enum acl_cfg_tbl type, uint32_t nb_rules)
+{
+	int dim = RTE_DIM(ipv4_defs);
+	struct rte_acl_config acl_build_param;
+	struct acl_config *pacl_config = &acl_config[type];
+	int i;
 
 	/* Perform builds */
 	memset(&acl_build_param, 0, sizeof(acl_build_param));
@@ -1269,26 +1305,140 @@ reset_and_build_rules(enum acl_cfg_tbl type)
 
 	memcpy(&acl_build_param.defs, ipv4_defs,
 			sizeof(ipv4_defs));
-	if (rte_acl_build(context, &acl_build_param) != 0)
-		rte_exit(EXIT_FAILURE, "Failed to build ACL trie\n");
 
-	pacl_config->acx_ipv4_built[socketid] = 1;
+	for (i = 0; i < NB_SOCKETS; i++) {
+		if (!pacl_config->mapped[i])
+			continue;
+
+		if (nb_rules == 0) {
+			/* Empty table: drop the trie, lookup skips it */
+			rte_acl_reset(pacl_config->acx_ipv4[i]);
+			pacl_config->acx_ipv4_built[i] = 0;
+			continue;
+		}
+
+		if (rte_acl_build(pacl_config->acx_ipv4[i],
+					&acl_build_param) != 0)
+			rte_exit(EXIT_FAILURE, "Failed to build ACL trie\n");
+
+		pacl_config->acx_ipv4_built[i] = 1;
 
 #ifdef DEBUG_ACL
-	rte_acl_dump(context);
+		rte_acl_dump(pacl_config->acx_ipv4[i]);
 #endif
-	return 0;
+	}
 }
 
 /**
- *	To add sdf or adc filter in acl table.
- *	The entries are first stored in local memory and then updated on
- *	standby table.
+ * Request a standby rebuild of rules table.
+ *	Updates issued before the builder wakes up are coalesced into
+ *	a single rebuild. Call with acl_rules_lock held.
+ *
+ * @param param
+ *	rules table updated.
+ *
+ * @return
+ *	void
+ */
+static void
+acl_rules_commit(enum acl_rules_params param)
+{
+	acl_rebuild_pending |= (1 << param);
+	pthread_cond_broadcast(&acl_rules_cond);
+}
+
+/**
+ * ACL builder thread.
+ *	Reload and build the standby context of every pending rules table,
+ *	publish it as active and wait for a grace period, so that no
+ *	worker still classifies on the retired context when it is reused
+ *	as standby.
+ *
+ * @param arg
+ *	unused.
+ *
+ * @return
+ *	never returns.
+ */
+static void *
+acl_builder_thread(void *arg)
+{
+	enum acl_cfg_tbl standby;
+	uint32_t pending;
+	uint32_t nb_rules;
+	int param;
+
+	RTE_SET_USED(arg);
+
+	pthread_mutex_lock(&acl_rules_lock);
+	while (1) {
+		while (acl_rebuild_pending == 0)
+			pthread_cond_wait(&acl_rules_cond, &acl_rules_lock);
+
+		pending = acl_rebuild_pending;
+		acl_rebuild_pending = 0;
+		acl_rebuild_busy = 1;
+
+		for (param = 0; param < MAX_PARAM; param++) {
+			if (!(pending & (1 << param)))
+				continue;
+
+			standby = dp_acl_get_standby(*acl_active_tbl[param]);
+			nb_rules = reset_rules(standby);
+			pthread_mutex_unlock(&acl_rules_lock);
+
+			build_rules(standby, nb_rules);
+
+			/* Publish the built trie before the table flip */
+			rte_smp_wmb();
+			*acl_active_tbl[param] = standby;
+			epc_synchronize();
+
+			pthread_mutex_lock(&acl_rules_lock);
+		}
+
+		acl_rebuild_busy = 0;
+		pthread_cond_broadcast(&acl_rules_cond);
+	}
+
+	return NULL;
+}
+
+/**
+ * Start ACL builder thread.
+ *
+ * @return
+ *	void
+ */
+static void
+acl_builder_init(void)
+{
+	pthread_t tid;
+
+	if (pthread_create(&tid, NULL, acl_builder_thread, NULL) != 0)
+		rte_exit(EXIT_FAILURE, "Failed to create ACL builder thread\n");
+
+	pthread_setname_np(tid, "acl_builder");
+}
+
+void dp_acl_rules_sync(void)
+{
+	pthread_mutex_lock(&acl_rules_lock);
+	while (acl_rebuild_pending || acl_rebuild_busy)
+		pthread_cond_wait(&acl_rules_cond, &acl_rules_lock);
+	pthread_mutex_unlock(&acl_rules_lock);
+}
+
+/**
+ *	To add sdf or adc filter in acl rules table.
+ *	The entries are stored in local memory, the standby table is
+ *	updated by the builder thread on acl_rules_commit.
+ *	Call with acl_rules_lock held.
  *
  * @param name
  *	ACL table name (SDF/ADC), only for debug logs.
- * @param type
- *	table to add entry.
+ * @param param
+ *	rules table to add entry.
  * @param pkt_filter
  *	packet filter which include ruleid, priority and
  *		acl rule string to be added.
@@ -1298,7 +1448,8 @@ reset_and_build_rules(enum acl_cfg_tbl type)
  *	- -1 on failure
  */
 static int
-dp_filter_entry_add(char *name, enum acl_cfg_tbl type, struct pkt_filter *pkt_filter)
+dp_filter_entry_add(char *name, enum acl_rules_params param,
+			struct pkt_filter *pkt_filter)
 {
 	struct rte_acl_rule *next = NULL;
 	struct rte_hash *hash = NULL;
@@ -1354,38 +1505,22 @@ dp_filter_entry_add(char *name, enum acl_cfg_tbl type, struct pkt_filter *pkt_fi
 	next->data.userdata = rule_id + ACL_DENY_SIGNATURE;
 	next->data.priority = prio;
 	next->data.category_mask = -1;
-		if (dp_rules_entry_add(&acl_rules_table[type/2], (struct acl4_rule *)next) < 0)
+		if (dp_rules_entry_add(&acl_rules_table[param], (struct acl4_rule *)next) < 0)
 			return -1;
 
-	if (reset_and_build_rules(type) < 0)
-		return -1;
-
 	return 0;
 }
-/**
- *	to get standby table id from active table.
- *
- * @param type
- *	current active table id.
- *
- * @return
- *	standby table id
- */
-static int
-dp_acl_get_standby(enum acl_cfg_tbl type)
-{
-	return (type % 2)?(type - 1):(type + 1);
-}
 
 /**
- *	To delete sdf or adc filter in acl table.
- *	The entries are first removed in local memory and then updated on
- *	standby table.
+ *	To delete sdf or adc filter in acl rules table.
+ *	The entries are removed in local memory, the standby table is
+ *	updated by the builder thread on acl_rules_commit.
+ *	Call with acl_rules_lock held.
  *
  * @param name
  *	ACL table name (SDF/ADC), only for debug logs.
- * @param type
- *	table to add entry.
+ * @param param
+ *	rules table to delete entry.
  * @param pkt_filter
  *	packet filter which include ruleid, priority and
  *		acl rule string to be deleted.
@@ -1395,7 +1530,7 @@ dp_acl_get_standby(enum acl_cfg_tbl type)
  *	- -1 on failure
  */
 static int
-dp_filter_entry_delete(char *name, enum acl_cfg_tbl type,
+dp_filter_entry_delete(char *name, enum acl_rules_params param,
 			struct pkt_filter *pkt_filter_entry)
 {
 	uint32_t rule_id;
@@ -1410,9 +1545,7 @@ dp_filter_entry_delete(char *name, enum acl_cfg_tbl type,
 
 	struct acl4_rule rule;
 	rule.data.userdata = rule_id + ACL_DENY_SIGNATURE;
-	dp_rules_entry_delete(&acl_rules_table[type/2], &rule);
-
-	return reset_and_build_rules(type);
+	return dp_rules_entry_delete(&acl_rules_table[param], &rule);
 }
 /**
  *	To add sdf or adc filter in acl table.
@@ -1488,6 +1621,12 @@ dp_sdf_filter_table_delete(struct dp_id dp_id)
 	int i;
 	RTE_SET_USED(dp_id);
 	struct acl_config *pacl_config = &acl_config[SDF_ACTIVE];
+
+	pthread_mutex_lock(&acl_rules_lock);
+	while (acl_rebuild_busy)
+		pthread_cond_wait(&acl_rules_cond, &acl_rules_lock);
+	acl_rebuild_pending &= ~(1 << SDF_PARAM);
+
 	for (i = 0; i < NB_SOCKETS; i++)
 		if (pacl_config->mapped[i])
 			rte_acl_reset(pacl_config->acx_ipv4[i]);
@@ -1498,6 +1637,7 @@ dp_sdf_filter_table_delete(struct dp_id dp_id)
 			rte_acl_reset(pacl_config->acx_ipv4[i]);
 
 	dp_acl_rules_table_delete(&acl_rules_table[SDF_PARAM]);
+	pthread_mutex_unlock(&acl_rules_lock);
 
 	return 0;
 }
@@ -1505,19 +1645,17 @@ dp_sdf_filter_table_delete(struct dp_id dp_id)
 int
 dp_sdf_filter_entry_add(struct dp_id dp_id, struct pkt_filter *pkt_filter)
 {
-	static int is_first = 1;
-	enum acl_cfg_tbl standby = dp_acl_get_standby(sdf_active_tbl);
+	int ret;
 	RTE_SET_USED(dp_id);
 
-	if (is_first == 1) {
-		is_first = 0;
-	}
-
-	if (dp_filter_entry_add("SDF", standby, pkt_filter) < 0)
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_add("SDF", SDF_PARAM, pkt_filter);
+	if (ret == 0)
+		acl_rules_commit(SDF_PARAM);
+	pthread_mutex_unlock(&acl_rules_lock);
+	if (ret < 0)
 		return -1;
 
-	sdf_active_tbl = standby;
-
 	RTE_LOG_DP(INFO, DP, "ACL ADD:%s, rule_id:%d, rule:%s\n",
 			"SDF", pkt_filter->pcc_rule_id, pkt_filter->u.rule_str);
 	return 0;
@@ -1527,13 +1665,16 @@ int
 dp_sdf_filter_entry_delete(struct dp_id dp_id,
 			struct pkt_filter *pkt_filter_entry)
 {
-	enum acl_cfg_tbl standby = dp_acl_get_standby(sdf_active_tbl);
+	int ret;
 	RTE_SET_USED(dp_id);
-	if (dp_filter_entry_delete("SDF", standby, pkt_filter_entry) < 0)
-		return -1;
 
-	sdf_active_tbl = standby;
-	return 0;
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_delete("SDF", SDF_PARAM, pkt_filter_entry);
+	if (ret == 0)
+		acl_rules_commit(SDF_PARAM);
+	pthread_mutex_unlock(&acl_rules_lock);
+
+	return ret;
 }
 
 int
@@ -1567,6 +1708,11 @@ dp_adc_filter_table_delete(struct dp_id dp_id)
 	RTE_SET_USED(dp_id);
 	struct acl_config *pacl_config;
 
+	pthread_mutex_lock(&acl_rules_lock);
+	while (acl_rebuild_busy)
+		pthread_cond_wait(&acl_rules_cond, &acl_rules_lock);
+	acl_rebuild_pending &= ~((1 << ADC_UL_PARAM) | (1 << ADC_DL_PARAM));
+
 	pacl_config	= &acl_config[ADC_UL_PARAM];
 	for (i = 0; i < NB_SOCKETS; i++)
 		if (pacl_config->mapped[i])
@@ -1590,6 +1736,7 @@ dp_adc_filter_table_delete(struct dp_id dp_id)
 	dp_acl_rules_table_delete(&acl_rules_table[ADC_UL_PARAM]);
 
 	dp_acl_rules_table_delete(&acl_rules_table[ADC_DL_PARAM]);
+	pthread_mutex_unlock(&acl_rules_lock);
 
 	return 0;
 }
@@ -1597,46 +1744,51 @@ dp_adc_filter_table_delete(struct dp_id dp_id)
 int
 dp_adc_filter_entry_add(struct dp_id dp_id, struct pkt_filter *pkt_filter)
 {
-	enum acl_cfg_tbl standby = dp_acl_get_standby(adc_ul_active_tbl);
+	int ret;
 
 	RTE_SET_USED(dp_id);
 
-	if (dp_filter_entry_add("ADC", standby, pkt_filter) < 0)
-		return -1;
-	adc_ul_active_tbl = standby;
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_add("ADC", ADC_UL_PARAM, pkt_filter);
+	if (ret < 0)
+		goto out;
+	acl_rules_commit(ADC_UL_PARAM);
 
 	/* swap the src and dst address for DL traffic.*/
 	swap_src_dst_ip((char *)&pkt_filter->u.rule_str[0]);
 
-	standby = dp_acl_get_standby(adc_dl_active_tbl);
-	RTE_SET_USED(dp_id);
-	if (dp_filter_entry_add("ADC", standby, pkt_filter) < 0)
-		return -1;
-	adc_dl_active_tbl = standby;
-	return 0;
+	ret = dp_filter_entry_add("ADC", ADC_DL_PARAM, pkt_filter);
+	if (ret < 0)
+		goto out;
+	acl_rules_commit(ADC_DL_PARAM);
+out:
+	pthread_mutex_unlock(&acl_rules_lock);
+	return ret;
 }
 
 int
 dp_adc_filter_entry_delete(struct dp_id dp_id,
 				struct pkt_filter *pkt_filter_entry)
 {
-	enum acl_cfg_tbl standby = dp_acl_get_standby(adc_ul_active_tbl);
+	int ret;
 	RTE_SET_USED(dp_id);
-	if (dp_filter_entry_delete("ADC", standby, pkt_filter_entry) < 0)
-		return -1;
 
-	adc_ul_active_tbl = standby;
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_delete("ADC", ADC_UL_PARAM, pkt_filter_entry);
+	if (ret < 0)
+		goto out;
+	acl_rules_commit(ADC_UL_PARAM);
 
 	/* swap the src and dst address for DL traffic.*/
 	swap_src_dst_ip((char *)&pkt_filter_entry->u.rule_str[0]);
 
-	standby = dp_acl_get_standby(adc_dl_active_tbl);
-	RTE_SET_USED(dp_id);
-	if (dp_filter_entry_delete("ADC", standby, pkt_filter_entry) < 0)
-		return -1;
-
-	adc_dl_active_tbl = standby;
-	return 0;
+	ret = dp_filter_entry_delete("ADC", ADC_DL_PARAM, pkt_filter_entry);
+	if (ret < 0)
+		goto out;
+	acl_rules_commit(ADC_DL_PARAM);
+out:
+	pthread_mutex_unlock(&acl_rules_lock);
+	return ret;
 }
 
 /******************** Callback functions **********************/
@@ -1724,10 +1876,12 @@ void app_filter_tbl_init(void)
 	/* Create ADC Rule table*/
 	struct dp_id dp_id;
 	sprintf(dp_id.name, "ADC_Filter_Table");
+	acl_builder_init();
 	dp_adc_filter_table_create(dp_id, MAX_ADC_RULES + RESVD_IDS);
 
 	/* install DNS pkt filter*/
 	dns_entry_add(dp_id);
+	dp_acl_rules_sync();
 }
 
 uint32_t *dp_acl_lookup(struct rte_mbuf **m, int nb_rx,
@@ -1738,7 +1892,8 @@ uint32_t *dp_acl_lookup(struct rte_mbuf **m, int nb_rx,
 	unsigned lcore_id;
 
 	lcore_id = rte_lcore_id();
-	socketid = rte_lcore_to_socket_id(lcore_id);
+	/* Contexts exist only on socket 0 when numa is off */
+	socketid = app.numa_on ? (int)rte_lcore_to_socket_id(lcore_id) : 0;
 
 	if ((nb_rx > 0) && ((acl_config->acx_ipv4[socketid])->trans_table != NULL)) {
 
@@ -1774,7 +1929,7 @@ uint32_t *adc_dl_lookup(struct rte_mbuf **m, int nb_rx)
 
 int dp_sdf_default_entry_add(struct dp_id dp_id, uint32_t rule_id)
 {
-	enum acl_cfg_tbl standby = dp_acl_get_standby(sdf_active_tbl);
+	int ret;
 	struct pkt_filter pktf = {
 			.pcc_rule_id = rule_id,
 		};
@@ -1793,16 +1948,18 @@ int dp_sdf_default_entry_add(struct dp_id dp_id, uint32_t rule_id)
 		0, 0/*proto, proto_mask)*/
 		);
 
-	if (dp_filter_entry_add("SDF", standby, &pktf) < 0)
-		return -1;
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_add("SDF", SDF_PARAM, &pktf);
+	if (ret == 0)
+		acl_rules_commit(SDF_PARAM);
+	pthread_mutex_unlock(&acl_rules_lock);
 
-	sdf_active_tbl = standby;
-	return 0;
+	return ret;
 }
 
 int dp_sdf_default_entry_action_modify(struct dp_id dp_id, uint32_t rule_id)
 {
-	enum acl_cfg_tbl standby = dp_acl_get_standby(sdf_active_tbl);
+	int ret;
 
 	RTE_SET_USED(dp_id);
 
@@ -1811,8 +1968,6 @@ int dp_sdf_default_entry_action_modify(struct dp_id dp_id, uint32_t rule_id)
 
 	struct acl4_rule rule;
 	rule.data.userdata = rule_id + ACL_DENY_SIGNATURE;
-	if (dp_rules_entry_delete(&acl_rules_table[standby/2], &rule))
-		return -1;
 
 	struct pkt_filter pktf = {
 			.pcc_rule_id = SDF_DEFAULT_RULE_ID,
@@ -1830,27 +1985,34 @@ int dp_sdf_default_entry_action_modify(struct dp_id dp_id, uint32_t rule_id)
 		0, 0/*proto, proto_mask)*/
 		);
 
-	if (dp_filter_entry_add("SDF", standby, &pktf) < 0)
-		return -1;
+	/* Swap the default action in a single rebuild */
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_rules_entry_delete(&acl_rules_table[SDF_PARAM], &rule);
+	if (ret == 0)
+		ret = dp_filter_entry_add("SDF", SDF_PARAM, &pktf);
+	if (ret == 0)
+		acl_rules_commit(SDF_PARAM);
+	pthread_mutex_unlock(&acl_rules_lock);
 
-	sdf_active_tbl = standby;
-	return 0;
+	return ret;
 }
 
 int
 dp_adc_filter_default_entry_add(struct dp_id dp_id)
 {
 	struct pkt_filter adc_filter;
-	enum acl_cfg_tbl standby = dp_acl_get_standby(adc_ul_active_tbl);
+	int ret;
 	RTE_SET_USED(dp_id);
 
 	adc_filter.pcc_rule_id = ADC_DEFAULT_RULE_ID;
 	sprintf(adc_filter.u.rule_str, "0.0.0.0/0 0.0.0.0/0 "
 		"0 : 65535 0 : 65535 0x0/0x0\n");
 
-	if (dp_filter_entry_add("ADC", standby, &adc_filter) < 0)
-		return -1;
-	adc_ul_active_tbl = standby;
+	pthread_mutex_lock(&acl_rules_lock);
+	ret = dp_filter_entry_add("ADC", ADC_UL_PARAM, &adc_filter);
+	if (ret == 0)
+		acl_rules_commit(ADC_UL_PARAM);
+	pthread_mutex_unlock(&acl_rules_lock);
 
-	return 0;
+	return ret;
 }
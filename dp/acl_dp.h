@@ -277,5 +277,16 @@ dp_sdf_default_entry_action_modify(struct dp_id dp_id, uint32_t rule_id);
 int
 dp_adc_filter_default_entry_add(struct dp_id dp_id);
 
+/**
+ *  Wait until pending rule updates are built and active.
+ *	Filter updates return once the rules table is updated, the
+ *	standby tables are rebuilt and swapped in by the ACL builder thread.
+ *
+ * @return
+ *	void
+ */
+void
+dp_acl_rules_sync(void);
+
 #endif /* _ACL_H_ */
 
@@ -37,6 +37,7 @@
 #include <rte_debug.h>
 
 #include "cdr.h"
+#include "cdr_writer.h"
 #include "master_cdr.h"
 #include "util.h"
 
@@ -54,13 +55,6 @@
 
 
 char *cdr_path = DEFAULT_CDR_PATH;
-FILE *cdr_file;
-FILE *cdr_file_stream;
-char *cdr_file_stream_ptr;
-size_t cdr_file_stream_sizeloc;
-FILE *mtr_file;
-
-uint64_t cdr_count;
 
 #ifdef SGX_CDR
 	SSL *ssl_handle;
@@ -107,319 +101,74 @@ iptoa_prefix(struct ip_addr addr, uint16_t prefix)
 }
 
 
-/* begin static cdr callback fucntions */
-
-static const char *
-cdr_time_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	static char time_str[RECORD_TIME_LENGTH];
-	time_t t = time(NULL);
-	struct tm *tmp = localtime(&t);
-	if (tmp == NULL)
-		return NULL;
-	strftime(time_str, RECORD_TIME_LENGTH, RECORD_TIME_FORMAT, tmp);
-	return time_str;
-}
-
-static const char *
-cdr_state_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return "EVENT";
-}
-
-static const char *
-ue_ip_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return iptoa(session->ue_addr);
-}
-
-static uint64_t
-dl_pkt_cnt_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->dl_cdr.pkt_count;
-}
-
-static uint64_t
-dl_byptes_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->dl_cdr.bytes;
-}
-
-static uint64_t
-dl_drop_pkt_cnt_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->dl_drop.pkt_count;
-}
-
-static uint64_t
-dl_drop_bytes_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->dl_drop.bytes;
-}
-
-static uint64_t
-ul_pkt_cnt_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->ul_cdr.pkt_count;
-}
-
-static uint64_t
-ul_byptes_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	return vol->ul_cdr.bytes;
-}
-
-static uint32_t
-rule_id_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->rule_id;
-	else if (adc_rule)
-		return adc_rule->rule_id;
-	PANIC_ON_UNDEFINED_RULE();
-	return 0;
-}
-
-static const char *
-rule_type_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->sdf_idx_cnt > 0 ? "SDF":"ADC";
-	else if (adc_rule)
-		return "ADC";
-	PANIC_ON_UNDEFINED_RULE();
-	return NULL;
-}
-
-static const char *
-rule_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->rule_name;
-	else if (adc_rule)
-		switch (adc_rule->sel_type) {
-		case DOMAIN_IP_ADDR:
-			return iptoa(adc_rule->u.domain_ip);
-		case DOMAIN_IP_ADDR_PREFIX:
-			return iptoa_prefix(adc_rule->u.domain_prefix.ip_addr,
-					adc_rule->u.domain_prefix.prefix);
-		case DOMAIN_NAME:
-			return adc_rule->u.domain_name;
-		default: //GCC_Security flag
-			break;
-		};
-	PANIC_ON_UNDEFINED_RULE();
-	return NULL;
-}
-
-static const char *
-action_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	uint8_t gate_status = UINT8_MAX;
-	if (pcc_rule)
-		gate_status = pcc_rule->gate_status;
-	else
-		PANIC_ON_UNDEFINED_RULE();
-	switch (gate_status) {
-	case OPEN:
-		return "CHARGED";
-	case CLOSE:
-		return "DROPPED";
-	}
-	return "ERROR IN ADC RULE";
-}
-
-static const char *
-sponsor_id_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->sponsor_id;
-	PANIC_ON_UNDEFINED_RULE();
-	return 0;
-}
-
-static uint32_t
-service_id_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->service_id;
-	PANIC_ON_UNDEFINED_RULE();
-	return 0;
-}
-
-static uint32_t
-rate_group_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->rating_group;
-	PANIC_ON_UNDEFINED_RULE();
-	return 0;
-}
-
-static uint8_t
-report_level_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return pcc_rule->report_level;
-	PANIC_ON_UNDEFINED_RULE();
-	return 0;
-}
-
-#if 0
-/* TODO : Param is not present in pcc or adc rules file */
-static const char *
-tarriff_group_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return "(null)";
-	else if (adc_rule)
-		return adc_rule->tarriff_group;
-	PANIC_ON_UNDEFINED_RULE();
-	return NULL;
-}
-
-static const char *
-tarriff_time_cb(struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule) {
-	if (pcc_rule)
-		return "(null)";
-	else if (adc_rule)
-		return adc_rule->tarriff_time;
-	PANIC_ON_UNDEFINED_RULE();
-	return NULL;
-}
-#endif
 /* cdr field definition macros */
-#define DEFINE_VALUE(head, val) {\
-	.header = head, \
-	.type = CDR_VALUE, \
-	.format_specifier = "%"PRIu64",", \
-	.value = val}
-#define DEFINE_CB_64(head, func) {\
-	.header = head, \
-	.type = CDR_CB_64, \
-	.format_specifier = "%"PRIu64",", \
-	.cb_64 = func}
-#define DEFINE_CB_32(head, func) {\
-	.header = head, \
-	.type = CDR_CB_32, \
-	.format_specifier = "%"PRIu64",", \
-	.cb_32 = func}
-#define DEFINE_CB_8(head, func) {\
-	.header = head, \
-	.type = CDR_CB_8, \
-	.format_specifier = "%"PRIu64",", \
-	.cb_8 = func}
-#define DEFINE_CB_STR(head, func) {\
-	.header = head, \
-	.type = CDR_CB_STR, \
-	.format_specifier = "%s,", \
-	.cb_str = func}
+#define DEFINE_U64(head, field) {\
+	.header = head, .type = CDR_U64, .offset = CDR_OFF(field)}
+#define DEFINE_U32(head, field) {\
+	.header = head, .type = CDR_U32, .offset = CDR_OFF(field)}
+#define DEFINE_U8(head, field) {\
+	.header = head, .type = CDR_U8, .offset = CDR_OFF(field)}
+#define DEFINE_TIME(head) {\
+	.header = head, .type = CDR_TIME, .offset = CDR_OFF(time)}
+#define DEFINE_IPV4(head, field) {\
+	.header = head, .type = CDR_IPV4, .offset = CDR_OFF(field)}
+#define DEFINE_CHARS(head, field) {\
+	.header = head, .type = CDR_CHARS, .offset = CDR_OFF(field)}
+#define DEFINE_ENUM(head, field, strs) {\
+	.header = head, .type = CDR_ENUM, .offset = CDR_OFF(field), \
+	.names = strs}
+#define DEFINE_CONST(head, str) {\
+	.header = head, .type = CDR_CONST, \
+	.names = (const char * const []){str}}
 
 /* define cdr fields */
 struct cdr_field_t cdr_fields[NUM_CDR_FIELDS] = {
-		DEFINE_VALUE("record", &cdr_count),
-		[CDR_TIME_FIELD_INDEX] = DEFINE_CB_STR("time", cdr_time_cb),
-		DEFINE_CB_STR("state", cdr_state_cb),
-		DEFINE_CB_STR("ue_ip", ue_ip_cb),
-		DEFINE_CB_64("dl_pkt_cnt", dl_pkt_cnt_cb),
-		DEFINE_CB_64("dl_bytes", dl_byptes_cb),
-		DEFINE_CB_64("dl_drop_pkt_cnt", dl_drop_pkt_cnt_cb),
-		DEFINE_CB_64("dl_drop_bytes", dl_drop_bytes_cb),
-		DEFINE_CB_64("ul_pkt_cnt", ul_pkt_cnt_cb),
-		DEFINE_CB_64("ul_bytes", ul_byptes_cb),
-		DEFINE_CB_32("pcc_rule_id", rule_id_cb),
-		DEFINE_CB_STR("filter_type", rule_type_cb),
-		DEFINE_CB_STR("rule", rule_cb),
-		DEFINE_CB_STR("action", action_cb),
-		DEFINE_CB_STR("sponsor_id", sponsor_id_cb),
-		DEFINE_CB_32("service_id", service_id_cb),
-		DEFINE_CB_32("rate_group", rate_group_cb),
-		DEFINE_CB_8("report_level", report_level_cb),
+		DEFINE_U64("record", seq),
+		[CDR_TIME_FIELD_INDEX] = DEFINE_TIME("time"),
+		DEFINE_CONST("state", "EVENT"),
+		DEFINE_IPV4("ue_ip", ue_ip),
+		DEFINE_U64("dl_pkt_cnt", vol[CDR_DL_PKTS]),
+		DEFINE_U64("dl_bytes", vol[CDR_DL_BYTES]),
+		DEFINE_U64("dl_drop_pkt_cnt", vol[CDR_DL_DROP_PKTS]),
+		DEFINE_U64("dl_drop_bytes", vol[CDR_DL_DROP_BYTES]),
+		DEFINE_U64("ul_pkt_cnt", vol[CDR_UL_PKTS]),
+		DEFINE_U64("ul_bytes", vol[CDR_UL_BYTES]),
+		DEFINE_U32("pcc_rule_id", id),
+		DEFINE_ENUM("filter_type", rule_type, cdr_rule_type_str),
+		DEFINE_CHARS("rule", name),
+		DEFINE_ENUM("action", action, cdr_action_str),
+		DEFINE_CHARS("sponsor_id", sponsor_id),
+		DEFINE_U32("service_id", service_id),
+		DEFINE_U32("rate_group", rating_group),
+		DEFINE_U8("report_level", report_level),
 		/**
-		 * DEFINE_CB_STR("tarriff_group", tarriff_group_cb),
-		 * DEFINE_CB_STR("tarriff_time", tarriff_time_cb),
+		 * TODO : tarriff_group, tarriff_time params are not present
+		 * in pcc or adc rules file
 		 */
 };
 
-static void
-write_to_cdr(void)
-{
-	fflush(cdr_file_stream);
-
-#ifdef SGX_CDR
-	/* TODO: Add error handling for SSL_Write and reconnect */
-	int sent = -1;
-
-	if (ssl_handle == NULL)
-		rte_panic("Error in sending records to DealerIn. Exiting.");
-
-	sent = SSL_write(ssl_handle, cdr_file_stream_ptr,
-			cdr_file_stream_sizeloc);
-
-	if (sent <= 0) {
-		rte_panic("Error in sending records to SGX DealerIn. Error %d\n",
-			SSL_get_error(ssl_handle, sent));
-	}
-#else
-	fwrite(cdr_file_stream_ptr, sizeof(char),
-			cdr_file_stream_sizeloc, cdr_file);
-#endif /* SGX_CDR */
-	rewind(cdr_file_stream);
-}
-
+static const struct cdr_field_t mtr_fields[] = {
+		DEFINE_TIME("time"),
+		DEFINE_IPV4("UE_addr", ue_ip),
+		DEFINE_CHARS("Type", name),
+		DEFINE_U32("ID", id),
+		DEFINE_U64("drop_pkts", vol[CDR_DL_DROP_PKTS]),
+};
 
 /**
- * Writes the CDR field headers to file
+ * Copy volume counters into record.
  */
-static void
-export_cdr_field_headers(void)
+void
+cdr_rec_set_vol(struct cdr_rec *rec, struct chrg_data_vol *vol)
 {
-	unsigned i;
-	fprintf(cdr_file_stream, "#");
-	for (i = 0; i < RTE_DIM(cdr_fields); ++i)
-		fprintf(cdr_file_stream, "%s,", cdr_fields[i].header);
-	fprintf(cdr_file_stream, "\n");
-
-	write_to_cdr();
+	rec->vol[CDR_DL_PKTS] = vol->dl_cdr.pkt_count;
+	rec->vol[CDR_DL_BYTES] = vol->dl_cdr.bytes;
+	rec->vol[CDR_DL_DROP_PKTS] = vol->dl_drop.pkt_count;
+	rec->vol[CDR_DL_DROP_BYTES] = vol->dl_drop.bytes;
+	rec->vol[CDR_UL_PKTS] = vol->ul_cdr.pkt_count;
+	rec->vol[CDR_UL_BYTES] = vol->ul_cdr.bytes;
+	rec->vol[CDR_UL_DROP_PKTS] = vol->ul_drop.pkt_count;
+	rec->vol[CDR_UL_DROP_BYTES] = vol->ul_drop.bytes;
 }
 
 /**
@@ -434,7 +183,8 @@ export_cdr_field_headers(void)
  *	adc rule - nust be NULL if CDR applies to PCC rule
  *
  * NOTE: common function for both ADC and PCC rules. Either adc_rule OR pcc_rule
- * must be defined - not both.
+ * must be defined - not both. The record is formatted by the CDR writer
+ * thread.
  */
 static void
 export_record(struct dp_session_info *session,
@@ -442,8 +192,9 @@ export_record(struct dp_session_info *session,
 		struct dp_pcc_rules *pcc_rule,
 		struct adc_rules *adc_rule)
 {
-	unsigned i;
-	if (pcc_rule != NULL && adc_rule != NULL)
+	struct cdr_rec *rec;
+
+	if ((pcc_rule == NULL) == (adc_rule == NULL))
 		PANIC_ON_UNDEFINED_RULE();
 
 	if (!session)
@@ -453,42 +204,47 @@ export_record(struct dp_session_info *session,
 			|| vol->dl_drop.pkt_count || vol->ul_drop.pkt_count))
 		return;
 
-	for (i = 0; i < RTE_DIM(cdr_fields); ++i) {
-		switch (cdr_fields[i].type) {
-		case CDR_VALUE:
-			fprintf(cdr_file_stream, cdr_fields[i].format_specifier,
-					*cdr_fields[i].value);
-			break;
-		case CDR_CB_STR:
-			fprintf(cdr_file_stream, cdr_fields[i].format_specifier,
-					cdr_fields[i].cb_str(session,
-							vol, pcc_rule,
-							adc_rule));
+	rec = cdr_rec_alloc(CDR_STREAM_RULE);
+	if (rec == NULL)
+		return;
+
+	rec->ue_ip = session->ue_addr.u.ipv4_addr;
+	cdr_rec_set_vol(rec, vol);
+
+	if (pcc_rule) {
+		rec->id = pcc_rule->rule_id;
+		rec->rule_type = pcc_rule->sdf_idx_cnt > 0 ?
+				CDR_RULE_SDF : CDR_RULE_ADC;
+		rec->action = pcc_rule->gate_status == OPEN ?
+				CDR_ACTION_CHARGED : pcc_rule->gate_status == CLOSE ?
+				CDR_ACTION_DROPPED : CDR_ACTION_ERROR;
+		cdr_rec_strcpy(rec->name, pcc_rule->rule_name);
+		cdr_rec_strcpy(rec->sponsor_id, pcc_rule->sponsor_id);
+		rec->service_id = pcc_rule->service_id;
+		rec->rating_group = pcc_rule->rating_group;
+		rec->report_level = pcc_rule->report_level;
+	} else {
+		rec->id = adc_rule->rule_id;
+		rec->rule_type = CDR_RULE_ADC;
+		rec->action = CDR_ACTION_ERROR;
+		switch (adc_rule->sel_type) {
+		case DOMAIN_IP_ADDR:
+			cdr_rec_strcpy(rec->name, iptoa(adc_rule->u.domain_ip));
 			break;
-		case CDR_CB_8:
-			fprintf(cdr_file_stream, cdr_fields[i].format_specifier,
-					cdr_fields[i].cb_8(session,
-							vol, pcc_rule,
-							adc_rule));
+		case DOMAIN_IP_ADDR_PREFIX:
+			cdr_rec_strcpy(rec->name,
+					iptoa_prefix(adc_rule->u.domain_prefix.ip_addr,
+					adc_rule->u.domain_prefix.prefix));
 			break;
-		case CDR_CB_32:
-			fprintf(cdr_file_stream, cdr_fields[i].format_specifier,
-					cdr_fields[i].cb_32(session,
-							vol, pcc_rule,
-							adc_rule));
+		case DOMAIN_NAME:
+			cdr_rec_strcpy(rec->name, adc_rule->u.domain_name);
 			break;
-		case CDR_CB_64:
-			fprintf(cdr_file_stream, cdr_fields[i].format_specifier,
-					cdr_fields[i].cb_64(session,
-							vol, pcc_rule,
-							adc_rule));
+		default: //GCC_Security flag
 			break;
-		}
+		};
 	}
-	++cdr_count;
-	fprintf(cdr_file_stream, "\n");
 
-	write_to_cdr();
+	cdr_rec_submit(rec);
 }
 
 void
@@ -574,47 +330,71 @@ create_new_cdr_file(void)
 
 	get_cdr_filename(filename);
 
-	cdr_count = 0;
-	cdr_file = fopen(filename, "w");
-	if (!cdr_file)
-		rte_panic("CDR file %s failed to open for writing\n - %s (%d)",
-					filename, strerror(errno), errno);
-
-	setvbuf(cdr_file, NULL, _IOLBF, BUFFER_SIZE);
-
-	cdr_file_stream = open_memstream(&cdr_file_stream_ptr,
-			&cdr_file_stream_sizeloc);
-	if (!cdr_file_stream)
-		rte_panic("CDR file stream failed to open\n - %s (%d)",
-					strerror(errno), errno);
-
-	export_cdr_field_headers();
+	cdr_writer_open(CDR_STREAM_RULE, filename, cdr_fields,
+			RTE_DIM(cdr_fields), "#", RECORD_TIME_FORMAT);
 }
 
 void
 cdr_close(void)
 {
+	/* Drain and write queued records */
+	cdr_writer_stop();
+
 #ifdef SGX_CDR
 	if (ssl_handle != NULL) {
 		sgx_cdr_channel_close(ssl_handle);
 	}
-
-	fclose(cdr_file_stream);
-	free(cdr_file_stream_ptr);
-	cdr_file_stream_ptr = NULL;
 #else
-	if (cdr_file) {
-		FILE *old_cdr_file = cdr_file;
-		cdr_file = stderr;
-
-		fclose(old_cdr_file);
-		finalize_cur_cdrs(cdr_path);
-	}
+	finalize_cur_cdrs(cdr_path);
 
 	free_master_cdr();
 #endif /* SGX_CDR */
 }
 
+#ifdef SGX_CDR
+/* CDR file identity, sent first on every DealerIn connection */
+static char sgx_cdr_filename[PATH_MAX];
+
+/**
+ * Open the SGX DealerIn channel and send the CDR file identity.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+sgx_cdr_connect(void)
+{
+	int sent;
+
+	ssl_handle = sgx_cdr_channel_init(app.dealer_in_ip, app.dealer_in_port,
+				app.dp_cert_path, app.dp_pkey_path, app.dealer_in_mrenclave,
+				app.dealer_in_mrsigner, app.dealer_in_isvsvn);
+	if (ssl_handle == NULL)
+		return -1;
+
+	RTE_LOG_DP(DEBUG, DP, "SSLWrite filename :%s\n", sgx_cdr_filename);
+	sent = SSL_write(ssl_handle, sgx_cdr_filename, strlen(sgx_cdr_filename));
+	if (sent <= 0) {
+		RTE_LOG_DP(ERR, DP, "Error in sending filename to SGX DealerIn. "
+				"Error %d\n", SSL_get_error(ssl_handle, sent));
+		sgx_cdr_channel_close(ssl_handle);
+		ssl_handle = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+sgx_cdr_reconnect(void)
+{
+	sgx_cdr_channel_close(ssl_handle);
+	ssl_handle = NULL;
+	return sgx_cdr_connect();
+}
+#endif /* SGX_CDR */
+
 void mtr_init(void)
 {
 		char filename[30] = "./cdr/mtr.csv";
@@ -629,63 +409,25 @@ void mtr_init(void)
 
 		printf("Logging MTR Records to %s\n", filename);
 
-		mtr_file = fopen(filename, "w");
-		if (!mtr_file)
-			rte_panic("CDR file %s failed to open for writing\n"
-					" - %s (%d)",
-					filename, strerror(errno), errno);
-
-		if (fprintf(mtr_file, "#%s,%s,%s,%s,%s\n",
-				"time",
-				"UE_addr",
-				"Type",
-				"ID",
-				"drop_pkts") < 0)
-			rte_panic("%s [%d] fprintf(cdr_file header failed -"
-				" %s (%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
-		if (fflush(mtr_file))
-			rte_panic("%s [%d] fflush(cdr_file failed - %s (%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
+		cdr_writer_open(CDR_STREAM_MTR, filename, mtr_fields,
+				RTE_DIM(mtr_fields), "#", "%y%m%d_%H%M%S");
 }
 
 void
 cdr_init(void)
 {
+	cdr_writer_init();
+
 #ifdef SGX_CDR
-	ssl_handle = sgx_cdr_channel_init(app.dealer_in_ip, app.dealer_in_port,
-				app.dp_cert_path, app.dp_pkey_path, app.dealer_in_mrenclave,
-				app.dealer_in_mrsigner, app.dealer_in_isvsvn);
+	get_cdr_filename(sgx_cdr_filename);
+	printf("Identify/Filename is  %s\n", sgx_cdr_filename);
 
-	if (ssl_handle == NULL) {
+	if (sgx_cdr_connect() < 0)
 		rte_panic("Error in connecting to DealerIn.\n");
-	}
-
-	/* TODO: Add error handling for SSL_Write and reconnect*/
-	int sent = -1;
-	char filename[PATH_MAX];
-
-	get_cdr_filename(filename);
-	printf("Identify/Filename is  %s\n", filename);
-
-	if (ssl_handle != NULL) {
-			RTE_LOG_DP(DEBUG, DP, "SSLWrite filename :%s\n",filename);
-			sent = SSL_write(ssl_handle, filename, strlen(filename));
-
-			if (sent <= 0) {
-				rte_panic("Error in sending filename to SGX DealerIn. Error %d\n",
-					SSL_get_error(ssl_handle, sent));
-			}
-	}
-
-	/* Open stream to write */
-	cdr_file_stream = open_memstream(&cdr_file_stream_ptr,
-						&cdr_file_stream_sizeloc);
-	if (!cdr_file_stream)
-		rte_panic("CDR file stream failed to open\n - %s (%d)",
-				strerror(errno), errno);
 
-	export_cdr_field_headers();
+	/* Records go to the DealerIn channel */
+	cdr_writer_open(CDR_STREAM_RULE, NULL, cdr_fields,
+			RTE_DIM(cdr_fields), "#", RECORD_TIME_FORMAT);
 #else
 	create_sys_path(cdr_path);
 
@@ -716,21 +458,14 @@ export_session_adc_record(struct adc_rules *adc_rule,
 void export_mtr(struct dp_session_info *session,
 		char *name, uint32_t id, uint64_t drops)
 {
-	/* create time string */
-	char time_str[30];
-	time_t t = time(NULL);
-	struct tm *tmp = localtime(&t);
-	if (tmp == NULL)
+	struct cdr_rec *rec = cdr_rec_alloc(CDR_STREAM_MTR);
+
+	if (rec == NULL)
 		return;
-	strftime(time_str, sizeof(time_str), "%y%m%d_%H%M%S", tmp);
-	fprintf(mtr_file, "%s,%s,%s,%d,%"PRIu64"\n",
-				time_str,
-				iptoa(session->ue_addr),
-				name,
-				id,
-				drops);
-
-	if (fflush(mtr_file))
-		rte_panic("%s [%d] fflush(cdr_file failed - %s (%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
+
+	rec->ue_ip = session->ue_addr.u.ipv4_addr;
+	cdr_rec_strcpy(rec->name, name);
+	rec->id = id;
+	rec->vol[CDR_DL_DROP_PKTS] = drops;
+	cdr_rec_submit(rec);
 }
@@ -22,6 +22,7 @@
  * PCC and ADC charging records.
  */
 #include "main.h"
+#include "cdr_writer.h"
 
 #define CDR_CUR_EXTENSION ".cur"
 #define CDR_CSV_EXTENSION ".csv"
@@ -35,39 +36,6 @@
 #define BUFFER_SIZE 4096
 
 
-/* cdr field type callbacks
- * all callbacks must have the same parameters
- */
-typedef uint64_t (*cb_64_type) (struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule);
-typedef uint32_t (*cb_32_type) (struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule);
-typedef const char *(*cb_str_type) (struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule);
-typedef uint8_t (*cb_8_type) (struct dp_session_info *session,
-		struct chrg_data_vol *vol,
-		struct dp_pcc_rules *pcc_rule,
-		struct adc_rules *adc_rule);
-
-struct cdr_field_t {
-	const char *header;
-	enum {CDR_VALUE, CDR_CB_64, CDR_CB_32, CDR_CB_8, CDR_CB_STR} type;
-	const char *format_specifier;
-	union {
-		uint64_t *value;
-		cb_64_type cb_64;
-		cb_32_type cb_32;
-		cb_8_type cb_8;
-		cb_str_type cb_str;
-	};
-};
-
 extern struct cdr_field_t cdr_fields[NUM_CDR_FIELDS];
 extern char *cdr_path;
 
@@ -84,11 +52,21 @@ void
 cdr_init(void);
 
 /**
- * Closes current cdr file and redirects any remaining output to stderr
+ * Writes queued records and closes current cdr file
  */
 void
 cdr_close(void);
 
+/**
+ * Copy volume counters into a CDR writer record.
+ * @param rec
+ *	record.
+ * @param vol
+ *	cdr volume.
+ */
+void
+cdr_rec_set_vol(struct cdr_rec *rec, struct chrg_data_vol *vol);
+
 /**
  * Sets configurable CDR path based on argument. String stored is ends with '/'.
  * @param path
@@ -195,17 +173,21 @@ extended_cdr_init(void);
 /**
  * Export extended CDR record to file.
  * @param ue_ip
- *	ue ip.
+ *	ue ipv4, host order.
  * @param app_ip
- *	application ip.
+ *	application ipv4, host order.
+ * @param pkt_mask
+ *	1 if packet is charged, 0 if dropped.
  * @param pcc_info
  *	pcc rule information
+ * @param direction
+ *	UL_FLOW or DL_FLOW.
  *
  * @return
  * Void
  */
 void
-export_extended_cdr(char *ue_ip, char *app_ip, uint8_t pkt_mask,
+export_extended_cdr(uint32_t ue_ip, uint32_t app_ip, uint8_t pkt_mask,
 		struct pcc_rules *pcc_info, int direction);
 
 #ifdef PERF_ANALYSIS
@@ -0,0 +1,584 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE     /* Expose declaration of pthread_setname_np() */
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include <rte_atomic.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_debug.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+#include "cdr_writer.h"
+
+#ifdef SGX_CDR
+#include "ssl_client.h"
+extern SSL *ssl_handle;
+#endif /* SGX_CDR */
+
+/* Longest CSV line; the active page is swapped below this much room */
+#define CDR_WR_LINE_MAX		1024
+
+const char * const cdr_rule_type_str[] = {
+	[CDR_RULE_SDF] = "SDF",
+	[CDR_RULE_ADC] = "ADC",
+};
+
+const char * const cdr_action_str[] = {
+	[CDR_ACTION_CHARGED] = "CHARGED",
+	[CDR_ACTION_DROPPED] = "DROPPED",
+	[CDR_ACTION_ERROR] = "ERROR IN ADC RULE",
+};
+
+const char * const cdr_direction_str[] = {
+	[CDR_DIR_UL] = "UL",
+	[CDR_DIR_DL] = "DL",
+};
+
+struct cdr_wr_page {
+	char *buf;
+	size_t len;
+};
+
+/**
+ * Output file with its page pair. page[cur] is filled by the writer
+ * thread; page[cur ^ 1] is owned by the flush thread while pending.
+ */
+struct cdr_wr_stream {
+	int fd;
+	const struct cdr_field_t *fields;
+	uint32_t nb_fields;
+	const char *header_prefix;
+	const char *time_fmt;
+	struct cdr_wr_page page[2];
+	uint32_t cur;
+	/** page[cur ^ 1] waits for the flush thread */
+	volatile uint32_t pending;
+	/** TSC of last swap */
+	uint64_t swap_tsc;
+	/** records written */
+	uint64_t seq;
+	/** last formatted time, per second */
+	uint64_t time;
+	char time_str[32];
+};
+
+static struct {
+	struct rte_ring *ring;
+	struct rte_mempool *pool;
+	struct cdr_wr_stream stream[CDR_STREAM_MAX];
+	uint64_t flush_cycles;
+	/** records dropped, counted by every producer */
+	rte_atomic64_t drops;
+	pthread_t writer;
+	pthread_t flusher;
+	pthread_mutex_t lock;
+	/** flusher has a pending page */
+	pthread_cond_t ready;
+	/** flusher wrote a pending page */
+	pthread_cond_t done;
+	volatile int stop_writer;
+	volatile int stop_flusher;
+	int running;
+} cdr_wr = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.ready = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER,
+};
+
+#ifdef SGX_CDR
+/**
+ * Write buffer to the SGX DealerIn channel. A failed channel is reopened
+ * and the rest of the buffer sent again, up to CDR_WR_SSL_RETRIES times
+ * in a row.
+ */
+static void
+cdr_wr_ssl_out(const char *buf, size_t len)
+{
+	uint32_t retries = 0;
+	int ret, err;
+
+	while (len) {
+		if (ssl_handle != NULL) {
+			ret = SSL_write(ssl_handle, buf, len);
+			if (ret > 0) {
+				buf += ret;
+				len -= ret;
+				retries = 0;
+				continue;
+			}
+			err = SSL_get_error(ssl_handle, ret);
+			if (err == SSL_ERROR_WANT_READ ||
+					err == SSL_ERROR_WANT_WRITE)
+				continue;
+			RTE_LOG(ERR, USER1, "Error in sending records to SGX "
+					"DealerIn. Error %d, reconnecting\n", err);
+		}
+
+		if (retries++ == CDR_WR_SSL_RETRIES)
+			rte_panic("Error in sending records to SGX DealerIn. "
+					"Exiting.\n");
+		if (sgx_cdr_reconnect() < 0)
+			sleep(1);
+	}
+}
+#endif /* SGX_CDR */
+
+/**
+ * Write buffer to stream file, retrying partial writes.
+ */
+static void
+cdr_wr_out(enum cdr_stream stream, const char *buf, size_t len)
+{
+	struct cdr_wr_stream *s = &cdr_wr.stream[stream];
+	ssize_t ret;
+
+#ifdef SGX_CDR
+	if (stream == CDR_STREAM_RULE) {
+		cdr_wr_ssl_out(buf, len);
+		return;
+	}
+#endif /* SGX_CDR */
+
+	while (len) {
+		ret = write(s->fd, buf, len);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			rte_panic("%s [%d] CDR write failed - %s (%d)\n",
+					__FILE__, __LINE__, strerror(errno), errno);
+		}
+		buf += ret;
+		len -= ret;
+	}
+}
+
+/**
+ * Flush thread: write pending pages.
+ */
+static void *
+cdr_flush_thread(void *arg)
+{
+	struct cdr_wr_page *page;
+	uint32_t i, found;
+
+	RTE_SET_USED(arg);
+
+	pthread_mutex_lock(&cdr_wr.lock);
+	for (;;) {
+		found = 0;
+		for (i = 0; i < CDR_STREAM_MAX; i++) {
+			if (!cdr_wr.stream[i].pending)
+				continue;
+
+			page = &cdr_wr.stream[i].page[cdr_wr.stream[i].cur ^ 1];
+			pthread_mutex_unlock(&cdr_wr.lock);
+			cdr_wr_out(i, page->buf, page->len);
+			page->len = 0;
+			pthread_mutex_lock(&cdr_wr.lock);
+
+			cdr_wr.stream[i].pending = 0;
+			pthread_cond_broadcast(&cdr_wr.done);
+			found = 1;
+		}
+
+		if (found)
+			continue;
+		if (cdr_wr.stop_flusher)
+			break;
+		pthread_cond_wait(&cdr_wr.ready, &cdr_wr.lock);
+	}
+	pthread_mutex_unlock(&cdr_wr.lock);
+
+	return NULL;
+}
+
+/**
+ * Wait until the flush thread wrote the stream pending page.
+ */
+static void
+cdr_wr_wait(struct cdr_wr_stream *s)
+{
+	pthread_mutex_lock(&cdr_wr.lock);
+	while (s->pending)
+		pthread_cond_wait(&cdr_wr.done, &cdr_wr.lock);
+	pthread_mutex_unlock(&cdr_wr.lock);
+}
+
+/**
+ * Hand the active page to the flush thread and fill the other one.
+ */
+static void
+cdr_wr_swap(struct cdr_wr_stream *s)
+{
+	s->swap_tsc = rte_rdtsc();
+	if (s->page[s->cur].len == 0)
+		return;
+
+	pthread_mutex_lock(&cdr_wr.lock);
+	while (s->pending)
+		pthread_cond_wait(&cdr_wr.done, &cdr_wr.lock);
+	s->cur ^= 1;
+	s->pending = 1;
+	pthread_cond_signal(&cdr_wr.ready);
+	pthread_mutex_unlock(&cdr_wr.lock);
+}
+
+#ifndef CDR_BINARY
+/**
+ * Format record as a CSV line at end of page.
+ */
+static void
+cdr_wr_csv(struct cdr_wr_stream *s, struct cdr_wr_page *page,
+		const struct cdr_rec *rec)
+{
+	char *p = page->buf + page->len;
+	char *end = page->buf + CDR_WR_PAGE_SIZE;
+	const struct cdr_field_t *f;
+	const uint8_t *field;
+	struct tm tm;
+	time_t t;
+	uint32_t i, ip;
+	int n = 0;
+
+	for (i = 0; i < s->nb_fields; i++) {
+		f = &s->fields[i];
+		field = (const uint8_t *)rec + f->offset;
+
+		switch (f->type) {
+		case CDR_U64:
+			n = snprintf(p, end - p, "%"PRIu64",",
+					*(const uint64_t *)field);
+			break;
+		case CDR_U32:
+			n = snprintf(p, end - p, "%"PRIu32",",
+					*(const uint32_t *)field);
+			break;
+		case CDR_U8:
+			n = snprintf(p, end - p, "%"PRIu8",", *field);
+			break;
+		case CDR_TIME:
+			if (rec->time != s->time) {
+				t = rec->time;
+				s->time = rec->time;
+				s->time_str[0] = '\0';
+				if (localtime_r(&t, &tm) != NULL)
+					strftime(s->time_str, sizeof(s->time_str),
+							s->time_fmt, &tm);
+			}
+			n = snprintf(p, end - p, "%s,", s->time_str);
+			break;
+		case CDR_IPV4:
+			ip = *(const uint32_t *)field;
+			n = snprintf(p, end - p, "%u.%u.%u.%u,",
+					(ip >> 24) & 0xff, (ip >> 16) & 0xff,
+					(ip >> 8) & 0xff, ip & 0xff);
+			break;
+		case CDR_CHARS:
+			n = snprintf(p, end - p, "%.*s,", CDR_NAME_LEN,
+					(const char *)field);
+			break;
+		case CDR_ENUM:
+			n = snprintf(p, end - p, "%s,", f->names[*field]);
+			break;
+		case CDR_CONST:
+			n = snprintf(p, end - p, "%s,", f->names[0]);
+			break;
+		}
+		p += RTE_MIN(n, end - p - 1);
+	}
+
+	/* Replace last separator */
+	if (p > page->buf + page->len)
+		p[-1] = '\n';
+	page->len = p - page->buf;
+}
+#endif /* CDR_BINARY */
+
+/**
+ * Write stream CSV header line.
+ */
+static void
+cdr_wr_header(struct cdr_wr_stream *s)
+{
+#ifndef CDR_BINARY
+	char header[CDR_WR_LINE_MAX];
+	int len;
+	uint32_t i;
+
+	len = snprintf(header, sizeof(header), "%s", s->header_prefix);
+	for (i = 0; i < s->nb_fields && len < (int)sizeof(header); i++)
+		len += snprintf(header + len, sizeof(header) - len, "%s,",
+				s->fields[i].header);
+	len = RTE_MIN(len, (int)sizeof(header) - 1);
+	/* No prefix and no columns: no header line */
+	if (len <= 0)
+		return;
+	header[len - 1] = '\n';
+	cdr_wr_out(s - cdr_wr.stream, header, len);
+#else
+	RTE_SET_USED(s);
+#endif /* CDR_BINARY */
+}
+
+/**
+ * Truncate stream file and restart it with its header line.
+ */
+static void
+cdr_wr_reset(struct cdr_wr_stream *s)
+{
+	cdr_wr_swap(s);
+	cdr_wr_wait(s);
+
+	if (s->fd >= 0 && (ftruncate(s->fd, 0) < 0 ||
+			lseek(s->fd, 0, SEEK_SET) < 0))
+		rte_panic("%s [%d] CDR truncate failed - %s (%d)\n",
+				__FILE__, __LINE__, strerror(errno), errno);
+	s->seq = 0;
+	cdr_wr_header(s);
+}
+
+/**
+ * Append record to the active page of its stream.
+ */
+static void
+cdr_wr_record(struct cdr_rec *rec)
+{
+	struct cdr_wr_stream *s = &cdr_wr.stream[rec->stream];
+	struct cdr_wr_page *page;
+
+	if (rec->op == CDR_OP_RESET) {
+		cdr_wr_reset(s);
+		return;
+	}
+
+	if (CDR_WR_PAGE_SIZE - s->page[s->cur].len < CDR_WR_LINE_MAX)
+		cdr_wr_swap(s);
+	page = &s->page[s->cur];
+
+	rec->seq = s->seq++;
+#ifdef CDR_BINARY
+	memcpy(page->buf + page->len, rec, sizeof(*rec));
+	page->len += sizeof(*rec);
+#else
+	cdr_wr_csv(s, page, rec);
+#endif /* CDR_BINARY */
+}
+
+/**
+ * Writer thread: dequeue records in bursts, format them, swap pages on
+ * size or age.
+ */
+static void *
+cdr_writer_thread(void *arg)
+{
+	struct cdr_rec *rec[CDR_WR_BURST];
+	uint32_t i, n;
+	uint64_t now;
+	int stop;
+
+	RTE_SET_USED(arg);
+
+	for (;;) {
+		/* Sample stop before dequeue: no record is left behind */
+		stop = cdr_wr.stop_writer;
+		rte_smp_rmb();
+
+		n = rte_ring_sc_dequeue_burst(cdr_wr.ring, (void **)rec,
+				CDR_WR_BURST, NULL);
+		for (i = 0; i < n; i++)
+			cdr_wr_record(rec[i]);
+		if (n)
+			rte_mempool_put_bulk(cdr_wr.pool, (void **)rec, n);
+
+		now = rte_rdtsc();
+		for (i = 0; i < CDR_STREAM_MAX; i++)
+			if (now - cdr_wr.stream[i].swap_tsc >= cdr_wr.flush_cycles)
+				cdr_wr_swap(&cdr_wr.stream[i]);
+
+		if (n == 0) {
+			if (stop)
+				break;
+			usleep(CDR_WR_IDLE_US);
+		}
+	}
+
+	for (i = 0; i < CDR_STREAM_MAX; i++) {
+		cdr_wr_swap(&cdr_wr.stream[i]);
+		cdr_wr_wait(&cdr_wr.stream[i]);
+	}
+
+	return NULL;
+}
+
+void
+cdr_writer_init(void)
+{
+	uint32_t i, j;
+
+	if (cdr_wr.running)
+		return;
+
+	cdr_wr.pool = rte_mempool_create("CDR_RECORDS", CDR_WR_RING_SIZE - 1,
+			sizeof(struct cdr_rec), 0, 0, NULL, NULL, NULL, NULL,
+			rte_socket_id(), 0);
+	if (cdr_wr.pool == NULL)
+		rte_panic("Failed to create CDR record pool\n");
+
+	cdr_wr.ring = rte_ring_create("CDR_WR_RING", CDR_WR_RING_SIZE,
+			rte_socket_id(), RING_F_SC_DEQ);
+	if (cdr_wr.ring == NULL)
+		rte_panic("Failed to create CDR writer ring\n");
+
+	for (i = 0; i < CDR_STREAM_MAX; i++) {
+		cdr_wr.stream[i].fd = -1;
+		for (j = 0; j < RTE_DIM(cdr_wr.stream[i].page); j++) {
+			cdr_wr.stream[i].page[j].buf = rte_malloc(NULL,
+					CDR_WR_PAGE_SIZE, RTE_CACHE_LINE_SIZE);
+			if (cdr_wr.stream[i].page[j].buf == NULL)
+				rte_panic("Failed to allocate CDR page\n");
+		}
+	}
+
+	cdr_wr.flush_cycles = rte_get_tsc_hz() * CDR_WR_FLUSH_MS / 1000;
+	cdr_wr.stop_writer = 0;
+	cdr_wr.stop_flusher = 0;
+
+	if (pthread_create(&cdr_wr.flusher, NULL, cdr_flush_thread, NULL) != 0)
+		rte_panic("Failed to create CDR flush thread\n");
+	pthread_setname_np(cdr_wr.flusher, "cdr_flush");
+
+	if (pthread_create(&cdr_wr.writer, NULL, cdr_writer_thread, NULL) != 0)
+		rte_panic("Failed to create CDR writer thread\n");
+	pthread_setname_np(cdr_wr.writer, "cdr_writer");
+
+	cdr_wr.running = 1;
+}
+
+void
+cdr_writer_open(enum cdr_stream stream, const char *filename,
+		const struct cdr_field_t *fields, uint32_t nb_fields,
+		const char *header_prefix, const char *time_fmt)
+{
+	struct cdr_wr_stream *s = &cdr_wr.stream[stream];
+
+	s->fields = fields;
+	s->nb_fields = nb_fields;
+	s->header_prefix = header_prefix;
+	s->time_fmt = time_fmt;
+	s->time = UINT64_MAX;
+	s->swap_tsc = rte_rdtsc();
+
+	if (filename != NULL) {
+		s->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR |
+				S_IWUSR | S_IRGRP | S_IROTH);
+		if (s->fd < 0)
+			rte_panic("CDR file %s failed to open for writing\n"
+					" - %s (%d)", filename, strerror(errno), errno);
+	}
+
+	/* No record of this stream is queued yet: safe to write here */
+	s->seq = 0;
+	cdr_wr_header(s);
+}
+
+struct cdr_rec *
+cdr_rec_alloc(enum cdr_stream stream)
+{
+	struct cdr_rec *rec;
+
+	if (!cdr_wr.running ||
+			rte_mempool_get(cdr_wr.pool, (void **)&rec) < 0) {
+		rte_atomic64_inc(&cdr_wr.drops);
+		return NULL;
+	}
+
+	memset(rec, 0, sizeof(*rec));
+	rec->op = CDR_OP_RECORD;
+	rec->stream = stream;
+	rec->time = time(NULL);
+	return rec;
+}
+
+void
+cdr_rec_submit(struct cdr_rec *rec)
+{
+	/* Ring holds the whole pool: cannot be full */
+	rte_ring_mp_enqueue(cdr_wr.ring, rec);
+}
+
+void
+cdr_writer_reset(enum cdr_stream stream)
+{
+	struct cdr_rec *rec = cdr_rec_alloc(stream);
+
+	if (rec == NULL)
+		return;
+
+	rec->op = CDR_OP_RESET;
+	cdr_rec_submit(rec);
+}
+
+void
+cdr_writer_stop(void)
+{
+	uint32_t i, j;
+
+	if (!cdr_wr.running)
+		return;
+
+	cdr_wr.stop_writer = 1;
+	pthread_join(cdr_wr.writer, NULL);
+
+	pthread_mutex_lock(&cdr_wr.lock);
+	cdr_wr.stop_flusher = 1;
+	pthread_cond_signal(&cdr_wr.ready);
+	pthread_mutex_unlock(&cdr_wr.lock);
+	pthread_join(cdr_wr.flusher, NULL);
+
+	for (i = 0; i < CDR_STREAM_MAX; i++) {
+		if (cdr_wr.stream[i].fd >= 0)
+			close(cdr_wr.stream[i].fd);
+		cdr_wr.stream[i].fd = -1;
+		for (j = 0; j < RTE_DIM(cdr_wr.stream[i].page); j++) {
+			rte_free(cdr_wr.stream[i].page[j].buf);
+			cdr_wr.stream[i].page[j].buf = NULL;
+		}
+	}
+
+	rte_ring_free(cdr_wr.ring);
+	rte_mempool_free(cdr_wr.pool);
+	cdr_wr.running = 0;
+}
+
+uint64_t
+cdr_writer_drops(void)
+{
+	return rte_atomic64_read(&cdr_wr.drops);
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CDR_WRITER_H
+#define _CDR_WRITER_H
+/**
+ * @file
+ * Charging record writer. Exporters fill a fixed size binary record and
+ * enqueue it; a writer thread formats records in bursts into the active
+ * page of a double buffered pair per output file, and a flush thread
+ * writes the other page with a single write. Pages are swapped when full
+ * or when CDR_WR_FLUSH_MS elapsed since the last swap.
+ *
+ * Records are written as CSV lines, or raw struct cdr_rec when built
+ * with CDR_BINARY.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Records queued to the writer thread */
+#define CDR_WR_RING_SIZE	(1 << 16)
+
+/* Records formatted per ring dequeue */
+#define CDR_WR_BURST		256
+
+/* Page size; one write per page */
+#define CDR_WR_PAGE_SIZE	(1 << 20)
+
+/* Max age of buffered records */
+#define CDR_WR_FLUSH_MS		1000
+
+/* Writer thread sleep when ring is empty */
+#define CDR_WR_IDLE_US		1000
+
+/* Name fields, truncated */
+#define CDR_NAME_LEN		64
+
+/* SGX DealerIn reconnects per failed write before giving up */
+#define CDR_WR_SSL_RETRIES	3
+
+/**
+ * Output files, one per record type.
+ */
+enum cdr_stream {
+	CDR_STREAM_RULE,	/* PCC/ADC rule records: cdr.c */
+	CDR_STREAM_SESS,	/* per session records: session_cdr.c */
+	CDR_STREAM_EXT,		/* per packet records: extended_cdr.c */
+	CDR_STREAM_MTR,		/* meter drop records: cdr.c */
+	CDR_STREAM_MAX
+};
+
+/**
+ * Volume counters, struct cdr_rec vol[] index.
+ */
+enum cdr_vol {
+	CDR_DL_PKTS,
+	CDR_DL_BYTES,
+	CDR_DL_DROP_PKTS,
+	CDR_DL_DROP_BYTES,
+	CDR_UL_PKTS,
+	CDR_UL_BYTES,
+	CDR_UL_DROP_PKTS,
+	CDR_UL_DROP_BYTES,
+	CDR_REC_VOL_MAX
+};
+
+/**
+ * Writer operations.
+ */
+enum cdr_op {
+	CDR_OP_RECORD,		/* append record */
+	CDR_OP_RESET,		/* truncate stream file */
+};
+
+/**
+ * Charging record as queued to the writer. Exporters copy what they need
+ * out of sessions and rules: the writer never dereferences DP tables.
+ */
+struct cdr_rec {
+	/** enum cdr_op */
+	uint8_t op;
+	/** enum cdr_stream */
+	uint8_t stream;
+	/** cdr_rule_type_str[] index */
+	uint8_t rule_type;
+	/** cdr_action_str[] index */
+	uint8_t action;
+	/** cdr_direction_str[] index */
+	uint8_t direction;
+	uint8_t report_level;
+	uint16_t pad;
+	/** rule, bearer, flow or rating group id */
+	uint32_t id;
+	uint32_t service_id;
+	uint32_t rating_group;
+	/** UE or source ipv4, host order */
+	uint32_t ue_ip;
+	/** application or destination ipv4, host order */
+	uint32_t app_ip;
+	/** record number in stream, set by writer */
+	uint64_t seq;
+	/** time of export */
+	uint64_t time;
+	uint64_t sess_id;
+	uint64_t vol[CDR_REC_VOL_MAX];
+	/** rule name, cdr type or meter type */
+	char name[CDR_NAME_LEN];
+	char sponsor_id[CDR_NAME_LEN];
+};
+
+/* struct cdr_field_t offset of a record field */
+#define CDR_OFF(field)		offsetof(struct cdr_rec, field)
+
+/**
+ * CSV column of a stream: header and record field.
+ */
+struct cdr_field_t {
+	const char *header;
+	enum {CDR_U64, CDR_U32, CDR_U8, CDR_TIME, CDR_IPV4, CDR_CHARS,
+		CDR_ENUM, CDR_CONST} type;
+	/** field offset in struct cdr_rec */
+	uint16_t offset;
+	/** CDR_ENUM strings, CDR_CONST string */
+	const char * const *names;
+};
+
+/* cdr_rec enum strings */
+enum {CDR_RULE_SDF, CDR_RULE_ADC};
+enum {CDR_ACTION_CHARGED, CDR_ACTION_DROPPED, CDR_ACTION_ERROR};
+enum {CDR_DIR_UL, CDR_DIR_DL};
+
+extern const char * const cdr_rule_type_str[];
+extern const char * const cdr_action_str[];
+extern const char * const cdr_direction_str[];
+
+/**
+ * Copy a string into a record name field, truncated to CDR_NAME_LEN.
+ * The field needs no terminator: records are zeroed on alloc.
+ * @param dst
+ *	record name field.
+ * @param src
+ *	string.
+ */
+static inline void
+cdr_rec_strcpy(char *dst, const char *src)
+{
+	memcpy(dst, src, strnlen(src, CDR_NAME_LEN));
+}
+
+/**
+ * Start writer and flush threads.
+ * Subsequent calls are no-ops.
+ */
+void
+cdr_writer_init(void);
+
+/**
+ * Open a stream file and write its CSV header line.
+ * @param stream
+ *	stream to open.
+ * @param filename
+ *	output file; NULL for the SGX DealerIn channel of CDR_STREAM_RULE.
+ * @param fields
+ *	CSV columns.
+ * @param nb_fields
+ *	number of columns.
+ * @param header_prefix
+ *	header line prefix.
+ * @param time_fmt
+ *	strftime format of CDR_TIME columns.
+ */
+void
+cdr_writer_open(enum cdr_stream stream, const char *filename,
+		const struct cdr_field_t *fields, uint32_t nb_fields,
+		const char *header_prefix, const char *time_fmt);
+
+/**
+ * Get a record to fill, stamped with current time.
+ * @param stream
+ *	destination stream.
+ * @return
+ *	record, NULL if writer is not running or out of records.
+ */
+struct cdr_rec *
+cdr_rec_alloc(enum cdr_stream stream);
+
+/**
+ * Queue a record from cdr_rec_alloc to the writer.
+ * @param rec
+ *	record.
+ */
+void
+cdr_rec_submit(struct cdr_rec *rec);
+
+/**
+ * Queue a truncate of a stream file; records queued after it start the
+ * new file.
+ * @param stream
+ *	stream to reset.
+ */
+void
+cdr_writer_reset(enum cdr_stream stream);
+
+/**
+ * Drain queued records, flush all pages and stop the threads.
+ * Stream files are closed.
+ */
+void
+cdr_writer_stop(void);
+
+#ifdef SGX_CDR
+/**
+ * Reopen the SGX DealerIn channel after a failed write, in cdr.c.
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int
+sgx_cdr_reconnect(void);
+#endif /* SGX_CDR */
+
+/**
+ * Records dropped because the writer could not keep up.
+ * @return
+ *	drop count.
+ */
+uint64_t
+cdr_writer_drops(void);
+
+#endif /* _CDR_WRITER_H */
@@ -20,7 +20,6 @@
 #include <arpa/inet.h>
 
 #include <rte_ethdev.h>
-#include <rte_kni.h>
 
 #include "main.h"
 #include "pkt_engines/ngic_rtc_framework.h"
@@ -160,6 +159,54 @@ static inline void dp_print_usage(void)
 			DESCRIPTION_WIDTH,
 			"Configured DL interface name(i.e SGI interface)");
 
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--num_workers",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"UL/DL worker pairs, one RSS queue each.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--gtpu_sport",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"GTP-U UDP src port 0-2152, 1-TEID, 2-flow.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--max_sessions",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Max. bearer sessions, sizes session tables.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--arp_max_age",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Secs. unconfirmed ARP entry kept, 0-off.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--arp_refresh",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Secs. before ARP entry is probed, 0-off.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--arp_neg_hold",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Secs. unresolved next hop is not probed.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--excp_path",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Kernel path 0-none, 1-TAP, 2-virtio-user.");
+
+	printf("| %-*s | %-*s | %-*s |\n",
+			ARGUMENT_WIDTH,    "--excp_poll_us",
+			PRESENCE_WIDTH,    "OPTIONAL",
+			DESCRIPTION_WIDTH,
+			"Usecs. between kernel interface polls.");
+
 	printf("+-------------------+-------------+"
 			"--------------------------------------------+\n");
 	printf("\n\nExample Usage:\n"
@@ -276,12 +323,26 @@ parse_config_args(struct app_params *app, int argc, char **argv)
 		{"numa", required_argument, 0, 'f'},
 		{"gtpu_seqnb_in",  required_argument, 0, 'I'},
 		{"gtpu_seqnb_out",  required_argument, 0, 'O'},
+		{"gtpu_sport",  required_argument, 0, 'P'},
 		{"kni_portmask", required_argument, 0, 'p'},
 		{"ul_iface", required_argument, 0, 'b'},
 		{"dl_iface", required_argument, 0, 'c'},
+		{"num_workers", required_argument, 0, 'w'},
+		{"max_sessions", required_argument, 0, 'M'},
+		{"arp_max_age", required_argument, 0, 'A'},
+		{"arp_refresh", required_argument, 0, 'R'},
+		{"arp_neg_hold", required_argument, 0, 'N'},
+		{"excp_path", required_argument, 0, 'E'},
+		{"excp_poll_us", required_argument, 0, 'U'},
 		{NULL, 0, 0, 0}
 	};
 
+	app->max_sessions = DEFAULT_MAX_SESSIONS;
+	app->arp_max_age = DEFAULT_ARP_MAX_AGE;
+	app->arp_refresh = DEFAULT_ARP_REFRESH;
+	app->arp_neg_hold = DEFAULT_ARP_NEG_HOLD;
+	app->excp_path = DEFAULT_EXCP_PATH;
+	app->excp_poll_us = DEFAULT_EXCP_POLL_US;
 	optind = 0;/* reset getopt lib */
 
 	while ((opt = getopt_long(argc, argv, "i:m:s:n:l:f:h:a:e:I:O",
@@ -534,6 +595,17 @@ parse_config_args(struct app_params *app, int argc, char **argv)
 			app->gtpu_seqnb_out = atoi(optarg);
 			break;
 
+			/* Outer UDP source port scheme */
+		case 'P':
+			app->gtpu_sport = atoi(optarg);
+			if (app->gtpu_sport > GTPU_SPORT_FLOW) {
+				printf("Invalid gtpu_sport %s, range 0-%u\n",
+						optarg, GTPU_SPORT_FLOW);
+				dp_print_usage();
+				return -1;
+			}
+			break;
+
 			/* Dpdk ports mask */
 		case 'p':
 			app->ports_mask = atoi(optarg);
@@ -541,12 +613,72 @@ parse_config_args(struct app_params *app, int argc, char **argv)
 
 			/* Configure S1U interface name*/
 		case 'b':
-			memcpy(app->ul_iface_name, optarg, RTE_KNI_NAMESIZE);
+			snprintf(app->ul_iface_name, sizeof(app->ul_iface_name),
+					"%s", optarg);
 			break;
 
 			/* Configure SGI interface name*/
 		case 'c':
-			memcpy(app->dl_iface_name, optarg, RTE_KNI_NAMESIZE);
+			snprintf(app->dl_iface_name, sizeof(app->dl_iface_name),
+					"%s", optarg);
+			break;
+
+			/* Number of UL/DL worker pairs */
+		case 'w':
+			epc_app.nb_workers = atoi(optarg);
+			if ((epc_app.nb_workers == 0) ||
+					(epc_app.nb_workers > DP_MAX_WORKERS)) {
+				printf("Invalid num_workers %s, range 1-%u\n",
+						optarg, DP_MAX_WORKERS);
+				dp_print_usage();
+				return -1;
+			}
+#ifdef FRAG
+			/* s1u_frag_tbl and death row are single lcore */
+			if (epc_app.nb_workers > 1) {
+				printf("FRAG supports a single worker only\n");
+				return -1;
+			}
+#endif /* FRAG */
+			break;
+
+			/* Session table sizes */
+		case 'M':
+			app->max_sessions = strtoul(optarg, NULL, 10);
+			if ((app->max_sessions == 0) ||
+					(app->max_sessions > MAX_SESSIONS_LIMIT)) {
+				printf("Invalid max_sessions %s, range 1-%u\n",
+						optarg, MAX_SESSIONS_LIMIT);
+				dp_print_usage();
+				return -1;
+			}
+			break;
+
+		case 'A':
+			app->arp_max_age = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'R':
+			app->arp_refresh = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'N':
+			app->arp_neg_hold = strtoul(optarg, NULL, 10);
+			break;
+
+			/* Kernel exception path backend */
+		case 'E':
+			app->excp_path = atoi(optarg);
+			if (app->excp_path > EXCP_PATH_VIRTIO_USER) {
+				printf("Invalid excp_path %s, range 0-%u\n",
+						optarg, EXCP_PATH_VIRTIO_USER);
+				dp_print_usage();
+				return -1;
+			}
+			break;
+
+		case 'U':
+			app->excp_poll_us = strtoul(optarg, NULL, 10);
 			break;
 
 		default:
@@ -555,10 +687,20 @@ parse_config_args(struct app_params *app, int argc, char **argv)
 		}		/* end switch (opt) */
 	}			/* end while() */
 
+	/* Entries are refreshed before they age out */
+	if (app->arp_max_age && app->arp_refresh >= app->arp_max_age) {
+		printf("Invalid arp_refresh %u, must be below arp_max_age %u\n",
+				app->arp_refresh, app->arp_max_age);
+		dp_print_usage();
+		return -1;
+	}
+
 	set_unused_lcore(&epc_app.core_mct, &used_coremask);
 	set_unused_lcore(&epc_app.core_iface, &used_coremask);
-	set_unused_lcore(&epc_app.core_ul[S1U_PORT_ID], &used_coremask);
-	set_unused_lcore(&epc_app.core_dl[SGI_PORT_ID], &used_coremask);
+	for (i = 0; i < (int)epc_app.nb_workers; i++) {
+		set_unused_lcore(&epc_app.core_ul[i], &used_coremask);
+		set_unused_lcore(&epc_app.core_dl[i], &used_coremask);
+	}
 
 	app->s1u_net = app->s1u_ip & app->s1u_mask;
 	app->s1u_bcast_addr = app->s1u_ip | ~(app->s1u_mask);
@@ -24,6 +24,8 @@
 #include <rte_ip.h>
 #include <rte_ip_frag.h>
 #include <rte_errno.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
 
 #include "main.h"
 #include "ngic_rtc_framework.h"
@@ -33,6 +35,10 @@
 #include "util.h"
 #include "meter.h"
 #include "acl_dp.h"
+#include "mem_budget.h"
+#ifdef UL_TEID_INDEX
+#include "teid_index.h"
+#endif /* UL_TEID_INDEX */
 #include <sponsdn.h>
 #include <stdbool.h>
 
@@ -48,12 +54,18 @@ struct rte_hash *rte_ue_hash;
 struct rte_hash *rte_sdf_pcc_hash;
 struct rte_hash *rte_adc_pcc_hash;
 struct rte_hash *rte_sess_cli_hash;
+#ifdef UL_TEID_INDEX
+struct teid_index *ul_teid_index;
+#endif /* UL_TEID_INDEX */
 
 #ifdef PCAP_GEN
 pcap_dumper_t *pcap_dumper_east;
 pcap_dumper_t *pcap_dumper_west;
 #endif /* PCAP_GEN */
 
+/* GTP-U sequence number of encapsulated pkts, per worker */
+static RTE_DEFINE_PER_LCORE(uint16_t, encap_seqnb);
+
 void
 gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask)
@@ -68,7 +80,7 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 	for (i = 0; i < n; i++) {
 		/* Skip previously marked packets to drop */
 		if (!ISSET_BIT(*pkts_mask, i)) {
-			--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+			--EPC_UL_PARAMS.pkts_in;
 			//wr_pkts++;
 			continue;
 		}
@@ -92,9 +104,9 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 
 		if (ipv4_hdr->dst_addr != ip) {
 			/* ASR-Probe:: Log(bad pkts[i]->data_len || pkt_len) */
-			epc_app.ul_params[S1U_PORT_ID].bad_pkt_idx = i;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->data_len;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->pkt_len;
+			EPC_UL_PARAMS.bad_pkt_idx = i;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->data_len;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->pkt_len;
 			RESET_BIT(*pkts_mask, i);
 			continue;
 		}
@@ -103,23 +115,23 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 		udp_hdr = get_mtoudp(pkts[i]);
 		if (ntohs(udp_hdr->dst_port) != UDP_PORT_GTPU) {
 			/* ASR-Probe:: Log(bad pkts[i]->data_len || pkt_len) */
-			epc_app.ul_params[S1U_PORT_ID].bad_pkt_idx = i;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->data_len;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->pkt_len;
+			EPC_UL_PARAMS.bad_pkt_idx = i;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->data_len;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->pkt_len;
 			RESET_BIT(*pkts_mask, i);
 			continue;
 		}
 
 		gtpu_hdr = get_mtogtpu(pkts[i]);
 		if (gtpu_hdr->teid == 0 || gtpu_hdr->msgtype != GTP_GPDU) {
-			--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+			--EPC_UL_PARAMS.pkts_in;
 #ifdef EXSTATS
-			++epc_app.ul_params[S1U_PORT_ID].pkts_echo;
+			++EPC_UL_PARAMS.pkts_echo;
 #endif /* EXSTATS */
 			/* ASR-Probe:: Log(bad pkts[i]->data_len || pkt_len) */
-			epc_app.ul_params[S1U_PORT_ID].bad_pkt_idx = i;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->data_len;
-			epc_app.ul_params[S1U_PORT_ID].bad_data_len = pkts[i]->pkt_len;
+			EPC_UL_PARAMS.bad_pkt_idx = i;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->data_len;
+			EPC_UL_PARAMS.bad_data_len = pkts[i]->pkt_len;
 			RESET_BIT(*pkts_mask, i);
 			continue;
 		}
@@ -135,26 +147,225 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 				IPV4_ADDR_FORMAT(GTPU_INNER_SRC_IP(pkts[i])));
 
 		/* ASR-Probe:: Log(ref pkts[i]->data_len) */
-		epc_app.ul_params[S1U_PORT_ID].ref_len = pkts[i]->data_len;
+		EPC_UL_PARAMS.ref_len = pkts[i]->data_len;
 		ret = DECAP_GTPU_HDR(pkts[i]);
 
 		if (ret < 0){
 			RESET_BIT(*pkts_mask, i);
-			--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+			--EPC_UL_PARAMS.pkts_in;
 		}
 	}
 }
 
+/**
+ * Outer UDP source port from a hash, in the dynamic port range.
+ *
+ * @param hash
+ *	TEID or flow hash.
+ *
+ * @return
+ *	port, network order.
+ */
+static inline uint16_t
+gtpu_sport_from_hash(uint32_t hash)
+{
+	return htons(GTPU_SPORT_BASE |
+			((hash ^ (hash >> 16)) & GTPU_SPORT_MASK));
+}
+
+/**
+ * Hash of the 5-tuple of a DL pkt before encap: the RX RSS hash if the
+ * NIC gave one, else CRC32 of addresses, protocol and L4 ports.
+ *
+ * @param m
+ *	mbuf of an ether + IPv4 pkt.
+ *
+ * @return
+ *	flow hash.
+ */
+static inline uint32_t
+gtpu_inner_flow_hash(struct rte_mbuf *m)
+{
+	struct ipv4_hdr *ip;
+	uint32_t hash, ports = 0;
+	uint16_t l4;
+
+	if (m->ol_flags & PKT_RX_RSS_HASH)
+		return m->hash.rss;
+
+	ip = get_mtoip(m);
+	l4 = ETH_HDR_SIZE + (ip->version_ihl & IPV4_HDR_IHL_MASK) *
+		IPV4_IHL_MULTIPLIER;
+	if ((ip->next_proto_id == IPPROTO_UDP ||
+				ip->next_proto_id == IPPROTO_TCP) &&
+			!(ip->fragment_offset & htons(IPV4_HDR_OFFSET_MASK)) &&
+			rte_pktmbuf_data_len(m) >= l4 + sizeof(ports))
+		ports = *rte_pktmbuf_mtod_offset(m, uint32_t *, l4);
+
+	hash = rte_hash_crc_4byte(ip->src_addr, ip->next_proto_id);
+	hash = rte_hash_crc_4byte(ip->dst_addr, hash);
+	return rte_hash_crc_4byte(ports, hash);
+}
+
+void
+gtpu_encap_tmpl_build(struct dp_session_hot *hot)
+{
+	struct gtpu_encap_tmpl *t = &hot->tmpl;
+	uint8_t hdr[ENCAP_TMPL_SIZE_SEQNB] = {0};
+	struct ether_hdr *eth = (struct ether_hdr *)hdr;
+	struct ipv4_hdr *ip = (struct ipv4_hdr *)(eth + 1);
+	struct udp_hdr *udp = (struct udp_hdr *)(ip + 1);
+	uint8_t *gpdu_hdr = (uint8_t *)(udp + 1);
+	uint32_t src_addr, dst_addr;
+	uint16_t ip_sum;
+	uint8_t portid, len;
+
+	switch (app.spgw_cfg) {
+		case PGWU:
+			src_addr = app.s5s8_pgwu_ip;
+			dst_addr = htonl(hot->s5s8_sgwu_ipv4);
+			portid = app.s5s8_pgwu_port;
+			break;
+
+		default:
+			src_addr = app.s1u_ip;
+			dst_addr = htonl(hot->enb_ipv4);
+			portid = app.s1u_port;
+			break;
+	}
+	len = (app.gtpu_seqnb_out == 1) ?
+		ENCAP_TMPL_SIZE_SEQNB : ENCAP_TMPL_SIZE;
+
+	/* Destination MAC is set on next hop resolution */
+	ether_addr_copy(&ports_eth_addr[portid], &eth->s_addr);
+	eth->ether_type = htons(ETH_TYPE_IPv4);
+
+	/* Fields of construct_ipv4_hdr(); length, id and checksum 0 */
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IP_PROTO_UDP;
+	ip->src_addr = src_addr;
+	ip->dst_addr = dst_addr;
+	ip_sum = rte_raw_cksum(ip, sizeof(struct ipv4_hdr));
+#ifndef FRAG
+	ip->packet_id = 0x1513;
+#endif /* !FRAG */
+
+	/* Per flow ports are patched on encap */
+	udp->src_port = (app.gtpu_sport == GTPU_SPORT_TEID) ?
+		gtpu_sport_from_hash(rte_hash_crc_4byte(hot->enb_teid, 0)) :
+		htons(UDP_PORT_GTPU);
+	udp->dst_port = htons(UDP_PORT_GTPU);
+
+	gpdu_hdr[0] = (GTPU_VERSION << 5) | (GTP_PROTOCOL_TYPE_GTP << 4);
+	if (len == ENCAP_TMPL_SIZE_SEQNB)
+		gpdu_hdr[0] |= GTP_FLAG_SEQNB;
+	gpdu_hdr[1] = GTP_GPDU;
+	*((uint32_t *)&gpdu_hdr[4]) = htonl(hot->enb_teid);
+
+	t->gen++;
+	rte_smp_wmb();
+	memcpy(t->hdr, hdr, sizeof(hdr));
+	t->len = len;
+	t->ip_sum = ip_sum;
+	rte_smp_wmb();
+	t->gen++;
+}
+
+/**
+ * Prepend the outer headers of a bearer template to a DL pkt, over its
+ * ether header, and patch lengths, IPv4 checksum and sequence number.
+ *
+ * @param m
+ *	mbuf of an ether + inner IP pkt.
+ * @param t
+ *	bearer encap template.
+ * @param hw_cksum
+ *	egress port computes the IPv4 checksum.
+ * @param sport
+ *	UDP source port of the flow, network order; 0 to keep the
+ *	template one.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if the mbuf has no headroom
+ */
+static inline int
+gtpu_encap_tmpl_apply(struct rte_mbuf *m, const struct gtpu_encap_tmpl *t,
+		uint8_t hw_cksum, uint16_t sport)
+{
+	uint16_t inner_len = rte_pktmbuf_data_len(m) - ETH_HDR_SIZE;
+	uint8_t len = t->len;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	uint8_t *hdr, *gpdu_hdr;
+	uint32_t gen, sum;
+	uint16_t ip_len;
+
+	hdr = (uint8_t *)rte_pktmbuf_prepend(m, len - ETH_HDR_SIZE);
+	if (hdr == NULL) {
+		RTE_LOG_DP(ERR, DP, "Error: Failed to add GTPU header\n");
+		return -1;
+	}
+
+	/* Fixed size copy, again if a modify rewrote the template */
+	do {
+		gen = t->gen;
+		rte_smp_rmb();
+		if (len == ENCAP_TMPL_SIZE_SEQNB)
+			rte_memcpy(hdr, t->hdr, ENCAP_TMPL_SIZE_SEQNB);
+		else
+			rte_memcpy(hdr, t->hdr, ENCAP_TMPL_SIZE);
+		sum = t->ip_sum;
+		rte_smp_rmb();
+	} while (unlikely((gen & 1) || gen != t->gen));
+
+	ip_len = inner_len + len - ETH_HDR_SIZE;
+	ip = (struct ipv4_hdr *)(hdr + ETH_HDR_SIZE);
+	ip->total_length = htons(ip_len);
+#ifdef FRAG
+	ip->packet_id = frag_id++;
+#endif /* FRAG */
+
+	if (hw_cksum) {
+		/* Template checksum field is 0 */
+		m->l2_len = ETH_HDR_SIZE;
+		m->l3_len = IPv4_HDR_SIZE;
+		m->ol_flags |= PKT_TX_IPV4 | PKT_TX_IP_CKSUM;
+	} else {
+		/* Template sum plus the patched words, as rte_ipv4_cksum() */
+		sum += ip->total_length + ip->packet_id;
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		ip->hdr_checksum = (sum == 0xffff) ?
+			(uint16_t)sum : (uint16_t)~sum;
+	}
+
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->dgram_len = htons(ip_len - IPv4_HDR_SIZE);
+	if (sport)
+		udp->src_port = sport;
+
+	gpdu_hdr = (uint8_t *)(udp + 1);
+	*((uint16_t *)&gpdu_hdr[2]) = htons(inner_len + len - ENCAP_TMPL_SIZE);
+	if (len == ENCAP_TMPL_SIZE_SEQNB)
+		*((uint16_t *)&gpdu_hdr[8]) =
+			htons(RTE_PER_LCORE(encap_seqnb)++);
+
+	return 0;
+}
+
 void
-gtpu_encap(struct dp_session_info **sess_info, struct rte_mbuf **pkts,
+gtpu_encap(struct dp_session_hot **sess_info, struct rte_mbuf **pkts,
 		uint32_t n, uint64_t *pkts_mask, uint64_t *pkts_queue_mask)
 {
 	uint32_t i;
-	struct dp_session_info *si;
+	struct dp_session_hot *si;
 	struct rte_mbuf *m;
-	uint16_t len;
-	uint32_t src_addr;
-	uint32_t dst_addr;
+	uint8_t hw_cksum = ipv4_cksum_offload[(app.spgw_cfg == PGWU) ?
+		app.s5s8_pgwu_port : app.s1u_port];
+	uint8_t flow_sport = (app.gtpu_sport == GTPU_SPORT_FLOW);
+	uint16_t sport = 0;
 
 	for (i = 0; i < n; i++) {
 		si = sess_info[i];
@@ -162,74 +373,54 @@ gtpu_encap(struct dp_session_info **sess_info, struct rte_mbuf **pkts,
 
 		/* Skip previously marked packets to drop */
 		if (!ISSET_BIT(*pkts_mask, i)) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 			continue;
 		}
 
 		if (si == NULL) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 			RESET_BIT(*pkts_mask, i);
 			continue;
 		}
 
+		/* Template line of the next bearer */
+		if (i + 1 < n && sess_info[i + 1] != NULL)
+			rte_prefetch0(&sess_info[i + 1]->tmpl);
+
 /** Check downlink bearer is ACTIVE or IDLE */
 #ifdef DP_DDN
 		if (si->sess_state != CONNECTED) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
-			++epc_app.dl_params[SGI_PORT_ID].ddn;
+			--EPC_DL_PARAMS.pkts_in;
+			++EPC_DL_PARAMS.ddn;
 			RESET_BIT(*pkts_mask, i);
 			SET_BIT(*pkts_queue_mask, i);
 			continue;
 		}
+		/* Endpoints and template are read after the state, see
+		 * dp_session_hot_sync */
+		rte_smp_rmb();
 #endif /* DP_DDN */
 
-		if (!si->dl_s1_info.enb_teid) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+		if (!si->enb_teid) {
+			--EPC_DL_PARAMS.pkts_in;
 			/* ASR-Probe:: Log(bad pkts[i]->data_len || pkt_len) */
-			epc_app.dl_params[SGI_PORT_ID].bad_pkt_idx = i;
-			epc_app.dl_params[SGI_PORT_ID].bad_data_len = pkts[i]->data_len;
-			epc_app.dl_params[SGI_PORT_ID].bad_data_len = pkts[i]->pkt_len;
+			EPC_DL_PARAMS.bad_pkt_idx = i;
+			EPC_DL_PARAMS.bad_data_len = pkts[i]->data_len;
+			EPC_DL_PARAMS.bad_data_len = pkts[i]->pkt_len;
 			RESET_BIT(*pkts_mask, i);
 			SET_BIT(*pkts_queue_mask, i);
 			continue;
 		}
 
 		/* ASR-Probe:: Log(ref pkts[i]->data_len) */
-		epc_app.dl_params[SGI_PORT_ID].ref_len = pkts[i]->data_len;
-		if (ENCAP_GTPU_HDR(m, si->dl_s1_info.enb_teid) < 0) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+		EPC_DL_PARAMS.ref_len = pkts[i]->data_len;
+		if (flow_sport)
+			sport = gtpu_sport_from_hash(gtpu_inner_flow_hash(m));
+		if (gtpu_encap_tmpl_apply(m, &si->tmpl, hw_cksum, sport) < 0) {
+			--EPC_DL_PARAMS.pkts_in;
 			RESET_BIT(*pkts_mask, i);
 			continue;
 		}
-
-		len = rte_pktmbuf_data_len(m);
-		len = len - ETH_HDR_SIZE;
-
-		if (app.spgw_cfg == PGWU)
-			dst_addr = si->dl_s1_info.s5s8_sgwu_addr.u.ipv4_addr;
-		else
-			dst_addr = si->dl_s1_info.enb_addr.u.ipv4_addr;
-
-		/* construct iphdr */
-		switch(app.spgw_cfg) {
-			case SPGWU:
-				src_addr = app.s1u_ip;
-				break;
-
-			case PGWU:
-				src_addr = app.s5s8_pgwu_ip;
-				break;
-
-			default:
-				break;
-		}
-
-		construct_ipv4_hdr(m, len, IP_PROTO_UDP, ntohl(src_addr),
-					dst_addr);
-
-		len = len - IPv4_HDR_SIZE;
-		/* construct udphdr */
-		construct_udp_hdr(m, len, UDP_PORT_GTPU, UDP_PORT_GTPU);
 	}
 }
 
@@ -335,8 +526,8 @@ adc_ue_info_get(struct rte_mbuf **pkts, uint32_t n, uint32_t *res,
 		key_ptr[j] = &key[j];
 	}
 
-	if ((rte_hash_lookup_bulk_data(rte_adc_ue_hash,
-		(const void **)&key_ptr[0], n, &hit_mask, adc_ue_info)) < 0)
+	if ((iface_lookup_adc_ue_bulk_data((const void **)&key_ptr[0], n,
+			&hit_mask, adc_ue_info)) < 0)
 		RTE_LOG_DP(ERR, DP, "ADC UE Bulk LKUP:FAIL!!\n");
 
 	for (j = 0; j < n; j++)
@@ -347,7 +538,7 @@ adc_ue_info_get(struct rte_mbuf **pkts, uint32_t n, uint32_t *res,
 void
 dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, struct dp_sdf_per_bearer_info **sess_info,
-		struct dp_session_info **si)
+		struct dp_session_hot **si)
 {
 	uint32_t j;
 	struct dl_bm_key key[MAX_BURST_SZ];
@@ -445,7 +636,7 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 			sess_info[j] = NULL;
 			si[j] = NULL;
 		} else {
-			si[j] = sess_info[j]->bear_sess_info;
+			si[j] = sess_info[j]->bear_hot;
 		}
 	}
 }
@@ -541,46 +732,107 @@ get_rating_grp(void **adc_ue_info, void **sdf_info,
 	}
 }
 
-static void
-update_cdr(struct ipcan_dp_bearer_cdr *cdr, struct rte_mbuf *pkt,
-				uint32_t flow, enum pkt_action_t action)
+static inline uint32_t
+cdr_charged_len(struct rte_mbuf *pkt)
 {
-	uint32_t charged_len;
 	struct ipv4_hdr *ip_h = NULL;
 
 	ip_h = rte_pktmbuf_mtod_offset(pkt, struct ipv4_hdr *,
 			sizeof(struct ether_hdr));
 
-	charged_len =
-			RTE_MIN(rte_pktmbuf_pkt_len(pkt) -
-					sizeof(struct ether_hdr),
-					ntohs(ip_h->total_length));
+	return RTE_MIN(rte_pktmbuf_pkt_len(pkt) - sizeof(struct ether_hdr),
+			ntohs(ip_h->total_length));
+}
+
+/**
+ * Count a pkt in the calling worker's shard of an ADC, SDF or rating
+ * group CDR.
+ */
+static void
+update_vol_shard(enum cdr_vol_type type, uint32_t idx, struct rte_mbuf *pkt,
+				uint32_t flow, enum pkt_action_t action)
+{
+	uint32_t charged_len = cdr_charged_len(pkt);
+	uint32_t wrk = RTE_PER_LCORE(epc_wrk_id);
+	struct cdr_vol_shard *shard;
+
+	if (flow == UL_FLOW) {
+		shard = &cdr_vol_ul_shards[type][wrk][idx];
+		/* VCCCCB-34 Statistics - add current number of active sessions and RXbytes,
+		 * TXbytes */
+		if (action == CHARGED)
+			EPC_UL_PARAMS.tot_ul_bytes += charged_len;
+	} else {
+		shard = &cdr_vol_dl_shards[type][wrk][idx];
+		if (action == CHARGED)
+			EPC_DL_PARAMS.tot_dl_bytes += charged_len;
+	}
 
 	if (action == CHARGED) {
-		if (flow == UL_FLOW) {
-			cdr->data_vol.ul_cdr.bytes += charged_len;
-			/* VCCCCB-34 Statistics - add current number of active sessions and RXbytes,
-			 * TXbytes */
-			epc_app.ul_params[S1U_PORT_ID].tot_ul_bytes += charged_len;
-			cdr->data_vol.ul_cdr.pkt_count++;
-		} else {
-			cdr->data_vol.dl_cdr.bytes += charged_len;
-			/* VCCCCB-34 Statistics - add current number of active sessions and RXbytes,
-			 * TXbytes */
-			epc_app.dl_params[SGI_PORT_ID].tot_dl_bytes += charged_len;
-			cdr->data_vol.dl_cdr.pkt_count++;
-		}	/* if (flow == UL_FLOW) */
+		shard->cdr.bytes += charged_len;
+		shard->cdr.pkt_count++;
 	} else {
-		if (flow == UL_FLOW) {
-			cdr->data_vol.ul_drop.bytes += charged_len;
-			cdr->data_vol.ul_drop.pkt_count++;
-		} else {
-			cdr->data_vol.dl_drop.bytes += charged_len;
-			cdr->data_vol.dl_drop.pkt_count++;
-		}	/* if (flow == UL_FLOW) */
+		shard->drop.bytes += charged_len;
+		shard->drop.pkt_count++;
 	}
 }
 
+/**
+ * Bearer counter shard of the calling worker for a session.
+ */
+static inline struct cdr_shard *
+cdr_shard_get(struct dp_session_hot *si, uint32_t flow)
+{
+	uint32_t wrk = RTE_PER_LCORE(epc_wrk_id);
+
+	if (flow == UL_FLOW)
+		return &cdr_ul_shards[wrk][si->cdr_slot];
+	return &cdr_dl_shards[wrk][si->cdr_slot];
+}
+
+/**
+ * Charge pkt to the calling worker's shard of the bearer session.
+ */
+static void
+update_bear_shard(struct cdr_shard *shard, struct rte_mbuf *pkt,
+				uint32_t flow, enum pkt_action_t action)
+{
+	uint32_t charged_len = cdr_charged_len(pkt);
+
+	if (action == CHARGED) {
+		shard->cdr.bytes += charged_len;
+		shard->cdr.pkt_count++;
+		shard->vol_unchecked += charged_len;
+		/* VCCCCB-34 Statistics - add current number of active sessions and RXbytes,
+		 * TXbytes */
+		if (flow == UL_FLOW)
+			EPC_UL_PARAMS.tot_ul_bytes += charged_len;
+		else
+			EPC_DL_PARAMS.tot_dl_bytes += charged_len;
+	} else {
+		shard->drop.bytes += charged_len;
+		shard->drop.pkt_count++;
+	}
+}
+
+/**
+ * Charged bytes of a session since its last CDR record, summed over
+ * all worker shards. Reads other workers' counters, call sparingly.
+ */
+static uint64_t
+cdr_shard_vol_delta(struct dp_session_info *si)
+{
+	struct chrg_data_vol *vol = &si->ipcan_dp_bearer_cdr.data_vol;
+	uint64_t bytes = 0;
+	uint32_t wrk;
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++)
+		bytes += cdr_ul_shards[wrk][si->cdr_slot].cdr.bytes +
+			cdr_dl_shards[wrk][si->cdr_slot].cdr.bytes;
+
+	return bytes - (vol->ul_cdr_last.bytes + vol->dl_cdr_last.bytes);
+}
+
 void
 update_adc_cdr(void **adc_ue_info,
 		struct rte_mbuf **pkts, uint32_t n,
@@ -599,11 +851,13 @@ update_adc_cdr(void **adc_ue_info,
 		 * due to pcc rule of metering.*/
 		if ((ISSET_BIT(*adc_pkts_mask, i))
 				&& (ISSET_BIT(*pkts_mask, i)))
-			update_cdr(&adc_ue->adc_cdr, pkts[i], flow, CHARGED);
+			update_vol_shard(CDR_VOL_ADC, adc_ue->vol_slot, pkts[i],
+					flow, CHARGED);
 
 		/* record drop counts if ADC rule is hit but gate is closed*/
 		if (!(ISSET_BIT(*adc_pkts_mask, i)))
-			update_cdr(&adc_ue->adc_cdr, pkts[i], flow, DROPPED);
+			update_vol_shard(CDR_VOL_ADC, adc_ue->vol_slot, pkts[i],
+					flow, DROPPED);
 	}	/* for (i = 0; i < n; i++)*/
 }
 
@@ -635,20 +889,24 @@ update_sdf_cdr(void **adc_ue_info,
 			continue;
 
 		if (ISSET_BIT(*pkts_mask, i))
-			update_cdr(&psdf->sdf_cdr, pkts[i], flow, CHARGED);
+			update_vol_shard(CDR_VOL_SDF, psdf->vol_slot, pkts[i],
+					flow, CHARGED);
 		else
-			update_cdr(&psdf->sdf_cdr, pkts[i], flow, DROPPED);
+			update_vol_shard(CDR_VOL_SDF, psdf->vol_slot, pkts[i],
+					flow, DROPPED);
 	}	/* for (i = 0; i < n; i++)*/
 }
 
 void
 update_pcc_cdr(struct dp_sdf_per_bearer_info **sdf_bear_info,
 		struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
-		uint32_t *pcc_rule, uint32_t flow)
+		uint32_t flow)
 {
 	uint32_t i;
-	uint64_t bytes;
+	uint64_t vol_trshld;
 	struct dp_sdf_per_bearer_info *psdf = NULL;
+	struct dp_session_hot *si;
+	struct cdr_shard *shard;
 
 	for (i = 0; i < n; i++) {
 		/* Skip previously marked packets to drop */
@@ -660,32 +918,35 @@ update_pcc_cdr(struct dp_sdf_per_bearer_info **sdf_bear_info,
 		if (NULL == psdf)
 			continue;
 
-		if (psdf->sdf_cdr.charging_rule_id == 0) {
-			psdf->sdf_cdr.charging_rule_id = pcc_rule[i];
-		}
-
-		if (!psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.ul_cdr.bytes &&
-				!psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.dl_cdr.bytes)
-		{
-			time((time_t *)&psdf->bear_sess_info->ipcan_dp_bearer_cdr.time_of_first_use);
-		}
-
-		if (ISSET_BIT(*pkts_mask, i))
-			update_cdr(&psdf->bear_sess_info->ipcan_dp_bearer_cdr, pkts[i], flow, CHARGED);
-		else
-			update_cdr(&psdf->bear_sess_info->ipcan_dp_bearer_cdr, pkts[i], flow, DROPPED);
-
-		bytes = ((psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.ul_cdr.bytes -
-				psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.ul_cdr_last.bytes) +
-				(psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.dl_cdr.bytes -
-				 psdf->bear_sess_info->ipcan_dp_bearer_cdr.data_vol.dl_cdr_last.bytes));
-
-		if ((bytes >= psdf->bear_sess_info->ipcan_dp_bearer_cdr.vol_trshld) &&
-			(psdf->bear_sess_info->ipcan_dp_bearer_cdr.vol_trshld)) {
-			update_vol_on_rec_close(psdf->bear_sess_info, CDR_REC_VOL);
-
-			int ret = rte_ring_enqueue(cdr_ring, (void *)psdf->bear_sess_info->sess_id);
+		si = psdf->bear_hot;
+		/* Workers of both directions race for the first pkt */
+		if (unlikely(!(si->flags & DP_SESS_F_FIRST_USE)) &&
+				!(__sync_fetch_and_or(&si->flags,
+						DP_SESS_F_FIRST_USE) &
+					DP_SESS_F_FIRST_USE))
+			time((time_t *)&si->cold->ipcan_dp_bearer_cdr.time_of_first_use);
+
+		shard = cdr_shard_get(si, flow);
+		update_bear_shard(shard, pkts[i], flow, CHARGED);
+
+		/* Sum all shards only once this worker charged its share
+		 * of the volume threshold since its last check. */
+		vol_trshld = si->vol_trshld;
+		if (!vol_trshld || shard->vol_unchecked <
+				vol_trshld / (2 * epc_app.nb_workers *
+					CDR_VOL_CHECK_DIV))
+			continue;
+		shard->vol_unchecked = 0;
+
+		/* The iface core closes the record when it dequeues it:
+		 * only one worker queues it per crossing */
+		if (!(si->flags & DP_SESS_F_CDR_QUEUED) &&
+				cdr_shard_vol_delta(si->cold) >= vol_trshld &&
+				dp_session_cdr_queue(si, 0)) {
+			int ret = rte_ring_enqueue(cdr_ring,
+					(void *)si->cold->sess_id);
 			if (ret == -ENOBUFS) {
+				dp_session_cdr_dequeued(si);
 				RTE_LOG_DP(DEBUG, DP, "update_pcc_cdr:Enqueu failed in cdr_ring\n");
 			}
 		}
@@ -698,7 +959,7 @@ update_bear_cdr(struct dp_sdf_per_bearer_info **sdf_bear_info,
 		uint64_t *pkts_mask, uint32_t flow)
 {
 	uint32_t i;
-	struct dp_session_info *si;
+	struct dp_session_hot *si;
 	struct dp_sdf_per_bearer_info *psdf;
 
 	for (i = 0; i < n; i++) {
@@ -706,15 +967,15 @@ update_bear_cdr(struct dp_sdf_per_bearer_info **sdf_bear_info,
 		if (psdf == NULL)
 			continue;
 
-		si = psdf->bear_sess_info;
+		si = psdf->bear_hot;
 		if (si == NULL)
 			continue;
 
 		if (ISSET_BIT(*pkts_mask, i))
-			update_cdr(&si->ipcan_dp_bearer_cdr, pkts[i],
+			update_bear_shard(cdr_shard_get(si, flow), pkts[i],
 					flow, CHARGED);
 		else
-			update_cdr(&si->ipcan_dp_bearer_cdr, pkts[i],
+			update_bear_shard(cdr_shard_get(si, flow), pkts[i],
 					flow, DROPPED);
 	}	/* for (i = 0; i < n; i++)*/
 }
@@ -725,8 +986,9 @@ update_rating_grp_cdr(void **sess_info, uint32_t **rgrp,
 		uint64_t *pkts_mask, uint32_t flow)
 {
 	uint32_t i;
-	struct dp_session_info *si;
+	struct dp_session_hot *si;
 	struct dp_sdf_per_bearer_info *psdf;
+	uint32_t rg_shard;
 	uint8_t rg_idx;
 
 	for (i = 0; i < n; i++) {
@@ -734,7 +996,7 @@ update_rating_grp_cdr(void **sess_info, uint32_t **rgrp,
 		if (psdf == NULL)
 			continue;
 
-		si = psdf->bear_sess_info;
+		si = psdf->bear_hot;
 		if (si == NULL)
 			continue;
 
@@ -745,12 +1007,13 @@ update_rating_grp_cdr(void **sess_info, uint32_t **rgrp,
 		if (rg_idx >= MAX_RATING_GRP)
 			continue;
 
+		rg_shard = si->ue_info_ptr->rg_vol_slot * MAX_RATING_GRP + rg_idx;
 		if (ISSET_BIT(*pkts_mask, i))
-			update_cdr(&si->ue_info_ptr->rating_grp[rg_idx],
-					pkts[i], flow, CHARGED);
+			update_vol_shard(CDR_VOL_RG, rg_shard, pkts[i], flow,
+					CHARGED);
 		else
-			update_cdr(&si->ue_info_ptr->rating_grp[rg_idx],
-					pkts[i], flow, DROPPED);
+			update_vol_shard(CDR_VOL_RG, rg_shard, pkts[i], flow,
+					DROPPED);
 	}	/* for (i = 0; i < n; i++)*/
 }
 
@@ -838,7 +1101,7 @@ clone_dns_pkts(struct rte_mbuf **pkts, uint32_t n, uint64_t pkts_mask)
 			if (meta_data->dns) {
 				push_dns_ring(pkts[i]);
 				/* ASR- TODO HYPERSCAN clone_dns_pkt to be tested */
-				++(epc_app.dl_params[SGI_PORT_ID].num_dns_packets);
+				++(EPC_DL_PARAMS.num_dns_packets);
 			}
 		}
 	}
@@ -850,15 +1113,12 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, uint8_t portid,
 		struct dp_sdf_per_bearer_info **sess_info)
 {
+	construct_ether_hdr_bulk(pkts, n, pkts_mask, portid, sess_info);
+
+#ifdef FRAG
 	uint32_t i;
 	for (i = 0; i < n; i++) {
 		if (ISSET_BIT(*pkts_mask, i)) {
-			if (construct_ether_hdr(pkts[i], portid, &sess_info[i]) < 0) {
-				RESET_BIT(*pkts_mask, i);
-				continue;
-			}
-
-#ifdef FRAG
 			if (RTE_ETH_IS_IPV4_HDR(pkts[i]->packet_type) &&
 			    unlikely(SGI_ETHER_MTU < pkts[i]->pkt_len)) {
 
@@ -964,7 +1224,8 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 					struct rte_mbuf **out_pkts = frag_tbl;
 
 					do {
-						ret = rte_eth_tx_burst(portid, 0, out_pkts, cnt);
+						ret = rte_eth_tx_burst(portid,
+								RTE_PER_LCORE(epc_wrk_id), out_pkts, cnt);
 						out_pkts += ret;
 						cnt -= ret;
 					} while (cnt > 0);
@@ -973,38 +1234,115 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 				/* un-set the bit */
 				RESET_BIT(*pkts_mask, i);
 			}
-#endif /* FRAG */
 		}
-		/* TODO: Set checksum offload.*/
 	}
+#endif /* FRAG */
+
+	ipv4_cksum_tx_prep(pkts, n, *pkts_mask, portid);
+}
+
+/**
+ * Relay a GTP-U pkt to the next tunnel hop in place: new outer IPv4
+ * addresses, and TEID if given. The IPv4 checksum is patched per RFC
+ * 1624, or left to the NIC; all other outer fields are kept.
+ *
+ * @param m
+ *	mbuf of an ether + IPv4 + UDP + GTP-U pkt.
+ * @param src_addr
+ *	outer source address, network order.
+ * @param dst_addr
+ *	outer destination address, network order.
+ * @param teid
+ *	TEID, network order; NULL to keep it.
+ * @param hw_cksum
+ *	egress port computes the IPv4 checksum.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if the outer header has options: rebuild it
+ */
+static inline int
+gtpu_relay(struct rte_mbuf *m, uint32_t src_addr, uint32_t dst_addr,
+		const uint32_t *teid, uint8_t hw_cksum)
+{
+	struct ipv4_hdr *ip = get_mtoip(m);
+	struct udp_hdr *udp = (struct udp_hdr *)(ip + 1);
+	uint16_t cksum;
+
+	if (unlikely(ip->version_ihl != 0x45))
+		return -1;
+
+	if (hw_cksum) {
+		ip->src_addr = src_addr;
+		ip->dst_addr = dst_addr;
+		ipv4_cksum_defer(m);
+	} else {
+		cksum = ipv4_cksum_adjust32(ip->hdr_checksum,
+				ip->src_addr, src_addr);
+		cksum = ipv4_cksum_adjust32(cksum, ip->dst_addr, dst_addr);
+		ip->src_addr = src_addr;
+		ip->dst_addr = dst_addr;
+		ip->hdr_checksum = cksum;
+	}
+
+	/* Optional over IPv4, and void with the new endpoints */
+	udp->dgram_cksum = 0;
+
+	if (teid != NULL)
+		((struct gtpu_hdr *)(udp + 1))->teid = *teid;
+
+	return 0;
+}
+
+/**
+ * Rebuild the outer IPv4 header of a relayed pkt with options.
+ *
+ * @param m
+ *	mbuf pointer.
+ * @param src_ip
+ *	outer source address, host order.
+ * @param dst_ip
+ *	outer destination address, host order.
+ */
+static void
+gtpu_relay_rebuild(struct rte_mbuf *m, uint32_t src_ip, uint32_t dst_ip)
+{
+	uint16_t len = rte_pktmbuf_data_len(m) - ETH_HDR_SIZE;
+
+	build_ipv4_default_hdr(m);
+	set_ipv4_hdr(m, len, IP_PROTO_UDP, src_ip, dst_ip);
+	ipv4_cksum_defer(m);
 }
 
 void
 update_nexts5s8_info(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, struct dp_sdf_per_bearer_info **sdf_bear_info)
 {
-	/*TODO: Do we need to update TEID in GTP header?*/
-	uint16_t len;
+	/* No S5/S8 TEID of the peer in the session: TEID is kept */
+	uint32_t src_addr, dst_addr;
+	uint8_t hw_cksum;
 	uint32_t i;
 
+	if (app.spgw_cfg == SGWU) {
+		src_addr = app.s5s8_sgwu_ip;
+		hw_cksum = ipv4_cksum_offload[app.s5s8_sgwu_port];
+	} else if (app.spgw_cfg == PGWU) {
+		src_addr = app.s5s8_pgwu_ip;
+		hw_cksum = ipv4_cksum_offload[app.s5s8_pgwu_port];
+	} else {
+		return;
+	}
+
 	for (i = 0; i < n; i++) {
-		if (ISSET_BIT(*pkts_mask, i)) {
-			len = rte_pktmbuf_data_len(pkts[i]);
-			len = len - ETH_HDR_SIZE;
-
-			if (app.spgw_cfg == SGWU) {
-				/*TODO : Make readable*/
-				uint32_t s5s8_pgwu_addr =
-					sdf_bear_info[i]->bear_sess_info->ul_s1_info.s5s8_pgwu_addr.u.ipv4_addr;
-				construct_ipv4_hdr(pkts[i], len, IP_PROTO_UDP,
-						ntohl(app.s5s8_sgwu_ip), s5s8_pgwu_addr);
-			}else if (app.spgw_cfg == PGWU) {
-				uint32_t s5s8_sgwu_addr =
-					sdf_bear_info[i]->bear_sess_info->dl_s1_info.s5s8_sgwu_addr.u.ipv4_addr;
-				construct_ipv4_hdr(pkts[i], len, IP_PROTO_UDP,
-						ntohl(app.s5s8_pgwu_ip), s5s8_sgwu_addr);
-			}
-		}
+		if (!ISSET_BIT(*pkts_mask, i))
+			continue;
+
+		dst_addr = (app.spgw_cfg == SGWU) ?
+			sdf_bear_info[i]->bear_hot->s5s8_pgwu_ipv4 :
+			sdf_bear_info[i]->bear_hot->s5s8_sgwu_ipv4;
+		if (gtpu_relay(pkts[i], src_addr, htonl(dst_addr), NULL,
+					hw_cksum) < 0)
+			gtpu_relay_rebuild(pkts[i], ntohl(src_addr), dst_addr);
 	}
 }
 
@@ -1012,22 +1350,21 @@ void
 update_enb_info(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, struct dp_sdf_per_bearer_info **sess_info)
 {
-	uint16_t len;
-	uint32_t i;
+	uint8_t hw_cksum = ipv4_cksum_offload[app.s1u_port];
+	struct dp_session_hot *hot;
+	uint32_t i, teid;
 
 	for (i = 0; i < n; i++) {
-		if (ISSET_BIT(*pkts_mask, i)) {
-			len = rte_pktmbuf_data_len(pkts[i]);
-			len = len - ETH_HDR_SIZE;
-
-			uint32_t enb_addr =
-					sess_info[i]->bear_sess_info->dl_s1_info.enb_addr.u.ipv4_addr;
-			construct_ipv4_hdr(pkts[i], len, IP_PROTO_UDP,
-					ntohl(app.s1u_ip), enb_addr);
+		if (!ISSET_BIT(*pkts_mask, i))
+			continue;
 
-			/*Update tied in GTP U header*/
-			((struct gtpu_hdr *)get_mtogtpu(pkts[i]))->teid  =
-					ntohl(sess_info[i]->bear_sess_info->dl_s1_info.enb_teid);
+		hot = sess_info[i]->bear_hot;
+		teid = htonl(hot->enb_teid);
+		if (gtpu_relay(pkts[i], app.s1u_ip, htonl(hot->enb_ipv4),
+					&teid, hw_cksum) < 0) {
+			gtpu_relay_rebuild(pkts[i], ntohl(app.s1u_ip),
+					hot->enb_ipv4);
+			((struct gtpu_hdr *)get_mtogtpu(pkts[i]))->teid = teid;
 		}
 	}
 }
@@ -1056,7 +1393,7 @@ hash_create(const char *name, struct rte_hash **rte_hash,
 		.key_len = key_len,
 		.hash_func = DEFAULT_HASH_FUNC,
 		.hash_func_init_val = 0,
-		.socket_id = rte_socket_id(),
+		.socket_id = dp_tbl_sz.socket,
 	};
 
 	*rte_hash = rte_hash_create(&rte_hash_params);
@@ -1071,17 +1408,26 @@ void dp_table_init(void)
 {
 	int ret;
 
+	/*
+	 * Size session tables from --max_sessions, check hugepages
+	 */
+	mem_budget_init(app.max_sessions);
+
 	/*
 	 * Create Uplink DB
 	 */
-	hash_create("iface_uplink_db", &rte_uplink_hash,
-				LDB_ENTRIES_DEFAULT * HASH_SIZE_FACTOR,
+	hash_create("iface_uplink_db", &rte_uplink_hash, dp_tbl_sz.ul_hash,
 				sizeof(struct ul_bm_key));
+#ifdef UL_TEID_INDEX
+	ul_teid_index = teid_index_create("iface_uplink_index",
+			dp_tbl_sz.teid_order);
+	if (ul_teid_index == NULL)
+		rte_exit(EXIT_FAILURE, "iface_uplink_index create failed\n");
+#endif /* UL_TEID_INDEX */
 	/*
 	 * Create Downlink DB
 	 */
-	hash_create("iface_downlink_db", &rte_downlink_hash,
-				LDB_ENTRIES_DEFAULT * HASH_SIZE_FACTOR,
+	hash_create("iface_downlink_db", &rte_downlink_hash, dp_tbl_sz.dl_hash,
 				sizeof(struct dl_bm_key));
 
 	/*
@@ -1093,19 +1439,19 @@ void dp_table_init(void)
 	/*
 	 * Create ADC UE info Hash table
 	 */
-	hash_create("adc_ue_info", &rte_adc_ue_hash, LDB_ENTRIES_DEFAULT,
+	hash_create("adc_ue_info", &rte_adc_ue_hash, dp_tbl_sz.adc_ue_hash,
 			sizeof(struct dl_bm_key));
 
 	/*
 	 * Create UE Sess Hash table
 	 */
-	hash_create("ue_sess_info", &rte_ue_hash, LDB_ENTRIES_DEFAULT,
+	hash_create("ue_sess_info", &rte_ue_hash, dp_tbl_sz.ue_hash,
 			sizeof(uint32_t));
 
 	/*
 	 * Create CLI Sess Hash table
 	 */
-	hash_create("sess_info_cli", &rte_sess_cli_hash, MAX_SESSIONS,
+	hash_create("sess_info_cli", &rte_sess_cli_hash, dp_tbl_sz.cli_hash,
 			sizeof(uint32_t));
 
 #ifdef HYPERSCAN_DPI
@@ -1178,6 +1524,8 @@ void dp_table_init(void)
 	hash_create("adc_pcc_hash", &rte_adc_pcc_hash, SDF_FILTER_TABLE_SIZE,
 			sizeof(uint32_t));
 
+	mem_budget_report();
+
 #ifdef PCAP_GEN
 	printf("\n\npcap files will be overwritten. Press ENTER to continue...\n");
 	getchar();
@@ -79,7 +79,7 @@ rte_ring *allocate_ring(void)
 			struct rte_ring *tmp =
 				rte_ring_create(name, DL_PKTS_RING_SIZE,
 						rte_socket_id(),
-						RING_F_SP_ENQ | RING_F_SC_DEQ);
+						RING_F_SC_DEQ);
 			if (tmp) {
 				int ret = rte_ring_enqueue(
 					dl_ring_container, tmp);
@@ -143,7 +143,7 @@ enqueue_dl_pkts(struct dp_sdf_per_bearer_info **sess_info,
 
 				}
 
-				si->sess_state = IN_PROGRESS;
+				dp_session_set_state(si, IN_PROGRESS);
 			}
 		}
 
@@ -151,7 +151,7 @@ enqueue_dl_pkts(struct dp_sdf_per_bearer_info **sess_info,
 			rte_pktmbuf_free(pkts[i]);
 			rte_ring_free(si->dl_ring);
 			si->dl_ring = NULL;
-			si->sess_state = IDLE;
+			dp_session_set_state(si, IDLE);
 
 			RTE_LOG_DP(ERR, DP, "%s::Can't queue pkt- ring full..."
 					" Dropping pkt\n", __func__);
@@ -144,18 +144,33 @@ nic_in_stats(void)
 static void
 ngic_rtc_in_stats(void)
 {
+	uint32_t wrk;
 
-	ul_pkts_dsp.ULRX = epc_app.ul_params[S1U_PORT_ID].pkts_in;
-	dl_pkts_dsp.DLRX = epc_app.dl_params[SGI_PORT_ID].pkts_in;
-	/* VCCCCB-34 Statistics- Add #of active sessions, RX & TX bytes */
-	ul_pkts_dsp.UL_BYTES = epc_app.ul_params[S1U_PORT_ID].tot_ul_bytes;
-	dl_pkts_dsp.DL_BYTES = epc_app.dl_params[SGI_PORT_ID].tot_dl_bytes;
+	ul_pkts_dsp.ULRX = 0;
+	dl_pkts_dsp.DLRX = 0;
+	ul_pkts_dsp.UL_BYTES = 0;
+	dl_pkts_dsp.DL_BYTES = 0;
 #ifdef DP_DDN
-	dl_pkts_dsp.ddn_pkts = epc_app.dl_params[SGI_PORT_ID].ddn;
+	dl_pkts_dsp.ddn_pkts = 0;
 #endif  /* DP_DDN */
 #ifdef EXSTATS
-	ul_pkts_dsp.GTP_ECHO = epc_app.ul_params[S1U_PORT_ID].pkts_echo;
+	ul_pkts_dsp.GTP_ECHO = 0;
 #endif /* EXSTATS */
+
+	/* Sum the per worker counters */
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		ul_pkts_dsp.ULRX += epc_app.ul_params[wrk].pkts_in;
+		dl_pkts_dsp.DLRX += epc_app.dl_params[wrk].pkts_in;
+		/* VCCCCB-34 Statistics- Add #of active sessions, RX & TX bytes */
+		ul_pkts_dsp.UL_BYTES += epc_app.ul_params[wrk].tot_ul_bytes;
+		dl_pkts_dsp.DL_BYTES += epc_app.dl_params[wrk].tot_dl_bytes;
+#ifdef DP_DDN
+		dl_pkts_dsp.ddn_pkts += epc_app.dl_params[wrk].ddn;
+#endif  /* DP_DDN */
+#ifdef EXSTATS
+		ul_pkts_dsp.GTP_ECHO += epc_app.ul_params[wrk].pkts_echo;
+#endif /* EXSTATS */
+	}
 }
 
 /**
@@ -170,8 +185,14 @@ ngic_rtc_in_stats(void)
 static void
 ngic_rtc_out_stats(void)
 {
-	ul_pkts_dsp.ULTX = epc_app.ul_params[S1U_PORT_ID].pkts_out;
-	dl_pkts_dsp.DLTX = epc_app.dl_params[SGI_PORT_ID].pkts_out;
+	uint32_t wrk;
+
+	ul_pkts_dsp.ULTX = 0;
+	dl_pkts_dsp.DLTX = 0;
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		ul_pkts_dsp.ULTX += epc_app.ul_params[wrk].pkts_out;
+		dl_pkts_dsp.DLTX += epc_app.dl_params[wrk].pkts_out;
+	}
 }
 
 /**
@@ -385,6 +406,7 @@ disp_trfstats(void)
 	while (rte_hash_iterate(rte_sess_hash, &next_key, &next_data, &iter) >= 0) {
 		struct dp_session_info *tmp_dp_sess_info =
 			(struct dp_session_info *)next_data;
+		cdr_shard_fold(tmp_dp_sess_info);
 		ue_ip = htonl(tmp_dp_sess_info->ue_addr.u.ipv4_addr);
 		printf("%#9lX %9s %9lu %9lu\n",
 				tmp_dp_sess_info->sess_id,
@@ -545,18 +567,29 @@ disp_mbfstats(void)
 void
 dp_mbf_stats(void)
 {
-	ul_mbuf_dsp.rx_alloc = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.rx_alloc;
-	ul_mbuf_dsp.gtpu = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.gtpu;
-	ul_mbuf_dsp.gtp_echo = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.gtp_echo;
-	ul_mbuf_dsp.kni = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.kni;
-	ul_mbuf_dsp.bad_pkt = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.bad_pkt;
-	ul_mbuf_dsp.tx_free = epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.tx_free;
-
-	dl_mbuf_dsp.rx_alloc = epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.rx_alloc;
-	dl_mbuf_dsp.dl_pkt = epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.dl_pkt;
-	dl_mbuf_dsp.kni = epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.kni;
-	dl_mbuf_dsp.bad_pkt = epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.bad_pkt;
-	dl_mbuf_dsp.tx_free = epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.tx_free;
+	uint32_t wrk;
+
+	memset(&ul_mbuf_dsp, 0, sizeof(ul_mbuf_dsp));
+	memset(&dl_mbuf_dsp, 0, sizeof(dl_mbuf_dsp));
+
+	/* Sum the per worker counters */
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		struct ul_mbuf_stats *ul = &epc_app.ul_params[wrk].ul_mbuf_rtime;
+		struct dl_mbuf_stats *dl = &epc_app.dl_params[wrk].dl_mbuf_rtime;
+
+		ul_mbuf_dsp.rx_alloc += ul->rx_alloc;
+		ul_mbuf_dsp.gtpu += ul->gtpu;
+		ul_mbuf_dsp.gtp_echo += ul->gtp_echo;
+		ul_mbuf_dsp.kni += ul->kni;
+		ul_mbuf_dsp.bad_pkt += ul->bad_pkt;
+		ul_mbuf_dsp.tx_free += ul->tx_free;
+
+		dl_mbuf_dsp.rx_alloc += dl->rx_alloc;
+		dl_mbuf_dsp.dl_pkt += dl->dl_pkt;
+		dl_mbuf_dsp.kni += dl->kni;
+		dl_mbuf_dsp.bad_pkt += dl->bad_pkt;
+		dl_mbuf_dsp.tx_free += dl->tx_free;
+	}
 }
 
 static void timer_cb(__attribute__ ((unused))
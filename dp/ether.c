@@ -16,6 +16,7 @@
 
 #include <arpa/inet.h>
 
+#include <rte_atomic.h>
 #include <rte_ip.h>
 
 #include "main.h"
@@ -24,11 +25,6 @@
 #include "ipv4.h"
 #include "mngtplane_handler.h"
 
-extern unsigned int fd_array[2];
-
-#ifndef STATIC_ARP
-static struct sockaddr_in dest_addr[2];
-#endif /* STATIC_ARP */
 /**
  * Function to set ethertype.
  *
@@ -47,127 +43,246 @@ static inline void set_ether_type(struct rte_mbuf *m, uint16_t type)
 	eth_hdr->ether_type = htons(type);
 }
 
+/* Next hop of the pkt's bearer, set in struct nh_policy peer */
+#define NH_PEER_NONE	0
+#define NH_PEER_PGWU	1
+#define NH_PEER_SGWU	2
+
 /**
- * Function to construct L2 headers.
- *
- * @param m
- *	mbuf pointer
+ * Next hop choice of an egress port, fixed per burst: the gateway when
+ * the destination is off the port's network, else the peer gateway of
+ * the bearer, else the destination itself.
+ */
+struct nh_policy {
+	/** gateway, network order, 0 if none */
+	uint32_t gw;
+	/** port network and mask; net ~0 with mask 0 for no network */
+	uint32_t net;
+	uint32_t mask;
+	/** NH_PEER_* */
+	uint8_t peer;
+};
+
+/**
+ * Next hop choice of an egress port for the configured gateway.
  *
- * @return
- *	- 0  on success
- *	- -1 on failure (ARP lookup fail)
+ * @param p
+ *	policy filled in.
+ * @param portid
+ *	egress port id.
  */
-int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
-		struct dp_sdf_per_bearer_info **sess_info)
+static void
+nh_policy_get(struct nh_policy *p, uint8_t portid)
 {
-	struct ipv4_hdr *ipv4_hdr =
-				rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
-										sizeof(struct ether_hdr));
-	struct arp_ipv4_key tmp_arp_key = {
-		.ip = ipv4_hdr->dst_addr
-	};
+	p->gw = 0;
+	p->net = UINT32_MAX;
+	p->mask = 0;
+	p->peer = NH_PEER_NONE;
 
 	if (app.spgw_cfg == SPGWU) {
 		if (portid == app.s1u_port) {
-			if (app.s1u_gw_ip != 0 &&
-					(tmp_arp_key.ip & app.s1u_mask) != app.s1u_net)
-				tmp_arp_key.ip = app.s1u_gw_ip;
-		} else if(portid == app.sgi_port) {
-			if (app.sgi_gw_ip != 0 &&
-					(tmp_arp_key.ip & app.sgi_mask) != app.sgi_net)
-				tmp_arp_key.ip = app.sgi_gw_ip;
+			p->gw = app.s1u_gw_ip;
+			p->net = app.s1u_net;
+			p->mask = app.s1u_mask;
+		} else if (portid == app.sgi_port) {
+			p->gw = app.sgi_gw_ip;
+			p->net = app.sgi_net;
+			p->mask = app.sgi_mask;
 		}
 	} else if (app.spgw_cfg == SGWU) {
 		if (portid == app.s1u_port) {
-			if (app.s1u_gw_ip != 0)
-				tmp_arp_key.ip = app.s1u_gw_ip;
+			p->gw = app.s1u_gw_ip;
 		} else if (portid == app.s5s8_sgwu_port) {
-			if (app.sgw_s5s8gw_ip != 0 &&
-					(tmp_arp_key.ip & app.sgw_s5s8gw_mask) != app.sgw_s5s8gw_net) {
-				tmp_arp_key.ip = app.sgw_s5s8gw_ip;
-			} else {
-				uint32_t s5s8_pgwu_addr =
-				sess_info[0]->bear_sess_info->ul_s1_info.s5s8_pgwu_addr.u.ipv4_addr;
-				if (s5s8_pgwu_addr != 0)
-					tmp_arp_key.ip = htonl(s5s8_pgwu_addr);
-			}
-
+			p->gw = app.sgw_s5s8gw_ip;
+			p->net = app.sgw_s5s8gw_net;
+			p->mask = app.sgw_s5s8gw_mask;
+			p->peer = NH_PEER_PGWU;
 		}
-	} else if(app.spgw_cfg == PGWU) {
+	} else if (app.spgw_cfg == PGWU) {
 		if (portid == app.sgi_port) {
-			if (app.sgi_gw_ip != 0)
-				tmp_arp_key.ip = app.sgi_gw_ip;
+			p->gw = app.sgi_gw_ip;
 		} else if (portid == app.s5s8_pgwu_port) {
-			if (app.pgw_s5s8gw_ip != 0 &&
-					(tmp_arp_key.ip & app.pgw_s5s8gw_mask) != app.pgw_s5s8gw_net) {
-				tmp_arp_key.ip = app.pgw_s5s8gw_ip;
-			} else {
-				uint32_t s5s8_sgwu_addr =
-					sess_info[0]->bear_sess_info->dl_s1_info.s5s8_sgwu_addr.u.ipv4_addr;
-				if (s5s8_sgwu_addr != 0)
-					tmp_arp_key.ip = htonl(s5s8_sgwu_addr);
-			}
-
+			p->gw = app.pgw_s5s8gw_ip;
+			p->net = app.pgw_s5s8gw_net;
+			p->mask = app.pgw_s5s8gw_mask;
+			p->peer = NH_PEER_SGWU;
 		}
 	}
+}
+
+/**
+ * Next hop of a pkt, before route lookup.
+ *
+ * @param p
+ *	egress port policy.
+ * @param m
+ *	mbuf pointer
+ * @param hot
+ *	bearer of the pkt, may be NULL.
+ *
+ * @return
+ *	next hop ip address, network order.
+ */
+static inline uint32_t
+nh_policy_apply(const struct nh_policy *p, struct rte_mbuf *m,
+		const struct dp_session_hot *hot)
+{
+	struct ipv4_hdr *ipv4_hdr =
+				rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+										sizeof(struct ether_hdr));
+	uint32_t ip = ipv4_hdr->dst_addr;
+	uint32_t peer_addr = 0;
+
+	if (p->gw != 0 && (ip & p->mask) != p->net)
+		return p->gw;
+
+	if (hot != NULL) {
+		if (p->peer == NH_PEER_PGWU)
+			peer_addr = hot->s5s8_pgwu_ipv4;
+		else if (p->peer == NH_PEER_SGWU)
+			peer_addr = hot->s5s8_sgwu_ipv4;
+	}
+	if (peer_addr != 0)
+		ip = htonl(peer_addr);
 
-	struct arp_entry_data *ret_arp_data = NULL;
-	if (ARPICMP_DEBUG)
-		printf("%s::"
-				"\n\tretrieve_arp_entry for ip 0x%x\n",
-				__func__, tmp_arp_key.ip);
-	ret_arp_data = retrieve_arp_entry(tmp_arp_key, portid);
-
-	if (ret_arp_data == NULL) {
-		RTE_LOG_DP(DEBUG, DP, "%s::"
-				"\n\tretrieve_arp_entry failed for ip 0x%x\n",
-				__func__, tmp_arp_key.ip);
+	return ip;
+}
+
+/**
+ * Copy the mac address of a next hop cache entry.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if the entry is stale, empty or being written
+ */
+static inline int
+nh_cache_get(const struct nh_cache *c, uint32_t gen, uint32_t ip,
+		struct ether_addr *mac)
+{
+	uint32_t seq = c->seq;
+
+	if (seq & 1)
+		return -1;
+	rte_smp_rmb();
+	if (c->gen != gen || c->ip != ip)
 		return -1;
+	ether_addr_copy(&c->mac, mac);
+	rte_smp_rmb();
+
+	return c->seq == seq ? 0 : -1;
+}
+
+/**
+ * Fill a next hop cache entry, unless another worker is filling it.
+ */
+static inline void
+nh_cache_set(struct nh_cache *c, uint32_t gen, uint32_t ip,
+		const struct ether_addr *mac)
+{
+	uint32_t seq = c->seq;
+
+	if ((seq & 1) || !rte_atomic32_cmpset(&c->seq, seq, seq + 1))
+		return;
+	rte_smp_wmb();
+	c->gen = gen;
+	c->ip = ip;
+	ether_addr_copy(mac, &c->mac);
+	rte_smp_wmb();
+	c->seq = seq + 2;
+}
+
+void
+construct_ether_hdr_bulk(struct rte_mbuf **pkts, uint32_t n,
+		uint64_t *pkts_mask, uint8_t portid,
+		struct dp_sdf_per_bearer_info **sess_info)
+{
+	struct nh_policy policy;
+	struct ether_addr mac[MAX_BURST_SZ];
+	struct nh_cache *nhc[MAX_BURST_SZ];
+	uint32_t key_ip[MAX_BURST_SZ];
+	/* Distinct next hops missing the cache, in burst order */
+	struct arp_ipv4_key miss_key[MAX_BURST_SZ];
+	struct arp_entry_data *arp_data[MAX_BURST_SZ];
+	uint8_t miss_slot[MAX_BURST_SZ];
+	uint64_t miss_mask = 0, arp_hits;
+	uint32_t i, s, nb_miss = 0, nb_out = 0;
+	struct dp_session_hot *hot;
+	struct ether_hdr *eth_hdr;
+	uint32_t gen;
+
+	/* Before the lookups: a change made meanwhile leaves the entries
+	 * filled below stale */
+	gen = nh_gen;
+	rte_smp_rmb();
+
+	nh_policy_get(&policy, portid);
+
+	for (i = 0; i < n; i++) {
+		if (!ISSET_BIT(*pkts_mask, i))
+			continue;
+
+		hot = sess_info[i] ? sess_info[i]->bear_hot : NULL;
+		key_ip[i] = nh_policy_apply(&policy, pkts[i], hot);
+		nhc[i] = hot ? &hot->nh[portid] : NULL;
+
+		if (nhc[i] && nh_cache_get(nhc[i], gen, key_ip[i], &mac[i]) == 0)
+			continue;
+
+		/* Bursts mostly go to a few next hops: only look a next hop
+		 * up again when it changes */
+		if (nb_miss == 0 || miss_key[nb_miss - 1].ip != key_ip[i])
+			miss_key[nb_miss++].ip = key_ip[i];
+		miss_slot[i] = nb_miss - 1;
+		SET_BIT(miss_mask, i);
 	}
 
+	if (miss_mask) {
+		if (ARPICMP_DEBUG)
+			printf("%s::"
+					"\n\tretrieve_arp_entry_bulk for %u next hops\n",
+					__func__, nb_miss);
+		arp_hits = retrieve_arp_entry_bulk(miss_key, nb_miss, portid,
+				arp_data);
 
-	if (ret_arp_data->status == INCOMPLETE) {
+		for (i = 0; i < n; i++) {
+			if (!ISSET_BIT(miss_mask, i))
+				continue;
+
+			s = miss_slot[i];
+			if (!ISSET_BIT(arp_hits, s) ||
+					arp_data[s]->status == INCOMPLETE) {
+				RTE_LOG_DP(DEBUG, DP, "%s::"
+						"\n\tretrieve_arp_entry failed for ip 0x%x\n",
+						__func__, miss_key[s].ip);
 #ifndef STATIC_ARP
-		RTE_LOG_DP(INFO, DP, "Sendto:: ret_arp_data->ip= %s\n",
-					inet_ntoa(*(struct in_addr *)&ret_arp_data->ip));
-
-		/* setting sendto destination addr */
-		dest_addr[portid].sin_family = AF_INET;
-		dest_addr[portid].sin_addr.s_addr = ret_arp_data->ip;
-		dest_addr[portid].sin_port = htons(SOCKET_PORT);
-
-		char *data = (char *)((char *)(m)->buf_addr + (m)->data_off);
-		if ((sendto(fd_array[portid], data, m->data_len, 0, (struct sockaddr *)
-					&dest_addr[portid], sizeof(struct sockaddr_in))) < 0) {
-			perror("send failed");
-			return -1;
-		}
+				/* Resolver lcore sends the pkt once next hop
+				 * resolves */
+				arp_queue_unresolved(pkts[i], miss_key[s].ip, portid);
 #endif /* STATIC_ARP */
-		return -1;
+				RESET_BIT(*pkts_mask, i);
+				continue;
+			}
+
+			ether_addr_copy(&arp_data[s]->eth_addr, &mac[i]);
+			if (nhc[i])
+				nh_cache_set(nhc[i], gen, key_ip[i], &mac[i]);
+		}
 	}
 
-	/* Assemble L2 hdr */
-	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
-	eth_hdr->ether_type = htons(ETH_TYPE_IPv4);
-
-	RTE_LOG_DP(DEBUG, DP,
-			"MAC found for ip %s"
-			", port %d - %02x:%02x:%02x:%02x:%02x:%02x\n",
-			inet_ntoa(*(struct in_addr *)&tmp_arp_key.ip), portid,
-					ret_arp_data->eth_addr.addr_bytes[0],
-					ret_arp_data->eth_addr.addr_bytes[1],
-					ret_arp_data->eth_addr.addr_bytes[2],
-					ret_arp_data->eth_addr.addr_bytes[3],
-					ret_arp_data->eth_addr.addr_bytes[4],
-					ret_arp_data->eth_addr.addr_bytes[5]);
-
-	ether_addr_copy(&ret_arp_data->eth_addr, &eth_hdr->d_addr);
-	ether_addr_copy(&ports_eth_addr[portid], &eth_hdr->s_addr);
-
-	if(portid == SGI_PORT_ID) {
-		++epc_app.ul_params[S1U_PORT_ID].pkts_out;
-	} else if(portid == S1U_PORT_ID) {
-		++epc_app.dl_params[SGI_PORT_ID].pkts_out;
+	/* Assemble L2 hdrs */
+	for (i = 0; i < n; i++) {
+		if (!ISSET_BIT(*pkts_mask, i))
+			continue;
+
+		eth_hdr = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+		eth_hdr->ether_type = htons(ETH_TYPE_IPv4);
+		ether_addr_copy(&mac[i], &eth_hdr->d_addr);
+		ether_addr_copy(&ports_eth_addr[portid], &eth_hdr->s_addr);
+		nb_out++;
 	}
-	return 0;
+
+	if (portid == SGI_PORT_ID)
+		EPC_UL_PARAMS.pkts_out += nb_out;
+	else if (portid == S1U_PORT_ID)
+		EPC_DL_PARAMS.pkts_out += nb_out;
 }
@@ -42,19 +42,25 @@ static inline struct ether_hdr *get_mtoeth(struct rte_mbuf *m)
 }
 
 /**
- * Function to construct L2 headers.
+ * Function to construct L2 headers of a burst.
+ *	Next hops are resolved once per burst: from the bearer next hop
+ *	cache (struct nh_cache), else with one retrieve_arp_entry_bulk
+ *	for the distinct next hops missing it.
  *
- * @param m
- *	mbuf pointer
+ * @param pkts
+ *	mbuf pointers
+ * @param n
+ *	number of pkts.
+ * @param pkts_mask
+ *	bit mask of pkts to process, bit reset for pkts whose next hop
+ *	is unresolved.
  * @param portid
  *	port id
  * @param sess_info
- *	pointer to session bear info
- * @return
- *	- 0  on success
- *	- -1 on failure (ARP lookup fail)
+ *	session bear info of each pkt, may be NULL.
  */
-int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
+void construct_ether_hdr_bulk(struct rte_mbuf **pkts, uint32_t n,
+		uint64_t *pkts_mask, uint8_t portid,
 		struct dp_sdf_per_bearer_info **sess_info);
 
 #endif				/* _ETHER_H_ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_bus_vdev.h>
+#include <rte_lcore.h>
+#include <rte_per_lcore.h>
+
+#include "main.h"
+#include "ngic_rtc_framework.h"
+#include "excp_handler.h"
+
+/* UDP sockets the ARP resolver kicks kernel resolution with, per port */
+unsigned int fd_array[2];
+
+/**
+ * Exception path backend: a PMD whose ports are kernel interfaces.
+ */
+struct excp_backend {
+	/** vdev name prefix */
+	const char *drv;
+	/**
+	 * Build the vdev args.
+	 *
+	 * @param iface
+	 *	kernel interface name.
+	 * @param mac
+	 *	interface MAC, formatted.
+	 * @param nb_queues
+	 *	queue pairs.
+	 */
+	int (*devargs)(char *buf, size_t len, const char *iface,
+			const char *mac, uint16_t nb_queues);
+};
+
+static int
+excp_tap_devargs(char *buf, size_t len, const char *iface, const char *mac,
+		uint16_t nb_queues)
+{
+	/* TAP queues are set at configure time */
+	RTE_SET_USED(nb_queues);
+	return snprintf(buf, len, "iface=%s,mac=%s", iface, mac);
+}
+
+static int
+excp_virtio_user_devargs(char *buf, size_t len, const char *iface,
+		const char *mac, uint16_t nb_queues)
+{
+	return snprintf(buf, len, "path=%s,iface=%s,mac=%s,queues=%u,"
+			"queue_size=%u", EXCP_VHOST_NET, iface, mac, nb_queues,
+			EXCP_NUM_DESC);
+}
+
+static const struct excp_backend excp_backend[] = {
+	[EXCP_PATH_TAP] = {"net_tap", excp_tap_devargs},
+	[EXCP_PATH_VIRTIO_USER] = {"virtio_user", excp_virtio_user_devargs},
+};
+
+/* Kernel interface port of each DP port, EXCP_NO_PORT if none */
+static uint16_t excp_port[RTE_MAX_ETHPORTS] = {
+	[0 ... RTE_MAX_ETHPORTS - 1] = EXCP_NO_PORT
+};
+/* Queue pairs of the kernel interface ports */
+static uint16_t excp_nb_queues;
+/* TSC cycles between two polls of a kernel interface */
+static uint64_t excp_poll_cycles;
+
+/* Next poll of the kernel interface of the lcore egress port */
+static RTE_DEFINE_PER_LCORE(uint64_t, excp_next_poll);
+
+/**
+ * Configure and start a kernel interface port.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+excp_port_start(uint16_t pid, struct rte_mempool *mp)
+{
+	struct rte_eth_conf conf;
+	uint16_t q;
+
+	memset(&conf, 0, sizeof(conf));
+	if (rte_eth_dev_configure(pid, excp_nb_queues, excp_nb_queues,
+				&conf) < 0)
+		return -1;
+
+	for (q = 0; q < excp_nb_queues; q++) {
+		if (rte_eth_rx_queue_setup(pid, q, EXCP_NUM_DESC,
+					rte_eth_dev_socket_id(pid), NULL, mp) < 0)
+			return -1;
+		if (rte_eth_tx_queue_setup(pid, q, EXCP_NUM_DESC,
+					rte_eth_dev_socket_id(pid), NULL) < 0)
+			return -1;
+	}
+
+	return rte_eth_dev_start(pid) < 0 ? -1 : 0;
+}
+
+int
+excp_init(uint16_t port_id, struct rte_mempool *mp)
+{
+	const struct excp_backend *be;
+	char name[RTE_ETH_NAME_MAX_LEN];
+	char args[256];
+	char mac[ETHER_ADDR_FMT_SIZE];
+	struct ether_addr addr;
+	const char *iface;
+	uint16_t pid;
+
+	/* Kernel ARP resolution is kicked with a UDP send to the next hop */
+	fd_array[port_id] = socket(AF_INET, SOCK_DGRAM, 0);
+	if ((int)fd_array[port_id] < 0) {
+		RTE_LOG_DP(ERR, DP, "EXCP: port %u socket failed\n", port_id);
+		return -1;
+	}
+
+	if (app.excp_path == EXCP_PATH_NONE)
+		return 0;
+
+	be = &excp_backend[app.excp_path];
+	excp_nb_queues = epc_app.nb_workers;
+	excp_poll_cycles = app.excp_poll_us * (rte_get_tsc_hz() / US_PER_S);
+
+	iface = (port_id == S1U_PORT_ID) ?
+		app.ul_iface_name : app.dl_iface_name;
+	rte_eth_macaddr_get(port_id, &addr);
+	ether_format_addr(mac, sizeof(mac), &addr);
+
+	snprintf(name, sizeof(name), "%s%u", be->drv, port_id);
+	if (be->devargs(args, sizeof(args), iface, mac, excp_nb_queues) >=
+			(int)sizeof(args))
+		return -1;
+
+	if (rte_vdev_init(name, args) < 0 ||
+			rte_eth_dev_get_port_by_name(name, &pid) < 0) {
+		RTE_LOG_DP(ERR, DP, "EXCP: %s %s create failed\n", name, args);
+		return -1;
+	}
+
+	if (excp_port_start(pid, mp) < 0) {
+		RTE_LOG_DP(ERR, DP, "EXCP: %s start failed\n", name);
+		return -1;
+	}
+
+	excp_port[port_id] = pid;
+	printf("EXCP: port %u kernel interface %s, %s port %u, %u queues\n",
+			port_id, iface, name, pid, excp_nb_queues);
+
+	return 0;
+}
+
+uint16_t
+excp_ingress(uint16_t port_id, struct rte_mbuf **pkts, uint16_t n)
+{
+	uint16_t pid = excp_port[port_id];
+	struct rte_mbuf *seg;
+	uint16_t i, nb_tx;
+
+	if (pid == EXCP_NO_PORT)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		for (seg = pkts[i]; seg != NULL; seg = seg->next)
+			rte_mbuf_refcnt_update(seg, 1);
+	}
+
+	nb_tx = rte_eth_tx_burst(pid, RTE_PER_LCORE(epc_wrk_id), pkts, n);
+	for (i = nb_tx; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	return nb_tx;
+}
+
+uint16_t
+excp_egress(uint16_t port_id, struct rte_mbuf **pkts)
+{
+	uint16_t pid = excp_port[port_id];
+	uint16_t q, nb_rx = 0;
+	uint64_t now;
+
+	if (pid == EXCP_NO_PORT)
+		return 0;
+
+	now = rte_rdtsc();
+	if (now < RTE_PER_LCORE(excp_next_poll))
+		return 0;
+	RTE_PER_LCORE(excp_next_poll) = now + excp_poll_cycles;
+
+	for (q = 0; q < excp_nb_queues && nb_rx < PKT_BURST_SZ; q++)
+		nb_rx += rte_eth_rx_burst(pid, q, &pkts[nb_rx],
+				PKT_BURST_SZ - nb_rx);
+
+	return nb_rx;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _EXCP_HANDLER_H_
+#define _EXCP_HANDLER_H_
+/**
+ * @file
+ * Kernel exception path. Pkts the DP does not handle itself (ARP, ICMP,
+ * ...) are handed to a kernel interface per DP port, named by --ul_iface
+ * and --dl_iface, and what the kernel sends out of that interface goes
+ * out of the DP port.
+ *
+ * The kernel interfaces are DPDK ports of a TAP or virtio-user PMD,
+ * picked by --excp_path, so stock kernels do: no out-of-tree module.
+ * Each worker has its own TX queue towards the kernel, so workers hand
+ * over their exception pkts lock-free, one burst at a time. The first
+ * worker of each direction polls the kernel interface of its egress
+ * port, every --excp_poll_us rather than every loop.
+ */
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+/* No kernel interface for this DP port */
+#define EXCP_NO_PORT		UINT16_MAX
+
+/* RX/TX descriptors per exception port queue */
+#define EXCP_NUM_DESC		512
+
+/* virtio-user vhost-net backend */
+#define EXCP_VHOST_NET		"/dev/vhost-net"
+
+/**
+ * Create the kernel interface of a DP port, with the --excp_path
+ * backend, the DP port MAC and one queue pair per worker, and open the
+ * socket the ARP resolver kicks kernel resolution with.
+ *
+ * @param port_id
+ *	DP port id, S1U_PORT_ID or SGI_PORT_ID; started.
+ * @param mp
+ *	mempool of the pkts the kernel sends.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int
+excp_init(uint16_t port_id, struct rte_mempool *mp);
+
+/**
+ * Hand a burst of pkts received on a DP port to its kernel interface,
+ * on the TX queue of the calling worker. The pkts are not copied: they
+ * take an extra reference, the caller still frees its own.
+ *
+ * @param port_id
+ *	DP port the pkts were received on.
+ * @param pkts
+ *	pkts to hand over.
+ * @param n
+ *	number of pkts, at most PKT_BURST_SZ.
+ *
+ * @return
+ *	number of pkts handed over.
+ */
+uint16_t
+excp_ingress(uint16_t port_id, struct rte_mbuf **pkts, uint16_t n);
+
+/**
+ * Receive the pkts the kernel sent out of the interface of a DP port,
+ * if --excp_poll_us elapsed since the last poll of the calling lcore.
+ * Single lcore per port.
+ *
+ * @param port_id
+ *	DP port the pkts are to be sent out of.
+ * @param pkts
+ *	array of PKT_BURST_SZ pkts.
+ *
+ * @return
+ *	number of pkts received, 0 when not polled.
+ */
+uint16_t
+excp_egress(uint16_t port_id, struct rte_mbuf **pkts);
+
+#endif /* _EXCP_HANDLER_H_ */
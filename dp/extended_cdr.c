@@ -29,8 +29,22 @@
 #include "cdr.h"
 #include "util.h"
 
-FILE *extended_cdr_file;
-uint64_t extcdr_count;
+/* ue_ip/app_ip columns hold source/destination of the packet */
+static const struct cdr_field_t ext_cdr_fields[] = {
+	{"record", CDR_U64, CDR_OFF(seq), NULL},
+	{"time", CDR_TIME, CDR_OFF(time), NULL},
+	{"ue_ip", CDR_IPV4, CDR_OFF(ue_ip), NULL},
+	{"app_ip", CDR_IPV4, CDR_OFF(app_ip), NULL},
+	{"direction", CDR_ENUM, CDR_OFF(direction), cdr_direction_str},
+	{"pcc_rule_id", CDR_U32, CDR_OFF(id), NULL},
+	{"pcc_rule_name", CDR_CHARS, CDR_OFF(name), NULL},
+	{"filter_type", CDR_ENUM, CDR_OFF(rule_type), cdr_rule_type_str},
+	{"action", CDR_ENUM, CDR_OFF(action), cdr_action_str},
+	{"sponsor_id", CDR_CHARS, CDR_OFF(sponsor_id), NULL},
+	{"service_id", CDR_U32, CDR_OFF(service_id), NULL},
+	{"rate_group", CDR_U32, CDR_OFF(rating_group), NULL},
+	{"report_level", CDR_U8, CDR_OFF(report_level), NULL},
+};
 
 void
 extended_cdr_init(void)
@@ -38,8 +52,6 @@ extended_cdr_init(void)
 	char timestamp[NAME_MAX];
 	char filename[PATH_MAX];
 
-	extcdr_count = 0;
-
 	time_t t = time(NULL);
 	struct tm *tmp = localtime(&t);
 
@@ -49,62 +61,40 @@ extended_cdr_init(void)
 
 	printf("Logging Extended CDR Records to %s\n", filename);
 
-	extended_cdr_file = fopen(filename, "w");
-	if (!extended_cdr_file)
-		rte_panic("Extended CDR file %s failed to open for writing\n - %s (%d)",
-					filename, strerror(errno), errno);
-
-	if (fprintf(extended_cdr_file, "#%s,%s,%s,%s,%s,%s,%s,%s,"
-				"%s,%s,%s,%s,%s\n",
-				"record",
-				"time",
-				"ue_ip",
-				"app_ip",
-				"direction",
-				"pcc_rule_id",
-				"pcc_rule_name",
-				"filter_type",
-				"action",
-				"sponsor_id",
-				"service_id",
-				"rate_group",
-				"report_level") < 0)
-		rte_panic("%s [%d] fprintf(extended_cdr_file header failed - %s "
-				"(%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
-	if (fflush(extended_cdr_file))
-		rte_panic("%s [%d] fflush(extended_cdr_file failed - %s (%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
+	cdr_writer_init();
+	cdr_writer_open(CDR_STREAM_EXT, filename, ext_cdr_fields,
+			RTE_DIM(ext_cdr_fields), "#", RECORD_TIME_FORMAT);
 }
 
 
 void
-export_extended_cdr(char *ue_ip,
-			char *app_ip, uint8_t pkt_mask, struct pcc_rules *pcc_info,
+export_extended_cdr(uint32_t ue_ip,
+			uint32_t app_ip, uint8_t pkt_mask, struct pcc_rules *pcc_info,
 			int direction)
 {
-	if(UL_FLOW == direction){
-		fprintf(extended_cdr_file, "%"PRIu64",%"PRIu32",%s,%s,%s,%"PRIu32
-			",%s,%s,%s,%s,%"PRIu32",%"PRIu32",%"PRIu32"\n",
-			extcdr_count, 1, ue_ip, app_ip, "UL", pcc_info->rule_id,
-			pcc_info->rule_name,
-			pcc_info->sdf_idx_cnt > 0 ? "SDF":"ADC",
-			pkt_mask == 1 ? "CHARGED":"DROPPED",
-			pcc_info->sponsor_id, pcc_info->service_id,
-			pcc_info->rating_group, pcc_info->report_level);
-	} else {
-		fprintf(extended_cdr_file, "%"PRIu64",%"PRIu32",%s,%s,%s,%"PRIu32
-			",%s,%s,%s,%s,%"PRIu32",%"PRIu32",%"PRIu32"\n",
-			extcdr_count, 1, app_ip, ue_ip, "DL", pcc_info->rule_id,
-			pcc_info->rule_name,
-			pcc_info->sdf_idx_cnt > 0 ? "SDF":"ADC",
-			pkt_mask == 1 ? "CHARGED":"DROPPED",
-			pcc_info->sponsor_id, pcc_info->service_id,
-			pcc_info->rating_group, pcc_info->report_level);
-	}
+	struct cdr_rec *rec = cdr_rec_alloc(CDR_STREAM_EXT);
 
-	fflush(extended_cdr_file);
+	if (rec == NULL)
+		return;
 
-	++extcdr_count;
+	if (UL_FLOW == direction) {
+		rec->ue_ip = ue_ip;
+		rec->app_ip = app_ip;
+		rec->direction = CDR_DIR_UL;
+	} else {
+		rec->ue_ip = app_ip;
+		rec->app_ip = ue_ip;
+		rec->direction = CDR_DIR_DL;
+	}
+	rec->id = pcc_info->rule_id;
+	cdr_rec_strcpy(rec->name, pcc_info->rule_name);
+	rec->rule_type = pcc_info->sdf_idx_cnt > 0 ?
+			CDR_RULE_SDF : CDR_RULE_ADC;
+	rec->action = pkt_mask == 1 ?
+			CDR_ACTION_CHARGED : CDR_ACTION_DROPPED;
+	cdr_rec_strcpy(rec->sponsor_id, pcc_info->sponsor_id);
+	rec->service_id = pcc_info->service_id;
+	rec->rating_group = pcc_info->rating_group;
+	rec->report_level = pcc_info->report_level;
+	cdr_rec_submit(rec);
 }
-
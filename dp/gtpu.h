@@ -152,11 +152,16 @@ void gtpu_get_inner_src_dst_ip_without_seqnb(struct rte_mbuf *m, uint32_t *src_i
 
 /**
  * Function to process GTPU Echo request
+ *  Turns the request into the response in place: swaps addresses and
+ *  ports, sets the message type and a Recovery IE in place of any
+ *  request IE. The IPv4 checksum is left to TX (ipv4_cksum_defer),
+ *  the UDP checksum is 0.
  *  @param echo_pkt
- *  mbuf of the incoming packet.
+ *  mbuf of the incoming packet, single segment.
  *
  * @return
- * void
+ *	- 0 on success
+ *	- -1 on failure (malformed request)
  */
-void process_echo_request(struct rte_mbuf *echo_pkt);
+int process_echo_request(struct rte_mbuf *echo_pkt);
 #endif	/* _GTPU_H_ */
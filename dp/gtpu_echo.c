@@ -3,6 +3,7 @@
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_udp.h>
+#include <rte_mbuf.h>
 #include "ipv4.h"
 #include "gtpu.h"
 //#include "gtpu_echo.h"
@@ -16,10 +17,12 @@ typedef struct gtpu_recovery_ie_t {
 
 /* Brief: Function to set echo request as echo response
  * @ Input param: echo_pkt rte_mbuf pointer
+ * @ Input param: udp_len UDP length of the response
  * @ Output param: none
  * Return: void
  */
-static void reset_req_pkt_as_resp(struct rte_mbuf *echo_pkt) {
+static void reset_req_pkt_as_resp(struct rte_mbuf *echo_pkt,
+		uint16_t udp_len) {
 	/* Swap src and destination mac addresses */
 	struct ether_hdr *eth_h = rte_pktmbuf_mtod(echo_pkt, struct ether_hdr *);
 	struct ether_addr tmp_mac;
@@ -32,75 +35,86 @@ static void reset_req_pkt_as_resp(struct rte_mbuf *echo_pkt) {
 	uint32_t tmp_ip = ip_hdr->dst_addr;
 	ip_hdr->dst_addr = ip_hdr->src_addr;
 	ip_hdr->src_addr = tmp_ip;
-	ip_hdr->total_length = htons(ntohs(ip_hdr->total_length)+
-			sizeof(gtpu_recovery_ie));
+	ip_hdr->total_length = htons(IPv4_HDR_SIZE + udp_len);
 
-	/* Swap src and dst UDP ports */
+	/* Swap src and dst UDP ports, no UDP checksum as on GTP-U relay */
 	struct udp_hdr *udphdr = get_mtoudp(echo_pkt);
 	uint16_t tmp_port = udphdr->dst_port;
 	udphdr->dst_port = udphdr->src_port;
 	udphdr->src_port = tmp_port;
-	udphdr->dgram_len = htons(ntohs(udphdr->dgram_len)+
-			sizeof(gtpu_recovery_ie));
+	udphdr->dgram_len = htons(udp_len);
+	udphdr->dgram_cksum = 0;
+
+	/* IPv4 checksum by the NIC, or at TX prep */
+	ipv4_cksum_defer(echo_pkt);
 }
-/* Brief: Function to set recovery IE
+
+/* Brief: Function to set recovery IE, in place of any request IE, and
+ * fit the pkt to the response
  * @ Input param: echo_pkt rte_mbuf pointer
  * @ Output param: none
- * Return: void
+ * Return: GTP-U length of the response, -1 on failure
  */
 static int set_recovery(struct rte_mbuf *echo_pkt) {
-	struct ipv4_hdr *ip_hdr = get_mtoip(echo_pkt);
 	struct gtpu_hdr *gtpu_hdr = get_mtogtpu(echo_pkt);
-	gtpu_recovery_ie *recovery_ie = NULL;
-	if (echo_pkt->pkt_len - (ETHER_HDR_LEN +(ip_hdr->total_length))) {
-		recovery_ie = (gtpu_recovery_ie*)((char*)gtpu_hdr+
-				GTPU_HDR_SIZE + ntohs(gtpu_hdr->msglen));
-	} else if ((echo_pkt->pkt_len - (ETHER_HDR_LEN +(ip_hdr->total_length))) == 0) {
-		recovery_ie = (gtpu_recovery_ie *)rte_pktmbuf_append(echo_pkt,
-				(sizeof(gtpu_recovery_ie)));
+	uint16_t off = ETH_HDR_SIZE + IPv4_HDR_SIZE + UDP_HDR_SIZE;
+	uint16_t data_len = rte_pktmbuf_data_len(echo_pkt);
+	gtpu_recovery_ie *recovery_ie;
+	uint16_t opt, len;
+
+	if (data_len < off + GTPU_HDR_SIZE)
+		return -1;
+
+	/* Sequence number, N-PDU number and next extension header type
+	 * are present if any of the S, PN or E flags is set */
+	opt = (gtpu_hdr->seq || gtpu_hdr->pdn || gtpu_hdr->ex) ?
+		sizeof(gtpu_hdr->seqnb) : 0;
+	if (data_len < off + GTPU_HDR_SIZE + opt)
+		return -1;
+	len = GTPU_HDR_SIZE + opt + sizeof(gtpu_recovery_ie);
+
+	/* Request IEs and ether padding are dropped */
+	if (off + len > data_len) {
+		if (rte_pktmbuf_append(echo_pkt, off + len - data_len) == NULL) {
+			RTE_LOG_DP(ERR, DP, "Couldn't append %u bytes to mbuf",
+					off + len - data_len);
+			return -1;
+		}
+	} else {
+		rte_pktmbuf_trim(echo_pkt, data_len - (off + len));
 	}
 
-	if (recovery_ie == NULL) {
-		RTE_LOG_DP(ERR, DP, "Couldn't append %lu bytes to mbuf",
-				sizeof(gtpu_recovery_ie));
-		 return -1;
+	/* No extension header in the response */
+	if (gtpu_hdr->ex) {
+		gtpu_hdr->ex = 0;
+		((uint8_t *)gtpu_hdr)[GTPU_HDR_SIZE + opt - 1] = 0;
 	}
 
+	recovery_ie = (gtpu_recovery_ie *)((uint8_t *)gtpu_hdr +
+			GTPU_HDR_SIZE + opt);
 	gtpu_hdr->msgtype = GTPU_ECHO_RESPONSE;
-	gtpu_hdr->msglen = htons(ntohs(gtpu_hdr->msglen)+
-		sizeof(gtpu_recovery_ie));
+	gtpu_hdr->msglen = htons(opt + sizeof(gtpu_recovery_ie));
 	recovery_ie->type = GTPU_ECHO_RECOVERY;
 	recovery_ie->restart_cntr = 0;
-	return 0;
+	return len;
 }
 
-/* Brief: Function to set checksum of IPv4 and UDP header
+/* Brief: Function to process GTP-U echo request, in place
  * @ Input param: echo_pkt rte_mbuf pointer
  * @ Output param: none
- * Return: void
+ * Return: 0 on success, -1 on failure
  */
-static void set_checksum(struct rte_mbuf *echo_pkt) {
-	struct ipv4_hdr *ipv4hdr = get_mtoip(echo_pkt);
-	ipv4hdr->hdr_checksum = 0;
-	struct udp_hdr *udphdr = get_mtoudp(echo_pkt);
-	udphdr->dgram_cksum = 0;
-	udphdr->dgram_cksum = rte_ipv4_udptcp_cksum(ipv4hdr, udphdr);
-	ipv4hdr->hdr_checksum = rte_ipv4_cksum(ipv4hdr);
-}
+int process_echo_request(struct rte_mbuf *echo_pkt) {
+	int len;
 
-/* Brief: Function to process GTP-U echo request
- * @ Input param: echo_pkt rte_mbuf pointer
- * @ Output param: none
- * Return: void
- */
-void process_echo_request(struct rte_mbuf *echo_pkt) {
-	int ret;
-	ret = set_recovery(echo_pkt);
-	if (ret < 0) {
-		fprintf(stderr, "Failed to create echo response..\n");
-		return;
-	}
+	if (!rte_pktmbuf_is_contiguous(echo_pkt) ||
+			get_mtoip(echo_pkt)->version_ihl != 0x45)
+		return -1;
 
-	reset_req_pkt_as_resp(echo_pkt);
-	set_checksum(echo_pkt);
+	len = set_recovery(echo_pkt);
+	if (len < 0)
+		return -1;
+
+	reset_req_pkt_as_resp(echo_pkt, UDP_HDR_SIZE + len);
+	return 0;
 }
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_prefetch.h>
+
+#include "hash_bulk.h"
+
+int
+dp_hash_lookup_bulk(const struct rte_hash *h, const void **key, uint32_t n,
+		uint64_t *hit_mask, void **data)
+{
+	uint64_t hits;
+	int ret;
+
+	if (n == 0) {
+		*hit_mask = 0;
+		return 0;
+	}
+
+	ret = rte_hash_lookup_bulk_data(h, key, n, hit_mask, data);
+	if (ret <= 0)
+		return ret;
+
+	hits = *hit_mask;
+	while (hits) {
+		rte_prefetch0(data[__builtin_ctzll(hits)]);
+		hits &= hits - 1;
+	}
+
+	return ret;
+}
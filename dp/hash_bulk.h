@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _HASH_BULK_H_
+#define _HASH_BULK_H_
+/**
+ * @file
+ * Burst lookup of DP hash tables. All DP tables hash with CRC32
+ * (DEFAULT_HASH_FUNC), which is the SSE4.2 crc32 instruction where the
+ * CPU has it. A burst is looked up in stages, each stage issued for the
+ * whole burst before the next one starts:
+ *	1. signatures of all keys,
+ *	2. prefetch of primary and secondary buckets,
+ *	3. signature compare and prefetch of the matching key slots,
+ *	4. key compare,
+ *	5. prefetch of the data of each hit.
+ * Stages 1 to 4 are rte_hash_lookup_bulk_data; stage 5 gets the first
+ * line of each session, ADC or ARP entry in flight before the caller
+ * touches it.
+ */
+#include <stdint.h>
+
+#include <rte_hash.h>
+
+/**
+ * Look up a burst of keys.
+ * @param h
+ *	hash table.
+ * @param key
+ *	keys.
+ * @param n
+ *	number of keys, at most 64.
+ * @param hit_mask
+ *	bit set for each key found.
+ * @param data
+ *	data of keys found.
+ * @return
+ *	\- number of keys found
+ *	\- -EINVAL on invalid parameters
+ */
+int
+dp_hash_lookup_bulk(const struct rte_hash *h, const void **key, uint32_t n,
+		uint64_t *hit_mask, void **data);
+
+#endif /* _HASH_BULK_H_ */
@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <rte_lcore.h>
 #include <rte_per_lcore.h>
@@ -25,11 +26,11 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
-#include <unistd.h>
-#ifdef FRAG
 #include <rte_cycles.h>
-#endif /* FRAG */
+#include <unistd.h>
 #include "main.h"
+#include "ipv4.h"
+#include "excp_handler.h"
 
 #ifdef FRAG
 /**
@@ -56,14 +57,10 @@ struct rte_mempool *sgi_indirect_pktmbuf_pool = NULL;
 /* memory pool for userplane pkts */
 struct rte_mempool *user_ulmp;
 struct rte_mempool *user_dlmp;
-/* memory pool for KNI pkts */
-struct rte_mempool *kni_ulmp;
-struct rte_mempool *kni_dlmp;
-/* memory pool for mngt pkts */
-struct rte_mempool *mngt_ulmp;
-struct rte_mempool *mngt_dlmp;
-
-struct kni_port_params *kni_port_params_array[RTE_MAX_ETHPORTS];
+/* memory pool for pkts sent by the kernel exception path */
+struct rte_mempool *excp_ulmp;
+struct rte_mempool *excp_dlmp;
+
 extern struct rte_ring *cdr_ring;
 
 #ifdef DP_DDN
@@ -73,24 +70,6 @@ struct rte_ring *notify_ring = NULL;
 struct rte_mempool *notify_msg_pool = NULL;
 #endif /* DP_DDN */
 
-/* VS: Route table Discovery */
-/**
- * Routing table hash params.
- */
-static struct rte_hash_parameters route_hash_params = {
-	.name = "ROUTE_TABLE",
-	.entries = 64*64,
-	.reserved = 0,
-	.key_len = sizeof(uint32_t),
-	.hash_func = rte_jhash,
-	.hash_func_init_val = 0,
-};
-
-/**
- * Route rte hash handler.
- */
-struct rte_hash *route_hash_handle;
-
 uint32_t nb_ports = 0 ;
 
 /**
@@ -124,9 +103,12 @@ const struct rte_eth_conf port_conf_default = {
 static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 {
 	struct rte_eth_dev_info dev_info;
-	struct rte_eth_txconf *txconf;
+	struct rte_eth_txconf txconf;
 	struct rte_eth_conf port_conf = port_conf_default;
-	const uint16_t rx_rings = 1, tx_rings = 1;  //tx_rings = rte_lcore_count() - 1;
+	/* One RX/TX queue pair per UL/DL worker, plus the EPC_CTRL_TXQ
+	 * TX queue of the ARP resolver and an EPC_ECHO_TXQ per UL worker */
+	const uint16_t rx_rings = epc_app.nb_workers;
+	const uint16_t tx_rings = 2 * epc_app.nb_workers + 1;
 	int retval;
 	uint16_t q;
 
@@ -134,6 +116,39 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	if (port >= rte_eth_dev_count())
 		return -1;
 
+	rte_eth_dev_info_get(port, &dev_info);
+
+	/* IPv4 checksum of encap and rewritten headers: by the NIC if it
+	 * can, else in SW over the TX burst (ipv4_cksum_tx_prep) */
+#if (RTE_VER_YEAR >= 18) && (RTE_VER_MONTH >= 02)
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_IPV4_CKSUM)
+		port_conf.txmode.offloads |= DEV_TX_OFFLOAD_IPV4_CKSUM;
+	ipv4_cksum_offload[port] =
+		(port_conf.txmode.offloads & DEV_TX_OFFLOAD_IPV4_CKSUM) != 0;
+#else
+	/* 16.11: no port offloads, enabled per TX queue by txq_flags */
+	ipv4_cksum_offload[port] =
+		(dev_info.tx_offload_capa & DEV_TX_OFFLOAD_IPV4_CKSUM) != 0;
+#endif /* (RTE_VER_YEAR >= 18) && (RTE_VER_MONTH >= 02) */
+	printf("Port %u: IPv4 TX checksum %s\n", port,
+			ipv4_cksum_offload[port] ? "offload" : "in SW");
+
+	/* Spread flows over the worker queues:
+	 * S1U: outer IPv4 + UDP ports, i.e. per eNB GTP-U tunnel endpoint
+	 * SGi: IPv4/L4 tuple, i.e. each UE flow sticks to one worker */
+	if (rx_rings > 1) {
+		port_conf.rxmode.mq_mode = ETH_MQ_RX_RSS;
+		port_conf.rx_adv_conf.rss_conf.rss_key = NULL;
+		port_conf.rx_adv_conf.rss_conf.rss_hf = (port == S1U_PORT_ID) ?
+			(ETH_RSS_IPV4 | ETH_RSS_NONFRAG_IPV4_UDP) :
+			(ETH_RSS_IP | ETH_RSS_UDP | ETH_RSS_TCP);
+		port_conf.rx_adv_conf.rss_conf.rss_hf &=
+			dev_info.flow_type_rss_offloads;
+		if (port_conf.rx_adv_conf.rss_conf.rss_hf == 0)
+			rte_exit(EXIT_FAILURE, "Port %u: no RSS support for %u "
+					"workers\n", port, rx_rings);
+	}
+
 	/* Configure the Ethernet device. */
 	retval = rte_eth_dev_configure(port, rx_rings, tx_rings, &port_conf);
 	if (retval != 0)
@@ -149,18 +164,26 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	}
 
 
+	/* Default txconf, with the port offloads */
+	txconf = dev_info.default_txconf;
+#if (RTE_VER_YEAR >= 18) && (RTE_VER_MONTH >= 02)
+	txconf.txq_flags = ETH_TXQ_FLAGS_IGNORE;
+	txconf.offloads = port_conf.txmode.offloads;
+#else
+	/* Default flags may pick a TX path without checksum offload */
+	if (ipv4_cksum_offload[port])
+		txconf.txq_flags &= ~ETH_TXQ_FLAGS_NOXSUMS;
+#endif /* (RTE_VER_YEAR >= 18) && (RTE_VER_MONTH >= 02) */
+
 	/* Allocate and set up TX queue per Ethernet port. */
 	for (q = 0; q < tx_rings; q++) {
-		/* Get Default txconf */
 		retval = rte_eth_tx_queue_setup(port, q, TX_NUM_DESC,
 				rte_eth_dev_socket_id(port),
-				NULL);
-		rte_eth_dev_info_get(port, &dev_info);
-		txconf = &dev_info.default_txconf;
+				&txconf);
 		printf("ASR- Probe::%s::"
 				"\n\tdefault tx_conf->tx_free_thresh= %u;"
 				"\n\tNUM_MBUFS= %u; Set tx_conf->tx_free_thresh=default tx_conf= %u\n",
-				__func__, txconf->tx_free_thresh, NUM_MBUFS, txconf->tx_free_thresh);
+				__func__, txconf.tx_free_thresh, NUM_MBUFS, txconf.tx_free_thresh);
 		/* ASR- Probe: Option to vary tx_free_thresh to modulate rte_eth_tx_burst()
 		 * freeing memory buffers of packets sent */
 //		txconf->tx_free_thresh = (NUM_MBUFS)/4;
@@ -195,9 +218,81 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	return 0;
 }
 
+int
+validate_parameters(uint32_t portmask)
+{
+	uint32_t i;
+
+	if (!portmask) {
+		printf("No port configured in port mask\n");
+		return -1;
+	}
+
+	for (i = 0; i < 32; i++) {
+		if (((portmask & (1 << i)) && i >= nb_ports) ||
+			(!(portmask & (1 << i)) && i < nb_ports))
+			rte_exit(EXIT_FAILURE, "portmask is not consistent "
+				"to port ids specified %u\n", portmask);
+	}
+
+	return 0;
+}
+
+/* Check the link status of all ports in up to 9s, and print them finally */
+void check_all_ports_link_status(uint16_t port_num, uint32_t port_mask) {
+#define CHECK_INTERVAL 10 /* 100ms */
+#define MAX_CHECK_TIME 9 /* 9s (90 * 100ms) in total */
+	uint16_t portid;
+	uint8_t count, all_ports_up, print_flag = 0;
+	struct rte_eth_link link;
+
+	printf("\nChecking link status\n");
+	fflush(stdout);
+	for (count = 0; count <= MAX_CHECK_TIME; count++) {
+		all_ports_up = 1;
+		for (portid = 0; portid < port_num; portid++) {
+			if ((port_mask & (1 << portid)) == 0)
+				continue;
+			memset(&link, 0, sizeof(link));
+			rte_eth_link_get_nowait(portid, &link);
+			/* print link status if flag set */
+			if (print_flag == 1) {
+				if (link.link_status)
+					printf(
+					"Port%d Link Up - speed %uMbps - %s\n",
+						portid, link.link_speed,
+				(link.link_duplex == ETH_LINK_FULL_DUPLEX) ?
+					("full-duplex") : ("half-duplex\n"));
+				else
+					printf("Port %d Link Down\n", portid);
+				continue;
+			}
+			/* clear all_ports_up flag if any link down */
+			if (link.link_status == ETH_LINK_DOWN) {
+				all_ports_up = 0;
+				break;
+			}
+		}
+		/* after finally printing all link status, get out */
+		if (print_flag == 1)
+			break;
+
+		if (all_ports_up == 0) {
+			printf(".");
+			fflush(stdout);
+			rte_delay_ms(CHECK_INTERVAL);
+		}
+
+		/* set the print_flag if all ports up or timeout */
+		if (all_ports_up == 1 || count == (MAX_CHECK_TIME - 1)) {
+			print_flag = 1;
+			printf("done\n");
+		}
+	}
+}
+
 void dp_port_init(void)
 {
-	uint8_t port_id;
 #ifdef FRAG
 	uint64_t frag_cycles;
 	int rxlcore_id;
@@ -207,7 +302,6 @@ void dp_port_init(void)
 		S1U_PORT = 0,
 		SGI_PORT = 1
 	};
-	int i = 0, j; //GCC_Security flag
 
 	nb_ports = rte_eth_dev_count();
 	printf ("nb_ports cnt is %u\n", nb_ports);
@@ -215,7 +309,8 @@ void dp_port_init(void)
 		rte_exit(EXIT_FAILURE, "Error: number of ports must be two\n");
 
 	/* Create user UL mempool to hold the mbufs. */
-	user_ulmp = rte_pktmbuf_pool_create("user_ulmp", NUM_MBUFS,
+	user_ulmp = rte_pktmbuf_pool_create("user_ulmp",
+			(NUM_MBUFS) * epc_app.nb_workers,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
@@ -223,44 +318,29 @@ void dp_port_init(void)
 		rte_exit(EXIT_FAILURE, "Cannot create user_ulmp !!!\n");
 
 	/* Create user DL mempool to hold the mbufs. */
-	user_dlmp = rte_pktmbuf_pool_create("user_dlmp", NUM_MBUFS,
+	user_dlmp = rte_pktmbuf_pool_create("user_dlmp",
+			(NUM_MBUFS) * epc_app.nb_workers,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
 	if (user_dlmp == NULL)
 		rte_exit(EXIT_FAILURE, "Cannot create user_dlmp !!!\n");
 
-	/* Create UL management mempool */
-	mngt_ulmp = rte_pktmbuf_pool_create("mngt_ulmp", NUM_MBUFS,
-			MBUF_CACHE_SIZE, 0,
-			RTE_MBUF_DEFAULT_BUF_SIZE,
-			rte_socket_id());
-	if (mngt_ulmp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannot create mngt_ulmp !!!\n");
-
-	/* Create DL management mempool */
-	mngt_dlmp = rte_pktmbuf_pool_create("mngt_dlmp", NUM_MBUFS,
-				MBUF_CACHE_SIZE, 0,
-				RTE_MBUF_DEFAULT_BUF_SIZE,
-				rte_socket_id());
-	if (mngt_dlmp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannot create mngt_dlmp !!!\n");
-
-	/* Create KNI UL mempool to hold the kni pkts mbufs. */
-	kni_ulmp = rte_pktmbuf_pool_create("kni_ulmp", NUM_MBUFS,
+	/* Create exception path UL mempool to hold the kernel pkts mbufs. */
+	excp_ulmp = rte_pktmbuf_pool_create("excp_ulmp", NUM_MBUFS,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
-	if (kni_ulmp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannot create kni_ulmp !!!\n");
+	if (excp_ulmp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create excp_ulmp !!!\n");
 
-	/* Create KNI DL mempool to hold the kni pkts mbufs. */
-	kni_dlmp = rte_pktmbuf_pool_create("kni_dlmp", NUM_MBUFS,
+	/* Create exception path DL mempool to hold the kernel pkts mbufs. */
+	excp_dlmp = rte_pktmbuf_pool_create("excp_dlmp", NUM_MBUFS,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
-	if (kni_dlmp == NULL)
-		rte_exit(EXIT_FAILURE, "Cannot create kni_dlmp !!!\n");
+	if (excp_dlmp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create excp_dlmp !!!\n");
 
 #ifdef FRAG
 	rxlcore_id = rte_lcore_id();
@@ -287,77 +367,33 @@ void dp_port_init(void)
 		rte_exit(EXIT_FAILURE, "Cannot create sgi_indirect_mbuf_pool !!!\n");
 #endif /* FRAG */
 
-	/* Initialize KNI interface on s1u and sgi port */
-	/* Check if the configured port ID is valid */
-	for (port_id = 0; port_id < nb_ports; port_id++) {
-		if (kni_port_params_array[port_id] && port_id >= nb_ports)
-			rte_exit(EXIT_FAILURE, "Configured invalid "
-					"port ID %u\n", port_id);
-		kni_port_params_array[port_id] =
-			rte_zmalloc("KNI_port_params",
-					sizeof(struct kni_port_params), RTE_CACHE_LINE_SIZE);
-
-		kni_port_params_array[port_id]->port_id = port_id;
-
-		if (port_id == 0) {
-			kni_port_params_array[port_id]->lcore_rx =
-				(uint8_t)epc_app.core_ul[S1U_PORT_ID];
-			kni_port_params_array[port_id]->lcore_tx = (uint8_t)epc_app.core_mct;
-			printf("KNI lcore on port :%u rx :%u tx :%u\n", port_id,
-					kni_port_params_array[port_id]->lcore_rx,
-					kni_port_params_array[port_id]->lcore_tx);
-		} else if (port_id == 1) {
-			kni_port_params_array[port_id]->lcore_rx =
-				(uint8_t)epc_app.core_dl[SGI_PORT_ID];
-			kni_port_params_array[port_id]->lcore_tx = (uint8_t)epc_app.core_mct;
-			printf("KNI lcore on port :%u rx :%u tx :%u\n", port_id,
-					kni_port_params_array[port_id]->lcore_rx,
-					kni_port_params_array[port_id]->lcore_tx);
-		}
-
-		for (j = 0; i < 3 && j < KNI_MAX_KTHREAD; i++, j++) {
-			kni_port_params_array[port_id]->lcore_k[j] = 0;
-		}
-		kni_port_params_array[port_id]->nb_lcore_k = 0;
-
-	}
-
 	/* Check that options were parsed ok */
 	if (validate_parameters(app.ports_mask) < 0) {
 		rte_exit(EXIT_FAILURE, "Invalid portmask\n");
 	}
 
-	/* Initialize KNI subsystem */
-	init_kni();
-
-	/* Initialize & Alloc:: KNI S1U & SGi ports */
+	/* Initialize S1U & SGi ports, and their kernel interfaces */
 	if (port_init(S1U_PORT, user_ulmp) != 0)
 		rte_exit(EXIT_FAILURE, "Cannot init s1u port %" PRIu8 "\n",
 				S1U_PORT);
-	kni_alloc(S1U_PORT);
+	if (excp_init(S1U_PORT, excp_ulmp) != 0)
+		rte_exit(EXIT_FAILURE, "Cannot init s1u exception path\n");
 	if (port_init(SGI_PORT, user_dlmp) != 0)
 		rte_exit(EXIT_FAILURE, "Cannot init s1u port %" PRIu8 "\n",
 				SGI_PORT);
-	kni_alloc(SGI_PORT);
+	if (excp_init(SGI_PORT, excp_dlmp) != 0)
+		rte_exit(EXIT_FAILURE, "Cannot init sgi exception path\n");
 
-	/* CDR Ring creation */
+	/* CDR Ring creation: UL and DL workers enqueue, iface core dequeues */
 	cdr_ring = rte_ring_create("CDR_RING", CDR_RING_SIZE,
 			rte_socket_id(),
-			RING_F_SP_ENQ | RING_F_SC_DEQ);
+			RING_F_SC_DEQ);
 
 	if (cdr_ring == NULL) {
 		rte_exit(EXIT_FAILURE, "Error in creating cdr ring!!!\n");
 	}
-	/* Routing Discovery : Create route hash for s1u and sgi port */
-	route_hash_params.socket_id = rte_socket_id();
-	route_hash_handle = rte_hash_create(&route_hash_params);
-	if (!route_hash_handle)
-		rte_panic("%s hash create failed: %s (%u)\n.",
-				route_hash_params.name, rte_strerror(rte_errno),
-				rte_errno);
-
 	check_all_ports_link_status(nb_ports, app.ports_mask);
-	printf("KNI: DP Port Mask:%u\n", app.ports_mask);
+	printf("DP Port Mask:%u\n", app.ports_mask);
 	printf("DP Port initialization completed.\n");
 }
 
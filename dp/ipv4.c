@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#include <rte_vect.h>
+
 #include "ipv4.h"
 
+uint8_t ipv4_cksum_offload[RTE_MAX_ETHPORTS];
+
 /**
  * Function to update ipv4 ckcum.
  *
@@ -45,3 +49,87 @@ construct_ipv4_hdr(struct rte_mbuf *m, uint16_t len, uint8_t protocol,
 
 	update_ckcum(m);
 }
+
+#ifdef __SSSE3__
+/**
+ * Sum the 16 bit words of a 20B IPv4 header into 4 32 bit lanes.
+ */
+static inline __m128i
+ipv4_cksum_lanes(const struct ipv4_hdr *ip)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v, t;
+
+	v = _mm_loadu_si128((const __m128i *)ip);
+	t = _mm_cvtsi32_si128(*((const int32_t *)ip + 4));
+
+	return _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(v, zero),
+				_mm_unpackhi_epi16(v, zero)),
+			_mm_unpacklo_epi16(t, zero));
+}
+
+/**
+ * Checksums of 4 headers, one per 32 bit lane.
+ */
+static inline void
+ipv4_cksum_x4(struct ipv4_hdr **ip)
+{
+	const __m128i mask = _mm_set1_epi32(0xffff);
+	__m128i s, eq;
+	uint32_t ck[4];
+	uint32_t i;
+
+	s = _mm_hadd_epi32(
+			_mm_hadd_epi32(ipv4_cksum_lanes(ip[0]),
+				ipv4_cksum_lanes(ip[1])),
+			_mm_hadd_epi32(ipv4_cksum_lanes(ip[2]),
+				ipv4_cksum_lanes(ip[3])));
+
+	/* Fold twice: 10 words sum to less than 2^20 */
+	s = _mm_add_epi32(_mm_and_si128(s, mask), _mm_srli_epi32(s, 16));
+	s = _mm_add_epi32(_mm_and_si128(s, mask), _mm_srli_epi32(s, 16));
+
+	/* Complement, but for a sum of 0xffff (as rte_ipv4_cksum) */
+	eq = _mm_cmpeq_epi32(s, mask);
+	s = _mm_xor_si128(s, _mm_andnot_si128(eq, mask));
+
+	_mm_storeu_si128((__m128i *)ck, s);
+	for (i = 0; i < 4; i++)
+		ip[i]->hdr_checksum = (uint16_t)ck[i];
+}
+#endif /* __SSSE3__ */
+
+void
+ipv4_cksum_bulk(struct ipv4_hdr **ip, uint32_t n)
+{
+	uint32_t i = 0;
+
+#ifdef __SSSE3__
+	for (; i + 4 <= n; i += 4)
+		ipv4_cksum_x4(&ip[i]);
+#endif /* __SSSE3__ */
+
+	for (; i < n; i++)
+		ip[i]->hdr_checksum = rte_ipv4_cksum(ip[i]);
+}
+
+void
+ipv4_cksum_tx_prep(struct rte_mbuf **pkts, uint32_t n,
+		uint64_t pkts_mask, uint8_t portid)
+{
+	struct ipv4_hdr *ip[MAX_BURST_SZ];
+	uint32_t i, cnt = 0;
+
+	if (ipv4_cksum_offload[portid])
+		return;
+
+	for (i = 0; i < n; i++) {
+		if (!ISSET_BIT(pkts_mask, i) ||
+				!(pkts[i]->ol_flags & PKT_TX_IP_CKSUM))
+			continue;
+		pkts[i]->ol_flags &= ~(PKT_TX_IPV4 | PKT_TX_IP_CKSUM);
+		ip[cnt++] = get_mtoip(pkts[i]);
+	}
+
+	ipv4_cksum_bulk(ip, cnt);
+}
@@ -47,6 +47,56 @@ static inline struct ipv4_hdr *get_mtoip(struct rte_mbuf *m)
 
 }
 
+/**
+ * Ports the PMD computes the IPv4 header checksum of TX pkts on.
+ */
+extern uint8_t ipv4_cksum_offload[RTE_MAX_ETHPORTS];
+
+/**
+ * Leave the IPv4 header checksum of a pkt to TX: the NIC if the egress
+ * port offloads it, else ipv4_cksum_tx_prep(). The header must be 20B.
+ *
+ * @param m
+ *	mbuf pointer
+ *
+ * @return
+ *	None
+ */
+static inline void ipv4_cksum_defer(struct rte_mbuf *m)
+{
+	get_mtoip(m)->hdr_checksum = 0;
+	m->l2_len = ETH_HDR_SIZE;
+	m->l3_len = IPv4_HDR_SIZE;
+	m->ol_flags |= PKT_TX_IPV4 | PKT_TX_IP_CKSUM;
+}
+
+/**
+ * Function to update an IPv4 header checksum for a rewritten 32 bit
+ * field, per RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m').
+ *
+ * @param cksum
+ *	header checksum, as in the header
+ * @param old_val
+ *	old field value, network order
+ * @param new_val
+ *	new field value, network order
+ *
+ * @return
+ *	updated header checksum
+ */
+static inline uint16_t
+ipv4_cksum_adjust32(uint16_t cksum, uint32_t old_val, uint32_t new_val)
+{
+	uint32_t sum = (uint16_t)~cksum;
+
+	sum += (uint16_t)~old_val + (uint16_t)~(old_val >> 16);
+	sum += (new_val & 0xffff) + (new_val >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)~sum;
+}
+
 #ifdef FRAG
 static __thread uint16_t frag_id = 0x1513;
 #endif /* FRAG */
@@ -138,4 +188,38 @@ construct_ipv4_hdr(struct rte_mbuf *m, uint16_t len, uint8_t protocol,
  *	mbuf pointer
  */
 void update_ckcum(struct rte_mbuf *m);
+
+/**
+ * Function to calculate the checksum of IPv4 headers in bulk, equal to
+ * rte_ipv4_cksum() of each. Vectorized over 4 headers at a time when
+ * built with SSSE3.
+ *
+ * @param ip
+ *	20B IPv4 headers, checksum field 0
+ * @param n
+ *	number of headers
+ *
+ * @return
+ *	None
+ */
+void ipv4_cksum_bulk(struct ipv4_hdr **ip, uint32_t n);
+
+/**
+ * Function to complete the checksums left by ipv4_cksum_defer() before
+ * TX on a port without checksum offload. No-op on offloading ports.
+ *
+ * @param pkts
+ *	mbuf pointers
+ * @param n
+ *	number of pkts
+ * @param pkts_mask
+ *	bit mask of pkts to TX
+ * @param portid
+ *	egress port
+ *
+ * @return
+ *	None
+ */
+void ipv4_cksum_tx_prep(struct rte_mbuf **pkts, uint32_t n,
+		uint64_t pkts_mask, uint8_t portid);
 #endif				/* _IPV4_H_ */
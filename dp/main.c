@@ -26,6 +26,10 @@
 #include <rte_branch_prediction.h>
 
 #include "main.h"
+#if defined(FILE_CDR) || defined(SDF_MTR) || defined(APN_MTR)
+#include "cdr.h"
+#include "session_cdr.h"
+#endif /* FILE_CDR || SDF_MTR || APN_MTR */
 
 struct rte_ring *cdr_ring;
 
@@ -35,16 +39,10 @@ struct rte_ring *cdr_ring;
 int main(int argc, char **argv)
 {
 	int ret;
-	sigset_t mask;
 
 	/* ASR- Initialize global vars */
 	cdr_ring = NULL;
 
-	sigemptyset(&mask);
-	sigaddset(&mask, SIGRTMIN);
-	if (sigprocmask(SIG_SETMASK, &mask, NULL) == -1)
-		RTE_LOG_DP(ERR, DP, "sigprocmask error\n");
-
 	/* Initialize the Environment Abstraction Layer */
 	ret = rte_eal_init(argc, argv);
 	if (ret < 0)
@@ -64,7 +62,6 @@ int main(int argc, char **argv)
 	if (app.log_level == DEBUG) {
 		/*Enable DEBUG log level*/
 		rte_log_set_level(RTE_LOGTYPE_DP, RTE_LOG_DEBUG);
-		rte_log_set_level(RTE_LOGTYPE_KNI, RTE_LOG_DEBUG);
 		rte_log_set_level(RTE_LOGTYPE_API, RTE_LOG_DEBUG);
 		rte_log_set_level(RTE_LOGTYPE_EPC, RTE_LOG_DEBUG);
 		RTE_LOG_DP(DEBUG, DP, "LOG_LEVEL=LOG_DEBUG::"
@@ -88,6 +85,12 @@ int main(int argc, char **argv)
 	/* Initialize DP PORTS and membufs */
 	dp_port_init();
 
+#if defined(FILE_CDR) || defined(SDF_MTR) || defined(APN_MTR)
+	/* Start the CDR writer: rule, session and meter drop CDR files */
+	cdr_init();
+	sess_cdr_init();
+#endif /* FILE_CDR || SDF_MTR || APN_MTR */
+
 #ifdef DP_DDN
 	/* Init Downlink data notification ring, container and mempool  */
 	dp_ddn_init();
@@ -33,6 +33,7 @@
 #include <rte_malloc.h>
 #include <rte_meter.h>
 #include <rte_jhash.h>
+#include <rte_hash_crc.h>
 #include <rte_version.h>
 #ifdef FRAG
 /* for ip defragging */
@@ -188,6 +189,28 @@
 /* Assume MAX Flows (Sessions) provisioned on DP = 50K */
 #define MAX_SESSIONS		50000
 
+/* Bearer sessions provisioned by default, --max_sessions overrides:
+ * two bearers for each of MAX_SESSIONS UEs */
+#define DEFAULT_MAX_SESSIONS	(2 * MAX_SESSIONS)
+
+/* Upper bound of --max_sessions */
+#define MAX_SESSIONS_LIMIT	(16 * 1024 * 1024)
+
+/* ARP timers by default, in seconds: --arp_max_age, --arp_refresh and
+ * --arp_neg_hold override */
+#define DEFAULT_ARP_MAX_AGE	300
+#define DEFAULT_ARP_REFRESH	120
+#define DEFAULT_ARP_NEG_HOLD	10
+
+/* Exception path by default: --excp_path and --excp_poll_us override.
+ * STATIC_ARP builds do not hand pkts to the kernel. */
+#ifdef STATIC_ARP
+#define DEFAULT_EXCP_PATH	EXCP_PATH_NONE
+#else
+#define DEFAULT_EXCP_PATH	EXCP_PATH_TAP
+#endif /* STATIC_ARP */
+#define DEFAULT_EXCP_POLL_US	100
+
 #ifdef FRAG
 /**
  * for setting log level
@@ -222,7 +245,8 @@ extern struct rte_mempool *sgi_indirect_pktmbuf_pool;
  * TODO: Cleaner way.
  */
 #define dp_pcc_rules pcc_rules
-#define DEFAULT_HASH_FUNC rte_jhash
+/* CRC32, hardware crc32 instruction where available */
+#define DEFAULT_HASH_FUNC rte_hash_crc
 
 /**
  * Reserved ADC ruleids installed by DP during init.
@@ -309,74 +333,25 @@ extern struct rte_mempool *sgi_indirect_pktmbuf_pool;
 /* Macro to specify size of CDR RING */
 #define CDR_RING_SIZE 8192
 
+/* Worker charged bytes between two volume threshold checks, as a
+ * fraction of vol_trshld split over all UL/DL shards of a session.
+ * Bounds the threshold overshoot to vol_trshld / CDR_VOL_CHECK_DIV. */
+#define CDR_VOL_CHECK_DIV 4
+
 /* ****************************************************************************
- * ****    KNI: Defines, Data Structures and functions    ****
+ * ****    Exception path: Defines and functions    ****
  * ****************************************************************************
  **/
-/* TODO: KNI releted parameters and struct define here */
-
-/* Max size of a single packet */
-#define MAX_PACKET_SZ           2048
-
-/* Total octets in ethernet header */
-#define KNI_ENET_HEADER_SIZE    14
-
-/* Total octets in the FCS */
-#define KNI_ENET_FCS_SIZE       4
-
-#define KNI_SECOND_PER_DAY      86400
-
-#define KNI_MAX_KTHREAD 32
+/** Kernel exception path backend, --excp_path */
+#define EXCP_PATH_NONE		0	/**< no kernel interfaces */
+#define EXCP_PATH_TAP		1	/**< TAP PMD (net_tap) */
+#define EXCP_PATH_VIRTIO_USER	2	/**< virtio-user PMD on vhost-net */
 
 /* UDP socket port configure */
 #define SOCKET_PORT 5556
 
-/* Ring Size */
-#define RXTX_RING_SIZE 512
-/**
- * Structure of port parameters
- */
-struct kni_port_params {
-	uint8_t port_id;/* Port ID */
-	unsigned lcore_rx; /* lcore ID for RX */
-	unsigned lcore_tx; /* lcore ID for TX */
-	uint32_t nb_lcore_k; /* Number of lcores for KNI multi kernel threads */
-	uint32_t nb_kni; /* Number of KNI devices to be created */
-	unsigned lcore_k[KNI_MAX_KTHREAD]; /* lcore ID list for kthreads */
-	struct rte_kni *kni[KNI_MAX_KTHREAD]; /* KNI context pointers */
-} __rte_cache_aligned;
-
 extern uint32_t nb_ports;
 
-extern struct kni_port_params *kni_port_params_array[RTE_MAX_ETHPORTS];
-
-/**
- * Interface to burst rx and enqueue mbufs into rx_q
- */
-void
-kni_ingress(struct kni_port_params *p, uint16_t port_id,
-		struct rte_mbuf *pkts_burst[PKT_BURST_SZ], unsigned nb_rx);
-
-/**
- * Receive burst from kni interface
- */
-unsigned
-kni_egress(struct kni_port_params *p, struct rte_mbuf **kni_rxburst);
-
-/**
- * free mbufs after trasmited resp back on port.
- */
-void
-kni_burst_free_mbufs(struct rte_mbuf **pkts, unsigned num);
-
-/* Initialize KNI subsystem */
-void
-init_kni(void);
-
-/* KNI interface allocatation */
-int
-kni_alloc(uint16_t port_id);
-
 /* Check the link status of all ports in up to 9s, and print them finally */
 void
 check_all_ports_link_status(uint16_t port_num, uint32_t port_mask);
@@ -385,15 +360,6 @@ check_all_ports_link_status(uint16_t port_num, uint32_t port_mask);
 int
 validate_parameters(uint32_t portmask);
 
-/* Free KNI allocation interface on ports */
-void free_kni_ports(void);
-
-//VS: Routing Discovery
-/**
- * rte hash handler.
- */
-extern struct rte_hash *route_hash_handle;
-
 /* ****************************************************************************
  * ****    NGIC Dataplane Application Data Structures    ****
  * ****************************************************************************
@@ -447,7 +413,25 @@ struct app_params {
 	uint32_t gtpu_seqnb_out;		/* outgoing GTP sequence number
 						 * 0 - do not include (default)
 						 * 1 - include */
+	uint32_t gtpu_sport;			/* outgoing GTP UDP source port
+						 * 0 - UDP_PORT_GTPU (default)
+						 * 1 - hash of bearer TEID
+						 * 2 - hash of inner 5-tuple */
 	uint32_t ports_mask;
+	uint32_t max_sessions;			/* max. bearer sessions, sizes
+						 * the session tables */
+	uint32_t arp_max_age;			/* seconds an unconfirmed ARP
+						 * entry is kept, 0 - no aging */
+	uint32_t arp_refresh;			/* seconds before an ARP entry
+						 * is probed, 0 - no probes */
+	uint32_t arp_neg_hold;			/* seconds an unresolved next
+						 * hop is not probed again */
+	uint32_t excp_path;			/* kernel exception path
+						 * 0 - none
+						 * 1 - TAP (default)
+						 * 2 - virtio-user */
+	uint32_t excp_poll_us;			/* usecs between two polls of
+						 * the kernel interfaces */
 	char ul_iface_name[MAX_LEN];
 	char dl_iface_name[MAX_LEN];
 	enum dp_config spgw_cfg;
@@ -503,8 +487,163 @@ struct dp_adc_rules {
 	uint16_t mtr_profile_index;             /* index 0 to skip */
 } __attribute__((packed, aligned(RTE_CACHE_LINE_SIZE)));
 
+struct ats_timer;
+
 /**
- * Bearer Session information structure
+ * Per worker bearer charging counters of one session slot.
+ * Written by the owning UL or DL worker only, folded into the
+ * session CDR when the CDR is read.
+ */
+struct cdr_shard {
+	struct cdr cdr;			/**< charged pkts/bytes */
+	struct cdr drop;		/**< dropped pkts/bytes */
+	uint64_t vol_unchecked;		/**< charged bytes since last
+					 * volume threshold check */
+};
+
+/**
+ * Counters of one worker for an ADC, SDF or rating group CDR. RSS
+ * spreads the flows of a UE over workers, so each worker counts in its
+ * own shard; readers fold the shards into the CDR data_vol.
+ */
+struct cdr_vol_shard {
+	struct cdr cdr;			/**< charged pkts/bytes */
+	struct cdr drop;		/**< dropped pkts/bytes */
+};
+
+/**
+ * Owners of ADC, SDF and rating group counter shards. Each owner record
+ * takes a vol slot of its type, indexing cdr_vol_ul/dl_shards.
+ */
+enum cdr_vol_type {
+	CDR_VOL_SDF,		/**< dp_sdf_per_bearer_info, 1 shard */
+	CDR_VOL_ADC,		/**< dp_adc_ue_info, 1 shard */
+	CDR_VOL_RG,		/**< ue_session_info, MAX_RATING_GRP shards */
+	CDR_VOL_MAX
+};
+
+/** Per worker UL/DL counter shards, indexed by session cdr_slot */
+extern struct cdr_shard *cdr_ul_shards[DP_MAX_WORKERS];
+extern struct cdr_shard *cdr_dl_shards[DP_MAX_WORKERS];
+
+/**
+ * Per worker UL/DL ADC, SDF and rating group counter shards, indexed by
+ * the vol slot of the owner record (times MAX_RATING_GRP, plus the
+ * rating group index, for CDR_VOL_RG). Kept out of the owner records:
+ * each worker writes its own arrays only.
+ */
+extern struct cdr_vol_shard *cdr_vol_ul_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+extern struct cdr_vol_shard *cdr_vol_dl_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+
+/**
+ * One worker's share of an SDF, ADC or APN meter. Each worker of a
+ * direction polices its RSS share of the flows with 1/nb_workers of the
+ * profile rate and bursts, so no meter is shared between workers.
+ */
+struct mtr_shard {
+	struct rte_meter_srtcm mtr;	/**< srtcm context of the share */
+	uint64_t drops;			/**< pkts dropped by the share */
+} __rte_cache_aligned;
+
+/**
+ * Per worker UL/DL meter shares, indexed by the vol slot of the owner
+ * record (SDF, ADC, or the UE for CDR_VOL_RG APN meters). Allocated for
+ * CDR_VOL_SDF and CDR_VOL_ADC with SDF_MTR, for CDR_VOL_RG with APN_MTR.
+ */
+extern struct mtr_shard *mtr_ul_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+extern struct mtr_shard *mtr_dl_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+
+struct dp_session_info;
+
+/** dp_session_hot flags, set and cleared with atomic ops */
+#define DP_SESS_F_FIRST_USE	0x01	/**< time_of_first_use is set */
+#define DP_SESS_F_CDR_QUEUED	0x02	/**< report queued in cdr_ring */
+#define DP_SESS_F_CDR_TIME	0x04	/**< queued report closes on time */
+
+/** Outer headers of a DL pkt: Ether 14B, IPv4 20B, UDP 8B, GTP-U 8B */
+#define ENCAP_TMPL_SIZE		50
+/** Outer headers with GTP-U sequence number */
+#define ENCAP_TMPL_SIZE_SEQNB	(ENCAP_TMPL_SIZE + 4)
+
+/** Outer UDP source port of GTP-U encap, --gtpu_sport */
+#define GTPU_SPORT_FIXED	0	/**< UDP_PORT_GTPU (default) */
+#define GTPU_SPORT_TEID		1	/**< per bearer, hash of the TEID */
+#define GTPU_SPORT_FLOW		2	/**< per flow, hash of inner 5-tuple */
+
+/** Hashed source ports are in the dynamic range 49152-65535 */
+#define GTPU_SPORT_BASE		0xc000
+#define GTPU_SPORT_MASK		0x3fff
+
+/**
+ * DL GTP-U encapsulation header template of a bearer, built by
+ * gtpu_encap_tmpl_build(). Encap copies len bytes in front of the inner
+ * IP pkt and patches lengths, IPv4 checksum, sequence number and, per
+ * flow, UDP source port; the destination MAC is left to next hop
+ * resolution.
+ * A generation count, odd while the template is rewritten, lets workers
+ * retry a copy that raced with a session modify.
+ */
+struct gtpu_encap_tmpl {
+	uint8_t hdr[ENCAP_TMPL_SIZE_SEQNB];	/**< outer headers */
+	uint8_t len;				/**< bytes of hdr used */
+	uint8_t rsvd;
+	volatile uint32_t gen;			/**< odd while written */
+	uint32_t ip_sum;			/**< IPv4 hdr sum, without
+						 * length and id */
+};
+
+/**
+ * Next hop mac address of a bearer on one egress port, cached by
+ * construct_ether_hdr_bulk so that most pkts skip the ARP lookup.
+ * Valid while gen is the current nh_gen, bumped on each ARP or route
+ * change, and ip the next hop the pkt is sent to. Workers of several
+ * RX queues may fill the same entry: seq, odd while written, lets
+ * readers skip an entry being rewritten.
+ */
+struct nh_cache {
+	volatile uint32_t seq;			/**< odd while written */
+	uint32_t gen;				/**< nh_gen when filled,
+						 * 0 if empty */
+	uint32_t ip;				/**< next hop before route
+						 * lookup, network order */
+	struct ether_addr mac;			/**< next hop mac address */
+	uint16_t rsvd;
+};
+
+/**
+ * Bearer forwarding state, the only part of a bearer session read per
+ * pkt: one cache line of state, one of DL encap template, one of next
+ * hop cache. Copied from
+ * the dp_session_info cold record by dp_session_hot_sync() on session
+ * create and modify. Addresses are in the host order of the cold record.
+ */
+struct dp_session_hot {
+	uint32_t ue_ipv4;			/**< UE ip address */
+	uint32_t s1u_sgw_teid;			/**< UL S1u SGW teid */
+	uint32_t enb_teid;			/**< DL eNodeB teid */
+	uint32_t enb_ipv4;			/**< DL eNodeB address */
+	uint32_t s5s8_sgwu_ipv4;		/**< DL S5S8 SGWU address */
+	uint32_t s5s8_pgwu_ipv4;		/**< UL S5S8 PGWU address */
+	uint32_t cdr_slot;			/**< index in cdr_ul/dl_shards */
+	uint8_t sess_state;			/**< enum dp_session_state */
+	volatile uint8_t flags;			/**< DP_SESS_F_* */
+	uint16_t rsvd;
+	uint64_t vol_trshld;			/**< volume threshold */
+	struct ue_session_info *ue_info_ptr;	/**< UE info of this bearer */
+	struct dp_session_info *cold;		/**< charging and rule data */
+	/** DL encap template, own cache line */
+	struct gtpu_encap_tmpl tmpl __rte_cache_aligned;
+	/** next hop per egress port, own cache line */
+	struct nh_cache nh[NUM_SPGW_PORTS] __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/** Hot records of all sessions, indexed by session cdr_slot */
+extern struct dp_session_hot *dp_sess_hot;
+
+/**
+ * Bearer Session information structure, the cold record of a bearer:
+ * rules, charging and control state. The fast path reads
+ * struct dp_session_hot instead.
  */
 struct dp_session_info {
 	struct ip_addr ue_addr;				/**< UE ip address*/
@@ -537,26 +676,73 @@ struct dp_session_info {
 	void *dp_session;                /* session_info: CP CDR collation handle */
 	void *ue_context;
 	uint8_t apn_idx;
+	uint32_t cdr_slot;			/**< index in cdr_ul/dl_shards */
+	struct ats_timer *ats_tmr;		/**< time threshold timer */
+	struct dp_session_hot *hot;		/**< forwarding state */
 } __attribute__((packed, aligned(RTE_CACHE_LINE_SIZE)));
 
 /**
- * UE Session information structure
+ * Set session state in both cold and hot records.
+ */
+static inline void
+dp_session_set_state(struct dp_session_info *si, enum dp_session_state state)
+{
+	si->sess_state = state;
+	si->hot->sess_state = state;
+}
+
+/**
+ * Mark a CDR report of the session queued, once per report: workers on
+ * a volume threshold crossing and the time threshold timer race for it.
+ *
+ * @param hot
+ *	hot record of the session.
+ * @param cause
+ *	DP_SESS_F_CDR_TIME for the timer, else 0.
+ *
+ * @return
+ *	1 if the caller is to enqueue the session id into cdr_ring,
+ *	0 if a report is already queued.
+ */
+static inline int
+dp_session_cdr_queue(struct dp_session_hot *hot, uint8_t cause)
+{
+	return !(__sync_fetch_and_or(&hot->flags,
+				DP_SESS_F_CDR_QUEUED | cause) &
+			DP_SESS_F_CDR_QUEUED);
+}
+
+/**
+ * Unmark the queued CDR report of the session, once it is closed or
+ * could not be enqueued.
+ *
+ * @param hot
+ *	hot record of the session.
+ */
+static inline void
+dp_session_cdr_dequeued(struct dp_session_hot *hot)
+{
+	__sync_fetch_and_and(&hot->flags,
+			(uint8_t)~(DP_SESS_F_CDR_QUEUED | DP_SESS_F_CDR_TIME));
+}
+
+/**
+ * UE Session information structure.
+ * Per pkt state (the rating group index map) comes first; rating group
+ * CDRs and ADC rule ids follow it. APN meters are in mtr_ul/dl_shards.
  */
 struct ue_session_info {
+	struct rating_group_index_map rg_idx_map[MAX_RATING_GRP]; /**< Rating group index*/
+
 	struct ip_addr ue_addr;			/**< UE ip address*/
 	uint32_t bearer_count;			/**< Num. of bearers configured*/
-	struct rte_meter_srtcm ul_apn_mtr_obj;
-	/**< UL APN meter object pointer*/
-	struct rte_meter_srtcm dl_apn_mtr_obj;
-	/**< DL APN meter object pointer*/
+	uint32_t ul_apn_mtr_idx;	/**< UL APN meter profile index*/
+	uint32_t dl_apn_mtr_idx;	/**< DL APN meter profile index*/
 
 	/* rating groups CDRs*/
-	struct rating_group_index_map rg_idx_map[MAX_RATING_GRP]; /**< Rating group index*/
 	struct ipcan_dp_bearer_cdr rating_grp[MAX_RATING_GRP];	/**< rating groups CDRs*/
-	uint32_t ul_apn_mtr_idx;	/**< UL APN meter profile index*/
-	uint32_t dl_apn_mtr_idx;	/**< DL APN meter profile index*/
-	uint64_t ul_apn_mtr_drops;	/**< drop count due to ul apn metering*/
-	uint64_t dl_apn_mtr_drops;	/**< drop count due to dl apn metering*/
+	uint32_t rg_vol_slot;	/**< CDR_VOL_RG slot of rating group counters
+				 * and APN meters*/
 
 	/* ADC rules related params*/
 	uint32_t num_adc_rules;					/**< No. of ADC rule*/
@@ -567,11 +753,11 @@ struct ue_session_info {
  * SDF and Bearer specific information structure
  */
 struct dp_sdf_per_bearer_info {
+	struct dp_session_hot *bear_hot;	/**< forwarding state of the bearer */
 	struct dp_pcc_rules pcc_info;						/**< PCC info of this bearer */
-	struct rte_meter_srtcm sdf_mtr_obj;					/**< meter object for this SDF flow */
 	struct ipcan_dp_bearer_cdr sdf_cdr;					/**< per SDF bearer CDR*/
+	uint32_t vol_slot;							/**< CDR_VOL_SDF slot of SDF counters and meter*/
 	struct dp_session_info *bear_sess_info;  	/**< pointer to bearer this flow belongs to */
-	uint64_t sdf_mtr_drops;								/**< drop count due to sdf metering*/
 } __attribute__((packed, aligned(RTE_CACHE_LINE_SIZE)));
 
 /**
@@ -580,7 +766,7 @@ struct dp_sdf_per_bearer_info {
 struct dp_adc_ue_info {
 	struct dp_adc_rules adc_info;		/**< ADC info of this bearer */
 	struct ipcan_dp_bearer_cdr adc_cdr;	/**< per ADC bearer CDR*/
-	struct rte_meter_srtcm mtr_obj;	/**< meter object for this SDF flow */
+	uint32_t vol_slot;	/**< CDR_VOL_ADC slot of ADC counters and meter*/
 } __attribute__((packed, aligned(RTE_CACHE_LINE_SIZE)));
 
 /* ****************************************************************************
@@ -753,10 +939,10 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask);
 
 /**
- * Encap gtpu header.
+ * Encap gtpu header from the bearer encap template.
  *
  * @param sess_info
- *	pointer to session info.
+ *	pointer to bearer hot records.
  * @param pkts
  *	pointer to mbuf of incoming packets.
  * @param n
@@ -765,9 +951,20 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
  *	bit mask to process the pkts, reset bit to free the pkt.
  */
 void
-gtpu_encap(struct dp_session_info **sess_info, struct rte_mbuf **pkts,
+gtpu_encap(struct dp_session_hot **sess_info, struct rte_mbuf **pkts,
 		uint32_t n, uint64_t *pkts_mask, uint64_t *pkts_queue_mask);
 
+/**
+ * Build the DL encap template of a bearer from its hot record
+ * addresses, the DP role and the GTP-U sequence number option.
+ * Single writer; workers may be encapsulating with it.
+ *
+ * @param hot
+ *	bearer hot record.
+ */
+void
+gtpu_encap_tmpl_build(struct dp_session_hot *hot);
+
 /**
  * Clone the DNS pkts and send to CP.
  * @param pkts
@@ -810,7 +1007,8 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 		struct dp_sdf_per_bearer_info **sess_info);
 
 /**
- * update nexthop info.
+ * update S5/S8 peer ip in ip header, in place: checksum patched
+ * incrementally, TEID kept.
  * @param pkts
  *	pointer to mbuf of packets.
  * @param n
@@ -825,7 +1023,8 @@ update_nexts5s8_info(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
 		struct dp_sdf_per_bearer_info **sdf_bear_info);
 
 /**
- * update enb ip in ip header and s1u tied in gtp header.
+ * update enb ip in ip header and s1u tied in gtp header, in place:
+ * checksum patched incrementally.
  * @param pkts
  *	pointer to mbuf of packets.
  * @param n
@@ -919,11 +1118,13 @@ ul_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
  *	bit mask to process the pkts, reset bit to free the pkt.
  * @param sess_info
  *	session information returned after hash lookup.
+ * @param si
+ *	bearer hot records of sess_info.
  */
 void
 dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, struct dp_sdf_per_bearer_info **sess_info,
-		struct dp_session_info **si);
+		struct dp_session_hot **si);
 
 
 /**
@@ -978,12 +1179,16 @@ get_sdf_mtr_id(void **sess_info, void **mtr_id,
 			uint64_t **mtr_drops, uint32_t n);
 
 /**
- * Process APN metering based on meter index.
+ * Process SDF metering, or ADC metering for pkts of an ADC UE.
  *
  * @param sdf_info
  *     sdf info ptr.
  * @param adc_ue_info
- *     adc ue info ptr.
+ *     adc ue info ptr, NULL if no ADC UE meter applies.
+ * @param adc_pkts_mask
+ *     unused.
+ * @param flow
+ *     uplink or downlink.
  * @param pkt
  *     mbuf pointer
  * @param n
@@ -998,7 +1203,7 @@ get_sdf_mtr_id(void **sess_info, void **mtr_id,
  */
 int
 sdf_mtr_process_pkt(struct dp_sdf_per_bearer_info **sdf_info,
-			void **adc_ue_info, uint64_t *adc_pkts_mask,
+			void **adc_ue_info, uint64_t *adc_pkts_mask, uint32_t flow,
 			struct rte_mbuf **pkt, uint32_t n, uint64_t *pkts_mask);
 /**
  * Process APN metering based on meter index.
@@ -1023,6 +1228,43 @@ int
 apn_mtr_process_pkt(struct dp_sdf_per_bearer_info **sdf_info, uint32_t flow,
 			struct rte_mbuf **pkt, uint32_t n, uint64_t *pkts_mask);
 
+/**
+ * Config the per worker shares of a meter: each worker of the direction
+ * gets 1/nb_workers of the profile rate and bursts. Drops are cleared.
+ *
+ * @param msg_id
+ *	meter profile index, 0 for no meter.
+ * @param type
+ *	owner type.
+ * @param vol_slot
+ *	vol slot of the owner record.
+ * @param flow
+ *	uplink or downlink.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if no meter applies
+ */
+int
+mtr_cfg_entry(int msg_id, enum cdr_vol_type type, uint32_t vol_slot,
+		uint32_t flow);
+
+/**
+ * Sum the drops of the per worker shares of a meter.
+ *
+ * @param type
+ *	owner type.
+ * @param vol_slot
+ *	vol slot of the owner record.
+ * @param flow
+ *	uplink or downlink.
+ *
+ * @return
+ *	pkts dropped by the meter.
+ */
+uint64_t
+mtr_shard_drops(enum cdr_vol_type type, uint32_t vol_slot, uint32_t flow);
+
 /**
  * Update CDR records per adc per ue.
  * @param adc_ue_info
@@ -1084,8 +1326,6 @@ update_sdf_cdr(void **adc_ue_info,
  *	number of pkts.
  * @param  pkts_mask
  *	bit mask to process the pkts, reset bit to free the pkt.
- * @param  pcc_rule
- *	array of pcc_rule id.
  * @param  flow
  *	direction of flow (UL_FLOW, DL_FLOW).
  *
@@ -1095,7 +1335,7 @@ update_sdf_cdr(void **adc_ue_info,
 void
 update_pcc_cdr(struct dp_sdf_per_bearer_info **sdf_bear_info,
 		struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
-		uint32_t *pcc_rule, uint32_t flow);
+		uint32_t flow);
 
 /**
  * Update CDR records of bearer.
@@ -1614,6 +1854,15 @@ iface_lookup_downlink_bulk_data(const void **key, uint32_t n,
 int
 iface_lookup_adc_ue_data(struct dl_bm_key *key,
 		void **value);
+/**
+ * @brief Called by DP to do bulk lookup of key-value pair in adc ue
+ * look up table.
+ *
+ * This function is thread safe (Read Only).
+ */
+int
+iface_lookup_adc_ue_bulk_data(const void **key, uint32_t n,
+		uint64_t *hit_mask, void **value);
 /**
  * @brief Function to return address of uplink hash table bucket, for the
  * 64 bits key.
@@ -1721,6 +1970,48 @@ dp_ue_cdr_flush(struct dp_id dp_id,	struct msg_ue_cdr *ue_cdr);
 int update_vol_on_rec_close(struct dp_session_info *session,
 		cdr_rec_cause_t cause);
 
+/**
+ * Fold the per worker counter shards of a session into its bearer CDR
+ * data_vol ul/dl cdr and drop counters. Control and stats path only.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	None
+ */
+void
+cdr_shard_fold(struct dp_session_info *session);
+
+/**
+ * Memory of the ADC, SDF and rating group counter and meter shards and
+ * of their free slot rings.
+ *
+ * @param nb_sess
+ *	max. bearer sessions.
+ * @param ring_sz
+ *	bytes of the free slot rings, on the tables socket.
+ *
+ * @return
+ *	bytes of shards per worker and direction.
+ */
+uint64_t
+cdr_vol_budget(uint32_t nb_sess, uint64_t *ring_sz);
+
+/**
+ * Copy the forwarding state of a bearer session into its hot record and
+ * rebuild its DL encap template.
+ * Called by the session owner on create and modify.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	None
+ */
+void
+dp_session_hot_sync(struct dp_session_info *session);
+
 /* ****************************************************************************
  * ****    ddn functions: ~/dp/ init.c, ddn.c    ****
  * ****************************************************************************
@@ -1863,9 +2154,60 @@ void ul_timer_stats(uint32_t n, struct ul_timer_stats *stats);
 void print_perf_statistics(void);
 #endif /* PERF_ANALYSIS */
 
-long ats_is_apn_timer_initialized(int apn_idx);
-void ats_init(int timer_threshold, int apn_idx);
-void ats_list_add_to_tail(uint64_t session_id, int apn_idx);
-void ats_list_del_node(uint64_t session_id, int apn_idx);
+/**
+ * Create the session time threshold timer wheel.
+ *
+ * @param nb_timers
+ *	max. armed session timers.
+ *
+ * @return
+ *	None
+ */
+void ats_init(uint32_t nb_timers);
+
+/**
+ * Memory ats_init takes on the calling lcore's socket.
+ *
+ * @param nb_timers
+ *	max. armed session timers.
+ *
+ * @return
+ *	bytes.
+ */
+uint64_t ats_budget(uint32_t nb_timers);
+
+/**
+ * Arm (or re-arm) the periodic time threshold timer of a session,
+ * firing every tmr_trshld seconds from now.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int ats_timer_arm(struct dp_session_info *session);
+
+/**
+ * Cancel the time threshold timer of a session, if armed.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	None
+ */
+void ats_timer_cancel(struct dp_session_info *session);
+
+/**
+ * Run due session timers. Queues the CDR of each expired session into
+ * cdr_ring, to be closed on the time threshold when dequeued.
+ * Called from the CP interface poll loop.
+ *
+ * @return
+ *	None
+ */
+void ats_poll(void);
 #endif /* _MAIN_H_ */
 
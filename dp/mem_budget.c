@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_hash.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+
+#include "main.h"
+#include "pkt_engines/ngic_rtc_framework.h"
+#include "sess_pool.h"
+#ifdef UL_TEID_INDEX
+#include "teid_index.h"
+#endif /* UL_TEID_INDEX */
+#include "mem_budget.h"
+
+/* struct rte_hash_bucket of DPDK 18.02: 104B, cache aligned */
+#define HASH_BUCKET_SZ		(2 * RTE_CACHE_LINE_SIZE)
+
+/* TEID index bounds: the CP allocates the low 24 TEID bits densely */
+#define TEID_ORDER_MIN		8
+#define TEID_ORDER_MAX		24
+
+struct dp_tbl_sizes dp_tbl_sz;
+
+/* Heap allocated per socket before the tables were created */
+static uint64_t heap_base[RTE_MAX_NUMA_NODES];
+
+/**
+ * Hash entries for n keys. Cuckoo adds start to fail before all buckets
+ * are full: keep 25% spare.
+ */
+static uint32_t
+hash_entries(uint64_t n)
+{
+	return (uint32_t)(n + n / 4);
+}
+
+/**
+ * Memory rte_hash_create takes: buckets, key slots and free slot ring.
+ */
+static uint64_t
+hash_budget(uint32_t entries, uint32_t key_len)
+{
+	uint64_t buckets = rte_align32pow2(entries) / RTE_HASH_BUCKET_ENTRIES;
+	uint32_t slots = entries + 1;
+
+	return buckets * HASH_BUCKET_SZ +
+		(uint64_t)slots * RTE_ALIGN(sizeof(void *) + key_len, 16) +
+		rte_ring_get_memsize(rte_align32pow2(slots));
+}
+
+/**
+ * Add a contiguous allocation to the needs of its socket.
+ */
+static void
+budget_add(uint64_t *need, uint64_t *big, int socket, uint64_t bytes)
+{
+	need[socket] += bytes;
+	big[socket] = RTE_MAX(big[socket], bytes);
+}
+
+void
+mem_budget_init(uint32_t nb_sess)
+{
+	uint64_t need[RTE_MAX_NUMA_NODES] = {0};
+	uint64_t big[RTE_MAX_NUMA_NODES] = {0};
+	struct rte_malloc_socket_stats st;
+	uint64_t total = 0, vol_shards, vol_rings;
+	uint32_t order, wrk;
+	unsigned int s;
+	int sock;
+
+	sock = rte_lcore_to_socket_id(epc_app.core_ul[0]);
+
+	dp_tbl_sz.sess = nb_sess;
+	dp_tbl_sz.sess_hash = hash_entries(nb_sess);
+	dp_tbl_sz.ue_hash = hash_entries(nb_sess);
+	dp_tbl_sz.cli_hash = hash_entries(nb_sess);
+	dp_tbl_sz.adc_ue_hash =
+		hash_entries((uint64_t)nb_sess * SESS_POOL_ADC_PER_UE);
+	/* Keys are bounded by the SDF pool, either direction */
+	dp_tbl_sz.ul_hash = hash_entries((uint64_t)nb_sess *
+			SESS_POOL_SDF_PER_BEARER * HASH_SIZE_FACTOR);
+	dp_tbl_sz.dl_hash = dp_tbl_sz.ul_hash;
+	dp_tbl_sz.socket = sock;
+
+	/* Twice the slots of sessions: default bearers fill the low half,
+	 * 2nd bearers the high half */
+	order = __builtin_ctz(rte_align32pow2(nb_sess)) + 1;
+	dp_tbl_sz.teid_order = RTE_MIN(RTE_MAX(order, TEID_ORDER_MIN),
+			TEID_ORDER_MAX);
+
+	budget_add(need, big, sock,
+			hash_budget(dp_tbl_sz.sess_hash, sizeof(uint64_t)));
+	budget_add(need, big, sock,
+			hash_budget(dp_tbl_sz.ue_hash, sizeof(uint32_t)));
+	budget_add(need, big, sock,
+			hash_budget(dp_tbl_sz.cli_hash, sizeof(uint32_t)));
+	budget_add(need, big, sock, hash_budget(dp_tbl_sz.adc_ue_hash,
+				sizeof(struct dl_bm_key)));
+	budget_add(need, big, sock, hash_budget(dp_tbl_sz.ul_hash,
+				sizeof(struct ul_bm_key)));
+	budget_add(need, big, sock, hash_budget(dp_tbl_sz.dl_hash,
+				sizeof(struct dl_bm_key)));
+#ifdef UL_TEID_INDEX
+	budget_add(need, big, sock,
+			sizeof(struct teid_index_entry) << dp_tbl_sz.teid_order);
+#endif /* UL_TEID_INDEX */
+	budget_add(need, big, sock,
+			(uint64_t)nb_sess * sizeof(struct dp_session_hot));
+	budget_add(need, big, sock,
+			rte_ring_get_memsize(rte_align32pow2(nb_sess + 1)));
+
+	vol_shards = cdr_vol_budget(nb_sess, &vol_rings);
+	budget_add(need, big, sock, vol_rings);
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		budget_add(need, big,
+				rte_lcore_to_socket_id(epc_app.core_ul[wrk]),
+				(uint64_t)nb_sess * sizeof(struct cdr_shard));
+		budget_add(need, big,
+				rte_lcore_to_socket_id(epc_app.core_dl[wrk]),
+				(uint64_t)nb_sess * sizeof(struct cdr_shard));
+		/* ADC, SDF and rating group shards and meter shares, counted
+		 * as one block */
+		budget_add(need, big,
+				rte_lcore_to_socket_id(epc_app.core_ul[wrk]),
+				vol_shards);
+		budget_add(need, big,
+				rte_lcore_to_socket_id(epc_app.core_dl[wrk]),
+				vol_shards);
+	}
+
+	/* Pools are populated in chunks: not a contiguous block */
+	need[rte_socket_id()] += ats_budget(nb_sess);
+	sess_pool_budget(nb_sess, need);
+
+	RTE_LOG_DP(INFO, DP, "Memory budget: %u sessions, session %zuB + "
+			"hot %zuB + SDF %zuB x %u\n", nb_sess,
+			sizeof(struct dp_session_info),
+			sizeof(struct dp_session_hot),
+			sizeof(struct dp_sdf_per_bearer_info),
+			SESS_POOL_SDF_PER_BEARER);
+
+	for (s = 0; s < RTE_MAX_NUMA_NODES; s++) {
+		if (rte_malloc_get_socket_stats(s, &st) < 0)
+			continue;
+		heap_base[s] = st.heap_allocsz_bytes;
+		if (need[s] == 0)
+			continue;
+
+		total += need[s];
+		RTE_LOG_DP(INFO, DP, "Memory budget: socket %u needs %"PRIu64
+				" MB, %"PRIu64" MB free\n", s, need[s] >> 20,
+				(uint64_t)st.heap_freesz_bytes >> 20);
+		if (need[s] > st.heap_freesz_bytes ||
+				big[s] > st.greatest_free_size)
+			rte_exit(EXIT_FAILURE, "%u sessions need %"PRIu64" MB "
+					"on socket %u, in blocks of up to %"PRIu64
+					" MB: %"PRIu64" MB free, largest block %"
+					PRIu64" MB. Raise --socket-mem or lower "
+					"--max_sessions\n", nb_sess,
+					need[s] >> 20, s, big[s] >> 20,
+					(uint64_t)st.heap_freesz_bytes >> 20,
+					(uint64_t)st.greatest_free_size >> 20);
+	}
+
+	RTE_LOG_DP(INFO, DP, "Memory budget: %"PRIu64" MB, %"PRIu64
+			" B/session\n", total >> 20, total / nb_sess);
+}
+
+void
+mem_budget_report(void)
+{
+	struct rte_malloc_socket_stats st;
+	uint64_t used = 0;
+	unsigned int s;
+
+	for (s = 0; s < RTE_MAX_NUMA_NODES; s++) {
+		if (rte_malloc_get_socket_stats(s, &st) < 0 ||
+				st.heap_allocsz_bytes < heap_base[s])
+			continue;
+		used += st.heap_allocsz_bytes - heap_base[s];
+	}
+
+	RTE_LOG_DP(INFO, DP, "DP tables: %"PRIu64" MB for %u sessions, %"
+			PRIu64" B/session, %u sessions in use\n", used >> 20,
+			dp_tbl_sz.sess, used / dp_tbl_sz.sess,
+			sess_pool_in_use(SESS_POOL_BEARER));
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MEM_BUDGET_H_
+#define _MEM_BUDGET_H_
+/**
+ * @file
+ * Session table sizing and hugepage memory budget. All per session
+ * tables (hashes, pools, cdr shards, hot records, TEID index) are sized
+ * at startup from --max_sessions. Before they are created, the memory
+ * each socket needs is checked against its free hugepage heap, so a DP
+ * configured beyond its --socket-mem fails at startup with the numbers
+ * instead of on the Nth session create.
+ */
+#include <stdint.h>
+
+/**
+ * Session table sizes.
+ */
+struct dp_tbl_sizes {
+	/** max. bearer sessions */
+	uint32_t sess;
+	/** hash entries: session, UE, CLI, ADC UE, uplink, downlink */
+	uint32_t sess_hash;
+	uint32_t ue_hash;
+	uint32_t cli_hash;
+	uint32_t adc_ue_hash;
+	uint32_t ul_hash;
+	uint32_t dl_hash;
+	/** TEID index slots as a power of two */
+	uint32_t teid_order;
+	/** socket of the tables: the one of the first UL worker */
+	int socket;
+};
+
+/** Sizes set by mem_budget_init */
+extern struct dp_tbl_sizes dp_tbl_sz;
+
+/**
+ * Size the session tables and check their memory fits the hugepage
+ * heap. Exits the DP if it does not.
+ * @param nb_sess
+ *	max. bearer sessions.
+ */
+void
+mem_budget_init(uint32_t nb_sess);
+
+/**
+ * Log the heap taken since mem_budget_init, per max. session and per
+ * bearer session in use.
+ */
+void
+mem_budget_report(void);
+
+#endif /* _MEM_BUDGET_H_ */
@@ -23,6 +23,7 @@
 #include <rte_cycles.h>
 
 #include "main.h"
+#include "ngic_rtc_framework.h"
 #include "meter.h"
 #include "interface.h"
 
@@ -116,51 +117,73 @@ FLOW_METER *app_flows;
 FLOW_METER *ambr_flows;
 
 /**
- * Function to set color.
+ * Apply srtcm policing to a burst with the calling worker's meter shares.
+ *	The shares are written by this worker only, so pkts are policed
+ *	in arrival order with one TSC read per burst, without locks or
+ *	atomics.
+ *
+ * @param mtr
+ *	per pkt meter share, NULL to skip the pkt.
+ * @param mtr_drops
+ *	per pkt drop counter of the meter owner, in this worker's shares.
+ * @param pkt
+ *	mbuf pointer
+ * @param n
+ *	num. of pkts.
+ * @param pkts_mask
+ *	bit mask to process the pkts,
+ *	reset bit to free the pkt.
+ *
  * @return
  *	None
  */
 static inline void
-app_set_pkt_color(uint8_t *pkt_data, enum policer_action color)
+mtr_burst_process(struct rte_meter_srtcm **mtr, uint64_t **mtr_drops,
+			struct rte_mbuf **pkt, uint32_t n, uint64_t *pkts_mask)
 {
-	pkt_data[APP_PKT_COLOR_POS] = (uint8_t) color;
+	uint64_t current_time = rte_rdtsc();
+	uint32_t i;
+	uint32_t pkt_len;
+	uint8_t color;
+
+	for (i = 0; i < n; i++) {
+		if (!ISSET_BIT(*pkts_mask, i) || mtr[i] == NULL)
+			continue;
+		pkt_len = rte_pktmbuf_pkt_len(pkt[i]) -
+				sizeof(struct ether_hdr);
+		/* color input is not used for blind modes */
+		color = (uint8_t) FUNC_METER(mtr[i], current_time,
+				pkt_len, e_RTE_METER_GREEN);
+		if (policer_table[e_RTE_METER_GREEN][color] != GREEN) {
+			RESET_BIT(*pkts_mask, i);
+			/* ADC meter drops count against the SDF */
+			(*mtr_drops[i])++;
+		}
+	}
 }
 
 /**
- * Process the packet to get action
+ * Meter share of a worker.
  *
- * @param pkt
- *	mbuf pointer
- * @param time
- * @param m
- *	srtcm context
+ * @param type
+ *	owner type.
+ * @param wrk
+ *	worker index.
+ * @param vol_slot
+ *	vol slot of the owner record.
+ * @param flow
+ *	uplink or downlink.
  *
  * @return
- *	int - action to be performed on the packet
+ *	meter share.
  */
-static int
-app_pkt_handle(struct rte_meter_srtcm *m, struct rte_mbuf *pkt,
-				uint64_t time)
+static inline struct mtr_shard *
+mtr_shard_get(enum cdr_vol_type type, uint32_t wrk, uint32_t vol_slot,
+		uint32_t flow)
 {
-	uint8_t input_color, output_color;
-	uint8_t *pkt_data = rte_pktmbuf_mtod(pkt, uint8_t *);
-	uint32_t pkt_len = rte_pktmbuf_pkt_len(pkt) - sizeof(struct ether_hdr);
-	enum policer_action action;
-
-	input_color = pkt_data[APP_PKT_COLOR_POS] & 0x3;
-	/* color input is not used for blind modes */
-	output_color =
-		(uint8_t) FUNC_METER(m,
-				 time,
-				 pkt_len,
-				 (enum rte_meter_color)input_color);
-
-	/* Apply policing and set the output color */
-	action = policer_table[input_color][output_color];
-
-	app_set_pkt_color(pkt_data, action);
-
-	return action;
+	if (flow == UL_FLOW)
+		return &mtr_ul_shards[type][wrk][vol_slot];
+	return &mtr_dl_shards[type][wrk][vol_slot];
 }
 
 /******************************************************************************/
@@ -275,66 +298,95 @@ mtr_del_entry(struct mtr_table *mtr_tbl, uint16_t mtr_profile_index)
 }
 
 int
-mtr_cfg_entry(int msg_id, struct rte_meter_srtcm *msg_payload)
+mtr_cfg_entry(int msg_id, enum cdr_vol_type type, uint32_t vol_slot,
+		uint32_t flow)
 {
-	struct rte_meter_srtcm *m;
 	struct mtr_table *mtr_tbl = &mtr_profile_tbl;
 	struct rte_meter_srtcm_params *app_srtcm_params =
 					&mtr_tbl->params[msg_id];
-	m = (struct rte_meter_srtcm *)msg_payload;
-	/* NOTE: rte_malloc will be replaced by simple ring_alloc in future*/
+	struct rte_meter_srtcm_params share;
+	uint32_t nb_wrk = epc_app.nb_workers;
+	struct mtr_shard *m;
+	uint32_t wrk;
 
 	if ((msg_id == 0) || (app_srtcm_params->cir == 0)) {
-		memset(m, 0, sizeof(struct rte_meter_srtcm));
+		for (wrk = 0; wrk < nb_wrk; wrk++)
+			memset(mtr_shard_get(type, wrk, vol_slot, flow), 0,
+					sizeof(struct mtr_shard));
 		return -1;
 	}
 
-	rte_meter_srtcm_config(m, &mtr_tbl->params[msg_id]);
+	/* RSS spreads the flows of a meter evenly over the workers */
+	share.cir = RTE_MAX(app_srtcm_params->cir / nb_wrk, 1UL);
+	share.cbs = app_srtcm_params->cbs ?
+			RTE_MAX(app_srtcm_params->cbs / nb_wrk, 1UL) : 0;
+	share.ebs = app_srtcm_params->ebs ?
+			RTE_MAX(app_srtcm_params->ebs / nb_wrk, 1UL) : 0;
 
 	RTE_LOG_DP(DEBUG, DP, "Configuring MTR index %d\n", msg_id);
-	if ((m)->cir_period == 0)
-		rte_exit(EXIT_FAILURE, "Meter config fail. cir_period is 0!!");
+	for (wrk = 0; wrk < nb_wrk; wrk++) {
+		m = mtr_shard_get(type, wrk, vol_slot, flow);
+		m->drops = 0;
+		rte_meter_srtcm_config(&m->mtr, &share);
+		if (m->mtr.cir_period == 0)
+			rte_exit(EXIT_FAILURE,
+				"Meter config fail. cir_period is 0!!");
+	}
 	return 0;
 }
 
+uint64_t
+mtr_shard_drops(enum cdr_vol_type type, uint32_t vol_slot, uint32_t flow)
+{
+	uint64_t drops = 0;
+	uint32_t wrk;
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++)
+		drops += mtr_shard_get(type, wrk, vol_slot, flow)->drops;
+	return drops;
+}
+
 int
 sdf_mtr_process_pkt(struct dp_sdf_per_bearer_info **sdf_info,
-			void **adc_ue_info, uint64_t *adc_pkts_mask,
+			void **adc_ue_info, uint64_t *adc_pkts_mask, uint32_t flow,
 			struct rte_mbuf **pkt, uint32_t n, uint64_t *pkts_mask)
 {
-	uint64_t current_time;
-	struct rte_meter_srtcm *m;
+	struct rte_meter_srtcm *mtr[MAX_BURST_SZ];
+	uint64_t *mtr_drops[MAX_BURST_SZ];
+	uint32_t wrk = RTE_PER_LCORE(epc_wrk_id);
+	struct mtr_shard *m;
 	uint32_t i;
 	struct dp_sdf_per_bearer_info *psdf;
 	struct dp_adc_ue_info *adc_ue;
-	/* struct qos_info *qos; */ //GCC_Security flag
-	enum policer_action action;
+
+	RTE_SET_USED(adc_pkts_mask);
 
 	for (i = 0; i < n; i++) {
+		mtr[i] = NULL;
 		if (!ISSET_BIT(*pkts_mask, i))
 			continue;
 		psdf = (struct dp_sdf_per_bearer_info *)sdf_info[i];
-		adc_ue = adc_ue_info[i];
-		/* qos = &psdf->pcc_info.qos; */ //GCC_Security flag
+		if (psdf == NULL)
+			continue;
+		adc_ue = (adc_ue_info != NULL) ? adc_ue_info[i] : NULL;
 		if (adc_ue)
-			m = &adc_ue->mtr_obj;
+			m = mtr_shard_get(CDR_VOL_ADC, wrk, adc_ue->vol_slot,
+					flow);
 		else
-			m = &psdf->sdf_mtr_obj;
+			m = mtr_shard_get(CDR_VOL_SDF, wrk, psdf->vol_slot,
+					flow);
 
-		current_time = rte_rdtsc();
-		if (m->cir_period == 0) {
+		if (m->mtr.cir_period == 0) {
 			RTE_LOG_DP(DEBUG, DP, "SDF: Either MTR not found or"
 				" MTR not configured!!!\n");
 			continue;
 		}
-		action = app_pkt_handle(m, pkt[i], current_time);
-		if ((action == RED)
-			|| (action == YELLOW)
-			|| (action == DROP)) {
-			RESET_BIT(*pkts_mask, i);
-			psdf->sdf_mtr_drops += 1;
-		}
+		mtr[i] = &m->mtr;
+		mtr_drops[i] = &mtr_shard_get(CDR_VOL_SDF, wrk,
+				psdf->vol_slot, flow)->drops;
 	}
+
+	mtr_burst_process(mtr, mtr_drops, pkt, n, pkts_mask);
 	return 0;
 }
 
@@ -355,56 +407,39 @@ int
 apn_mtr_process_pkt(struct dp_sdf_per_bearer_info **sdf_info, uint32_t flow,
 			struct rte_mbuf **pkt, uint32_t n, uint64_t *pkts_mask)
 {
-	uint64_t current_time;
-	struct rte_meter_srtcm *m;
+	struct rte_meter_srtcm *mtr[MAX_BURST_SZ];
+	uint64_t *mtr_drops[MAX_BURST_SZ];
+	uint32_t wrk = RTE_PER_LCORE(epc_wrk_id);
+	struct mtr_shard *m;
 	uint32_t i;
-	struct dp_session_info *si;
+	struct dp_session_hot *si;
 	struct dp_sdf_per_bearer_info *psdf;
-	struct ue_session_info *ue;
-	enum policer_action action;
-	uint64_t *mtr_drops;
-	struct qos_info *qos;
 
 	for (i = 0; i < n; i++) {
+		mtr[i] = NULL;
 		if (!ISSET_BIT(*pkts_mask, i))
 			continue;
 		psdf = (struct dp_sdf_per_bearer_info *)sdf_info[i];
-		qos = &psdf->pcc_info.qos;
-		if (is_qci_gbr(qos, flow))
+		if (psdf == NULL)
 			continue;
-		si = psdf->bear_sess_info;
-		ue = si->ue_info_ptr;
-
-		if (flow == UL_FLOW) {
-			m = &ue->ul_apn_mtr_obj;
-			mtr_drops = &ue->ul_apn_mtr_drops;
-			RTE_LOG_DP(DEBUG, DP, "APN MTR UL LKUP: apn_mtr_id:%u, "
-					"apn_mtr_obj:0x%"PRIx64"\n",
-					ue->ul_apn_mtr_idx,
-					(uint64_t)&ue->ul_apn_mtr_obj);
-		} else {
-			m = &ue->dl_apn_mtr_obj;
-			mtr_drops = &ue->dl_apn_mtr_drops;
-			RTE_LOG_DP(DEBUG, DP, "APN MTR DL LKUP: apn_mtr_id:%u, "
-					"apn_mtr_obj:0x%"PRIx64"\n",
-					ue->dl_apn_mtr_idx,
-					(uint64_t)&ue->dl_apn_mtr_obj);
-		}
+		if (is_qci_gbr(&psdf->pcc_info.qos, flow))
+			continue;
+		si = psdf->bear_hot;
+		if (si == NULL || si->ue_info_ptr == NULL)
+			continue;
+		m = mtr_shard_get(CDR_VOL_RG, wrk,
+				si->ue_info_ptr->rg_vol_slot, flow);
 
-		current_time = rte_rdtsc();
-		if (m->cir_period == 0) {
+		if (m->mtr.cir_period == 0) {
 			RTE_LOG_DP(DEBUG, DP, "APN: Either MTR not found or"
 				" MTR not configured!!!\n");
 			continue;
 		}
-		action = app_pkt_handle(m, pkt[i], current_time);
-		if ((action == RED)
-			|| (action == YELLOW)
-			|| (action == DROP)) {
-			RESET_BIT(*pkts_mask, i);
-			*mtr_drops += 1;
-		}
+		mtr[i] = &m->mtr;
+		mtr_drops[i] = &m->drops;
 	}
+
+	mtr_burst_process(mtr, mtr_drops, pkt, n, pkts_mask);
 	return 0;
 }
 
@@ -24,19 +24,6 @@
 #include <rte_mbuf.h>
 #include <rte_meter.h>
 
-/**
- * config meter entry.
- *
- * @param msg_id
- *	message id.
- * @param msg_payload
- *	pointer to msg_payload
- *
- * @return
- *	- 0 on success
- *	- -1 on failure
- */
-int
-mtr_cfg_entry(int msg_id, struct rte_meter_srtcm *msg_payload);
+/* Meter shares (struct mtr_shard) and their config are in main.h */
 
 #endif				/* _METER_H_ */
@@ -37,11 +37,12 @@
 #include <rte_table_stub.h>
 #include <rte_mbuf.h>
 #include <rte_ring.h>
+#include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_log.h>
 #include <rte_ethdev.h>
 #include <rte_port_ethdev.h>
-#include <rte_kni.h>
+#include <rte_spinlock.h>
 
 #ifdef STATIC_ARP
 #include <rte_cfgfile.h>
@@ -50,8 +51,11 @@
 #include "mngtplane_handler.h"
 #include "util.h"
 #include "main.h"
+#include "hash_bulk.h"
 #include "dp_stats.h"
 #include "gtpu.h"
+#include "ipv4.h"
+#include "route_fib.h"
 
 /* ****************************************************************************
  * ****    Mngt Handler Defines/Data Structures    ****
@@ -65,17 +69,11 @@
 char ipAddr[128];
 char gwAddr[128];
 char netMask[128];
-int gatway_flag = 0;
 int netlink_sock = -1;
+volatile uint32_t nh_gen = 1;
 
 /* print arp table */
 static void print_arp_table(void);
-/* memory pool for mngt pkts */
-extern struct rte_mempool *mngt_ulmp;
-extern struct rte_mempool *mngt_dlmp;
-/* Rings for management responses (ARP, GTP ECHO, etc...) */
-extern struct rte_ring *mngt_ul_ring;
-extern struct rte_ring *mngt_dl_ring;
 
 /* hash params */
 static struct rte_hash_parameters
@@ -85,7 +83,7 @@ static struct rte_hash_parameters
 			.reserved = 0,
 			.key_len =
 					sizeof(uint32_t),
-			.hash_func = rte_jhash,
+			.hash_func = DEFAULT_HASH_FUNC,
 			.hash_func_init_val = 0 },
 		{
 			.name = "ARP_SGI",
@@ -93,7 +91,7 @@ static struct rte_hash_parameters
 			.reserved = 0,
 			.key_len =
 					sizeof(uint32_t),
-			.hash_func = rte_jhash,
+			.hash_func = DEFAULT_HASH_FUNC,
 			.hash_func_init_val = 0 }
 };
 /**
@@ -102,6 +100,54 @@ static struct rte_hash_parameters
 /* 2 hash handles, one for S1U and another for SGI */
 struct rte_hash *arp_hash_handle[NUM_SPGW_PORTS];
 
+/* Serializes ARP table writers: the netlink thread and the ARP aging on
+ * the mct lcore. Never held across a grace period, the mct lcore takes
+ * part in them. */
+static rte_spinlock_t arp_lock = RTE_SPINLOCK_INITIALIZER;
+
+#ifndef STATIC_ARP
+extern unsigned int fd_array[2];
+
+/* Pkts handed off by UL/DL workers for unresolved next hops */
+static struct rte_ring *arp_pend_ring[NUM_SPGW_PORTS];
+
+/* Pkts waiting on one unresolved next hop, owned by the resolver lcore */
+struct arp_pending {
+	/** next hop ip address, 0 if slot is free */
+	uint32_t ip;
+	/** egress port id */
+	uint8_t port;
+	/** ARP requests sent */
+	uint8_t retries;
+	/** number of queued pkts */
+	uint16_t nb_pkts;
+	/** tsc of next ARP request */
+	uint64_t next_req;
+	/** queued pkts */
+	struct rte_mbuf *pkts[ARP_PENDING_QLEN];
+};
+static struct arp_pending arp_pending[ARP_PENDING_MAX];
+
+/* Next hop left unresolved, owned by the resolver lcore */
+struct arp_neg {
+	/** next hop ip address, 0 if slot is free */
+	uint32_t ip;
+	/** egress port id */
+	uint8_t port;
+	/** tsc until which pkts to the next hop are dropped */
+	uint64_t expire;
+};
+static struct arp_neg arp_neg[ARP_NEG_MAX];
+
+/* ARP aging state, owned by the resolver lcore */
+static uint8_t arp_age_port;
+static uint32_t arp_age_next[NUM_SPGW_PORTS];
+/* Entries aged out, freed once arp_aged_tok grace period is over */
+static struct arp_entry_data *arp_aged[ARP_AGE_SCAN_MAX];
+static uint32_t arp_nb_aged;
+static struct epc_qs_token arp_aged_tok;
+#endif	/* STATIC_ARP */
+
 /* ****************************************************************************
  * ****    Mngt Handler Utility Functions  ****
  * ****************************************************************************
@@ -194,93 +240,61 @@ static void add_arp_data(
 				inet_ntoa(*(struct in_addr *)&arp_key->ip),
 				rte_strerror(abs(ret)));
 	}
+	nh_gen_bump();
 }
 
-struct arp_entry_data *
-retrieve_arp_entry(struct arp_ipv4_key arp_key,
-		uint8_t portid)
+uint64_t
+retrieve_arp_entry_bulk(struct arp_ipv4_key *arp_key, uint32_t n,
+		uint8_t portid, struct arp_entry_data **arp_data)
 {
-	int ret;
-	struct arp_entry_data *ret_arp_data = NULL;
-	struct RouteInfo *route_entry = NULL;
-	if (ARPICMP_DEBUG)
-		printf("%s::"
-				"\n\tretrieve_arp_entry for ip 0x%x\n",
-				__func__, arp_key.ip);
-
-	ret = rte_hash_lookup_data(arp_hash_handle[portid],
-					&arp_key.ip, (void **)&ret_arp_data);
-	if (ret < 0) {
-		/* Compute the key(subnet) based on netmask is 24 */
-		struct RouteInfo key;
-		key.dstAddr = (arp_key.ip & NETMASK);
+	const void *key_ptr[MAX_BURST_SZ];
+	struct arp_entry_data *gw_data[MAX_BURST_SZ];
+	uint32_t miss_pos[MAX_BURST_SZ];
+	uint32_t miss_ip[MAX_BURST_SZ];
+	uint32_t nh_ip[MAX_BURST_SZ];
+	uint64_t hits = 0, route_hits, gw_hits = 0;
+	uint32_t i, nb_miss = 0, nb_gw = 0;
+
+	for (i = 0; i < n; i++)
+		key_ptr[i] = &arp_key[i].ip;
+
+	if (dp_hash_lookup_bulk(arp_hash_handle[portid], key_ptr, n,
+				&hits, (void **)arp_data) < 0)
+		hits = 0;
+	if (hits == RTE_LEN2MASK(n, uint64_t))
+		return hits;
+
+	for (i = 0; i < n; i++) {
+		if (ISSET_BIT(hits, i))
+			continue;
+		arp_data[i] = NULL;
+		miss_ip[nb_miss] = arp_key[i].ip;
+		miss_pos[nb_miss++] = i;
+	}
 
-		ret = rte_hash_lookup_data(route_hash_handle,
-						&key.dstAddr, (void **)&route_entry);
+	route_hits = route_fib_lookup_bulk(miss_ip, nb_miss, nh_ip);
 
+	/* Off-link destinations: next hop is the route gateway */
+	for (i = 0; i < nb_miss; i++) {
+		if (!ISSET_BIT(route_hits, i) || nh_ip[i] == miss_ip[i])
+			continue;
+		arp_key[miss_pos[i]].ip = nh_ip[i];
+		key_ptr[nb_gw] = &arp_key[miss_pos[i]].ip;
+		miss_pos[nb_gw++] = miss_pos[i];
+	}
 
-		if (ret == 0) {
-			if ((route_entry->gateWay != 0) && (route_entry->gateWay_Mac.addr_bytes != 0)) {
-				/* Fill the gateway entry */
-				ret_arp_data =
-						rte_malloc_socket(NULL,
-								sizeof(struct arp_entry_data),
-								RTE_CACHE_LINE_SIZE, rte_socket_id());
-				ret_arp_data->last_update = time(NULL);
-				ret_arp_data->status = COMPLETE;
-				ret_arp_data->ip = route_entry->gateWay;
-				ret_arp_data->eth_addr = route_entry->gateWay_Mac;
-				return ret_arp_data;
-
-			} else if ((route_entry->gateWay != 0) && (route_entry->gateWay_Mac.addr_bytes == 0)) {
-				struct arp_ipv4_key gw_arp_key;
-				gw_arp_key.ip = route_entry->gateWay;
-				RTE_LOG_DP(INFO, DP, "GateWay ARP entry not found for %s!!!\n",
-						inet_ntoa(*((struct in_addr *)&gw_arp_key.ip)));
-				/* No arp entry for arp_key.ip
-				 * Add arp_data for arp_key.ip at
-				 * arp_hash_handle[portid]
-				 * */
-				ret_arp_data =
-						rte_malloc_socket(NULL,
-								sizeof(struct arp_entry_data),
-								RTE_CACHE_LINE_SIZE, rte_socket_id());
-				ret_arp_data->last_update = time(NULL);
-				ret_arp_data->status = INCOMPLETE;
-				add_arp_data(&gw_arp_key, ret_arp_data, portid);
-
-				/* Added arp_data for gw_arp_key.ip at
-				 * arp_hash_handle[portid]
-				 * Queue arp_data in arp_pkt mbuf
-				 * send_arp_req(portid, gw_arp_key.ip)
-				 * */
-				ret_arp_data->ip = gw_arp_key.ip;
-				return ret_arp_data;
-			}
-		}
+	if (dp_hash_lookup_bulk(arp_hash_handle[portid], key_ptr, nb_gw,
+				&gw_hits, (void **)gw_data) < 0)
+		return hits;
 
-		RTE_LOG_DP(INFO, DP, "ARP entry not found for %s!!!\n",
-				inet_ntoa(*((struct in_addr *)&arp_key.ip)));
-		/* No arp entry for arp_key.ip
-		 * Add arp_data for arp_key.ip at
-		 * arp_hash_handle[portid]
-		 * */
-		ret_arp_data =
-				rte_malloc_socket(NULL,
-						sizeof(struct arp_entry_data),
-						RTE_CACHE_LINE_SIZE, rte_socket_id());
-		ret_arp_data->last_update = time(NULL);
-		ret_arp_data->status = INCOMPLETE;
-		add_arp_data(&arp_key, ret_arp_data, portid);
-
-		/* Added arp_data for arp_key.ip at
-		 * arp_hash_handle[portid]
-		 * Queue arp_data in arp_pkt mbuf
-		 * send_arp_req(portid, arp_key.ip)
-		 * */
-		ret_arp_data->ip = arp_key.ip;
+	for (i = 0; i < nb_gw; i++) {
+		if (!ISSET_BIT(gw_hits, i))
+			continue;
+		arp_data[miss_pos[i]] = gw_data[i];
+		SET_BIT(hits, miss_pos[i]);
 	}
-	return ret_arp_data;
+
+	return hits;
 }
 
 /**
@@ -292,14 +306,18 @@ retrieve_arp_entry(struct arp_ipv4_key arp_key,
  *	source IP address.
  * @param portid
  * port
+ * @param confirmed
+ *	1 if the kernel confirmed the entry reachable, refreshing it.
  *	return void.
  *
  */
 static
 void update_arp_table(const struct ether_addr *hw_addr,
-		uint32_t ipaddr, uint8_t portid)
+		uint32_t ipaddr, uint8_t portid, int confirmed)
 {
 	struct arp_ipv4_key arp_key;
+	struct arp_entry_data *old_data = NULL;
+	struct arp_entry_data *arp_data;
 	arp_key.ip = ipaddr;
 
 	if (ARPICMP_DEBUG)
@@ -307,21 +325,46 @@ void update_arp_table(const struct ether_addr *hw_addr,
 				"\n\tarp_key.ip= 0x%x; portid= %d\n",
 				__func__, arp_key.ip, portid);
 
-	/* On ARP_REQ || ARP_RSP retrieve_arp_entry */
-	struct arp_entry_data *arp_data =
-				retrieve_arp_entry(arp_key, portid);
-
-	if (arp_data) {
-		arp_data->last_update = time(NULL);
-		if (!(is_same_ether_addr(&arp_data->eth_addr, hw_addr))) {
-			/* ARP_RSP || ARP_REQ:
-			 * Copy hw_addr -> arp_data->eth_addr
-			 * */
-			ether_addr_copy(hw_addr, &arp_data->eth_addr);
-			if (arp_data->status == INCOMPLETE) {
-				arp_data->status = COMPLETE;
-			}
+	if (is_zero_ether_addr(hw_addr))
+		return;
+
+	rte_spinlock_lock(&arp_lock);
+	if (rte_hash_lookup_data(arp_hash_handle[portid],
+				&arp_key.ip, (void **)&old_data) >= 0) {
+		/* Stale/delay/probe states only repeat the known mac */
+		if (confirmed)
+			old_data->last_update = time(NULL);
+		if (is_same_ether_addr(&old_data->eth_addr, hw_addr)) {
+			rte_spinlock_unlock(&arp_lock);
+			return;
 		}
+	} else {
+		old_data = NULL;
+	}
+
+	/* Workers read entries without lock: publish a new entry rather
+	 * than rewriting the mac address in place */
+	arp_data = rte_zmalloc_socket(NULL, sizeof(struct arp_entry_data),
+			RTE_CACHE_LINE_SIZE, rte_socket_id());
+	if (arp_data == NULL) {
+		rte_spinlock_unlock(&arp_lock);
+		RTE_LOG_DP(ERR, DP, "ARP: Failed to allocate entry for %s\n",
+				inet_ntoa(*(struct in_addr *)&arp_key.ip));
+		return;
+	}
+	arp_data->ip = arp_key.ip;
+	arp_data->port = portid;
+	arp_data->last_update = time(NULL);
+	ether_addr_copy(hw_addr, &arp_data->eth_addr);
+	arp_data->status = COMPLETE;
+
+	rte_smp_wmb();
+	add_arp_data(&arp_key, arp_data, portid);
+	rte_spinlock_unlock(&arp_lock);
+
+	if (old_data) {
+		epc_synchronize();
+		rte_free(old_data);
 	}
 }
 
@@ -337,16 +380,28 @@ void update_arp_table(const struct ether_addr *hw_addr,
  */
 static void del_arp_data(uint32_t ipaddr, uint8_t portid)
 {
-	struct arp_ipv4_key arp_key;
-	arp_key.ip = ipaddr;
-	struct arp_entry_data *arp_data = retrieve_arp_entry(arp_key, portid);
-	if(arp_data)
-		rte_free(arp_data);
+	struct arp_entry_data *arp_data = NULL;
+
+	rte_spinlock_lock(&arp_lock);
+	if (rte_hash_lookup_data(arp_hash_handle[portid],
+				&ipaddr, (void **)&arp_data) < 0) {
+		rte_spinlock_unlock(&arp_lock);
+		return;
+	}
 
 	int32_t ret = rte_hash_del_key(arp_hash_handle[portid], &ipaddr);
 	if (ret < 0){
+		rte_spinlock_unlock(&arp_lock);
 		RTE_LOG_DP(ERR, DP, "Failed to del entry in ARP hash table");
+		return;
 	}
+
+	nh_gen_bump();
+	rte_spinlock_unlock(&arp_lock);
+
+	/* Wait for workers to drop their reference */
+	epc_synchronize();
+	rte_free(arp_data);
 }
 
 /* ****************************************************************************
@@ -354,69 +409,377 @@ static void del_arp_data(uint32_t ipaddr, uint8_t portid)
  * ****************************************************************************
  **/
 
-int mngt_ingress(struct rte_mbuf *pkt, uint8_t in_port_id)
+uint16_t mngt_echo_reply(struct rte_mbuf **pkts, uint16_t n,
+		uint8_t in_port_id)
 {
-	char *mngt_req = rte_pktmbuf_mtod(pkt, char *);
-	int pkt_size = rte_pktmbuf_pkt_len(pkt);
-	char *mngt_rsp = rte_zmalloc("mngt_resp", (pkt_size + PKT_LEN_SIZE),
-					RTE_CACHE_LINE_SIZE);
-	/* epc_ul(...)::mngt_ingress(...)::in_port_id == S1U_PORT_ID */
-	struct rte_ring *dst_queue = (in_port_id == S1U_PORT_ID) ?
-					mngt_dl_ring : mngt_ul_ring;
-	if (mngt_rsp) {
-		/* Copying pkt len into first four bytes of malloc'd structure */
-		((int *)mngt_rsp)[0] = pkt_size;
-		/* Copying the packet into malloc'd structure */
-		memcpy(&mngt_rsp[PKT_LEN_SIZE], mngt_req, pkt_size);
-		if (rte_ring_enqueue(dst_queue, mngt_rsp) == -ENOBUFS) {
-			RTE_LOG_DP(ERR, DP, "%s::Can't queue Mngt pkt- ring full..."
-				" Dropping pkt\n", __func__);
-			rte_free(mngt_rsp);
+	struct rte_mbuf *rsp[PKT_BURST_SZ];
+	uint16_t i, nb_rsp = 0, nb_tx;
+
+	for (i = 0; i < n; i++) {
+		if (process_echo_request(pkts[i]) < 0) {
+			RTE_LOG_DP(DEBUG, DP, "Failed to create echo response\n");
+			continue;
 		}
+		rte_mbuf_refcnt_update(pkts[i], 1);
+		rsp[nb_rsp++] = pkts[i];
+	}
+	if (nb_rsp == 0)
+		return 0;
+
+	ipv4_cksum_tx_prep(rsp, nb_rsp, (~0LLU) >> (64 - nb_rsp), in_port_id);
+	nb_tx = rte_eth_tx_burst(in_port_id,
+			EPC_ECHO_TXQ(RTE_PER_LCORE(epc_wrk_id)), rsp, nb_rsp);
+	for (i = nb_tx; i < nb_rsp; i++)
+		rte_pktmbuf_free(rsp[i]);
+
+	return nb_tx;
+}
+
+/* ****************************************************************************
+ * ****    ARP Resolver Functions    ****
+ * ****************************************************************************
+ **/
+
+#ifndef STATIC_ARP
+int arp_queue_unresolved(struct rte_mbuf *m, uint32_t nh_ip,
+		uint8_t portid)
+{
+	struct rte_mbuf *seg;
+
+	m->udata64 = nh_ip;
+
+	/* Take a reference for the resolver, the worker drops its own */
+	for (seg = m; seg != NULL; seg = seg->next)
+		rte_mbuf_refcnt_update(seg, 1);
+
+	if (rte_ring_mp_enqueue(arp_pend_ring[portid], m) != 0) {
+		for (seg = m; seg != NULL; seg = seg->next)
+			rte_mbuf_refcnt_update(seg, -1);
+		return -1;
 	}
 	return 0;
 }
 
-uint16_t mngt_egress(port_pairs_t *ip_op, struct rte_mbuf **pkts)
+/**
+ * Kick kernel ARP resolution, or revalidation, of next hop through the
+ * kernel interface of the exception path.
+ *
+ * @param ip
+ *	next hop ip address.
+ * @param portid
+ *	egress port id
+ *
+ * @return
+ *	void.
+ */
+static void
+arp_kick(uint32_t ip, uint8_t portid)
 {
-	/* epc_dl(...)::mngt_egress(...)::ip_op->in_pid == SGI_PORT_ID */
-	struct rte_ring *dst_queue = (ip_op->in_pid == S1U_PORT_ID) ?
-					mngt_ul_ring : mngt_dl_ring;
-	struct rte_mempool *mp = (ip_op->in_pid == S1U_PORT_ID) ?
-					mngt_ulmp : mngt_dlmp;
-	uint32_t queued_cnt = rte_ring_count(dst_queue);
-	int i, j = 0, pkt_size;
-	char *pkt_buf, *mngt_rsp;
-	if (queued_cnt) {
-		char *buffs[queued_cnt];
-		/* Dequeue malloc'd buffers */
-		uint32_t rx_cnt = rte_ring_dequeue_bulk(dst_queue,
-				(void**)buffs, queued_cnt, NULL);
-		for (i = 0,j = 0; i < rx_cnt; i++) {
-			pkt_buf = buffs[i];
-			/* Allocate pkt mbuf at port mempool for GTP Echo Response */
-			pkts[j] = rte_pktmbuf_alloc(mp);
-			if (pkts[j] == NULL) {
-				rte_free(pkt_buf);
-				rte_panic("Failed to alloc mbuf for mngt resp messages");
-			}
-			/* convert malloc'd buffer into mbuf */
-			pkt_size = ((int *)pkt_buf)[0];
-			mngt_rsp = rte_pktmbuf_mtod(pkts[j], char *);
-			memcpy(mngt_rsp, &pkt_buf[PKT_LEN_SIZE], pkt_size);
-			pkts[j]->pkt_len = pkts[j]->data_len = pkt_size;
-
-			/* Process GTP ECHO REQ */
-			process_echo_request(pkts[j]);
-
-			/* Free malloc'd buffer */
-			rte_free(pkt_buf);
-			j++;
+	struct sockaddr_in dest_addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SOCKET_PORT),
+		.sin_addr.s_addr = ip,
+	};
+
+	if (sendto(fd_array[portid], NULL, 0, MSG_DONTWAIT,
+				(struct sockaddr *)&dest_addr, sizeof(dest_addr)) < 0)
+		RTE_LOG_DP(DEBUG, DP, "ARP: sendto failed: %s\n",
+				strerror(errno));
+}
+
+/**
+ * Send ARP request for a pending next hop.
+ *
+ * @param p
+ *	pending next hop.
+ * @param now
+ *	current tsc.
+ *
+ * @return
+ *	void.
+ */
+static void
+arp_send_req(struct arp_pending *p, uint64_t now)
+{
+	RTE_LOG_DP(INFO, DP, "ARP: resolve %s, try %u\n",
+			inet_ntoa(*(struct in_addr *)&p->ip), p->retries + 1);
+
+	arp_kick(p->ip, p->port);
+
+	p->retries++;
+	p->next_req = now + ARP_TIMEOUT * rte_get_timer_hz();
+}
+
+/**
+ * Transmit queued pkts of a resolved next hop and release the slot.
+ *
+ * @param p
+ *	pending next hop.
+ * @param hw_addr
+ *	next hop mac address, NULL to drop the queued pkts.
+ *
+ * @return
+ *	void.
+ */
+static void
+arp_pending_flush(struct arp_pending *p, const struct ether_addr *hw_addr)
+{
+	struct ether_hdr *eth_hdr;
+	uint16_t i, nb_tx = 0;
+
+	if (hw_addr != NULL) {
+		for (i = 0; i < p->nb_pkts; i++) {
+			eth_hdr = rte_pktmbuf_mtod(p->pkts[i], struct ether_hdr *);
+			eth_hdr->ether_type = htons(ETH_TYPE_IPv4);
+			ether_addr_copy(hw_addr, &eth_hdr->d_addr);
+			ether_addr_copy(&ports_eth_addr[p->port], &eth_hdr->s_addr);
+		}
+		nb_tx = rte_eth_tx_burst(p->port, EPC_CTRL_TXQ,
+				p->pkts, p->nb_pkts);
+	}
+
+	for (i = nb_tx; i < p->nb_pkts; i++)
+		rte_pktmbuf_free(p->pkts[i]);
+
+	p->nb_pkts = 0;
+	p->ip = 0;
+}
+
+/**
+ * Check the negative cache for a next hop, releasing expired slots.
+ *
+ * @param ip
+ *	next hop ip address.
+ * @param portid
+ *	egress port id
+ * @param now
+ *	current tsc.
+ *
+ * @return
+ *	1 if next hop is held unreachable, 0 otherwise.
+ */
+static int
+arp_neg_lookup(uint32_t ip, uint8_t portid, uint64_t now)
+{
+	int i;
+
+	for (i = 0; i < ARP_NEG_MAX; i++) {
+		if (arp_neg[i].ip != ip || arp_neg[i].port != portid)
+			continue;
+		if (now < arp_neg[i].expire)
+			return 1;
+		arp_neg[i].ip = 0;
+		return 0;
+	}
+	return 0;
+}
+
+/**
+ * Hold an unresolved next hop in the negative cache for
+ * app.arp_neg_hold seconds, evicting the slot expiring first when full.
+ *
+ * @param ip
+ *	next hop ip address.
+ * @param portid
+ *	egress port id
+ * @param now
+ *	current tsc.
+ *
+ * @return
+ *	void.
+ */
+static void
+arp_neg_add(uint32_t ip, uint8_t portid, uint64_t now)
+{
+	struct arp_neg *n = &arp_neg[0];
+	int i;
+
+	if (app.arp_neg_hold == 0)
+		return;
+
+	for (i = 0; i < ARP_NEG_MAX; i++) {
+		if (arp_neg[i].ip == 0 || now >= arp_neg[i].expire) {
+			n = &arp_neg[i];
+			break;
+		}
+		if (arp_neg[i].expire < n->expire)
+			n = &arp_neg[i];
+	}
+
+	n->ip = ip;
+	n->port = portid;
+	n->expire = now + app.arp_neg_hold * rte_get_timer_hz();
+}
+
+/**
+ * Queue pkt on the pending slot of its next hop.
+ *	Pkts to a next hop in the negative cache are dropped.
+ *
+ * @param m
+ *	pkt handed off by a worker.
+ * @param portid
+ *	egress port id
+ * @param now
+ *	current tsc.
+ *
+ * @return
+ *	void.
+ */
+static void
+arp_pending_add(struct rte_mbuf *m, uint8_t portid, uint64_t now)
+{
+	uint32_t nh_ip = (uint32_t)m->udata64;
+	struct arp_pending *p = NULL;
+	int i;
+
+	if (arp_neg_lookup(nh_ip, portid, now)) {
+		rte_pktmbuf_free(m);
+		return;
+	}
+
+	for (i = 0; i < ARP_PENDING_MAX; i++) {
+		if (arp_pending[i].ip == nh_ip &&
+				arp_pending[i].port == portid) {
+			p = &arp_pending[i];
+			break;
 		}
+		if (p == NULL && arp_pending[i].ip == 0)
+			p = &arp_pending[i];
+	}
+
+	if (p == NULL || p->nb_pkts == ARP_PENDING_QLEN) {
+		RTE_LOG_DP(DEBUG, DP, "ARP: pending queue full for %s\n",
+				inet_ntoa(*(struct in_addr *)&nh_ip));
+		rte_pktmbuf_free(m);
+		return;
+	}
+
+	p->pkts[p->nb_pkts++] = m;
+	if (p->ip == 0) {
+		p->ip = nh_ip;
+		p->port = portid;
+		p->retries = 0;
+		arp_send_req(p, now);
 	}
-	return j;
 }
 
+uint32_t arp_age(time_t now)
+{
+	struct arp_entry_data *expired[ARP_AGE_SCAN_MAX];
+	uint32_t probe_ip[ARP_AGE_SCAN_MAX];
+	uint32_t nb_expired = 0, nb_probe = 0, i;
+	uint8_t port = arp_age_port;
+	struct arp_entry_data *data;
+	const void *key;
+	void *next_data;
+	time_t age;
+
+	if (arp_nb_aged) {
+		if (!epc_qs_check(&arp_aged_tok))
+			return 0;
+		for (i = 0; i < arp_nb_aged; i++)
+			rte_free(arp_aged[i]);
+		arp_nb_aged = 0;
+	}
+
+	if (app.arp_max_age == 0 && app.arp_refresh == 0)
+		return 0;
+
+	rte_spinlock_lock(&arp_lock);
+	for (i = 0; i < ARP_AGE_SCAN_MAX; i++) {
+		if (rte_hash_iterate(arp_hash_handle[port], &key, &next_data,
+					&arp_age_next[port]) < 0) {
+			/* End of this port's table, next pass scans the other */
+			arp_age_next[port] = 0;
+			arp_age_port = (port + 1) % NUM_SPGW_PORTS;
+			break;
+		}
+
+		data = (struct arp_entry_data *)next_data;
+		age = now - data->last_update;
+		if (app.arp_max_age && age >= (time_t)app.arp_max_age) {
+			expired[nb_expired++] = data;
+		} else if (app.arp_refresh && age >= (time_t)app.arp_refresh &&
+				now >= data->next_probe) {
+			data->next_probe = now + ARP_PROBE_INTERVAL;
+			probe_ip[nb_probe++] = data->ip;
+		}
+	}
+
+	/* Deleted after the scan, rte_hash_iterate walks the key slots */
+	for (i = 0; i < nb_expired; i++) {
+		rte_hash_del_key(arp_hash_handle[port], &expired[i]->ip);
+		arp_aged[i] = expired[i];
+	}
+	if (nb_expired)
+		nh_gen_bump();
+	rte_spinlock_unlock(&arp_lock);
+
+	if (nb_expired) {
+		arp_nb_aged = nb_expired;
+		epc_qs_start(&arp_aged_tok);
+	}
+
+	for (i = 0; i < nb_expired; i++)
+		RTE_LOG_DP(INFO, DP, "ARP: %s aged out\n",
+				inet_ntoa(*(struct in_addr *)&expired[i]->ip));
+
+	for (i = 0; i < nb_probe; i++)
+		arp_kick(probe_ip[i], port);
+
+	return nb_expired;
+}
+
+void arp_resolver_core(void)
+{
+	static uint64_t age_tsc;
+	struct rte_mbuf *pkts[PKT_BURST_SZ];
+	struct arp_entry_data *arp_data;
+	struct arp_pending *p;
+	uint64_t now = rte_get_timer_cycles();
+	uint8_t port;
+	unsigned i, nb_rx;
+
+	if (now >= age_tsc) {
+		arp_age(time(NULL));
+		age_tsc = now + rte_get_timer_hz();
+	}
+
+	for (port = 0; port < NUM_SPGW_PORTS; port++) {
+		nb_rx = rte_ring_sc_dequeue_burst(arp_pend_ring[port],
+				(void **)pkts, PKT_BURST_SZ, NULL);
+		for (i = 0; i < nb_rx; i++)
+			arp_pending_add(pkts[i], port, now);
+	}
+
+	for (i = 0; i < ARP_PENDING_MAX; i++) {
+		p = &arp_pending[i];
+		if (p->ip == 0)
+			continue;
+
+		if (rte_hash_lookup_data(arp_hash_handle[p->port],
+					&p->ip, (void **)&arp_data) >= 0 &&
+				arp_data->status == COMPLETE) {
+			arp_pending_flush(p, &arp_data->eth_addr);
+			continue;
+		}
+
+		if (now < p->next_req)
+			continue;
+
+		if (p->retries == ARP_MAX_RETRY) {
+			RTE_LOG_DP(INFO, DP, "ARP: %s unresolved, dropping %u pkts\n",
+					inet_ntoa(*(struct in_addr *)&p->ip),
+					p->nb_pkts);
+			arp_neg_add(p->ip, p->port, now);
+			arp_pending_flush(p, NULL);
+			continue;
+		}
+		arp_send_req(p, now);
+	}
+}
+#endif	/* STATIC_ARP */
+
 /* ****************************************************************************
  * ****    Static ARP Table Update/Functions	****
  * ****************************************************************************
@@ -518,6 +881,48 @@ add_static_arp_entry(struct rte_cfgfile_entry *entry,
 	}
 }
 
+/**
+ * Add static route entry.
+ *	<prefix>/<depth> = <gateway>, gateway 0.0.0.0 for on-link routes.
+ *
+ * @param entry
+ *	config file entry.
+ *	return void.
+ */
+static void
+add_static_route_entry(struct rte_cfgfile_entry *entry)
+{
+	struct in_addr prefix, gw;
+	char name[CFG_NAME_LEN];
+	char *depth_ptr;
+	char *end;
+	unsigned long depth;
+
+	strncpy(name, entry->name, sizeof(name) - 1);
+	name[sizeof(name) - 1] = '\0';
+
+	depth_ptr = strchr(name, '/');
+	if (depth_ptr == NULL) {
+		printf("Error parsing static route entry: %s = %s\n",
+				entry->name, entry->value);
+		return;
+	}
+	*depth_ptr++ = '\0';
+
+	depth = strtoul(depth_ptr, &end, 10);
+	if (*end != '\0' || depth > 32 ||
+			inet_aton(name, &prefix) == 0 ||
+			inet_aton(entry->value, &gw) == 0) {
+		printf("Error parsing static route entry: %s = %s\n",
+				entry->name, entry->value);
+		return;
+	}
+
+	if (route_fib_add(prefix.s_addr, depth, gw.s_addr) < 0)
+		printf("Error adding static route entry: %s = %s\n",
+				entry->name, entry->value);
+}
+
 /**
  * Configure Static ARP Entries.
  *	return void.
@@ -528,8 +933,10 @@ config_static_arp(void)
 	struct rte_cfgfile *file = rte_cfgfile_load(STATIC_ARP_FILE, 0);
 	struct rte_cfgfile_entry *sgi_entries = NULL;
 	struct rte_cfgfile_entry *s1u_entries = NULL;
+	struct rte_cfgfile_entry *route_entries = NULL;
 	int num_sgi_entries;
 	int num_s1u_entries;
+	int num_route_entries;
 	int i;
 
 	if (file == NULL) {
@@ -583,6 +990,29 @@ config_static_arp(void)
 		rte_free(s1u_entries);
 	}
 
+	num_route_entries = rte_cfgfile_section_num_entries(file, "route");
+	if (num_route_entries > 0) {
+		route_entries = rte_malloc_socket(NULL,
+				sizeof(struct rte_cfgfile_entry) *
+				num_route_entries,
+				RTE_CACHE_LINE_SIZE, rte_socket_id());
+		if (route_entries == NULL) {
+			fprintf(stderr, "Error configuring route entry of %s\n",
+					STATIC_ARP_FILE);
+		} else {
+			rte_cfgfile_section_entries(file, "route",
+					route_entries, num_route_entries);
+			for (i = 0; i < num_route_entries; ++i) {
+				printf("[ROUTE]: %s = %s\n",
+						route_entries[i].name,
+						route_entries[i].value);
+				add_static_route_entry(&route_entries[i]);
+			}
+			rte_free(route_entries);
+			route_fib_commit();
+		}
+	}
+
 	if (ARPICMP_DEBUG)
 		print_arp_table();
 }
@@ -625,124 +1055,87 @@ static int print_route_entry(
 /**
  * Delete entry in route table.
  *
- * @param rte_route_data
- *		- key
- *		- route info
- * port
- *	return void.
- *
+ * @param info
+ *	route info
+ * @return
+ *	- 0 on success
+ *	- -1 if no such route
  */
 static int
-del_route_entry(
-			struct RouteInfo *info)
+del_route_entry(struct RouteInfo *info)
 {
-	int ret;
-	struct RouteInfo *ret_route_data = NULL;
-
-	/* Check Route Entry is present or Not */
-	ret = rte_hash_lookup_data(route_hash_handle,
-					&info->dstAddr, (void **)&ret_route_data);
-	if (ret) {
-		/* Route Entry is present. Delete Route Entry */
-		ret = rte_hash_del_key(route_hash_handle, &info->dstAddr);
-		if (ret < 0) {
-			rte_panic("ROUTE: Error at:%s::"
-					"\n\tDelete route_data= %s"
-					"\n\tError= %s\n",
-					__func__,
-					inet_ntoa(*(struct in_addr *)&info->dstAddr),
-					rte_strerror(abs(ret)));
-
-
-			return -1;
-		}
+	if (route_fib_del(info->dstAddr, __builtin_popcount(info->mask)) < 0)
+		return -1;
 
-		printf("Route entry DELETED from hash table :: \n");
-		print_route_entry(info);
-	}
+	printf("Route entry DELETED from route table :: \n");
+	print_route_entry(info);
 	return 0;
-
 }
 
 /**
- * Add entry in route table.
+ * Map kernel interface name to DP port id.
  *
- * @param rte_route_data
- *		- key
- *		- route info
- * port
- *	return void.
+ * @param ifName
+ *	interface name
  *
+ * @return
+ *	port id, -1 if not a DP interface.
  */
-static void add_route_data(
-			struct RouteInfo *info) {
-	int ret;
-	struct RouteInfo *ret_route_data = NULL;
-
-	/* Check Route Entry is present or Not */
-	ret = rte_hash_lookup_data(route_hash_handle,
-					&info->dstAddr, (void **)&ret_route_data);
-	if (ret < 0) {
-
-		/* Route Entry not present. Add Route Entry */
-		if (gatway_flag != 1) {
-			info->gateWay = 0;
-			memset(&info->gateWay_Mac, 0, sizeof(struct ether_addr));
-		}
-
-		ret = rte_hash_add_key_data(route_hash_handle,
-						&info->dstAddr, info);
-		if (ret) {
-			/* Add route_data panic because:
-			 * ret == -EINVAL &&  wrong parameter ||
-			 * ret == -ENOSPC && hash table size insufficient
-			 * */
-			rte_panic("ROUTE: Error at:%s::"
-					"\n\tadd route_data= %s"
-					"\n\tError= %s\n",
-					__func__,
-					inet_ntoa(*(struct in_addr *)&info->dstAddr),
-					rte_strerror(abs(ret)));
-		}
+static int
+iface_to_portid(const char *ifName)
+{
+	if (!strcmp(app.ul_iface_name, ifName))
+		return S1U_PORT_ID;
+	if (!strcmp(app.dl_iface_name, ifName))
+		return SGI_PORT_ID;
+	return -1;
+}
 
-		gatway_flag = 0;
+/**
+ * Add ARP entry of route gateway, when its mac address was found in
+ * the kernel ARP cache.
+ *
+ * @param info
+ *	route info
+ *	return void.
+ */
+static void
+add_gateway_arp(struct RouteInfo *info)
+{
+	int portid;
 
-		printf("Route entry ADDED in hash table :: \n");
-		print_route_entry(info);
+	if (info->gateWay == 0 || is_zero_ether_addr(&info->gateWay_Mac))
 		return;
-	} else if (ret == 0) {
-		if (ret_route_data->dstAddr == info->dstAddr){
 
-			/* Route Entry not present. Add Route Entry */
-			if (gatway_flag != 1) {
-				info->gateWay = 0;
-				memset(&info->gateWay_Mac, 0, sizeof(struct ether_addr));
-			}
+	portid = iface_to_portid(info->ifName);
+	if (portid < 0)
+		return;
 
-			ret = rte_hash_add_key_data(route_hash_handle,
-							&info->dstAddr, info);
-			if (ret) {
-				/* Add route_data panic because:
-				 * ret == -EINVAL &&  wrong parameter ||
-				 * ret == -ENOSPC && hash table size insufficient
-				 * */
-				rte_panic("ROUTE: Error at:%s::"
-						"\n\tadd route_data= %s"
-						"\n\tError= %s\n",
-						__func__,
-						inet_ntoa(*(struct in_addr *)&info->dstAddr),
-						rte_strerror(abs(ret)));
-			}
+	update_arp_table(&info->gateWay_Mac, info->gateWay, portid, 1);
+}
 
-			gatway_flag = 0;
+/**
+ * Add entry in route table.
+ *
+ * @param info
+ *	route info
+ *	return void.
+ */
+static void
+add_route_data(struct RouteInfo *info)
+{
+	if (route_fib_add(info->dstAddr, __builtin_popcount(info->mask),
+				info->gateWay) < 0) {
+		RTE_LOG_DP(ERR, DP, "ROUTE: Failed to add route %s/%u\n",
+				inet_ntoa(*(struct in_addr *)&info->dstAddr),
+				__builtin_popcount(info->mask));
+		return;
+	}
 
-			printf("Route entry ADDED in hash table :: \n");
-			print_route_entry(info);
-			return;
-		}
+	add_gateway_arp(info);
 
-	}
-	print_route_entry(ret_route_data);
+	printf("Route entry ADDED in route table :: \n");
+	print_route_entry(info);
 }
 
 /**
@@ -890,7 +1283,7 @@ static void
 {
 
 	int		recv_bytes = 0;
-	int		count = 0, i;
+	int		i;
 	struct	nlmsghdr *nlp;
 	struct	rtmsg *rtp = NULL;
 	struct  ndmsg *ntp = NULL;
@@ -945,8 +1338,10 @@ static void
 					if (ARPICMP_DEBUG)
 						printf("Interface Name:[%s]-index:[%d]\n",ifName, ntp->ndm_ifindex);
 				}
-				/* Get attributes of ntp */
+				/* Get attributes of ntp, failed entries have no
+				 * NDA_LLADDR */
 				rtap = (struct rtattr *) RTM_RTA(ntp);
+				bzero(mac_addr, ETH_ALEN);
 			} else {
 				rtp = (struct rtmsg *) NLMSG_DATA(nlp);
 				/* Get main routing table */
@@ -956,8 +1351,16 @@ static void
 				/* Get attributes of rtp */
 				rtap = (struct rtattr *) RTM_RTA(rtp);
 
-				i++;
+				/* Routes are applied as parsed, slots are reused */
+				i = (i + 1) % RTE_DIM(route);
+				memset(&route[i], 0, sizeof(route[i]));
 				route[i].flags|=RTF_UP;
+
+				/* Default route has no RTA_DST */
+				route[i].mask = rtp->rtm_dst_len ?
+					0xffffffff << (32 - rtp->rtm_dst_len) : 0;
+				if (route[i].mask == 0xFFFFFFFF)
+					route[i].flags|=RTF_HOST;
 			}
 
 			/* Get the route atttibutes len */
@@ -977,21 +1380,11 @@ static void
 								if (ARPICMP_DEBUG)
 									printf("RTA_DST:[%s]\n",inet_ntoa(*(struct in_addr *)&dst_addr));
 							} else {
-								count = 32 - rtp->rtm_dst_len;
-
 								route[i].dstAddr = *(uint32_t *) RTA_DATA(rtap);
-
-								route[i].mask = 0xffffffff;
-								for (; count!=0 ;count--)
-									route[i].mask = route[i].mask << 1;
-
-								if (route[i].mask == 0xFFFFFFFF)
-									route[i].flags|=RTF_HOST;
 							}
 							break;
 
 						case RTA_GATEWAY:
-								gatway_flag = 1;
 								char mac[64];
 
 								route[i].gateWay = *(uint32_t *) RTA_DATA(rtap);
@@ -1052,8 +1445,15 @@ static void
 					del_route_entry(&route[i]);
 					break;
 				case RTM_NEWNEIGH:
+					/* Kernel gave up resolving it */
+					if (ntp->ndm_state & NUD_FAILED) {
+						del_arp_data(dst_addr, portid);
+						break;
+					}
 					update_arp_table((struct ether_addr *)mac_addr,
-							dst_addr, portid);
+							dst_addr, portid,
+							!!(ntp->ndm_state & (NUD_REACHABLE |
+								NUD_PERMANENT | NUD_NOARP)));
 					break;
 				case RTM_DELNEIGH:
 					del_arp_data(dst_addr, portid);
@@ -1062,6 +1462,9 @@ static void
 					break;
 			}
 		}
+
+		/* One table swap for the routes of this read */
+		route_fib_commit();
 	}
 	return NULL; //GCC_Security flag
 }
@@ -1156,8 +1559,22 @@ mngtplane_init(void)
 	/**
 	 * VS: Routing Discovery
 	 */
+	if (route_fib_init() < 0)
+		rte_exit(EXIT_FAILURE, "Cannot create route table\n");
 
 #ifndef STATIC_ARP
+	for (port_cnt = 0; port_cnt < NUM_SPGW_PORTS; ++port_cnt) {
+		char name[RING_NAME_LEN];
+
+		snprintf(name, sizeof(name), "ARP_PEND_%u", port_cnt);
+		/* Multi producer: any UL/DL worker may hand off pkts */
+		arp_pend_ring[port_cnt] = rte_ring_create(name,
+				ARP_BUFFER_RING_SIZE, rte_socket_id(),
+				RING_F_SC_DEQ);
+		if (arp_pend_ring[port_cnt] == NULL)
+			rte_exit(EXIT_FAILURE, "Cannot create %s ring\n", name);
+	}
+
 	if (init_netlink_socket() != 0)
 		rte_exit(EXIT_FAILURE, "Cannot init netlink socket...!!!\n");
 #else
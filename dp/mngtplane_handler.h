@@ -22,6 +22,7 @@
  * prototypes of ARP packet processing.
  */
 #include <rte_ether.h>
+#include <rte_atomic.h>
 #include <rte_rwlock.h>
 
 /* VS: Routing Discovery */
@@ -40,6 +41,24 @@
 /* ring size */
 #define ARP_BUFFER_RING_SIZE 512
 
+/* ARP requests sent for a next hop before its pending pkts are dropped */
+#define ARP_MAX_RETRY 3
+
+/* Max unresolved next hops tracked by the ARP resolver */
+#define ARP_PENDING_MAX 64
+
+/* Max pkts held per unresolved next hop */
+#define ARP_PENDING_QLEN 32
+
+/* seconds between refresh probes of an unconfirmed ARP entry */
+#define ARP_PROBE_INTERVAL 10
+
+/* ARP entries checked per aging pass, one pass per second */
+#define ARP_AGE_SCAN_MAX 64
+
+/* Max unreachable next hops held in the negative cache */
+#define ARP_NEG_MAX 64
+
 /* ARP entry populated and echo reply received */
 #define COMPLETE   1
 
@@ -52,9 +71,6 @@
 /* netlink_recv_thread buffer */
 #define BUFFER_SIZE 4096
 
-/* size of packet length indicator */
-#define PKT_LEN_SIZE 4
-
 /* ETH Address Length */
 #define ETH_ALEN 6
 
@@ -93,8 +109,6 @@
 #define CHECK_ENDIAN_32(x) (x)
 #endif
 
-/* VS: Routing Discovery */
-#define NETMASK ntohl(4294967040)
 #define ERR_RET(x) do { perror(x); return EXIT_FAILURE; } while (0);
 
 /* VS: Get Local arp table entry */
@@ -150,44 +164,126 @@ struct arp_entry_data {
 	time_t last_update;
 	/** UL || DL port id */
 	uint8_t port;
+	/** time of next refresh probe, 0 if none sent; resolver only */
+	time_t next_probe;
 } __attribute__((packed));
 
+/* ARP tables of next hops, per port */
+extern struct rte_hash *arp_hash_handle[NUM_SPGW_PORTS];
+
 /**
- * Retrieve ARP entry.
+ * Next hop generation: bumped after each ARP table or route table
+ * change, so bearer next hop caches filled before it are stale.
+ * Always odd, never 0, which marks an empty cache.
+ */
+extern volatile uint32_t nh_gen;
+
+/**
+ * Bump the next hop generation, once the change is visible to workers.
+ * Atomic: the netlink thread and the ARP aging on the mct lcore both
+ * bump it.
+ */
+static inline void
+nh_gen_bump(void)
+{
+	/* Full barrier, the change is published before the new gen */
+	__sync_add_and_fetch(&nh_gen, 2);
+}
+
+/**
+ * Retrieve ARP entries of a burst of next hops, the next hop
+ *	resolution of construct_ether_hdr_bulk.
+ *	Lock-free table read, safe on worker lcores. Entries are only
+ *	added by the netlink thread; lookup never allocates.
+ *	ARP and gateway ARP lookups are each done for the whole burst
+ *	with dp_hash_lookup_bulk, route lookups with one
+ *	route_fib_lookup_bulk.
  *
  * @param arp_key
- *	key.
+ *	destination keys, each set to its gateway when the destination
+ *	is reached through a route.
+ * @param n
+ *	number of keys, at most MAX_BURST_SZ.
  * @param portid
  *	port id
+ * @param arp_data
+ *	arp entry data of each key, NULL if next hop is unresolved.
  *
  * @return
- *	arp entry data if found.
- *	neg value if error.
+ *	bit set for each key with an arp entry.
  */
-struct arp_entry_data *retrieve_arp_entry(
-			const struct arp_ipv4_key arp_key,
-			uint8_t portid);
+uint64_t
+retrieve_arp_entry_bulk(struct arp_ipv4_key *arp_key, uint32_t n,
+		uint8_t portid, struct arp_entry_data **arp_data);
 
 /**
- * Send Mngt Messages to crossover core.
+ * Hand off pkt for an unresolved next hop to the ARP resolver.
+ *	The caller keeps dropping the pkt as usual, the resolver holds
+ *	its own reference until the next hop resolves or times out.
+ *
+ * @param m
+ *	pkt to transmit once resolved.
+ * @param nh_ip
+ *	next hop ip address.
+ * @param portid
+ *	egress port id
  *
- * @param pkt
- *	Req/Rsp packet
- * @param in_port_id
- *	port id
  * @return
  *	- 0 on success
- *	- -1 on failure
+ *	- -1 on failure (resolver queue full)
  */
-int mngt_ingress(struct rte_mbuf *pkt, uint8_t in_port_id);
+int arp_queue_unresolved(struct rte_mbuf *m, uint32_t nh_ip,
+		uint8_t portid);
+
 /**
- * DeQueue Mngt Responses and Sent.
+ * ARP resolver, run on the mct lcore poll loop.
+ *	Queues pkts handed off by workers per next hop, sends ARP
+ *	requests and transmits the queued pkts once next hop resolves.
+ *	Next hops left unresolved after ARP_MAX_RETRY requests are held
+ *	in a negative cache for app.arp_neg_hold seconds, during which
+ *	their pkts are dropped without new requests. Runs arp_age once
+ *	per second.
+ */
+void arp_resolver_core(void);
+
+/**
+ * ARP aging pass, over at most ARP_AGE_SCAN_MAX entries from where the
+ *	previous pass stopped. Entries not confirmed for app.arp_refresh
+ *	seconds get a refresh probe every ARP_PROBE_INTERVAL seconds,
+ *	entries not confirmed for app.arp_max_age seconds are deleted.
+ *	Deleted entries are freed after a grace period, by a later pass.
+ *	mct lcore only.
+ *
+ * @param now
+ *	current time, as time(NULL).
  *
- * @param ip_op
- *	in/out port data.
  * @return
- *	- 0 on success
- *	- -1 on failure
+ *	number of entries deleted.
+ */
+uint32_t arp_age(time_t now);
+
+/**
+ * Initialize Mngt Plane Handler.
+ */
+void mngtplane_init(void);
+
+/**
+ * Answer GTP-U echo requests of a UL worker burst in place, and send
+ *	the responses back on the port they came in, on the worker's
+ *	EPC_ECHO_TXQ. No copy, allocation or hand off to another core.
+ *	Takes its own reference on each pkt; the caller drops its own as
+ *	for other exception pkts.
+ *
+ * @param pkts
+ *	echo request pkts.
+ * @param n
+ *	number of pkts, at most PKT_BURST_SZ.
+ * @param in_port_id
+ *	port the requests came in on.
+ *
+ * @return
+ *	number of responses sent.
  */
-uint16_t mngt_egress(port_pairs_t *ip_op, struct rte_mbuf **pkts);
+uint16_t mngt_echo_reply(struct rte_mbuf **pkts, uint16_t n,
+		uint8_t in_port_id);
 #endif /*__MNGT_PLANE_HANDLER_H__ */
@@ -23,6 +23,7 @@
 #include "meter.h"
 #include "interface.h"
 #include "structs.h"
+#include "tbl_rcu.h"
 
 extern struct rte_hash *rte_pcc_hash;
 extern struct rte_hash *rte_sdf_pcc_hash;
@@ -48,10 +49,13 @@ dp_pcc_table_delete(struct dp_id dp_id)
 	return 0;
 }
 
-int
-dp_pcc_entry_add(struct dp_id dp_id, struct pcc_rules *entry)
+/**
+ * @brief Add PCC rule, table write lock held.
+ */
+static int
+pcc_entry_add(struct dp_id dp_id, struct pcc_rules *entry)
 {
-	struct dp_pcc_rules *pcc;
+	struct dp_pcc_rules *pcc, *old = NULL;
 	uint32_t key32;
 	int ret;
 
@@ -62,12 +66,17 @@ dp_pcc_entry_add(struct dp_id dp_id, struct pcc_rules *entry)
 	memcpy(pcc, entry, sizeof(struct pcc_rules));
 
 	key32 = entry->rule_id;
+	rte_hash_lookup_data(rte_pcc_hash, &key32, (void **)&old);
 	ret = rte_hash_add_key_data(rte_pcc_hash, &key32,
 				  pcc);
 	if (ret < 0) {
 		RTE_LOG_DP(ERR, DP, "Failed to add entry in hash table");
+		rte_free(pcc);
 		return -1;
 	}
+	/* Known rule id: entry data replaced in place */
+	if (old != NULL)
+		tbl_rcu_defer(rte_free, old);
 
 	RTE_LOG_DP(INFO, DP, "PCC_TBL ADD: rule_id:%u, addr:0x%"PRIx64
 			", ul_mtr_idx:%u, dl_mtr_idx:%u, sdf_cnt=%d, adc_idx=%d\n",
@@ -85,8 +94,23 @@ dp_pcc_entry_add(struct dp_id dp_id, struct pcc_rules *entry)
 				entry->gate_status, 1, &entry->adc_idx);
 	return 0;
 }
+
 int
-dp_pcc_entry_delete(struct dp_id dp_id, struct pcc_rules *entry)
+dp_pcc_entry_add(struct dp_id dp_id, struct pcc_rules *entry)
+{
+	int ret;
+
+	tbl_wr_lock();
+	ret = pcc_entry_add(dp_id, entry);
+	tbl_wr_unlock();
+	return ret;
+}
+
+/**
+ * @brief Delete PCC rule, table write lock held.
+ */
+static int
+pcc_entry_delete(struct dp_id dp_id, struct pcc_rules *entry)
 {
 	struct dp_pcc_rules *pcc;
 	uint32_t key32;
@@ -104,10 +128,21 @@ dp_pcc_entry_delete(struct dp_id dp_id, struct pcc_rules *entry)
 	if (ret < 0)
 		return -1;
 
-	rte_free(pcc);
+	tbl_rcu_defer(rte_free, pcc);
 	return 0;
 }
 
+int
+dp_pcc_entry_delete(struct dp_id dp_id, struct pcc_rules *entry)
+{
+	int ret;
+
+	tbl_wr_lock();
+	ret = pcc_entry_delete(dp_id, entry);
+	tbl_wr_unlock();
+	return ret;
+}
+
 /******************** Call back functions **********************/
 /**
  *  Call back to parse msg to create pcc rules table
@@ -326,18 +361,8 @@ filter_pcc_entry_add(enum filter_pcc_type type, uint32_t pcc_id,
 			data->entries = pinfo->entries + 1;
 			data->pcc_info = pcc;
 
-			ret = rte_hash_del_key(hash, &rule_ids[i]);
-			if (ret < 0) {
-				rte_free(pcc);
-				rte_free(data);
-				RTE_LOG_DP(DEBUG, DP, "Failed to delete from rte_sdf_pcc hash\n");
-				continue;
-			}
-
-			rte_free(pinfo->pcc_info);
-			rte_free(pinfo);
-			pinfo = NULL;
-
+			/* Replace the entry data in place: workers find either
+			 * list, never a miss */
 			ret = rte_hash_add_key_data(hash,
 					&rule_ids[i], data);
 			if (ret < 0) {
@@ -347,6 +372,10 @@ filter_pcc_entry_add(enum filter_pcc_type type, uint32_t pcc_id,
 						"Failed to add entry in sdf_pcc hash table\n");
 				continue;
 			}
+
+			tbl_rcu_defer(rte_free, pinfo->pcc_info);
+			tbl_rcu_defer(rte_free, pinfo);
+			pinfo = NULL;
 		}
 	}
 	return 0;
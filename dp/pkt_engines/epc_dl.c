@@ -40,11 +40,11 @@
 #include <rte_mbuf.h>
 #include <rte_hash_crc.h>
 #include <rte_port_ring.h>
-#include <rte_kni.h>
 #include <rte_arp.h>
 
 #include "ngic_rtc_framework.h"
 #include "mngtplane_handler.h"
+#include "excp_handler.h"
 #include "main.h"
 #include "gtpu.h"
 #ifdef UNIT_TEST
@@ -56,7 +56,6 @@
 _timer_t _init_time = 0;
 #endif /* PERF_ANALYSIS */
 
-extern struct kni_port_params *kni_port_params_array[RTE_MAX_ETHPORTS];
 /* Generate new pcap for sgi port. */
 #ifdef PCAP_GEN
 extern pcap_dumper_t *pcap_dumper_east;
@@ -76,7 +75,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		     (m->ol_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD ||
 		     (m->ol_flags & PKT_RX_L4_CKSUM_MASK) == PKT_RX_L4_CKSUM_BAD)) {
 		RTE_LOG_DP(ERR, DP, "UL Bad checksum: %lu\n", m->ol_flags);
-		sgi_pktyp = BAD_PKT;
+		RTE_PER_LCORE(sgi_pktyp) = BAD_PKT;
 		return;
 	}
 
@@ -88,7 +87,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		if(unlikely(ipv4_hdr->fragment_offset != 0 &&
 					ipv4_hdr->fragment_offset != 64))
 		{
-			sgi_pktyp = JUMBO_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = JUMBO_PKT;
 			return;
 		}
 
@@ -100,7 +99,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:app.sgi_ip==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
@@ -111,7 +110,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:IPV$_MCAST==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
@@ -122,13 +121,13 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:app.sgi_bcast_addr==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
 		/* Flag all other pkts for epc_dl proc handling */
 		RTE_LOG_DP(DEBUG, DP, "SGI packet\n");
-		sgi_pktyp = DL_PKT;
+		RTE_PER_LCORE(sgi_pktyp) = DL_PKT;
 		return;
 	} /* IPv4 packet */
 
@@ -137,10 +136,10 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		(is_multicast_ether_addr(&eth_h->d_addr)) ||
 		(is_universal_ether_addr(&eth_h->d_addr)) ||
 		(is_broadcast_ether_addr(&eth_h->d_addr))) {
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 		return;
 	}
-	sgi_pktyp = UNKNOWN_PKT;
+	RTE_PER_LCORE(sgi_pktyp) = UNKNOWN_PKT;
 }
 
 static dl_handler dl_pkt_handler[NUM_SPGW_PORTS];
@@ -173,42 +172,50 @@ static int dl_in_ah(struct rte_mbuf **pkts,
 
 	uint32_t i, j;
 	uint32_t nb_data_pkts = 0;
+#ifndef STATIC_ARP
+	struct rte_mbuf *excp_pkts[PKT_BURST_SZ];
+	uint16_t nb_excp = 0;
+#endif /* !STATIC_ARP */
 
 	for (i = 0, j=0; i < n; i++) {
 		struct rte_mbuf *m = pkts[i];
 		dl_set_flow_id(m);
-		switch (sgi_pktyp) {
+		switch (RTE_PER_LCORE(sgi_pktyp)) {
 			case DL_PKT:
 				nb_data_pkts++;
 				data_pkts[j] = m;
 				j++;
 			break;
-#ifndef STATIC_ARP /* !STATIC_ARP == KNI Mode */
+#ifndef STATIC_ARP
 			case KNI_PKT:
 				RESET_BIT(*pkts_mask, i);
-				RTE_LOG(DEBUG, DP, "KNI: UL send pkts to kni\n");
-				kni_ingress(kni_port_params_array[pid], pid,
-						&pkts[i], 1);
+				/* Handed to the kernel after the loop */
+				excp_pkts[nb_excp++] = m;
 				/* Update KNI alloc DL count */
-				epc_app.dl_params[pid].dl_mbuf_rtime.kni++;
+				EPC_DL_PARAMS.dl_mbuf_rtime.kni++;
 				break;
-#endif /* !STATIC_ARP == KNI mode */
+#endif /* !STATIC_ARP */
 			/* RESET_BIT::
 			 * !STATIC_ARP: BAD_PKT | UNKNOWN_PKT
 			 * */
 			default:
 				RESET_BIT(*pkts_mask, i);
 				/* Update BAD_PKT alloc DL count */
-				epc_app.dl_params[pid].dl_mbuf_rtime.bad_pkt++;
+				EPC_DL_PARAMS.dl_mbuf_rtime.bad_pkt++;
 				RTE_LOG(DEBUG, DP, "sgi_pktyp::"
 						"\n\tBAD_PKT | UNKNOWN_PKT\n");
 		}
 	}
 
+#ifndef STATIC_ARP
+	if (nb_excp)
+		excp_ingress(pid, excp_pkts, nb_excp);
+#endif /* !STATIC_ARP */
+
 	/* Update DL fastpath packets count */
-	epc_app.dl_params[SGI_PORT_ID].pkts_in += nb_data_pkts;
+	EPC_DL_PARAMS.pkts_in += nb_data_pkts;
 	/* Update DL_PKT alloc DL mbuf count */
-	epc_app.dl_params[pid].dl_mbuf_rtime.dl_pkt += nb_data_pkts;
+	EPC_DL_PARAMS.dl_mbuf_rtime.dl_pkt += nb_data_pkts;
 
 /* Capture packets on sgi port. */
 #ifdef PCAP_GEN
@@ -246,11 +253,14 @@ static int dl_in_ah(struct rte_mbuf **pkts,
  */
 void epc_dl(void *args, port_pairs_t ip_op)
 {
-	uint16_t i, nb_dlrx, nb_dltx, nb_sent, nb_burst, pkt_rx, pkt_tx;
+	uint16_t i, nb_dlrx, nb_dltx, nb_sent, nb_burst;
 	uint32_t nb_data_pkts = 0;
 	struct rte_mbuf *dl_procmbuf[PKT_BURST_SZ];
 	struct rte_mbuf *data_pkts[PKT_BURST_SZ] = {NULL};
-	struct rte_mbuf *pkt_rxburst[PKT_BURST_SZ] = {NULL};
+#ifndef STATIC_ARP
+	uint16_t pkt_rx, pkt_tx;
+	struct rte_mbuf *pkt_rxburst[PKT_BURST_SZ];
+#endif /* !STATIC_ARP */
 	uint64_t pkts_mask =0, dpkts_mask = 0;
 
 /* rte_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
@@ -271,7 +281,7 @@ void epc_dl(void *args, port_pairs_t ip_op)
 #endif
 		pkts_mask = (~0LLU) >> (64 - nb_dlrx);
 		/* Update allocated DL mbuf count */
-		epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.rx_alloc += nb_dlrx;
+		EPC_DL_PARAMS.dl_mbuf_rtime.rx_alloc += nb_dlrx;
 		nb_data_pkts=
 			dl_in_ah(dl_procmbuf, nb_dlrx, &pkts_mask,
 					data_pkts, &dpkts_mask, ip_op.in_pid);
@@ -297,11 +307,11 @@ void epc_dl(void *args, port_pairs_t ip_op)
 				nb_dltx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
 								&data_pkts[nb_sent], nb_data_pkts);
 				/* Update TX+FREE DL mbuf count */
-				epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free += nb_dltx;
+				EPC_DL_PARAMS.dl_mbuf_rtime.tx_free += nb_dltx;
 				for (i = nb_dltx; i < nb_data_pkts; i++) {
 						rte_pktmbuf_free(data_pkts[i]);
 					/* Update TX+FREE DL mbuf count */
-					epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
+					EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
 				}
 				if (nb_dltx < nb_data_pkts) {
 					printf("ASR- Probe::%s::"
@@ -318,11 +328,11 @@ void epc_dl(void *args, port_pairs_t ip_op)
 				nb_dltx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
 								&data_pkts[nb_sent], nb_burst - 1);
 				/* Update TX+FREE DL mbuf count */
-				epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free += nb_dltx;
+				EPC_DL_PARAMS.dl_mbuf_rtime.tx_free += nb_dltx;
 				for (i = nb_dltx; i < (nb_burst -1); i++) {
 						rte_pktmbuf_free(data_pkts[i]);
 					/* Update TX+FREE DL mbuf count */
-					epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
+					EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
 				}
 				if (nb_dltx < (nb_burst - 1)) {
 					printf("ASR- Probe::%s::"
@@ -339,7 +349,7 @@ void epc_dl(void *args, port_pairs_t ip_op)
 			if (nb_sent <= nb_data_pkts) {
 				rte_pktmbuf_free(data_pkts[nb_sent - 1]);
 					/* Update TX+FREE DL mbuf count */
-					epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
+					EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
 				dpkts_mask >>= nb_burst ;
 			}
 		}
@@ -352,50 +362,33 @@ void epc_dl(void *args, port_pairs_t ip_op)
 		}
 	}
 
-	/* Process mngt_req pkts received on UL port */
-	pkt_rx = mngt_egress(&ip_op, pkt_rxburst);
-	/* Send mngt_rsp pkts on DL path */
-	pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid, pkt_rxburst, pkt_rx);
-	/* Update TX+FREE DL mbuf count */
-	epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free += pkt_tx;
-	for (i = pkt_tx; i < pkt_rx; i++) {
-		rte_pktmbuf_free(pkt_rxburst[i]);
-		/* Update TX+FREE DL mbuf count */
-		epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
-	}
-	if (pkt_tx < pkt_rx) {
-		printf("ASR- Probe::%s::"
-				"\n\teth_tx descriptors/tx_ring full!!!"
-				"\n\tpkt_rx= %u; pkt_tx= %u\n",
-				__func__, pkt_rx, pkt_tx);
-	}
+	/* Kernel exception path egress and DDN are owned by the first worker */
+	if (ip_op.in_qid != DEFAULT_QID)
+		return;
 
 #ifndef STATIC_ARP
-	/** Handle the request mbufs sent from kernel space,
-	 *  Then analyzes it and calls the specific actions for the specific requests.
-	 *  Finally constructs the response mbuf and puts it back to the resp_q.
-	 */
-	rte_kni_handle_request(kni_port_params_array[ip_op.in_pid]->kni[0]);
-
-	pkt_rx = kni_egress(kni_port_params_array[ip_op.out_pid],
-					pkt_rxburst);
+	/* Pkts the kernel sent out of the egress port interface, polled
+	 * every --excp_poll_us */
+	pkt_rx = excp_egress(ip_op.out_pid, pkt_rxburst);
+	if (pkt_rx) {
 #ifdef PCAP_GEN
-	dump_pcap(pkt_rxburst, pkt_rx, pcap_dumper_east);
+		dump_pcap(pkt_rxburst, pkt_rx, pcap_dumper_east);
 #endif /* PCAP_GEN */
-	pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
-						pkt_rxburst, pkt_rx);
-	/* Update TX+FREE DL mbuf count */
-	epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free += pkt_tx;
-	for (i = pkt_tx; i < pkt_rx; i++) {
-		rte_pktmbuf_free(pkt_rxburst[i]);
+		pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
+							pkt_rxburst, pkt_rx);
 		/* Update TX+FREE DL mbuf count */
-		epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free++;
-	}
-	if (pkt_tx < pkt_rx) {
-		printf("ASR- Probe::%s::"
-				"\n\teth_tx descriptors/tx_ring full!!!"
-				"\n\tpkt_rx= %u; pkt_tx= %u\n",
-				__func__, pkt_rx, pkt_tx);
+		EPC_DL_PARAMS.dl_mbuf_rtime.tx_free += pkt_tx;
+		for (i = pkt_tx; i < pkt_rx; i++) {
+			rte_pktmbuf_free(pkt_rxburst[i]);
+			/* Update TX+FREE DL mbuf count */
+			EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
+		}
+		if (pkt_tx < pkt_rx) {
+			printf("ASR- Probe::%s::"
+					"\n\teth_tx descriptors/tx_ring full!!!"
+					"\n\tpkt_rx= %u; pkt_tx= %u\n",
+					__func__, pkt_rx, pkt_tx);
+		}
 	}
 #endif /* !STATIC_ARP */
 
@@ -40,11 +40,11 @@
 #include <rte_mbuf.h>
 #include <rte_hash_crc.h>
 #include <rte_port_ring.h>
-#include <rte_kni.h>
 #include <rte_arp.h>
 
 #include "ngic_rtc_framework.h"
 #include "mngtplane_handler.h"
+#include "excp_handler.h"
 #include "main.h"
 #include "gtpu.h"
 #ifdef UNIT_TEST
@@ -56,7 +56,6 @@
 _timer_t _init_time = 0;
 #endif /* PERF_ANALYSIS */
 
-extern struct kni_port_params *kni_port_params_array[RTE_MAX_ETHPORTS];
 /* Generate new pcap for sgi port. */
 #ifdef PCAP_GEN
 extern pcap_dumper_t *pcap_dumper_east;
@@ -76,7 +75,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		     (m->ol_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD ||
 		     (m->ol_flags & PKT_RX_L4_CKSUM_MASK) == PKT_RX_L4_CKSUM_BAD)) {
 		RTE_LOG_DP(ERR, DP, "UL Bad checksum: %lu\n", m->ol_flags);
-		sgi_pktyp = BAD_PKT;
+		RTE_PER_LCORE(sgi_pktyp) = BAD_PKT;
 		return;
 	}
 
@@ -88,7 +87,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		if(unlikely(ipv4_hdr->fragment_offset != 0 &&
 					ipv4_hdr->fragment_offset != 64))
 		{
-			sgi_pktyp = JUMBO_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = JUMBO_PKT;
 			return;
 		}
 
@@ -100,7 +99,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:app.sgi_ip==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
@@ -111,7 +110,7 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:IPV$_MCAST==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
@@ -122,13 +121,13 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 					"\n\t@SGI:app.sgi_bcast_addr==ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 			return;
 		}
 
 		/* Flag all other pkts for epc_dl proc handling */
 		RTE_LOG_DP(DEBUG, DP, "SGI packet\n");
-		sgi_pktyp = DL_PKT;
+		RTE_PER_LCORE(sgi_pktyp) = DL_PKT;
 		return;
 	} /* IPv4 packet */
 
@@ -137,10 +136,10 @@ static inline void dl_set_flow_id(struct rte_mbuf *m)
 		(is_multicast_ether_addr(&eth_h->d_addr)) ||
 		(is_universal_ether_addr(&eth_h->d_addr)) ||
 		(is_broadcast_ether_addr(&eth_h->d_addr))) {
-			sgi_pktyp = KNI_PKT;
+			RTE_PER_LCORE(sgi_pktyp) = KNI_PKT;
 		return;
 	}
-	sgi_pktyp = UNKNOWN_PKT;
+	RTE_PER_LCORE(sgi_pktyp) = UNKNOWN_PKT;
 }
 
 #define AVX512_NUM_LONGS (8)
@@ -223,40 +222,48 @@ static int dl_in_ah(struct rte_mbuf **pkts, struct rte_mbuf **data_pkts,
 
 	uint32_t i;
 	uint32_t nb_data_pkts = 0;
+#ifndef STATIC_ARP
+	struct rte_mbuf *excp_pkts[PKT_BURST_SZ];
+	uint16_t nb_excp = 0;
+#endif /* !STATIC_ARP */
 	uint64_t dpkts_mask, pkts_mask = (~0LLU) >> (64 - n);
 
 	for (i = 0; i < n; i++) {
 		struct rte_mbuf *m = pkts[i];
 		dl_set_flow_id(m);
-		switch (sgi_pktyp) {
+		switch (RTE_PER_LCORE(sgi_pktyp)) {
 			case DL_PKT:
 				/* Update DL fastpath packets count */
-				epc_app.dl_params[SGI_PORT_ID].pkts_in ++;
+				EPC_DL_PARAMS.pkts_in ++;
 				/* Update DL_PKT alloc DL mbuf count */
-				epc_app.dl_params[pid].dl_mbuf_rtime.dl_pkt ++;
+				EPC_DL_PARAMS.dl_mbuf_rtime.dl_pkt ++;
 			break;
-#ifndef STATIC_ARP /* !STATIC_ARP == KNI Mode */
+#ifndef STATIC_ARP
 			case KNI_PKT:
 				RESET_BIT(pkts_mask, i);
-				RTE_LOG(DEBUG, DP, "KNI: UL send pkts to kni\n");
-				kni_ingress(kni_port_params_array[pid], pid,
-						&pkts[i], 1);
+				/* Handed to the kernel after the loop */
+				excp_pkts[nb_excp++] = m;
 				/* Update KNI alloc DL count */
-				epc_app.dl_params[pid].dl_mbuf_rtime.kni++;
+				EPC_DL_PARAMS.dl_mbuf_rtime.kni++;
 				break;
-#endif /* !STATIC_ARP == KNI mode */
+#endif /* !STATIC_ARP */
 			/* RESET_BIT::
 			 * !STATIC_ARP: BAD_PKT | UNKNOWN_PKT
 			 * */
 			default:
 				RESET_BIT(pkts_mask, i);
 				/* Update BAD_PKT alloc DL count */
-				epc_app.dl_params[pid].dl_mbuf_rtime.bad_pkt++;
+				EPC_DL_PARAMS.dl_mbuf_rtime.bad_pkt++;
 				RTE_LOG(DEBUG, DP, "sgi_pktyp::"
 						"\n\tBAD_PKT | UNKNOWN_PKT\n");
 		}
 	}
 
+#ifndef STATIC_ARP
+	if (nb_excp)
+		excp_ingress(pid, excp_pkts, nb_excp);
+#endif /* !STATIC_ARP */
+
 	nb_data_pkts = compress((unsigned long *)pkts,(unsigned long *)data_pkts, pkts_mask, n);
 	*processed_pkts = data_pkts;
 
@@ -301,7 +308,10 @@ static int dl_in_ah(struct rte_mbuf **pkts, struct rte_mbuf **data_pkts,
  */
 void epc_dl(void *args, port_pairs_t ip_op)
 {
-	uint16_t i, nb_dlrx, nb_dltx = 0, pkt_rx, pkt_tx;
+	uint16_t i, nb_dlrx, nb_dltx = 0;
+#ifndef STATIC_ARP
+	uint16_t pkt_rx, pkt_tx;
+#endif /* !STATIC_ARP */
 	uint32_t nb_data_pkts = 0;
 	struct rte_mbuf *dl_procmbuf[PKT_BURST_SZ];
 	struct rte_mbuf *data_pkts[PKT_BURST_SZ];
@@ -325,7 +335,7 @@ void epc_dl(void *args, port_pairs_t ip_op)
 #endif
 		/* Update allocated DL mbuf count */
 
-		epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.rx_alloc += nb_dlrx;
+		EPC_DL_PARAMS.dl_mbuf_rtime.rx_alloc += nb_dlrx;
 		nb_data_pkts=
 			dl_in_ah(dl_procmbuf, data_pkts,
 				&dl_processed_pkts, nb_dlrx, ip_op.in_pid);
@@ -342,62 +352,45 @@ void epc_dl(void *args, port_pairs_t ip_op)
 		if (nb_data_pkts) {
 			nb_dltx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid, dl_processed_pkts, nb_data_pkts);
 		 /* Update TX+FREE UL mbuf count */
-		 epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free += nb_dltx;
+		 EPC_DL_PARAMS.dl_mbuf_rtime.tx_free += nb_dltx;
 		}
 
 		 for (i = nb_dltx; i < nb_dlrx; i++) {
 			rte_pktmbuf_free(dl_processed_pkts[i]);
 			/* Update TX+FREE UL mbuf count */
-			epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
+			EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
 		 }
 
 
 	}
 
-	/* Process mngt_req pkts received on UL port */
-	pkt_rx = mngt_egress(&ip_op, data_pkts);
-	/* Send mngt_rsp pkts on DL path */
-	pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid, data_pkts, pkt_rx);
-	/* Update TX+FREE DL mbuf count */
-	epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free += pkt_tx;
-	for (i = pkt_tx; i < pkt_rx; i++) {
-		rte_pktmbuf_free(data_pkts[i]);
-		/* Update TX+FREE DL mbuf count */
-		epc_app.dl_params[ip_op.in_pid].dl_mbuf_rtime.tx_free++;
-	}
-	if (pkt_tx < pkt_rx) {
-		printf("ASR- Probe::%s::"
-				"\n\teth_tx descriptors/tx_ring full!!!"
-				"\n\tpkt_rx= %u; pkt_tx= %u\n",
-				__func__, pkt_rx, pkt_tx);
-	}
+	/* Kernel exception path egress and DDN are owned by the first worker */
+	if (ip_op.in_qid != DEFAULT_QID)
+		return;
 
-	/** Handle the request mbufs sent from kernel space,
-	 *  Then analyzes it and calls the specific actions for the specific requests.
-	 *  Finally constructs the response mbuf and puts it back to the resp_q.
-	 */
 #ifndef STATIC_ARP
-	rte_kni_handle_request(kni_port_params_array[ip_op.in_pid]->kni[0]);
-
-	pkt_rx = kni_egress(kni_port_params_array[ip_op.out_pid],
-					data_pkts);
+	/* Pkts the kernel sent out of the egress port interface, polled
+	 * every --excp_poll_us */
+	pkt_rx = excp_egress(ip_op.out_pid, data_pkts);
+	if (pkt_rx) {
 #ifdef PCAP_GEN
-	dump_pcap(data_pkts, pkt_rx, pcap_dumper_east);
+		dump_pcap(data_pkts, pkt_rx, pcap_dumper_east);
 #endif /* PCAP_GEN */
-	pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
-						data_pkts, pkt_rx);
-	/* Update TX+FREE DL mbuf count */
-	epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free += pkt_tx;
-	for (i = pkt_tx; i < pkt_rx; i++) {
-		rte_pktmbuf_free(data_pkts[i]);
+		pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid,
+							data_pkts, pkt_rx);
 		/* Update TX+FREE DL mbuf count */
-		epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free++;
-	}
-	if (pkt_tx < pkt_rx) {
-		printf("ASR- Probe::%s::"
-				"\n\teth_tx descriptors/tx_ring full!!!"
-				"\n\tpkt_rx= %u; pkt_tx= %u\n",
-				__func__, pkt_rx, pkt_tx);
+		EPC_DL_PARAMS.dl_mbuf_rtime.tx_free += pkt_tx;
+		for (i = pkt_tx; i < pkt_rx; i++) {
+			rte_pktmbuf_free(data_pkts[i]);
+			/* Update TX+FREE DL mbuf count */
+			EPC_DL_PARAMS.dl_mbuf_rtime.tx_free++;
+		}
+		if (pkt_tx < pkt_rx) {
+			printf("ASR- Probe::%s::"
+					"\n\teth_tx descriptors/tx_ring full!!!"
+					"\n\tpkt_rx= %u; pkt_tx= %u\n",
+					__func__, pkt_rx, pkt_tx);
+		}
 	}
 #endif /* !STATIC_ARP */
 
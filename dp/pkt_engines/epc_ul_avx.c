@@ -40,11 +40,11 @@
 #include <rte_mbuf.h>
 #include <rte_hash_crc.h>
 #include <rte_port_ring.h>
-#include <rte_kni.h>
 #include <rte_arp.h>
 
 #include "ngic_rtc_framework.h"
 #include "mngtplane_handler.h"
+#include "excp_handler.h"
 #include "main.h"
 #include "gtpu.h"
 #ifdef UNIT_TEST
@@ -56,7 +56,6 @@
 extern pcap_dumper_t *pcap_dumper_west;
 #endif /* PCAP_GEN */
 
-extern struct kni_port_params *kni_port_params_array[RTE_MAX_ETHPORTS];
 #ifdef PERF_ANALYSIS
 #include "perf_timer.h"
 extern _timer_t _init_time;
@@ -78,7 +77,7 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 			 (m->ol_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD ||
 			 (m->ol_flags & PKT_RX_L4_CKSUM_MASK) == PKT_RX_L4_CKSUM_BAD)) {
 		RTE_LOG_DP(ERR, DP, "UL Bad checksum: %lu\n", m->ol_flags);
-		s1u_pktyp = BAD_PKT;
+		RTE_PER_LCORE(s1u_pktyp) = BAD_PKT;
 		return;
 	}
 
@@ -90,7 +89,7 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 		if(unlikely(ext_ipv4_hdr->fragment_offset != 0 &&
 					ext_ipv4_hdr->fragment_offset != 64))
 		{
-			s1u_pktyp = JUMBO_PKT;
+			RTE_PER_LCORE(s1u_pktyp) = JUMBO_PKT;
 			return;
 		}
 
@@ -105,7 +104,7 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 			/* Check UDP packet */
 			if (unlikely(ext_ipv4_hdr->next_proto_id != IPPROTO_UDP))
 			{
-				s1u_pktyp = KNI_PKT;
+				RTE_PER_LCORE(s1u_pktyp) = KNI_PKT;
 				return;
 			}
 
@@ -117,7 +116,7 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 			/* Check UDP PORT == GTPU_PORT */
 			if (unlikely(udph->dst_port != UDP_PORT_GTPU_NW_ORDER))
 			{
-				s1u_pktyp = KNI_PKT;
+				RTE_PER_LCORE(s1u_pktyp) = KNI_PKT;
 				return;
 			}
 			/* GTP PKT == GTPU data | ECHO | UNSUPPORTED */
@@ -125,17 +124,17 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 			if (likely(gtpuhdr->msgtype == GTP_GPDU))
 			{
 				RTE_LOG_DP(DEBUG, DP, "UL: GTPU packet\n");
-				s1u_pktyp = GTPU_PKT;
+				RTE_PER_LCORE(s1u_pktyp) = GTPU_PKT;
 				return;
 			}
 			if (likely(gtpuhdr->msgtype == GTPU_ECHO_REQUEST))
 			{
 				RTE_LOG_DP(DEBUG, DP, "UL: GTPU ECHO packet\n");
-				s1u_pktyp = GTPU_ECHO_REQ;
+				RTE_PER_LCORE(s1u_pktyp) = GTPU_ECHO_REQ;
 				return;
 			}
 			RTE_LOG_DP(DEBUG, DP, "UL: GTP UNSUPPORTED packet\n");
-			s1u_pktyp = GTPU_UNSUPPORTED;
+			RTE_PER_LCORE(s1u_pktyp) = GTPU_UNSUPPORTED;
 			return;
 		}
 
@@ -146,7 +145,7 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 					"\n\t@S1U:IPV$_MCAST==ext_ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			s1u_pktyp = KNI_PKT;
+			RTE_PER_LCORE(s1u_pktyp) = KNI_PKT;
 			return;
 		}
 
@@ -157,10 +156,10 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 					"\n\t@S1U:app.s1u_bcast_addr==ext_ipv4_hdr->dst_addr= %s\n",
 					__func__,
 					inet_ntoa(*(struct in_addr *)&ho_addr));
-			s1u_pktyp = KNI_PKT;
+			RTE_PER_LCORE(s1u_pktyp) = KNI_PKT;
 			return;
 		}
-		s1u_pktyp = UNKNOWN_PKT;
+		RTE_PER_LCORE(s1u_pktyp) = UNKNOWN_PKT;
 		return;
 	} /* IPv4 packet */
 
@@ -169,10 +168,10 @@ static inline void ul_set_flow_id(struct rte_mbuf *m)
 		(is_multicast_ether_addr(&eth_h->d_addr)) ||
 		(is_universal_ether_addr(&eth_h->d_addr)) ||
 		(is_broadcast_ether_addr(&eth_h->d_addr))) {
-			s1u_pktyp = KNI_PKT;
+			RTE_PER_LCORE(s1u_pktyp) = KNI_PKT;
 			return;
 	}
-	s1u_pktyp = UNKNOWN_PKT;
+	RTE_PER_LCORE(s1u_pktyp) = UNKNOWN_PKT;
 }
 
 #ifdef FRAG
@@ -303,6 +302,12 @@ static uint64_t ul_in_ah(struct rte_mbuf **pkts, struct rte_mbuf **data_pkts,
 
 	uint32_t i;
 	uint32_t nb_data_pkts = 0;
+#ifndef STATIC_ARP
+	struct rte_mbuf *excp_pkts[PKT_BURST_SZ];
+	uint16_t nb_excp = 0;
+#endif /* !STATIC_ARP */
+	struct rte_mbuf *echo_pkts[PKT_BURST_SZ];
+	uint16_t nb_echo = 0;
 	uint64_t dpkts_mask, pkts_mask = (~0LLU) >> (64 - n);
 
 #ifdef FRAG
@@ -320,34 +325,27 @@ static uint64_t ul_in_ah(struct rte_mbuf **pkts, struct rte_mbuf **data_pkts,
 #endif /* FRAG */
 
 		ul_set_flow_id(m);
-		switch (s1u_pktyp) {
+		switch (RTE_PER_LCORE(s1u_pktyp)) {
 			case GTPU_PKT:
 				/* Update UL fastpath packets count */
-				epc_app.ul_params[S1U_PORT_ID].pkts_in++;
+				EPC_UL_PARAMS.pkts_in++;
 				/* Update GTPU alloc UL mbuf count */
-				epc_app.ul_params[pid].ul_mbuf_rtime.gtpu++;
+				EPC_UL_PARAMS.ul_mbuf_rtime.gtpu++;
 				break;
-#ifdef STATIC_ARP
 			case GTPU_ECHO_REQ:
+				/* Answered in place after the loop */
 				RESET_BIT(pkts_mask, i);
-				mngt_ingress(pkts[i], pid);
+				echo_pkts[nb_echo++] = m;
 				/* Update GTP_ECHO alloc UL count */
-				epc_app.ul_params[pid].ul_mbuf_rtime.gtp_echo++;
-				break;
-#else /* !STATIC_ARP == KNI */
-			case GTPU_ECHO_REQ:
-				RESET_BIT(pkts_mask, i);
-				mngt_ingress(pkts[i], pid);
-				/* Update GTP_ECHO alloc UL count */
-				epc_app.ul_params[pid].ul_mbuf_rtime.gtp_echo++;
+				EPC_UL_PARAMS.ul_mbuf_rtime.gtp_echo++;
 				break;
+#ifndef STATIC_ARP
 			case KNI_PKT:
 				RESET_BIT(pkts_mask, i);
-				RTE_LOG(DEBUG, DP, "KNI: UL send pkts to kni\n");
-				kni_ingress(kni_port_params_array[pid], pid,
-						&pkts[i], 1);
+				/* Handed to the kernel after the loop */
+				excp_pkts[nb_excp++] = m;
 				/* Update KNI alloc UL count */
-				epc_app.ul_params[pid].ul_mbuf_rtime.kni++;
+				EPC_UL_PARAMS.ul_mbuf_rtime.kni++;
 				break;
 #endif /* STATIC_ARP */
 			/* RESET_BIT::
@@ -357,12 +355,19 @@ static uint64_t ul_in_ah(struct rte_mbuf **pkts, struct rte_mbuf **data_pkts,
 			default:
 				RESET_BIT(pkts_mask, i);
 				/* Update BAD_PKT alloc UL count */
-				epc_app.ul_params[pid].ul_mbuf_rtime.bad_pkt++;
+				EPC_UL_PARAMS.ul_mbuf_rtime.bad_pkt++;
 				RTE_LOG(DEBUG, DP, "s1u_pktyp::"
 						"\n\tGTPU_UNSUPPORTED | BAD_PKT | UNKNOWN_PKT\n");
 		}
 	}
 
+	if (nb_echo)
+		mngt_echo_reply(echo_pkts, nb_echo, pid);
+#ifndef STATIC_ARP
+	if (nb_excp)
+		excp_ingress(pid, excp_pkts, nb_excp);
+#endif /* !STATIC_ARP */
+
 	nb_data_pkts = compress((unsigned long *)pkts,(unsigned long *)data_pkts, pkts_mask, n);
 	*processed_pkts = data_pkts;
 
@@ -431,7 +436,7 @@ void epc_ul(void *args, port_pairs_t ip_op)
 		create_mixed_bursts(ul_procmbuf, nb_ulrx, ip_op.in_pid);
 #endif
 		/* Update total RX-ALLOC UL mbuf count */
-		epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.rx_alloc += nb_ulrx;
+		EPC_UL_PARAMS.ul_mbuf_rtime.rx_alloc += nb_ulrx;
 		nb_data_pkts=
 			ul_in_ah(ul_procmbuf, data_pkts,
 				&ul_processed_pkts, nb_ulrx, ip_op.in_pid);
@@ -448,34 +453,36 @@ void epc_ul(void *args, port_pairs_t ip_op)
 		if (nb_data_pkts) {
 			nb_ultx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid, ul_processed_pkts, nb_data_pkts);
 			/* Update TX+FREE UL mbuf count */
-			epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free += nb_ultx;
+			EPC_UL_PARAMS.ul_mbuf_rtime.tx_free += nb_ultx;
 		}
 
 		for (i = nb_ultx; i < nb_ulrx; i++) {
 			rte_pktmbuf_free(ul_processed_pkts[i]);
 			/* Update TX+FREE UL mbuf count */
-			epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free++;
+			EPC_UL_PARAMS.ul_mbuf_rtime.tx_free++;
 		}
 	}
 
 #ifndef STATIC_ARP
-	/** Handle the request mbufs sent from kernel space,
-	 *  Then analysis it and calls the specific actions for the specific requests.
-	 *  Finally constructs the response mbuf and puts it back to the resp_q.
-	 */
-	rte_kni_handle_request(kni_port_params_array[ip_op.in_pid]->kni[0]);
+	/* Kernel exception path egress is owned by the first worker only */
+	if (ip_op.in_qid != DEFAULT_QID)
+		return;
 
-	uint16_t pkt_rx = kni_egress(kni_port_params_array[ip_op.out_pid], data_pkts);
+	/* Pkts the kernel sent out of the egress port interface, polled
+	 * every --excp_poll_us */
+	uint16_t pkt_rx = excp_egress(ip_op.out_pid, data_pkts);
+	if (pkt_rx == 0)
+		return;
 #ifdef PCAP_GEN
 	dump_pcap(data_pkts, pkt_rx, pcap_dumper_west);
 #endif /* PCAP_GEN */
 	uint16_t pkt_tx = rte_eth_tx_burst(ip_op.out_pid, ip_op.out_qid, data_pkts, pkt_rx);
 	/* Update TX+FREE UL mbuf count */
-	epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free += pkt_tx;
+	EPC_UL_PARAMS.ul_mbuf_rtime.tx_free += pkt_tx;
 	for (i = pkt_tx; i < pkt_rx; i++) {
 		rte_pktmbuf_free(data_pkts[i]);
 		/* Update TX+FREE UL mbuf count */
-		epc_app.ul_params[ip_op.in_pid].ul_mbuf_rtime.tx_free++;
+		EPC_UL_PARAMS.ul_mbuf_rtime.tx_free++;
 	}
 	if (pkt_tx < pkt_rx) {
 		printf("ASR- Probe::%s::"
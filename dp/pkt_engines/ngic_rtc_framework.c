@@ -35,6 +35,7 @@
 #include <rte_cycles.h>
 #include <rte_timer.h>
 #include <rte_debug.h>
+#include <rte_pause.h>
 #include <cmdline_rdline.h>
 #include <cmdline_parse.h>
 #include <cmdline_socket.h>
@@ -45,24 +46,34 @@
 #include "meter.h"
 #include "acl_dp.h"
 #include "dp_commands.h"
+#include "mngtplane_handler.h"
+#include "tbl_rcu.h"
 
 struct rte_ring *epc_mct_spns_dns_rx;
-/* Rings for management messages (ARP, GTP ECHO) */
-struct rte_ring *mngt_ul_ring = NULL;
-struct rte_ring *mngt_dl_ring = NULL;
 
 struct epc_app_params epc_app = {
 	.core_mct = -1,
 	.core_iface = -1,
 	.core_spns_dns = -1,
-	.core_ul[S1U_PORT_ID] = -1,
-	.core_dl[SGI_PORT_ID] = -1,
+	.core_ul = { [0 ... (DP_MAX_WORKERS - 1)] = -1 },
+	.core_dl = { [0 ... (DP_MAX_WORKERS - 1)] = -1 },
+	.nb_workers = 1,
 };
 
+RTE_DEFINE_PER_LCORE(uint32_t, epc_wrk_id);
+struct epc_qs_state epc_qs[DP_MAX_LCORE];
+/* Per worker packet classification */
+RTE_DEFINE_PER_LCORE(enum pkt_types, s1u_pktyp);
+RTE_DEFINE_PER_LCORE(enum pkt_types, sgi_pktyp);
+
 static void *dp_zmq_thread(__rte_unused void *arg)
 {
-	while (1)
+	while (1) {
 		iface_remove_que(COMM_ZMQ);
+		ats_poll();
+		/* Free retired table entries */
+		tbl_rcu_poll();
+	}
 	return NULL; //GCC_Security flag
 }
 
@@ -72,6 +83,9 @@ static void *dp_zmq_thread(__rte_unused void *arg)
 static void epc_util_handler(__rte_unused void *arg,
 			__rte_unused port_pairs_t ip_op)
 {
+#ifndef STATIC_ARP
+	arp_resolver_core();
+#endif /* STATIC_ARP */
 	epc_stats_core();
 }
 
@@ -81,15 +95,6 @@ static void epc_util_handler(__rte_unused void *arg,
 static void epc_iface_core(__rte_unused void *args,
 						__rte_unused port_pairs_t ip_op)
 {
-	static int timer_mask;
-	if (timer_mask == 0) {
-		sigset_t mask;
-		sigemptyset(&mask);
-		sigaddset(&mask, SIGRTMIN);
-		if (sigprocmask(SIG_UNBLOCK, &mask, NULL) == -1)
-			RTE_LOG_DP(ERR, API, "sigprocmask error\n");
-		timer_mask = 1;
-	}
 #ifdef SIMU_CP /* SIMU_CP::Built-in session injection */
 	static int simu_call;
 
@@ -97,6 +102,8 @@ static void epc_iface_core(__rte_unused void *args,
 		simu_cp();
 		simu_call = 1;
 	}
+	/* Free retired table entries */
+	tbl_rcu_poll();
 #else /* !SIMU_CP::Live session injection */
 	uint32_t lcore;
 
@@ -121,8 +128,12 @@ static void epc_iface_core(__rte_unused void *args,
 	 */
 	while (1) {
 		iface_remove_que(COMM_ZMQ);
+		/* Run due session time threshold timers */
+		ats_poll();
 		/* Process CDR messages */
 		process_cdr_queue();
+		/* Free retired table entries */
+		tbl_rcu_poll();
 #ifdef HYPERSCAN_DPI
 		scan_dns_ring();
 #endif /* HYPERSCAN_DPI */
@@ -136,27 +147,12 @@ static void epc_iface_core(__rte_unused void *args,
  */
 static void epc_stats_init(void)
 {
-	epc_app.ul_params[S1U_PORT_ID].pkts_in = 0,
-	epc_app.ul_params[S1U_PORT_ID].pkts_out = 0,
-	epc_app.ul_params[S1U_PORT_ID].tot_ul_bytes = 0,
-
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.rx_alloc = 0;
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.gtpu = 0;
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.gtp_echo = 0;
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.kni = 0;
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.bad_pkt = 0;
-	epc_app.ul_params[S1U_PORT_ID].ul_mbuf_rtime.tx_free = 0;
-
-	epc_app.dl_params[SGI_PORT_ID].pkts_in = 0,
-	epc_app.dl_params[SGI_PORT_ID].pkts_out = 0,
-	epc_app.dl_params[SGI_PORT_ID].tot_dl_bytes = 0,
-	epc_app.dl_params[SGI_PORT_ID].ddn = 0,
-
-	epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.rx_alloc = 0;
-	epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.dl_pkt = 0;
-	epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.kni = 0;
-	epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.bad_pkt = 0;
-	epc_app.dl_params[SGI_PORT_ID].dl_mbuf_rtime.tx_free = 0;
+	uint32_t wrk;
+
+	for (wrk = 0; wrk < DP_MAX_WORKERS; wrk++) {
+		memset(&epc_app.ul_params[wrk], 0, sizeof(struct epc_ul_params));
+		memset(&epc_app.dl_params[wrk], 0, sizeof(struct epc_dl_params));
+	}
 }
 
 /**
@@ -178,26 +174,31 @@ static void epc_init_lcores(void)
 	epc_alloc_lcore(epc_iface_core, NULL, epc_app.core_iface,
 					null_port_pair);
 
-	/* UL Port Pair */
-	port_pairs_t ul_port_pair = {
-		.in_pid = S1U_PORT_ID,
-		.in_qid = DEFAULT_QID,
-		.out_pid = SGI_PORT_ID,
-		.out_qid = DEFAULT_QID
-	};
-	epc_alloc_lcore(epc_ul, &epc_app.ul_params[S1U_PORT_ID],
-						epc_app.core_ul[S1U_PORT_ID],
-						ul_port_pair);
-	/* DL Port Pair */
-	port_pairs_t dl_port_pair = {
-		.in_pid = SGI_PORT_ID,
-		.in_qid = DEFAULT_QID,
-		.out_pid = S1U_PORT_ID,
-		.out_qid = DEFAULT_QID
-	};
-	epc_alloc_lcore(epc_dl, &epc_app.dl_params[SGI_PORT_ID],
-						epc_app.core_dl[SGI_PORT_ID],
-						dl_port_pair);
+	/* One UL and one DL worker per RSS queue: worker 'wrk' polls queue
+	 * 'wrk' of its input port and transmits on queue 'wrk' of its output
+	 * port, so no TX queue is shared between workers */
+	for (uint32_t wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		/* UL Port Pair */
+		port_pairs_t ul_port_pair = {
+			.in_pid = S1U_PORT_ID,
+			.in_qid = wrk,
+			.out_pid = SGI_PORT_ID,
+			.out_qid = wrk
+		};
+		epc_alloc_lcore(epc_ul, &epc_app.ul_params[wrk],
+							epc_app.core_ul[wrk],
+							ul_port_pair);
+		/* DL Port Pair */
+		port_pairs_t dl_port_pair = {
+			.in_pid = SGI_PORT_ID,
+			.in_qid = wrk,
+			.out_pid = S1U_PORT_ID,
+			.out_qid = wrk
+		};
+		epc_alloc_lcore(epc_dl, &epc_app.dl_params[wrk],
+							epc_app.core_dl[wrk],
+							dl_port_pair);
+	}
 }
 
 /* initialize rings common to all ngic-rtc flows */
@@ -214,18 +215,6 @@ static void epc_init_rings(void)
 				RING_F_SC_DEQ);
 	if (epc_mct_spns_dns_rx == NULL)
 		rte_panic("Cannot create RX ring %u\n", port);
-
-	mngt_ul_ring = rte_ring_create("UL_MNGT_ring", RXTX_RING_SIZE,
-			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
-	if (mngt_ul_ring == NULL) {
-		rte_exit(EXIT_FAILURE, "Error in creating mngt_ul_ring!!!\n");
-	}
-	mngt_dl_ring = rte_ring_create("DL_MNGT_ring", RXTX_RING_SIZE,
-			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
-	if (mngt_dl_ring == NULL) {
-		rte_exit(EXIT_FAILURE, "Error in creating mngt_dl_ring!!!\n");
-	}
-
 }
 
 static inline void ngic_rtc_run(void)
@@ -240,6 +229,7 @@ static inline void ngic_rtc_run(void)
 		config->launch.func(config->launch.arg,
 							config->launch.ip_op_ports);
 	}
+	epc_qs_quiescent();
 }
 
 static int epc_lcore_main_loop(__attribute__ ((unused))
@@ -254,6 +244,16 @@ static int epc_lcore_main_loop(__attribute__ ((unused))
 	if (config->allocated == 0)
 		return 0;
 
+	/* UL/DL workers: worker index == RX queue id served. Workers and
+	 * the mct lcore (ARP resolver) take part in grace periods, the iface
+	 * core never returns to the poll loop */
+	if (config->launch.ip_op_ports.in_qid >= 0) {
+		RTE_PER_LCORE(epc_wrk_id) = config->launch.ip_op_ports.in_qid;
+		epc_qs_online();
+	} else if (lcore == (uint32_t)epc_app.core_mct) {
+		epc_qs_online();
+	}
+
 	RTE_LOG_DP(NOTICE, DP, "RTE NOTICE enabled on lcore %d\n", lcore);
 	RTE_LOG_DP(INFO, DP, "RTE INFO enabled on lcore %d\n", lcore);
 	RTE_LOG_DP(DEBUG, DP, "RTE DEBUG enabled on lcore %d\n", lcore);
@@ -289,8 +289,10 @@ void init_ngic_rtc_framework(uint8_t east_port_id, uint8_t west_port_id)
 	epc_spns_dns_init();
 #endif
 
-	printf("Uplink Core on:\t\t\t%d\n", epc_app.core_ul[S1U_PORT_ID]);
-	printf("Downlink Core on:\t\t%d\n", epc_app.core_dl[SGI_PORT_ID]);
+	for (uint32_t wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		printf("Uplink Core[%u] on:\t\t%d\n", wrk, epc_app.core_ul[wrk]);
+		printf("Downlink Core[%u] on:\t\t%d\n", wrk, epc_app.core_dl[wrk]);
+	}
 
 	/*
 	 * ngic-rtc map function to: Cores | Ports | Queues
@@ -340,3 +342,51 @@ void epc_alloc_lcore(ngic_rtc_func_t func, void *arg,
 	lcore->launch.ip_op_ports = ip_op;
 	lcore->allocated++;
 }
+
+void epc_qs_online(void)
+{
+	epc_qs[rte_lcore_id()].cnt++;
+	epc_qs[rte_lcore_id()].online = 1;
+	rte_smp_mb();
+}
+
+void epc_qs_offline(void)
+{
+	rte_smp_mb();
+	epc_qs[rte_lcore_id()].online = 0;
+}
+
+void epc_qs_start(struct epc_qs_token *tok)
+{
+	unsigned lcore;
+
+	/* Publish the writer's updates before sampling the counters */
+	rte_smp_mb();
+	for (lcore = 0; lcore < DP_MAX_LCORE; lcore++)
+		tok->cnt[lcore] = epc_qs[lcore].cnt;
+	tok->self = rte_lcore_id();
+}
+
+int epc_qs_check(const struct epc_qs_token *tok)
+{
+	unsigned lcore;
+
+	for (lcore = 0; lcore < DP_MAX_LCORE; lcore++) {
+		if (lcore == tok->self)
+			continue;
+		if (epc_qs[lcore].online && epc_qs[lcore].cnt == tok->cnt[lcore])
+			return 0;
+	}
+	/* Order the readers' accesses before the caller's reuse */
+	rte_smp_mb();
+	return 1;
+}
+
+void epc_synchronize(void)
+{
+	struct epc_qs_token tok;
+
+	epc_qs_start(&tok);
+	while (!epc_qs_check(&tok))
+		rte_pause();
+}
@@ -24,6 +24,9 @@
  * Data Plane function prototypes
  */
 #include <rte_port.h>
+#include <rte_per_lcore.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
 #include <rte_hash_crc.h>
 
 #include "interface.h"
@@ -62,6 +65,13 @@ extern uint64_t num_dns_processed;
  */
 #define DEFAULT_QID   0
 
+/**
+ * Max number of UL (and DL) worker cores. Each worker polls its own RSS
+ * queue on the input port and transmits on the same queue id of the
+ * output port.
+ */
+#define DP_MAX_WORKERS 8
+
 #define DL_RINGS_THRESHOLD 32
 
 /* Per worker macros for DDN */
@@ -129,7 +139,7 @@ enum pkt_types {
 /**
  * Packet Types
  */
-enum pkt_types s1u_pktyp;
+RTE_DECLARE_PER_LCORE(enum pkt_types, s1u_pktyp);
 
 struct epc_ul_params {
 	/** Number of dns packets cloned by this worker */
@@ -169,7 +179,7 @@ struct epc_ul_params {
 typedef int (*ul_handler) (struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask);
 
 /** DL ngic_rtc parameters - Per input port */
-enum pkt_types sgi_pktyp;
+RTE_DECLARE_PER_LCORE(enum pkt_types, sgi_pktyp);
 
 struct epc_dl_params {
 	/** Number of dns packets cloned by this worker */
@@ -248,8 +258,10 @@ struct epc_app_params {
 	int core_mct;           /* ASR- Note:: core_mct == core_stats */
 	int core_iface;
 	int core_spns_dns;
-	int core_ul[NUM_SPGW_PORTS];
-	int core_dl[NUM_SPGW_PORTS];
+	int core_ul[DP_MAX_WORKERS];
+	int core_dl[DP_MAX_WORKERS];
+	/* Number of UL/DL worker pairs == RX queues per port */
+	uint32_t nb_workers;
 
 	/* Ports */
 	uint32_t ports[NUM_SPGW_PORTS];
@@ -257,12 +269,90 @@ struct epc_app_params {
 	/* Rx rings */
 	struct rte_ring *epc_mct_spns_dns_rx;
 
-	/* ngic_rtc packet processing core params */
-	struct epc_ul_params ul_params[NUM_SPGW_PORTS];
-	struct epc_dl_params dl_params[NUM_SPGW_PORTS];
+	/* ngic_rtc packet processing core params - Per worker */
+	struct epc_ul_params ul_params[DP_MAX_WORKERS];
+	struct epc_dl_params dl_params[DP_MAX_WORKERS];
 } __rte_cache_aligned;
 extern struct epc_app_params epc_app;
 
+/**
+ * Worker index of the calling lcore, i.e. the RX/TX queue id it owns.
+ * Non worker lcores run with index 0.
+ */
+RTE_DECLARE_PER_LCORE(uint32_t, epc_wrk_id);
+
+/** UL params of the calling UL worker */
+#define EPC_UL_PARAMS (epc_app.ul_params[RTE_PER_LCORE(epc_wrk_id)])
+/** DL params of the calling DL worker */
+#define EPC_DL_PARAMS (epc_app.dl_params[RTE_PER_LCORE(epc_wrk_id)])
+
+/** TX queue of the mct lcore, next to the UL/DL worker TX queues */
+#define EPC_CTRL_TXQ (epc_app.nb_workers)
+
+/** TX queue of UL worker 'wrk' on its RX port, for GTP-U echo responses */
+#define EPC_ECHO_TXQ(wrk) (EPC_CTRL_TXQ + 1 + (wrk))
+
+/**
+ * Quiescent state of a worker lcore. A worker holds no reference into
+ * shared tables (ACL contexts, session, PCC and ADC entries, ...) between
+ * two poll loop iterations, i.e. two bursts; it then bumps 'cnt'. Control
+ * threads wait for every online worker to move its 'cnt' (a grace period)
+ * before reusing retired memory.
+ */
+struct epc_qs_state {
+	/* Quiescent state counter, bumped once per poll loop */
+	volatile uint64_t cnt;
+	/* Set while the lcore takes part in grace periods */
+	volatile uint32_t online;
+} __rte_cache_aligned;
+extern struct epc_qs_state epc_qs[DP_MAX_LCORE];
+
+/**
+ * Report a quiescent state for the calling worker lcore.
+ */
+static inline void epc_qs_quiescent(void)
+{
+	/* Order the burst's table reads before the counter update */
+	rte_smp_mb();
+	epc_qs[rte_lcore_id()].cnt++;
+}
+
+/**
+ * Register/unregister the calling lcore as a grace period participant.
+ */
+void epc_qs_online(void);
+void epc_qs_offline(void);
+
+/**
+ * Grace period started by epc_qs_start: worker counters at its start.
+ */
+struct epc_qs_token {
+	uint64_t cnt[DP_MAX_LCORE];
+	/* lcore of the caller, not waited for */
+	unsigned self;
+};
+
+/**
+ * Start a grace period, without waiting for it. Memory retired before
+ * the call may be reused once epc_qs_check returns 1.
+ */
+void epc_qs_start(struct epc_qs_token *tok);
+
+/**
+ * Poll a grace period started by epc_qs_start.
+ * @return
+ *	1 once every online worker lcore, other than the caller, went
+ *	through a quiescent state since the start, 0 before.
+ */
+int epc_qs_check(const struct epc_qs_token *tok);
+
+/**
+ * Wait for a grace period: returns once every online worker lcore,
+ * other than the caller, went through a quiescent state.
+ * Must not be called from a worker fast path.
+ */
+void epc_synchronize(void);
+
 /**
  * Adds ngic_rtc function to cores, ports and queue to run
  *
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <arpa/inet.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_lpm.h>
+#include <rte_spinlock.h>
+
+#include "main.h"
+#include "mngtplane_handler.h"
+#include "route_fib.h"
+
+/* Next hop index of a rte_lpm lookup result */
+#define ROUTE_FIB_NH_MASK	0x00ffffff
+/* No default route */
+#define ROUTE_FIB_NO_NH		UINT32_MAX
+
+/**
+ * Next hop entry, indexed by the rte_lpm next hop.
+ */
+struct route_fib_nh {
+	/** gateway, network order, 0 if on-link */
+	uint32_t gw;
+};
+
+/**
+ * Route table. rte_lpm rules are 1 to 32 bits deep, the default route
+ * is kept aside.
+ */
+struct route_fib_tbl {
+	struct rte_lpm *lpm;
+	/** next hop of the default route, ROUTE_FIB_NO_NH if none */
+	uint32_t dflt;
+};
+
+/**
+ * Update made to the shadow table, replayed on the other table once
+ * the shadow table is active.
+ */
+struct route_fib_upd {
+	/** prefix, host order */
+	uint32_t ip;
+	uint8_t depth;
+	/** 1 for add, 0 for delete */
+	uint8_t add;
+	/** next hop of an add */
+	uint32_t nh;
+};
+
+static struct route_fib_tbl route_fib_tbl[2];
+/* Index of the active table, the other one is the shadow */
+static volatile uint32_t route_fib_active;
+
+static struct route_fib_nh route_fib_nh[ROUTE_FIB_MAX_RULES];
+
+/* Writer state */
+static rte_spinlock_t route_fib_lock = RTE_SPINLOCK_INITIALIZER;
+static uint32_t route_fib_free[ROUTE_FIB_MAX_RULES];
+static uint32_t route_fib_nb_free;
+/* Updates and next hops released since the last commit */
+static struct route_fib_upd route_fib_log[ROUTE_FIB_LOG_MAX];
+static uint32_t route_fib_nb_log;
+static uint32_t route_fib_retired[ROUTE_FIB_LOG_MAX];
+static uint32_t route_fib_nb_retired;
+
+int
+route_fib_init(void)
+{
+	struct rte_lpm_config config = {
+		.max_rules = ROUTE_FIB_MAX_RULES,
+		.number_tbl8s = ROUTE_FIB_NUMBER_TBL8S,
+		.flags = 0,
+	};
+	char name[RTE_LPM_NAMESIZE];
+	uint32_t i;
+
+	for (i = 0; i < RTE_DIM(route_fib_tbl); i++) {
+		snprintf(name, sizeof(name), "ROUTE_FIB_%u", i);
+		route_fib_tbl[i].lpm = rte_lpm_create(name, rte_socket_id(),
+				&config);
+		if (route_fib_tbl[i].lpm == NULL) {
+			RTE_LOG_DP(ERR, DP, "%s create failed: %s\n", name,
+					rte_strerror(rte_errno));
+			return -1;
+		}
+		route_fib_tbl[i].dflt = ROUTE_FIB_NO_NH;
+	}
+
+	for (i = 0; i < ROUTE_FIB_MAX_RULES; i++)
+		route_fib_free[i] = ROUTE_FIB_MAX_RULES - 1 - i;
+	route_fib_nb_free = ROUTE_FIB_MAX_RULES;
+
+	return 0;
+}
+
+/**
+ * Apply an update to a table.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+route_fib_apply(struct route_fib_tbl *t, const struct route_fib_upd *u)
+{
+	if (u->depth == 0) {
+		t->dflt = u->add ? u->nh : ROUTE_FIB_NO_NH;
+		return 0;
+	}
+
+	if (u->add)
+		return rte_lpm_add(t->lpm, u->ip, u->depth, u->nh) < 0 ? -1 : 0;
+	return rte_lpm_delete(t->lpm, u->ip, u->depth) < 0 ? -1 : 0;
+}
+
+/**
+ * Next hop of a rule of the shadow table.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if no such rule
+ */
+static int
+route_fib_rule(const struct route_fib_tbl *t, uint32_t ip, uint8_t depth,
+		uint32_t *nh)
+{
+	if (depth == 0) {
+		*nh = t->dflt;
+		return t->dflt == ROUTE_FIB_NO_NH ? -1 : 0;
+	}
+	return rte_lpm_is_rule_present(t->lpm, ip, depth, nh) == 1 ? 0 : -1;
+}
+
+/**
+ * Swap the tables, wait for workers to leave the former active table,
+ * replay the log on it, and release the retired next hops. Route lock
+ * held.
+ */
+static void
+route_fib_swap(void)
+{
+	struct route_fib_tbl *t;
+	uint32_t i;
+
+	if (route_fib_nb_log == 0)
+		return;
+
+	/* Next hop entries before the table pointing to them */
+	rte_smp_wmb();
+	route_fib_active ^= 1;
+	nh_gen_bump();
+	epc_synchronize();
+
+	/* Same updates, in the same order, on an equal table: only fails
+	 * if the shadow update did */
+	t = &route_fib_tbl[route_fib_active ^ 1];
+	for (i = 0; i < route_fib_nb_log; i++) {
+		if (route_fib_apply(t, &route_fib_log[i]) < 0)
+			rte_panic("ROUTE: replay of 0x%08x/%u failed\n",
+					route_fib_log[i].ip,
+					route_fib_log[i].depth);
+	}
+
+	for (i = 0; i < route_fib_nb_retired; i++)
+		route_fib_free[route_fib_nb_free++] = route_fib_retired[i];
+	route_fib_nb_log = 0;
+	route_fib_nb_retired = 0;
+}
+
+/**
+ * Apply an update to the shadow table and log it. Route lock held.
+ *
+ * @param old_nh
+ *	next hop the update releases, ROUTE_FIB_NO_NH if none.
+ */
+static int
+route_fib_update(struct route_fib_upd *u, uint32_t old_nh)
+{
+	if (route_fib_apply(&route_fib_tbl[route_fib_active ^ 1], u) < 0)
+		return -1;
+
+	route_fib_log[route_fib_nb_log++] = *u;
+	if (old_nh != ROUTE_FIB_NO_NH)
+		route_fib_retired[route_fib_nb_retired++] = old_nh;
+	return 0;
+}
+
+int
+route_fib_add(uint32_t prefix, uint8_t depth, uint32_t gw)
+{
+	struct route_fib_upd u;
+	uint32_t old_nh;
+	int ret = -1;
+
+	if (depth > 32)
+		return -1;
+
+	u.ip = depth ? ntohl(prefix) & (UINT32_MAX << (32 - depth)) : 0;
+	u.depth = depth;
+	u.add = 1;
+
+	rte_spinlock_lock(&route_fib_lock);
+	if (route_fib_nb_log == ROUTE_FIB_LOG_MAX)
+		route_fib_swap();
+
+	if (route_fib_rule(&route_fib_tbl[route_fib_active ^ 1], u.ip, depth,
+				&old_nh) < 0)
+		old_nh = ROUTE_FIB_NO_NH;
+	else if (route_fib_nh[old_nh].gw == gw) {
+		ret = 0;
+		goto out;
+	}
+
+	/* Next hop entries are not rewritten in place: workers may be
+	 * reading the old one */
+	if (route_fib_nb_free == 0)
+		goto out;
+	u.nh = route_fib_free[--route_fib_nb_free];
+	route_fib_nh[u.nh].gw = gw;
+
+	ret = route_fib_update(&u, old_nh);
+	if (ret < 0)
+		route_fib_free[route_fib_nb_free++] = u.nh;
+out:
+	rte_spinlock_unlock(&route_fib_lock);
+	return ret;
+}
+
+int
+route_fib_del(uint32_t prefix, uint8_t depth)
+{
+	struct route_fib_upd u;
+	uint32_t old_nh;
+	int ret = -1;
+
+	if (depth > 32)
+		return -1;
+
+	u.ip = depth ? ntohl(prefix) & (UINT32_MAX << (32 - depth)) : 0;
+	u.depth = depth;
+	u.add = 0;
+	u.nh = 0;
+
+	rte_spinlock_lock(&route_fib_lock);
+	if (route_fib_nb_log == ROUTE_FIB_LOG_MAX)
+		route_fib_swap();
+
+	if (route_fib_rule(&route_fib_tbl[route_fib_active ^ 1], u.ip, depth,
+				&old_nh) == 0)
+		ret = route_fib_update(&u, old_nh);
+	rte_spinlock_unlock(&route_fib_lock);
+
+	return ret;
+}
+
+void
+route_fib_commit(void)
+{
+	rte_spinlock_lock(&route_fib_lock);
+	route_fib_swap();
+	rte_spinlock_unlock(&route_fib_lock);
+}
+
+int
+route_fib_lookup(uint32_t ip, uint32_t *nh_ip)
+{
+	const struct route_fib_tbl *t = &route_fib_tbl[route_fib_active];
+	uint32_t nh, gw;
+
+	if (rte_lpm_lookup(t->lpm, ntohl(ip), &nh) < 0) {
+		nh = t->dflt;
+		if (nh == ROUTE_FIB_NO_NH)
+			return -1;
+	}
+
+	gw = route_fib_nh[nh].gw;
+	*nh_ip = gw ? gw : ip;
+	return 0;
+}
+
+uint64_t
+route_fib_lookup_bulk(const uint32_t *ip, uint32_t n, uint32_t *nh_ip)
+{
+	const struct route_fib_tbl *t = &route_fib_tbl[route_fib_active];
+	uint32_t host_ip[MAX_BURST_SZ];
+	uint32_t hop[MAX_BURST_SZ];
+	uint64_t hits = 0;
+	uint32_t i, nh, gw;
+
+	for (i = 0; i < n; i++)
+		host_ip[i] = ntohl(ip[i]);
+
+	rte_lpm_lookup_bulk(t->lpm, host_ip, hop, n);
+
+	for (i = 0; i < n; i++) {
+		if (hop[i] & RTE_LPM_LOOKUP_SUCCESS)
+			nh = hop[i] & ROUTE_FIB_NH_MASK;
+		else if (t->dflt != ROUTE_FIB_NO_NH)
+			nh = t->dflt;
+		else
+			continue;
+
+		gw = route_fib_nh[nh].gw;
+		nh_ip[i] = gw ? gw : ip[i];
+		SET_BIT(hits, i);
+	}
+
+	return hits;
+}
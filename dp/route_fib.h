@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ROUTE_FIB_H_
+#define _ROUTE_FIB_H_
+/**
+ * @file
+ * Longest prefix match route table (FIB), mapping a destination to its
+ * next hop: the route gateway, or the destination itself when on-link.
+ * Fed by the netlink listener, or by the [route] section of the static
+ * ARP config under STATIC_ARP.
+ *
+ * Two rte_lpm tables, active and shadow. Workers look the active table
+ * up without locks. The writer adds and deletes rules in the shadow
+ * table and logs them; route_fib_commit makes the shadow table active,
+ * waits for a grace period (epc_synchronize) so no worker still reads
+ * the former active table, and replays the log on it, making it the
+ * new shadow. Next hop entries of replaced or deleted rules are reused
+ * only after that grace period.
+ */
+#include <stdint.h>
+
+/* Rules per table */
+#define ROUTE_FIB_MAX_RULES	4096
+/* tbl8 groups per table, one per distinct /24 with longer prefixes */
+#define ROUTE_FIB_NUMBER_TBL8S	256
+/* Updates logged between commits; a full log is committed */
+#define ROUTE_FIB_LOG_MAX	256
+
+/**
+ * Create the route tables.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int
+route_fib_init(void);
+
+/**
+ * Add or replace a route in the shadow table. Single writer.
+ *
+ * @param prefix
+ *	destination prefix, network order.
+ * @param depth
+ *	prefix length, 0 to 32.
+ * @param gw
+ *	gateway, network order, 0 if on-link.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int
+route_fib_add(uint32_t prefix, uint8_t depth, uint32_t gw);
+
+/**
+ * Delete a route from the shadow table. Single writer.
+ *
+ * @param prefix
+ *	destination prefix, network order.
+ * @param depth
+ *	prefix length, 0 to 32.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if no such route
+ */
+int
+route_fib_del(uint32_t prefix, uint8_t depth);
+
+/**
+ * Make the updates since the last commit visible to workers, and bring
+ * the former active table up to date. Waits for a grace period when
+ * there are updates. Single writer.
+ */
+void
+route_fib_commit(void);
+
+/**
+ * Next hop of a destination. Lock-free, safe on worker lcores.
+ *
+ * @param ip
+ *	destination, network order.
+ * @param nh_ip
+ *	next hop, network order: route gateway, or ip if on-link.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if no route
+ */
+int
+route_fib_lookup(uint32_t ip, uint32_t *nh_ip);
+
+/**
+ * Next hops of a burst of destinations, as route_fib_lookup, with one
+ * rte_lpm_lookup_bulk call.
+ *
+ * @param ip
+ *	destinations, network order.
+ * @param n
+ *	number of destinations, at most 64.
+ * @param nh_ip
+ *	next hop of each destination with a route, network order.
+ *
+ * @return
+ *	bit set for each destination with a route.
+ */
+uint64_t
+route_fib_lookup_bulk(const uint32_t *ip, uint32_t n, uint32_t *nh_ip);
+
+#endif /* _ROUTE_FIB_H_ */
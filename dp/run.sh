@@ -131,6 +131,38 @@ if [ -n "${SGI_GW_IP}" ]; then
 	ARGS="$ARGS --sgi_gw_ip $SGI_GW_IP"
 fi
 
+if [ -n "${NUM_WORKERS}" ]; then
+	ARGS="$ARGS --num_workers $NUM_WORKERS"
+fi
+
+if [ -n "${MAX_SESSIONS}" ]; then
+	ARGS="$ARGS --max_sessions $MAX_SESSIONS"
+fi
+
+if [ -n "${GTPU_SPORT}" ]; then
+	ARGS="$ARGS --gtpu_sport $GTPU_SPORT"
+fi
+
+if [ -n "${ARP_MAX_AGE}" ]; then
+	ARGS="$ARGS --arp_max_age $ARP_MAX_AGE"
+fi
+
+if [ -n "${ARP_REFRESH}" ]; then
+	ARGS="$ARGS --arp_refresh $ARP_REFRESH"
+fi
+
+if [ -n "${ARP_NEG_HOLD}" ]; then
+	ARGS="$ARGS --arp_neg_hold $ARP_NEG_HOLD"
+fi
+
+if [ -n "${EXCP_PATH}" ]; then
+	ARGS="$ARGS --excp_path $EXCP_PATH"
+fi
+
+if [ -n "${EXCP_POLL_US}" ]; then
+	ARGS="$ARGS --excp_poll_us $EXCP_POLL_US"
+fi
+
 echo $ARGS | sed -e $'s/--/\\\n\\t--/g'
 
 USAGE="\nUsage:\trun.sh [ log | debug | dbg-dpdk | optm-dpdk]
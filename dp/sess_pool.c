@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+
+#include "main.h"
+#include "sess_pool.h"
+
+/* Pools hold up to millions of objects, each read by address only:
+ * no padding to spread objects over memory channels. */
+#define SESS_POOL_FLAGS		MEMPOOL_F_NO_SPREAD
+
+static struct rte_mempool *sess_pools[SESS_POOL_MAX][RTE_MAX_NUMA_NODES];
+
+static const struct {
+	const char *name;
+	uint32_t size;
+} sess_pool_desc[SESS_POOL_MAX] = {
+	[SESS_POOL_BEARER] = {"SESS_BEAR", sizeof(struct dp_session_info)},
+	[SESS_POOL_UE] = {"SESS_UE", sizeof(struct ue_session_info)},
+	[SESS_POOL_SDF] = {"SESS_SDF", sizeof(struct dp_sdf_per_bearer_info)},
+	[SESS_POOL_ADC_UE] = {"SESS_ADC_UE", sizeof(struct dp_adc_ue_info)},
+	[SESS_POOL_CLI] = {"SESS_CLI", sizeof(dp_sess_strct)},
+};
+
+/**
+ * Objects of a type for nb_sess bearer sessions, over all sockets. Every
+ * UE has a bearer: UE counts are bounded by nb_sess.
+ */
+static uint32_t
+sess_pool_size(enum sess_pool_type type, uint32_t nb_sess)
+{
+	switch (type) {
+	case SESS_POOL_SDF:
+		return nb_sess * SESS_POOL_SDF_PER_BEARER;
+	case SESS_POOL_ADC_UE:
+		return nb_sess * SESS_POOL_ADC_PER_UE;
+	default:
+		return nb_sess;
+	}
+}
+
+/**
+ * Mark the sockets with an enabled lcore.
+ * @return
+ *	number of sockets marked.
+ */
+static uint32_t
+sess_pool_sockets(uint8_t on_socket[RTE_MAX_NUMA_NODES])
+{
+	uint32_t nb_sockets = 0;
+	unsigned int lcore, s;
+
+	RTE_LCORE_FOREACH(lcore) {
+		s = rte_lcore_to_socket_id(lcore);
+		if (!on_socket[s])
+			nb_sockets++;
+		on_socket[s] = 1;
+	}
+
+	return nb_sockets;
+}
+
+/**
+ * Objects per socket of a pool, and their cache size.
+ */
+static uint32_t
+sess_pool_per_socket(enum sess_pool_type type, uint32_t nb_sess,
+		uint32_t nb_sockets, uint32_t *cache)
+{
+	uint32_t n = RTE_MAX(sess_pool_size(type, nb_sess) / nb_sockets, 1U);
+
+	*cache = RTE_MIN(SESS_POOL_CACHE_SIZE, n / 2);
+	return n;
+}
+
+void
+sess_pool_budget(uint32_t nb_sess, uint64_t need[RTE_MAX_NUMA_NODES])
+{
+	uint8_t on_socket[RTE_MAX_NUMA_NODES] = {0};
+	struct rte_mempool_objsz sz;
+	uint32_t nb_sockets, n, cache;
+	unsigned int s;
+	int type;
+
+	nb_sockets = sess_pool_sockets(on_socket);
+	for (type = 0; type < SESS_POOL_MAX; type++) {
+		n = sess_pool_per_socket(type, nb_sess, nb_sockets, &cache);
+		rte_mempool_calc_obj_size(sess_pool_desc[type].size,
+				SESS_POOL_FLAGS, &sz);
+		for (s = 0; s < RTE_MAX_NUMA_NODES; s++) {
+			if (!on_socket[s])
+				continue;
+			need[s] += (uint64_t)n * sz.total_size;
+			if (cache)
+				need[s] += sizeof(struct rte_mempool_cache) *
+					RTE_MAX_LCORE;
+		}
+	}
+}
+
+int
+sess_pool_init(uint32_t nb_sess)
+{
+	uint8_t on_socket[RTE_MAX_NUMA_NODES] = {0};
+	char name[RTE_MEMPOOL_NAMESIZE];
+	uint32_t nb_sockets, n, cache;
+	uint64_t total = 0;
+	unsigned int s;
+	int type;
+
+	nb_sockets = sess_pool_sockets(on_socket);
+
+	/* Split each pool over the sockets: capacity and memory are the
+	 * same on any topology, allocation falls back to remote sockets. */
+	for (type = 0; type < SESS_POOL_MAX; type++) {
+		n = sess_pool_per_socket(type, nb_sess, nb_sockets, &cache);
+
+		for (s = 0; s < RTE_MAX_NUMA_NODES; s++) {
+			if (!on_socket[s] || sess_pools[type][s] != NULL)
+				continue;
+			snprintf(name, sizeof(name), "%s_%u",
+					sess_pool_desc[type].name, s);
+			sess_pools[type][s] = rte_mempool_create(name, n,
+					sess_pool_desc[type].size, cache, 0,
+					NULL, NULL, NULL, NULL, s,
+					SESS_POOL_FLAGS);
+			if (sess_pools[type][s] == NULL) {
+				RTE_LOG_DP(ERR, DP, "%s pool create failed: %s\n",
+						name, rte_strerror(rte_errno));
+				return -1;
+			}
+			total += (uint64_t)n * sess_pool_desc[type].size;
+		}
+	}
+
+	RTE_LOG_DP(INFO, DP, "Session pools: %u sessions on %u sockets, %"PRIu64
+			" MB\n", nb_sess, nb_sockets, total >> 20);
+	return 0;
+}
+
+/**
+ * Get n objects, local socket pool first.
+ */
+static int
+sess_pool_get_bulk(enum sess_pool_type type, void **obj, uint32_t n)
+{
+	unsigned int local = rte_socket_id();
+	unsigned int s;
+
+	if (local < RTE_MAX_NUMA_NODES && sess_pools[type][local] != NULL &&
+			rte_mempool_get_bulk(sess_pools[type][local], obj, n) == 0)
+		return 0;
+
+	for (s = 0; s < RTE_MAX_NUMA_NODES; s++) {
+		if (s == local || sess_pools[type][s] == NULL)
+			continue;
+		if (rte_mempool_get_bulk(sess_pools[type][s], obj, n) == 0)
+			return 0;
+	}
+
+	return -1;
+}
+
+void *
+sess_pool_alloc(enum sess_pool_type type)
+{
+	void *obj;
+
+	if (sess_pool_get_bulk(type, &obj, 1) < 0)
+		return NULL;
+
+	memset(obj, 0, sess_pool_desc[type].size);
+	return obj;
+}
+
+int
+sess_pool_alloc_bulk(enum sess_pool_type type, void **obj, uint32_t n)
+{
+	uint32_t i;
+
+	if (sess_pool_get_bulk(type, obj, n) < 0)
+		return -1;
+
+	for (i = 0; i < n; i++)
+		memset(obj[i], 0, sess_pool_desc[type].size);
+	return 0;
+}
+
+void
+sess_pool_free(void *obj)
+{
+	if (obj != NULL)
+		rte_mempool_put(rte_mempool_from_obj(obj), obj);
+}
+
+void
+sess_pool_free_bulk(void **obj, uint32_t n)
+{
+	struct rte_mempool *mp;
+	uint32_t i = 0, first;
+
+	/* One put per run of objects from the same pool */
+	while (i < n) {
+		if (obj[i] == NULL) {
+			i++;
+			continue;
+		}
+		mp = rte_mempool_from_obj(obj[i]);
+		first = i;
+		while (i < n && obj[i] != NULL &&
+				rte_mempool_from_obj(obj[i]) == mp)
+			i++;
+		rte_mempool_put_bulk(mp, &obj[first], i - first);
+	}
+}
+
+uint32_t
+sess_pool_in_use(enum sess_pool_type type)
+{
+	uint32_t in_use = 0;
+	unsigned int s;
+
+	for (s = 0; s < RTE_MAX_NUMA_NODES; s++)
+		if (sess_pools[type][s] != NULL)
+			in_use += rte_mempool_in_use_count(sess_pools[type][s]);
+
+	return in_use;
+}
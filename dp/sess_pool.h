@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SESS_POOL_H_
+#define _SESS_POOL_H_
+/**
+ * @file
+ * Fixed size object pools for DP session structures, one rte_mempool per
+ * structure and NUMA socket, with per lcore caches. Pools are sized once
+ * from the max. bearer session count; when a pool is empty, allocation
+ * fails instead of growing the heap.
+ *
+ * Objects are returned zeroed. An object is freed to the pool it came
+ * from, whichever lcore frees it.
+ */
+#include <stdint.h>
+
+#include <rte_config.h>
+
+/* Pool sizes per bearer session */
+#define SESS_POOL_SDF_PER_BEARER	2	/* dp_sdf_per_bearer_info, UL+DL */
+#define SESS_POOL_ADC_PER_UE		2	/* dp_adc_ue_info */
+
+/* Objects cached per lcore */
+#define SESS_POOL_CACHE_SIZE		32
+
+/**
+ * Pooled session structures.
+ */
+enum sess_pool_type {
+	SESS_POOL_BEARER,	/* struct dp_session_info */
+	SESS_POOL_UE,		/* struct ue_session_info */
+	SESS_POOL_SDF,		/* struct dp_sdf_per_bearer_info */
+	SESS_POOL_ADC_UE,	/* struct dp_adc_ue_info */
+	SESS_POOL_CLI,		/* dp_sess_strct */
+	SESS_POOL_MAX
+};
+
+/**
+ * Create the pools of every socket with an enabled lcore.
+ * @param nb_sess
+ *	max. bearer sessions.
+ * @return
+ *	\- 0 on success
+ *	\- -1 on failure
+ */
+int
+sess_pool_init(uint32_t nb_sess);
+
+/**
+ * Add the memory sess_pool_init will take on each socket.
+ * @param nb_sess
+ *	max. bearer sessions.
+ * @param need
+ *	bytes per socket, added to.
+ */
+void
+sess_pool_budget(uint32_t nb_sess, uint64_t need[RTE_MAX_NUMA_NODES]);
+
+/**
+ * Allocate a zeroed object, from the pool of the calling lcore's socket
+ * if it has one.
+ * @param type
+ *	object type.
+ * @return
+ *	object, NULL if the pool is empty.
+ */
+void *
+sess_pool_alloc(enum sess_pool_type type);
+
+/**
+ * Allocate n zeroed objects, all or none.
+ * @param type
+ *	object type.
+ * @param obj
+ *	objects.
+ * @param n
+ *	number of objects.
+ * @return
+ *	\- 0 on success
+ *	\- -1 if the pool has less than n objects
+ */
+int
+sess_pool_alloc_bulk(enum sess_pool_type type, void **obj, uint32_t n);
+
+/**
+ * Free an object to its pool. NULL is ignored.
+ * @param obj
+ *	object from sess_pool_alloc.
+ */
+void
+sess_pool_free(void *obj);
+
+/**
+ * Free n objects to their pools. NULL objects are skipped.
+ * @param obj
+ *	objects from sess_pool_alloc, of any type.
+ * @param n
+ *	number of objects.
+ */
+void
+sess_pool_free_bulk(void **obj, uint32_t n);
+
+/**
+ * Objects in use.
+ * @param type
+ *	object type.
+ * @return
+ *	objects allocated over all sockets.
+ */
+uint32_t
+sess_pool_in_use(enum sess_pool_type type);
+
+#endif /* _SESS_POOL_H_ */
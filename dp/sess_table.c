@@ -18,6 +18,7 @@
 #include <search.h>
 #include <rte_mbuf.h>
 #include <rte_common.h>
+#include <rte_atomic.h>
 #include <rte_eal.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
@@ -33,6 +34,15 @@
 #include "acl_dp.h"
 #include "interface.h"
 #include "meter.h"
+#include "hash_bulk.h"
+#include "sess_pool.h"
+#include "tbl_rcu.h"
+#include "mem_budget.h"
+#ifdef UL_TEID_INDEX
+#include "teid_index.h"
+
+extern struct teid_index *ul_teid_index;
+#endif /* UL_TEID_INDEX */
 
 extern struct rte_hash *rte_uplink_hash;
 extern struct rte_hash *rte_downlink_hash;
@@ -43,6 +53,48 @@ extern struct rte_hash *rte_sess_hash;
 extern struct rte_hash *rte_ue_hash;
 extern struct rte_hash *rte_sess_cli_hash;
 
+struct cdr_shard *cdr_ul_shards[DP_MAX_WORKERS];
+struct cdr_shard *cdr_dl_shards[DP_MAX_WORKERS];
+struct cdr_vol_shard *cdr_vol_ul_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+struct cdr_vol_shard *cdr_vol_dl_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+struct mtr_shard *mtr_ul_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+struct mtr_shard *mtr_dl_shards[CDR_VOL_MAX][DP_MAX_WORKERS];
+struct dp_session_hot *dp_sess_hot;
+
+/** Free session cdr slots */
+static struct rte_ring *cdr_slot_ring;
+
+/** Free ADC, SDF and rating group vol slots */
+static struct rte_ring *cdr_vol_slot_ring[CDR_VOL_MAX];
+
+#ifdef SDF_MTR
+#define CDR_VOL_SDF_MTR	1
+#else
+#define CDR_VOL_SDF_MTR	0
+#endif	/* SDF_MTR */
+#ifdef APN_MTR
+#define CDR_VOL_APN_MTR	1
+#else
+#define CDR_VOL_APN_MTR	0
+#endif	/* APN_MTR */
+
+/**
+ * Vol slots per bearer session, counter shards per slot and whether
+ * meter shares are kept, of each owner type
+ */
+static const struct {
+	const char *name;
+	uint32_t per_sess;
+	uint32_t stride;
+	uint32_t mtr;
+} cdr_vol_desc[CDR_VOL_MAX] = {
+	[CDR_VOL_SDF] = {"CDR_VOL_SDF", SESS_POOL_SDF_PER_BEARER, 1,
+		CDR_VOL_SDF_MTR},
+	[CDR_VOL_ADC] = {"CDR_VOL_ADC", SESS_POOL_ADC_PER_UE, 1,
+		CDR_VOL_SDF_MTR},
+	[CDR_VOL_RG] = {"CDR_VOL_RG", 1, MAX_RATING_GRP, CDR_VOL_APN_MTR},
+};
+
 #define DEBUG_SESS_TABLE 0
 
 #if DEBUG_SESS_TABLE
@@ -131,6 +183,11 @@ int
 iface_lookup_uplink_data(struct ul_bm_key *key,
 		void **value)
 {
+#ifdef UL_TEID_INDEX
+	*value = teid_index_lookup(ul_teid_index, key->s1u_sgw_teid, key->rid);
+	if (*value != NULL)
+		return 0;
+#endif /* UL_TEID_INDEX */
 	return rte_hash_lookup_data(rte_uplink_hash, key, value);
 }
 
@@ -138,7 +195,42 @@ int
 iface_lookup_uplink_bulk_data(const void **key, uint32_t n,
 		uint64_t *hit_mask, void **value)
 {
-	return rte_hash_lookup_bulk_data(rte_uplink_hash, key, n, hit_mask, value);
+#ifdef UL_TEID_INDEX
+	const void *miss_key[MAX_BURST_SZ];
+	void *miss_value[MAX_BURST_SZ];
+	uint32_t miss_pos[MAX_BURST_SZ];
+	uint64_t hits, miss_hits = 0;
+	uint32_t i, nb_miss = 0;
+
+	if (teid_index_lookup_bulk(ul_teid_index, key, n, &hits, value) == n) {
+		*hit_mask = hits;
+		return n;
+	}
+
+	/* Keys not indexed: TEID slot taken or unknown TEID */
+	for (i = 0; i < n; i++) {
+		if (ISSET_BIT(hits, i))
+			continue;
+		miss_pos[nb_miss] = i;
+		miss_key[nb_miss++] = key[i];
+	}
+
+	if (dp_hash_lookup_bulk(rte_uplink_hash, miss_key, nb_miss,
+			&miss_hits, miss_value) < 0)
+		miss_hits = 0;
+
+	for (i = 0; i < nb_miss; i++) {
+		if (!ISSET_BIT(miss_hits, i))
+			continue;
+		value[miss_pos[i]] = miss_value[i];
+		SET_BIT(hits, miss_pos[i]);
+	}
+
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+#else
+	return dp_hash_lookup_bulk(rte_uplink_hash, key, n, hit_mask, value);
+#endif /* UL_TEID_INDEX */
 }
 
 int
@@ -152,7 +244,7 @@ int
 iface_lookup_downlink_bulk_data(const void **key, uint32_t n,
 		uint64_t *hit_mask, void **value)
 {
-	return rte_hash_lookup_bulk_data(rte_downlink_hash, key, n, hit_mask, value);
+	return dp_hash_lookup_bulk(rte_downlink_hash, key, n, hit_mask, value);
 }
 
 int
@@ -162,6 +254,13 @@ iface_lookup_adc_ue_data(struct dl_bm_key *key,
 	return rte_hash_lookup_data(rte_adc_ue_hash, key, value);
 }
 
+int
+iface_lookup_adc_ue_bulk_data(const void **key, uint32_t n,
+		uint64_t *hit_mask, void **value)
+{
+	return dp_hash_lookup_bulk(rte_adc_ue_hash, key, n, hit_mask, value);
+}
+
 /******************** DP- ADC, PCC funcitons **********************/
 /**
  * @brief Called by DP to lookup key-value in PCC table.
@@ -183,7 +282,7 @@ int iface_lookup_adc_data(const uint32_t key32,
 int iface_lookup_adc_bulk_data(const void **key, uint32_t n,
 		uint64_t *hit_mask, void **value)
 {
-	return rte_hash_lookup_bulk_data(rte_adc_hash, key, n, hit_mask, value);
+	return dp_hash_lookup_bulk(rte_adc_hash, key, n, hit_mask, value);
 }
 struct rte_hash_bucket *bucket_ul_addr(uint64_t key)
 {
@@ -221,6 +320,225 @@ add_rg_idx(uint32_t rg_val, struct rating_group_index_map *rg_idx_map)
 	return -1;
 }
 
+/********************* ADC, SDF, rating group counters *******************/
+uint64_t
+cdr_vol_budget(uint32_t nb_sess, uint64_t *ring_sz)
+{
+	uint64_t shards = 0;
+	uint32_t n;
+	int type;
+
+	*ring_sz = 0;
+	for (type = 0; type < CDR_VOL_MAX; type++) {
+		n = nb_sess * cdr_vol_desc[type].per_sess;
+		*ring_sz += rte_ring_get_memsize(rte_align32pow2(n + 1));
+		shards += (uint64_t)n * cdr_vol_desc[type].stride *
+			sizeof(struct cdr_vol_shard);
+		shards += (uint64_t)n * cdr_vol_desc[type].mtr *
+			sizeof(struct mtr_shard);
+	}
+
+	return shards;
+}
+
+/**
+ * Create the per worker UL/DL ADC, SDF and rating group counter shards,
+ * the meter shares of the metered types and the free vol slot pool of
+ * each owner type.
+ *
+ * @param nb_sess
+ *	max. bearer sessions.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+cdr_vol_create(uint32_t nb_sess)
+{
+	uint32_t wrk, slot, n;
+	size_t sz, mtr_sz;
+	int type;
+
+	for (type = 0; type < CDR_VOL_MAX; type++) {
+		n = nb_sess * cdr_vol_desc[type].per_sess;
+		sz = sizeof(struct cdr_vol_shard) * n * cdr_vol_desc[type].stride;
+		mtr_sz = sizeof(struct mtr_shard) * n;
+
+		cdr_vol_slot_ring[type] = rte_ring_create(cdr_vol_desc[type].name,
+				rte_align32pow2(n + 1), dp_tbl_sz.socket,
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (cdr_vol_slot_ring[type] == NULL) {
+			RTE_LOG_DP(ERR, DP, "Failed to create %s ring\n",
+					cdr_vol_desc[type].name);
+			return -1;
+		}
+
+		for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+			cdr_vol_ul_shards[type][wrk] = rte_zmalloc_socket(
+					"cdr vol ul shards", sz, RTE_CACHE_LINE_SIZE,
+					rte_lcore_to_socket_id(epc_app.core_ul[wrk]));
+			cdr_vol_dl_shards[type][wrk] = rte_zmalloc_socket(
+					"cdr vol dl shards", sz, RTE_CACHE_LINE_SIZE,
+					rte_lcore_to_socket_id(epc_app.core_dl[wrk]));
+			if (cdr_vol_ul_shards[type][wrk] == NULL ||
+					cdr_vol_dl_shards[type][wrk] == NULL) {
+				RTE_LOG_DP(ERR, DP, "Failed to allocate %s shards\n",
+						cdr_vol_desc[type].name);
+				return -1;
+			}
+			if (!cdr_vol_desc[type].mtr)
+				continue;
+			mtr_ul_shards[type][wrk] = rte_zmalloc_socket(
+					"mtr ul shards", mtr_sz, RTE_CACHE_LINE_SIZE,
+					rte_lcore_to_socket_id(epc_app.core_ul[wrk]));
+			mtr_dl_shards[type][wrk] = rte_zmalloc_socket(
+					"mtr dl shards", mtr_sz, RTE_CACHE_LINE_SIZE,
+					rte_lcore_to_socket_id(epc_app.core_dl[wrk]));
+			if (mtr_ul_shards[type][wrk] == NULL ||
+					mtr_dl_shards[type][wrk] == NULL) {
+				RTE_LOG_DP(ERR, DP, "Failed to allocate %s meters\n",
+						cdr_vol_desc[type].name);
+				return -1;
+			}
+		}
+
+		for (slot = 0; slot < n; slot++)
+			rte_ring_sp_enqueue(cdr_vol_slot_ring[type],
+					(void *)(uintptr_t)slot);
+	}
+
+	return 0;
+}
+
+/**
+ * Take a vol slot for a new ADC UE, SDF or UE record and clear its
+ * counter shards and meter shares.
+ *
+ * @param type
+ *	owner type.
+ * @param vol_slot
+ *	slot taken.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if all slots are in use
+ */
+static int
+cdr_vol_slot_alloc(enum cdr_vol_type type, uint32_t *vol_slot)
+{
+	uint32_t stride = cdr_vol_desc[type].stride;
+	uint32_t wrk;
+	void *slot;
+
+	if (rte_ring_sc_dequeue(cdr_vol_slot_ring[type], &slot) < 0)
+		return -1;
+
+	*vol_slot = (uint32_t)(uintptr_t)slot;
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		memset(&cdr_vol_ul_shards[type][wrk][*vol_slot * stride], 0,
+				sizeof(struct cdr_vol_shard) * stride);
+		memset(&cdr_vol_dl_shards[type][wrk][*vol_slot * stride], 0,
+				sizeof(struct cdr_vol_shard) * stride);
+		if (!cdr_vol_desc[type].mtr)
+			continue;
+		memset(&mtr_ul_shards[type][wrk][*vol_slot], 0,
+				sizeof(struct mtr_shard));
+		memset(&mtr_dl_shards[type][wrk][*vol_slot], 0,
+				sizeof(struct mtr_shard));
+	}
+
+	return 0;
+}
+
+/**
+ * Put a vol slot back to the pool of its type.
+ */
+static void
+cdr_vol_slot_put(enum cdr_vol_type type, uint32_t vol_slot)
+{
+	rte_ring_sp_enqueue(cdr_vol_slot_ring[type],
+			(void *)(uintptr_t)vol_slot);
+}
+
+/**
+ * Free an SDF record and its vol slot, deferred by tbl_rcu_defer.
+ */
+static void
+sdf_info_free(void *obj)
+{
+	struct dp_sdf_per_bearer_info *psdf = obj;
+
+	cdr_vol_slot_put(CDR_VOL_SDF, psdf->vol_slot);
+	sess_pool_free(psdf);
+}
+
+/**
+ * Free an ADC UE record and its vol slot, deferred by tbl_rcu_defer.
+ */
+static void
+adc_ue_info_free(void *obj)
+{
+	struct dp_adc_ue_info *padc_ue = obj;
+
+	cdr_vol_slot_put(CDR_VOL_ADC, padc_ue->vol_slot);
+	sess_pool_free(padc_ue);
+}
+
+/**
+ * Free a UE record and its rating group vol slot, deferred by
+ * tbl_rcu_defer. NULL is ignored.
+ */
+static void
+ue_info_free(void *obj)
+{
+	struct ue_session_info *ue_data = obj;
+
+	if (ue_data == NULL)
+		return;
+	cdr_vol_slot_put(CDR_VOL_RG, ue_data->rg_vol_slot);
+	sess_pool_free(ue_data);
+}
+
+/**
+ * Fold the per worker counter shards of an ADC, SDF or rating group CDR
+ * into its data_vol ul/dl cdr and drop counters.
+ *
+ * @param cdr
+ *	CDR to update.
+ * @param type
+ *	owner type of the shards.
+ * @param idx
+ *	shard index of the CDR.
+ */
+static void
+cdr_vol_fold(struct ipcan_dp_bearer_cdr *cdr, enum cdr_vol_type type,
+		uint32_t idx)
+{
+	struct chrg_data_vol *vol = &cdr->data_vol;
+	struct cdr ul_cdr = {0}, dl_cdr = {0}, ul_drop = {0}, dl_drop = {0};
+	struct cdr_vol_shard *ul, *dl;
+	uint32_t wrk;
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		ul = &cdr_vol_ul_shards[type][wrk][idx];
+		dl = &cdr_vol_dl_shards[type][wrk][idx];
+		ul_cdr.bytes += ul->cdr.bytes;
+		ul_cdr.pkt_count += ul->cdr.pkt_count;
+		ul_drop.bytes += ul->drop.bytes;
+		ul_drop.pkt_count += ul->drop.pkt_count;
+		dl_cdr.bytes += dl->cdr.bytes;
+		dl_cdr.pkt_count += dl->cdr.pkt_count;
+		dl_drop.bytes += dl->drop.bytes;
+		dl_drop.pkt_count += dl->drop.pkt_count;
+	}
+
+	vol->ul_cdr = ul_cdr;
+	vol->dl_cdr = dl_cdr;
+	vol->ul_drop = ul_drop;
+	vol->dl_drop = dl_drop;
+}
+
 /********************* PCC rules update functions ***********************/
 /**
  * @brief Function to add UL pcc entry with key and
@@ -253,17 +571,23 @@ add_ul_pcc_entry_key_with_idx(struct dp_session_info *old,
 	}
 
 	/* alloc memory for per sdf per bearer info structure*/
-	psdf = rte_zmalloc("sdf per bearer", sizeof(struct dp_sdf_per_bearer_info),
-			RTE_CACHE_LINE_SIZE);
+	psdf = sess_pool_alloc(SESS_POOL_SDF);
 	if (NULL == psdf) {
 		RTE_LOG_DP(ERR, DP, "Failed to allocate memory for sdf per bearer info");
 		return ;
 	}
+	if (cdr_vol_slot_alloc(CDR_VOL_SDF, &psdf->vol_slot) < 0) {
+		RTE_LOG_DP(ERR, DP, "No free vol slot for sdf per bearer info");
+		sess_pool_free(psdf);
+		return ;
+	}
 	psdf->pcc_info = *pcc_info;
 	psdf->bear_sess_info = old;
+	psdf->bear_hot = old->hot;
 
 #ifdef SDF_MTR
-	mtr_cfg_entry(pcc_info->qos.ul_mtr_profile_index, &psdf->sdf_mtr_obj);
+	mtr_cfg_entry(pcc_info->qos.ul_mtr_profile_index, CDR_VOL_SDF,
+			psdf->vol_slot, UL_FLOW);
 	RTE_LOG_DP(DEBUG, DP, "SDF MTR ADD:UL pcc %d, mtr_idx %d\n",
 			pcc_info->rule_id, pcc_info->qos.ul_mtr_profile_index);
 #endif	/* SDF_MTR */
@@ -272,6 +596,7 @@ add_ul_pcc_entry_key_with_idx(struct dp_session_info *old,
 	ul_key.rid = pcc_id;
 	psdf->sdf_cdr.vol_trshld =
 		psdf->bear_sess_info->ipcan_dp_bearer_cdr.vol_trshld;
+	psdf->sdf_cdr.charging_rule_id = pcc_id;
 
 	RTE_LOG_DP(DEBUG, DP, "SDF ADD:UL_KEY: teid:0x%X, rid:%u\n",
 			ul_key.s1u_sgw_teid, ul_key.rid);
@@ -281,6 +606,14 @@ add_ul_pcc_entry_key_with_idx(struct dp_session_info *old,
 
 	if (ret < 0)
 		rte_panic("Failed to add entry in rte_uplink_hash table");
+
+#ifdef UL_TEID_INDEX
+	/* Slot taken: key is only found through the hash */
+	if (teid_index_add(ul_teid_index, ul_key.s1u_sgw_teid, ul_key.rid,
+			psdf) < 0)
+		RTE_LOG_DP(DEBUG, DP, "UL_KEY teid:0x%X, rid:%u not indexed\n",
+				ul_key.s1u_sgw_teid, ul_key.rid);
+#endif /* UL_TEID_INDEX */
 }
 
 /**
@@ -312,6 +645,10 @@ del_ul_pcc_entry_key_with_idx(struct dp_session_info *data, uint32_t idx)
 		return ;
 	}
 
+#ifdef UL_TEID_INDEX
+	teid_index_del(ul_teid_index, ul_key.s1u_sgw_teid, ul_key.rid);
+#endif /* UL_TEID_INDEX */
+
 	ret = rte_hash_del_key(rte_uplink_hash,
 			&ul_key);
 	if (ret == -ENOENT)
@@ -321,7 +658,7 @@ del_ul_pcc_entry_key_with_idx(struct dp_session_info *data, uint32_t idx)
 	if (ret < 0)
 		rte_panic("Failed to del entry from hash table");
 
-	rte_free(psdf);
+	tbl_rcu_defer(sdf_info_free, psdf);
 }
 
 /**
@@ -357,17 +694,23 @@ add_dl_pcc_entry_key_with_idx(struct dp_session_info *old,
 	}
 
 	/* alloc memory for per sdf per bearer info */
-	psdf = rte_zmalloc("sdf per bearer", sizeof(struct dp_sdf_per_bearer_info),
-			RTE_CACHE_LINE_SIZE);
+	psdf = sess_pool_alloc(SESS_POOL_SDF);
 	if (psdf == NULL) {
 		RTE_LOG_DP(ERR, DP, "Failed to allocate memory for sdf per bearer info");
 		return ;
 	}
+	if (cdr_vol_slot_alloc(CDR_VOL_SDF, &psdf->vol_slot) < 0) {
+		RTE_LOG_DP(ERR, DP, "No free vol slot for sdf per bearer info");
+		sess_pool_free(psdf);
+		return ;
+	}
 	psdf->pcc_info = *pcc_info;
 	psdf->bear_sess_info = old;
+	psdf->bear_hot = old->hot;
 
 #ifdef SDF_MTR
-	mtr_cfg_entry(pcc_info->qos.dl_mtr_profile_index, &psdf->sdf_mtr_obj);
+	mtr_cfg_entry(pcc_info->qos.dl_mtr_profile_index, CDR_VOL_SDF,
+			psdf->vol_slot, DL_FLOW);
 	RTE_LOG_DP(DEBUG, DP, "SDF MTR ADD:DL pcc %d, mtr_idx %d\n",
 			pcc_info->rule_id, pcc_info->qos.dl_mtr_profile_index);
 #endif	/* SDF_MTR */
@@ -376,6 +719,7 @@ add_dl_pcc_entry_key_with_idx(struct dp_session_info *old,
 	dl_key.rid = pcc_id;
 	psdf->sdf_cdr.vol_trshld =
 		psdf->bear_sess_info->ipcan_dp_bearer_cdr.vol_trshld;
+	psdf->sdf_cdr.charging_rule_id = pcc_id;
 
 	RTE_LOG_DP(DEBUG, DP, "SDF ADD:DL_KEY: ue_addr:"IPV4_ADDR ", rid: %d\n",
 			IPV4_ADDR_HOST_FORMAT(dl_key.ue_ipv4), pcc_id);
@@ -390,22 +734,22 @@ add_dl_pcc_entry_key_with_idx(struct dp_session_info *old,
 
 #ifdef SDF_MTR
 static void
-flush_sdf_mtr(struct dp_sdf_per_bearer_info *psdf, char *s)
+flush_sdf_mtr(struct dp_sdf_per_bearer_info *psdf, uint32_t flow, char *s)
 {
 	export_mtr(psdf->bear_sess_info, s, psdf->pcc_info.rule_id,
-					psdf->sdf_mtr_drops);
+			mtr_shard_drops(CDR_VOL_SDF, psdf->vol_slot, flow));
 }
 #endif /* SDF_MTR*/
 #ifdef APN_MTR
 static void
 flush_apn_mtr(struct dp_sdf_per_bearer_info *psdf)
 {
-	export_mtr(psdf->bear_sess_info, "UL-APN",
-			psdf->bear_sess_info->ue_info_ptr->ul_apn_mtr_idx,
-			psdf->bear_sess_info->ue_info_ptr->ul_apn_mtr_drops);
-	export_mtr(psdf->bear_sess_info, "DL-APN",
-			psdf->bear_sess_info->ue_info_ptr->dl_apn_mtr_idx,
-			psdf->bear_sess_info->ue_info_ptr->dl_apn_mtr_drops);
+	struct ue_session_info *ue = psdf->bear_sess_info->ue_info_ptr;
+
+	export_mtr(psdf->bear_sess_info, "UL-APN", ue->ul_apn_mtr_idx,
+			mtr_shard_drops(CDR_VOL_RG, ue->rg_vol_slot, UL_FLOW));
+	export_mtr(psdf->bear_sess_info, "DL-APN", ue->dl_apn_mtr_idx,
+			mtr_shard_drops(CDR_VOL_RG, ue->rg_vol_slot, DL_FLOW));
 }
 #endif /* APN_MTR*/
 
@@ -445,10 +789,10 @@ del_dl_pcc_entry_key_with_idx(struct dp_session_info *data, uint32_t idx)
 		rte_panic("Failed to del entry from hash table");
 
 #ifdef SDF_MTR
-	flush_sdf_mtr(psdf, "DL-SDF");
+	flush_sdf_mtr(psdf, DL_FLOW, "DL-SDF");
 #endif
 
-	rte_free(psdf);
+	tbl_rcu_defer(sdf_info_free, psdf);
 }
 
 /**
@@ -559,13 +903,21 @@ add_adc_entry_key_with_idx(struct ue_session_info *old,
 	old->adc_rule_id[idx] = adc_id;
 
 	/* alloc memory for per ADC per UE info structure*/
-	padc_ue = rte_zmalloc("adc ue info", sizeof(struct dp_adc_ue_info),
-			RTE_CACHE_LINE_SIZE);
+	padc_ue = sess_pool_alloc(SESS_POOL_ADC_UE);
 	if (padc_ue == NULL) {
 		RTE_LOG_DP(ERR, DP, "Failed to allocate memory for adc ue info");
 		return ;
 	}
+	if (cdr_vol_slot_alloc(CDR_VOL_ADC, &padc_ue->vol_slot) < 0) {
+		RTE_LOG_DP(ERR, DP, "No free vol slot for adc ue info");
+		sess_pool_free(padc_ue);
+		return ;
+	}
 	copy_dp_adc_rules(&padc_ue->adc_info, adc_info);
+#ifdef SDF_MTR
+	mtr_cfg_entry(padc_ue->adc_info.mtr_profile_index, CDR_VOL_ADC,
+			padc_ue->vol_slot, UL_FLOW);
+#endif  /* SDF_MTR */
 
 	RTE_LOG_DP(DEBUG, DP, "ADC UE INFO ADD: ue_addr:"IPV4_ADDR ",",
 					IPV4_ADDR_HOST_FORMAT(key.ue_ipv4));
@@ -575,10 +927,6 @@ add_adc_entry_key_with_idx(struct ue_session_info *old,
 					&key, padc_ue);
 	if (ret < 0)
 			rte_panic("Failed to add entry in rte_adc_ue_hash table");
-
-#ifdef SDF_MTR
-	mtr_cfg_entry(padc_ue->adc_info.mtr_profile_index, &padc_ue->mtr_obj);
-#endif  /* SDF_MTR */
 }
 
 /**
@@ -616,8 +964,8 @@ del_adc_entry_key_with_idx(struct ue_session_info *data, uint32_t idx)
 	if (ret < 0)
 		rte_panic("Failed to del entry from hash table");
 
-	/* free the memory*/
-	rte_free(padc_ue);
+	/* free the memory, once no worker holds it */
+	tbl_rcu_defer(adc_ue_info_free, padc_ue);
 }
 
 /**
@@ -681,7 +1029,7 @@ void print_adc_hash(void)
 int
 adc_dns_entry_add(struct msg_adc *data)
 {
-	struct msg_adc *adc;
+	struct msg_adc *adc, *old = NULL;
 	uint32_t key32 = 0;
 	int32_t ret;
 	adc = rte_malloc("data", sizeof(struct msg_adc),
@@ -693,12 +1041,20 @@ adc_dns_entry_add(struct msg_adc *data)
 	*adc = *data;
 
 	key32 = adc->ipv4;
+	tbl_wr_lock();
+	rte_hash_lookup_data(rte_adc_hash, &key32, (void **)&old);
 	ret = rte_hash_add_key_data(rte_adc_hash, &key32,
 			adc);
 	if (ret < 0){
+		tbl_wr_unlock();
 		RTE_LOG_DP(ERR, DP, "Failed to add entry in rte_adc_hash table");
+		rte_free(adc);
 		return -1;
 	}
+	/* Known address: entry data replaced in place */
+	if (old != NULL)
+		tbl_rcu_defer(rte_free, old);
+	tbl_wr_unlock();
 	return 0;
 }
 
@@ -708,9 +1064,11 @@ int adc_dns_entry_delete(struct msg_adc *data)
 	uint32_t key32 = 0;
 	int32_t ret;
 	key32 = data->ipv4;
+	tbl_wr_lock();
 	ret = rte_hash_lookup_data(rte_adc_hash, &key32,
 			(void **)&adc);
 	if (ret < 0) {
+		tbl_wr_unlock();
 		RTE_LOG_DP(ERR, DP, "Failed to del\n"
 				"adc key 0x%X to hash table\n",
 				data->ipv4);
@@ -718,14 +1076,180 @@ int adc_dns_entry_delete(struct msg_adc *data)
 	}
 	ret = rte_hash_del_key(rte_adc_hash, &key32);
 	if (ret < 0){
+		tbl_wr_unlock();
 		RTE_LOG_DP(ERR, DP, "Failed to del entry in hash table");
 		return -1;
 	}
-	rte_free(adc);
+	tbl_rcu_defer(rte_free, adc);
+	tbl_wr_unlock();
 	return 0;
 }
 
 /******************** Session functions **********************/
+/**
+ * Create per worker UL/DL charging counter shards, the session hot
+ * records and the free slot pool handing out their indexes to sessions.
+ *
+ * @param nb_slots
+ *	max. sessions.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+cdr_shards_create(uint32_t nb_slots)
+{
+	uint32_t wrk, slot;
+	size_t sz = sizeof(struct cdr_shard) * nb_slots;
+
+	cdr_slot_ring = rte_ring_create("CDR_SLOTS",
+			rte_align32pow2(nb_slots + 1), dp_tbl_sz.socket,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (cdr_slot_ring == NULL) {
+		RTE_LOG_DP(ERR, DP, "Failed to create cdr slot ring\n");
+		return -1;
+	}
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		cdr_ul_shards[wrk] = rte_zmalloc_socket("cdr ul shards", sz,
+				RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(epc_app.core_ul[wrk]));
+		cdr_dl_shards[wrk] = rte_zmalloc_socket("cdr dl shards", sz,
+				RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(epc_app.core_dl[wrk]));
+		if (cdr_ul_shards[wrk] == NULL || cdr_dl_shards[wrk] == NULL) {
+			RTE_LOG_DP(ERR, DP, "Failed to allocate cdr shards\n");
+			return -1;
+		}
+	}
+
+	dp_sess_hot = rte_zmalloc_socket("sess hot",
+			sizeof(struct dp_session_hot) * nb_slots,
+			RTE_CACHE_LINE_SIZE, dp_tbl_sz.socket);
+	if (dp_sess_hot == NULL) {
+		RTE_LOG_DP(ERR, DP, "Failed to allocate session hot records\n");
+		return -1;
+	}
+
+	for (slot = 0; slot < nb_slots; slot++)
+		rte_ring_sp_enqueue(cdr_slot_ring, (void *)(uintptr_t)slot);
+
+	return 0;
+}
+
+/**
+ * Take a cdr slot for a new session, clear its shards and bind its
+ * hot record.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if all slots are in use
+ */
+static int
+cdr_slot_alloc(struct dp_session_info *session)
+{
+	void *slot;
+	uint32_t wrk;
+
+	if (rte_ring_sc_dequeue(cdr_slot_ring, &slot) < 0)
+		return -1;
+
+	session->cdr_slot = (uint32_t)(uintptr_t)slot;
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		memset(&cdr_ul_shards[wrk][session->cdr_slot], 0,
+				sizeof(struct cdr_shard));
+		memset(&cdr_dl_shards[wrk][session->cdr_slot], 0,
+				sizeof(struct cdr_shard));
+	}
+
+	session->hot = &dp_sess_hot[session->cdr_slot];
+	memset(session->hot, 0, sizeof(struct dp_session_hot));
+	session->hot->cdr_slot = session->cdr_slot;
+	session->hot->cold = session;
+	return 0;
+}
+
+/**
+ * Put a cdr slot back to the pool.
+ */
+static void
+cdr_slot_put(void *slot)
+{
+	rte_ring_sp_enqueue(cdr_slot_ring, slot);
+}
+
+/**
+ * Return the cdr slot of a deleted session. The slot goes back to the
+ * pool after a grace period: workers may still count in flight pkts of
+ * the session on its shards and hot record.
+ *
+ * @param session
+ *	dp bearer session.
+ *
+ * @return
+ *	None
+ */
+static void
+cdr_slot_free(struct dp_session_info *session)
+{
+	tbl_rcu_defer(cdr_slot_put, (void *)(uintptr_t)session->cdr_slot);
+}
+
+void
+dp_session_hot_sync(struct dp_session_info *session)
+{
+	struct dp_session_hot *hot = session->hot;
+
+	hot->ue_ipv4 = session->ue_addr.u.ipv4_addr;
+	hot->s1u_sgw_teid = session->ul_s1_info.sgw_teid;
+	hot->enb_teid = session->dl_s1_info.enb_teid;
+	hot->enb_ipv4 = session->dl_s1_info.enb_addr.u.ipv4_addr;
+	hot->s5s8_sgwu_ipv4 = session->dl_s1_info.s5s8_sgwu_addr.u.ipv4_addr;
+	hot->s5s8_pgwu_ipv4 = session->ul_s1_info.s5s8_pgwu_addr.u.ipv4_addr;
+	hot->vol_trshld = session->ipcan_dp_bearer_cdr.vol_trshld;
+	hot->ue_info_ptr = session->ue_info_ptr;
+	/* Workers and the timer set flags concurrently */
+	if (session->ipcan_dp_bearer_cdr.time_of_first_use)
+		__sync_fetch_and_or(&hot->flags, DP_SESS_F_FIRST_USE);
+	gtpu_encap_tmpl_build(hot);
+
+	/* A worker seeing the new state sees the endpoints and template
+	 * written above */
+	rte_smp_wmb();
+	hot->sess_state = session->sess_state;
+}
+
+void
+cdr_shard_fold(struct dp_session_info *session)
+{
+	struct chrg_data_vol *vol = &session->ipcan_dp_bearer_cdr.data_vol;
+	struct cdr ul_cdr = {0}, dl_cdr = {0}, ul_drop = {0}, dl_drop = {0};
+	struct cdr_shard *ul, *dl;
+	uint32_t wrk;
+
+	for (wrk = 0; wrk < epc_app.nb_workers; wrk++) {
+		ul = &cdr_ul_shards[wrk][session->cdr_slot];
+		dl = &cdr_dl_shards[wrk][session->cdr_slot];
+		ul_cdr.bytes += ul->cdr.bytes;
+		ul_cdr.pkt_count += ul->cdr.pkt_count;
+		ul_drop.bytes += ul->drop.bytes;
+		ul_drop.pkt_count += ul->drop.pkt_count;
+		dl_cdr.bytes += dl->cdr.bytes;
+		dl_cdr.pkt_count += dl->cdr.pkt_count;
+		dl_drop.bytes += dl->drop.bytes;
+		dl_drop.pkt_count += dl->drop.pkt_count;
+	}
+
+	vol->ul_cdr = ul_cdr;
+	vol->dl_cdr = dl_cdr;
+	vol->ul_drop = ul_drop;
+	vol->dl_drop = dl_drop;
+}
+
 /**
  * @brief Function to return session info entry address.
  *	if entry not found, allocate the memory & add entry.
@@ -757,18 +1281,24 @@ get_session_data(uint64_t sess_id, uint32_t is_mod)
 		return NULL;
 
 	/* allocate memory for session info*/
-	data = rte_zmalloc("data", sizeof(struct dp_session_info),
-			RTE_CACHE_LINE_SIZE);
+	data = sess_pool_alloc(SESS_POOL_BEARER);
 	if (data == NULL){
 		RTE_LOG_DP(ERR, DP, "Failed to allocate memory for session info\n");
 		return NULL;
 	}
 
+	if (cdr_slot_alloc(data) < 0) {
+		RTE_LOG_DP(ERR, DP, "No free cdr slot for session info\n");
+		sess_pool_free(data);
+		return NULL;
+	}
+
 	/* add entry*/
 	ret = rte_hash_add_key_data(rte_sess_hash, &sess_id, data);
 	if (ret < 0){
 		RTE_LOG_DP(ERR, DP, "Failed to add entry in rte_sess_hash table\n");
-		rte_free(data);
+		cdr_slot_free(data);
+		sess_pool_free(data);
 		return NULL;
 	}
 
@@ -779,14 +1309,23 @@ int
 dp_session_table_create(struct dp_id dp_id, uint32_t max_elements)
 {
 	RTE_SET_USED(dp_id);
+	/* Sized from --max_sessions (dp_tbl_sz), not the requester's count */
+	RTE_SET_USED(max_elements);
 	int rc;
 	if (rte_sess_hash) {
 		RTE_LOG_DP(INFO, DP, "PCC table: \"%s\" exist\n", dp_id.name);
 		return 0;
 	}
-	rc = hash_create(dp_id.name, &rte_sess_hash, max_elements * 4,
+	if (sess_pool_init(dp_tbl_sz.sess) < 0)
+		return -1;
+	rc = hash_create(dp_id.name, &rte_sess_hash, dp_tbl_sz.sess_hash,
 			sizeof(uint64_t));
-	return rc;
+	if (rc < 0)
+		return rc;
+	ats_init(dp_tbl_sz.sess);
+	if (cdr_vol_create(dp_tbl_sz.sess) < 0)
+		return -1;
+	return cdr_shards_create(dp_tbl_sz.sess);
 }
 
 int
@@ -822,8 +1361,11 @@ copy_session_info(struct dp_session_info *dst,
 	dst->apn_idx = src->apn_idx;
 }
 
-int
-dp_session_create(struct dp_id dp_id,
+/**
+ * @brief Add bearer session, table write lock held.
+ */
+static int
+sess_create(struct dp_id dp_id,
 		struct session_info *entry)
 {
 	PRINT_SESSION_INFO(entry);
@@ -882,14 +1424,27 @@ dp_session_create(struct dp_id dp_id,
 					"\n\tDefault bearer not found for sess_id:%u, bear_id:%u\n",
 						ue_sess_id, bear_id);
 			rte_hash_del_key(rte_sess_hash, &entry->sess_id);
-			free(data);
+			cdr_slot_free(data);
+			tbl_rcu_defer(sess_pool_free, data);
 			return 0;
 		}
 		/* add UE data*/
-		ue_data = rte_zmalloc("ue sess info", sizeof(struct ue_session_info),
-				RTE_CACHE_LINE_SIZE);
-		if (ue_data == NULL)
-			rte_panic("Failed to alloc mem for ue session");
+		ue_data = sess_pool_alloc(SESS_POOL_UE);
+		if (ue_data != NULL && cdr_vol_slot_alloc(CDR_VOL_RG,
+					&ue_data->rg_vol_slot) < 0) {
+			sess_pool_free(ue_data);
+			ue_data = NULL;
+		}
+		if (ue_data == NULL) {
+			/* UE pool is sized for --max_sessions: reject the UE */
+			RTE_LOG_DP(ERR, DP, "BEAR_SESS ADD Fail:"
+					"\n\tUE session pool empty, sess_id:%u\n",
+					ue_sess_id);
+			rte_hash_del_key(rte_sess_hash, &entry->sess_id);
+			cdr_slot_free(data);
+			tbl_rcu_defer(sess_pool_free, data);
+			return -1;
+		}
 		ret = rte_hash_add_key_data(rte_ue_hash, &ue_sess_id, ue_data);
 		if (ret < 0) {
 			rte_panic("Failed to add entry in rte_ue_hash table");
@@ -902,19 +1457,17 @@ dp_session_create(struct dp_id dp_id,
 		ue_data->bearer_count = 1;
 
 #ifdef APN_MTR
-		mtr_cfg_entry(ue_data->ul_apn_mtr_idx,
-				&ue_data->ul_apn_mtr_obj);
+		mtr_cfg_entry(ue_data->ul_apn_mtr_idx, CDR_VOL_RG,
+				ue_data->rg_vol_slot, UL_FLOW);
 		RTE_LOG_DP(DEBUG, DP, "UL-APN MTR ADD: apn_mtr_id: %u, "
-				"apn_obj:0x%"PRIx64"\n",
-				ue_data->ul_apn_mtr_idx,
-				(uint64_t)&ue_data->ul_apn_mtr_obj);
+				"vol_slot:%u\n",
+				ue_data->ul_apn_mtr_idx, ue_data->rg_vol_slot);
 
-		mtr_cfg_entry(ue_data->dl_apn_mtr_idx,
-				&ue_data->dl_apn_mtr_obj);
+		mtr_cfg_entry(ue_data->dl_apn_mtr_idx, CDR_VOL_RG,
+				ue_data->rg_vol_slot, DL_FLOW);
 		RTE_LOG_DP(DEBUG, DP, "DL-APN MTR ADD: apn_mtr_id: %u, "
-				"apn_obj:0x%"PRIx64"\n",
-				ue_data->dl_apn_mtr_idx,
-				(uint64_t)&ue_data->dl_apn_mtr_obj);
+				"vol_slot:%u\n",
+				ue_data->dl_apn_mtr_idx, ue_data->rg_vol_slot);
 #endif	/* APN_MTR */
 	} else {
 		/* update UE data*/
@@ -926,6 +1479,7 @@ dp_session_create(struct dp_id dp_id,
 	/* Update UE session info ptr */
 	data->ue_info_ptr = ue_data;
 	data->sess_state = IN_PROGRESS;
+	dp_session_hot_sync(data);
 
 	/* Update adc rules */
 	if (entry->num_adc_rules) {
@@ -948,25 +1502,18 @@ dp_session_create(struct dp_id dp_id,
 	localtime_r(&rawtime, &data->ipcan_dp_bearer_cdr.record_open_time);
 	data->ipcan_dp_bearer_cdr.charging_id = entry->sess_id;
 
-	// initialize per APN timer (new APN) and monitor this session
-	if (data->apn_idx < MAX_NB_APN) {
-		if (!ats_is_apn_timer_initialized(data->apn_idx) &&
-			(data->ipcan_dp_bearer_cdr.tmr_trshld != 0))
-			ats_init(data->ipcan_dp_bearer_cdr.tmr_trshld, data->apn_idx);
-
-		if (data->ipcan_dp_bearer_cdr.tmr_trshld != 0)
-			ats_list_add_to_tail(data->sess_id, data->apn_idx);
-	}
+	/* periodic CDR record on the session time threshold */
+	if (data->ipcan_dp_bearer_cdr.tmr_trshld != 0)
+		ats_timer_arm(data);
 
 	/* Update CLI Session entry for CLI monitoring */
 	ret = rte_hash_lookup_data(rte_sess_cli_hash, &ue_sess_id, (void **)&cli_sess_data);
 	if ((cli_sess_data != NULL) || (ret != -ENOENT)) {
 			rte_hash_del_key(rte_sess_cli_hash, &ue_sess_id);
-			rte_free(cli_sess_data);
+			tbl_rcu_defer(sess_pool_free, cli_sess_data);
 	}
 	/* add UE Session Data into CLI hash*/
-	cli_sess_data = rte_zmalloc("cli sess info", sizeof(dp_sess_strct),
-			RTE_CACHE_LINE_SIZE);
+	cli_sess_data = sess_pool_alloc(SESS_POOL_CLI);
 	if (cli_sess_data == NULL)
 		rte_panic("Failed to alloc mem for ue cli session");
 
@@ -983,7 +1530,22 @@ dp_session_create(struct dp_id dp_id,
 }
 
 int
-dp_session_modify(struct dp_id dp_id,
+dp_session_create(struct dp_id dp_id,
+		struct session_info *entry)
+{
+	int ret;
+
+	tbl_wr_lock();
+	ret = sess_create(dp_id, entry);
+	tbl_wr_unlock();
+	return ret;
+}
+
+/**
+ * @brief Modify bearer session, table write lock held.
+ */
+static int
+sess_modify(struct dp_id dp_id,
 		struct session_info *entry)
 {
 	PRINT_SESSION_INFO(entry);
@@ -1070,9 +1632,24 @@ dp_session_modify(struct dp_id dp_id,
 		}
 	}
 
+	/* Tunnel endpoints are published before the new state */
+	dp_session_hot_sync(data);
+
 	return 0;
 }
 
+int
+dp_session_modify(struct dp_id dp_id,
+		struct session_info *entry)
+{
+	int ret;
+
+	tbl_wr_lock();
+	ret = sess_modify(dp_id, entry);
+	tbl_wr_unlock();
+	return ret;
+}
+
 /**
  * Flush CDR records of all the PCC rules for the given Bearer session,
  * into cdr cvs record file.
@@ -1102,6 +1679,7 @@ flush_session_records(struct dp_session_info *session)
 			continue;
 		}
 
+		cdr_vol_fold(&psdf->sdf_cdr, CDR_VOL_SDF, psdf->vol_slot);
 		iface_lookup_pcc_data(psdf->sdf_cdr.charging_rule_id, &pcc_info);
 
 		// if (pcc_info != NULL)
@@ -1117,6 +1695,7 @@ flush_session_records(struct dp_session_info *session)
 			continue;
 		}
 
+		cdr_vol_fold(&psdf->sdf_cdr, CDR_VOL_SDF, psdf->vol_slot);
 		iface_lookup_pcc_data(psdf->sdf_cdr.charging_rule_id, &pcc_info);
 
 		// if (pcc_info != NULL)
@@ -1158,6 +1737,8 @@ flush_session_adc_records(struct dp_session_info *session)
 		key.rid = adc_id;
 		if ((rte_hash_lookup_data(rte_adc_ue_hash, &key, (void **)&adc_ue_info)) < 0)
 			continue;
+		cdr_vol_fold(&adc_ue_info->adc_cdr, CDR_VOL_ADC,
+				adc_ue_info->vol_slot);
 		/* SC- Reserved Future Use (RFU) CDR */
 	}
 }
@@ -1232,6 +1813,8 @@ export_adc_cdr_record(struct dp_session_info *session)
 			IPV4_ADDR_HOST_FORMAT(session->ue_addr.u.ipv4_addr));
 			continue;
 		}
+		cdr_vol_fold(&adc_ue_info->adc_cdr, CDR_VOL_ADC,
+				adc_ue_info->vol_slot);
 		/* SC- Reserved Future Use (RFU) CDR */
 	}
 }
@@ -1294,12 +1877,15 @@ export_flow_cdr_record(struct dp_session_info *session)
 						session->ue_addr.u.ipv4_addr));
 			continue;
 		}
+		cdr_vol_fold(&psdf->sdf_cdr, CDR_VOL_SDF, psdf->vol_slot);
 	}
 }
 
 int update_vol_on_rec_close(struct dp_session_info *session,
 		enum cdr_rec_cause closure_cause)
 {
+	cdr_shard_fold(session);
+
 	/* UL delta = Total bytes - Last bytes */
 	session->ipcan_dp_bearer_cdr.data_vol.ul_bytes_delta =
 		(session->ipcan_dp_bearer_cdr.data_vol.ul_cdr.bytes -
@@ -1362,7 +1948,31 @@ create_cdr_report(struct resp_msgbuf *resp, uint64_t sess_id)
 }
 
 int
-dp_session_delete(struct dp_id dp_id,
+close_cdr_report(struct resp_msgbuf *resp, uint64_t sess_id)
+{
+	struct dp_session_info *session;
+	struct dp_session_hot *hot;
+
+	session = get_session_data(sess_id, SESS_MODIFY);
+	if (session == NULL) {
+		printf("Session id 0x%"PRIx64" not found\n", sess_id);
+		return -1;
+	}
+
+	hot = session->hot;
+	update_vol_on_rec_close(session, (hot->flags & DP_SESS_F_CDR_TIME) ?
+			CDR_REC_TIME : CDR_REC_VOL);
+	/* Workers check the volume delta against the new record */
+	dp_session_cdr_dequeued(hot);
+
+	return create_cdr_report(resp, sess_id);
+}
+
+/**
+ * @brief Delete bearer session, table write lock held.
+ */
+static int
+sess_delete(struct dp_id dp_id,
 		struct session_info *entry)
 {
 	PRINT_SESSION_INFO(entry);
@@ -1421,6 +2031,7 @@ dp_session_delete(struct dp_id dp_id,
 #endif	/* DP_DDN */
 	}
 
+	cdr_shard_fold(data);
 	flush_session_adc_records(data);
 	/*flush_session_pcc_records(data);*/
 	flush_session_records(data);
@@ -1436,8 +2047,7 @@ dp_session_delete(struct dp_id dp_id,
 	export_flow_cdr_record(data);
 
 
-	if (data->ipcan_dp_bearer_cdr.tmr_trshld != 0)
-		ats_list_del_node(data->sess_id, data->apn_idx);
+	ats_timer_cancel(data);
 
 	struct dp_session_info new;
 
@@ -1459,18 +2069,32 @@ dp_session_delete(struct dp_id dp_id,
 	if (rte_hash_del_key(rte_sess_hash, &entry->sess_id) < 0)
 		return -1;
 
-	rte_free(data->ue_info_ptr);
-	rte_free(data);
+	cdr_slot_free(data);
 
 	/* Delete CLI sess table entry */
 	hash_ret = rte_hash_lookup_data(rte_sess_cli_hash, &ue_sess_id, (void **)&cli_sess_data);
-	if ((cli_sess_data != NULL) || (hash_ret != -ENOENT)) {
+	if ((cli_sess_data != NULL) || (hash_ret != -ENOENT))
 			rte_hash_del_key(rte_sess_cli_hash, &ue_sess_id);
-			rte_free(cli_sess_data);
-	}
+
+	/* Workers may still hold the session from a lookup */
+	tbl_rcu_defer(ue_info_free, data->ue_info_ptr);
+	tbl_rcu_defer(sess_pool_free, data);
+	tbl_rcu_defer(sess_pool_free, cli_sess_data);
 	return 0;
 }
 
+int
+dp_session_delete(struct dp_id dp_id,
+		struct session_info *entry)
+{
+	int ret;
+
+	tbl_wr_lock();
+	ret = sess_delete(dp_id, entry);
+	tbl_wr_unlock();
+	return ret;
+}
+
 /**
  * Flush Rating Group CDR records for the given Bearer session,
  * into cdr cvs record file.
@@ -1487,8 +2111,12 @@ export_rg_cdr_record(struct dp_session_info *session)
 	uint32_t i;
 
 	for (i = 0; i < MAX_RATING_GRP; i++) {
-		if (session->ue_info_ptr->rg_idx_map[i].rg_val)
+		if (session->ue_info_ptr->rg_idx_map[i].rg_val) {
+			cdr_vol_fold(&session->ue_info_ptr->rating_grp[i],
+					CDR_VOL_RG, session->ue_info_ptr->rg_vol_slot *
+					MAX_RATING_GRP + i);
 			/* SC- Reserved Future Use (RFU) CDR */
+		}
 	}
 }
 #endif /* RATING_GRP_CDR */
@@ -31,7 +31,23 @@
 #include "util.h"
 
 #define SESS_CDR_FILE "/var/log/dpn/sess_cdr.csv"
-FILE *sess_cdr_file;
+
+static const struct cdr_field_t sess_cdr_fields[] = {
+	{"time", CDR_TIME, CDR_OFF(time), NULL},
+	{"sess_id", CDR_U64, CDR_OFF(sess_id), NULL},
+	{"cdr_type", CDR_CHARS, CDR_OFF(name), NULL},
+	{"id", CDR_U32, CDR_OFF(id), NULL},
+	{"ue_ip", CDR_IPV4, CDR_OFF(ue_ip), NULL},
+	{"dl_pkt_cnt", CDR_U64, CDR_OFF(vol[CDR_DL_PKTS]), NULL},
+	{"dl_bytes", CDR_U64, CDR_OFF(vol[CDR_DL_BYTES]), NULL},
+	{"ul_pkt_cnt", CDR_U64, CDR_OFF(vol[CDR_UL_PKTS]), NULL},
+	{"ul_bytes", CDR_U64, CDR_OFF(vol[CDR_UL_BYTES]), NULL},
+	{"dl_drop_cnt", CDR_U64, CDR_OFF(vol[CDR_DL_DROP_PKTS]), NULL},
+	{"dl_drop_bytes", CDR_U64, CDR_OFF(vol[CDR_DL_DROP_BYTES]), NULL},
+	{"ul_drop_cnt", CDR_U64, CDR_OFF(vol[CDR_UL_DROP_PKTS]), NULL},
+	{"ul_drop_bytes", CDR_U64, CDR_OFF(vol[CDR_UL_DROP_BYTES]), NULL},
+	{"rate_group", CDR_U32, CDR_OFF(rating_group), NULL},
+};
 
 void
 sess_cdr_init(void)
@@ -47,91 +63,31 @@ sess_cdr_init(void)
 
 	printf("Logging Session ID based CDR Records to %s\n", filename);
 
-	sess_cdr_file = fopen(filename, "w");
-	if (!sess_cdr_file)
-		rte_panic("CDR file %s failed to open for writing\n - %s (%d)",
-					filename, strerror(errno), errno);
-
-	if (fprintf(sess_cdr_file, "#%s,%s,%s,%s,%s,%s,%s,"
-				"%s,%s,%s,%s,%s,%s,%s\n",
-				"time",
-				"sess_id",
-				"cdr_type",
-				"id",
-				"ue_ip",
-				"dl_pkt_cnt",
-				"dl_bytes",
-				"ul_pkt_cnt",
-				"ul_bytes",
-				"dl_drop_cnt",
-				"dl_drop_bytes",
-				"ul_drop_cnt",
-				"ul_drop_bytes",
-				"rate_group") < 0)
-		rte_panic("%s [%d] fprintf(sess_cdr_file header failed - %s "
-				"(%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
-	if (fflush(sess_cdr_file))
-		rte_panic("%s [%d] fflush(sess_cdr_file failed - %s (%d)\n",
-				__FILE__, __LINE__, strerror(errno), errno);
+	cdr_writer_init();
+	cdr_writer_open(CDR_STREAM_SESS, filename, sess_cdr_fields,
+			RTE_DIM(sess_cdr_fields), "#", "%y%m%d_%H%M%S");
 }
 
 void
 sess_cdr_reset(void)
 {
-	fclose(sess_cdr_file);
-	sess_cdr_init();
-}
-
-/**
- * @brief Function to update timestamp of records to file.
- */
-static void
-update_timestamp(FILE *cfile)
-{
-	/* create time string */
-	char time_str[30];
-	time_t t = time(NULL);
-	struct tm *tmp = localtime(&t);
-	if (tmp == NULL)
-		return;
-	strftime(time_str, sizeof(time_str), "%y%m%d_%H%M%S", tmp);
-	fprintf(cfile, "%s", time_str);
-}
-
-/**
- * @brief Function to update Uplink and downlink records to file.
- */
-static void
-update_pkt_counts(FILE *cfile,
-				struct ipcan_dp_bearer_cdr *charge_record)
-{
-	if (!charge_record)
-		return;
-
-	fprintf(cfile, ",%"PRIu64",%"PRIu64
-				",%"PRIu64",%"PRIu64
-				",%"PRIu64",%"PRIu64
-				",%"PRIu64",%"PRIu64,
-				charge_record->data_vol.dl_cdr.pkt_count,
-				charge_record->data_vol.dl_cdr.bytes,
-				charge_record->data_vol.ul_cdr.pkt_count,
-				charge_record->data_vol.ul_cdr.bytes,
-				charge_record->data_vol.dl_drop.pkt_count,
-				charge_record->data_vol.dl_drop.bytes,
-				charge_record->data_vol.ul_drop.pkt_count,
-				charge_record->data_vol.ul_drop.bytes);
+	cdr_writer_reset(CDR_STREAM_SESS);
 }
 
 void
 export_cdr_record(struct dp_session_info *session, char *name,
 			uint32_t id, struct ipcan_dp_bearer_cdr *charge_record)
 {
-	update_timestamp(sess_cdr_file);
-	fprintf(sess_cdr_file, ",%"PRIu64"", session->sess_id);
-	fprintf(sess_cdr_file, ",%s,%u,%s", name, id,
-						iptoa(session->ue_addr));
-	update_pkt_counts(sess_cdr_file, charge_record);
-	fprintf(sess_cdr_file, ",%"PRIu32"\n", charge_record->rating_group);
-	fflush(sess_cdr_file);
+	struct cdr_rec *rec = cdr_rec_alloc(CDR_STREAM_SESS);
+
+	if (rec == NULL)
+		return;
+
+	rec->sess_id = session->sess_id;
+	cdr_rec_strcpy(rec->name, name);
+	rec->id = id;
+	rec->ue_ip = session->ue_addr.u.ipv4_addr;
+	cdr_rec_set_vol(rec, &charge_record->data_vol);
+	rec->rating_group = charge_record->rating_group;
+	cdr_rec_submit(rec);
 }
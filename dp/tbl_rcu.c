@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_common.h>
+#include <rte_spinlock.h>
+
+#include "main.h"
+#include "tbl_rcu.h"
+
+/**
+ * Retired entry.
+ */
+struct tbl_rcu_ent {
+	tbl_rcu_free_t fn;
+	void *obj;
+};
+
+/**
+ * Batch of retired entries.
+ */
+struct tbl_rcu_batch {
+	/* grace period of a waiting batch */
+	struct epc_qs_token tok;
+	uint32_t n;
+	struct tbl_rcu_ent ent[TBL_RCU_MAX];
+};
+
+static rte_spinlock_t tbl_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* Entries retired since the last grace period start, and entries
+ * waiting for the grace period started last */
+static struct tbl_rcu_batch tbl_rcu_batches[2];
+static struct tbl_rcu_batch *tbl_rcu_cur = &tbl_rcu_batches[0];
+static struct tbl_rcu_batch *tbl_rcu_wait = &tbl_rcu_batches[1];
+
+static void
+tbl_rcu_run(struct tbl_rcu_batch *b)
+{
+	uint32_t i;
+
+	for (i = 0; i < b->n; i++)
+		b->ent[i].fn(b->ent[i].obj);
+	b->n = 0;
+}
+
+/**
+ * Free the waiting batch if its grace period is over, then start a
+ * grace period for the current batch. Table write lock held.
+ */
+static void
+tbl_rcu_advance(void)
+{
+	struct tbl_rcu_batch *b;
+
+	if (tbl_rcu_wait->n) {
+		if (!epc_qs_check(&tbl_rcu_wait->tok))
+			return;
+		tbl_rcu_run(tbl_rcu_wait);
+	}
+
+	if (tbl_rcu_cur->n == 0)
+		return;
+
+	b = tbl_rcu_wait;
+	tbl_rcu_wait = tbl_rcu_cur;
+	tbl_rcu_cur = b;
+	epc_qs_start(&tbl_rcu_wait->tok);
+}
+
+/**
+ * Wait for a grace period and free both batches. Table write lock held.
+ */
+static void
+tbl_rcu_flush(void)
+{
+	epc_synchronize();
+	tbl_rcu_run(tbl_rcu_wait);
+	tbl_rcu_run(tbl_rcu_cur);
+}
+
+void
+tbl_wr_lock(void)
+{
+	rte_spinlock_lock(&tbl_lock);
+}
+
+void
+tbl_wr_unlock(void)
+{
+	tbl_rcu_advance();
+	rte_spinlock_unlock(&tbl_lock);
+}
+
+void
+tbl_rcu_defer(tbl_rcu_free_t fn, void *obj)
+{
+	struct tbl_rcu_ent *e;
+
+	if (unlikely(tbl_rcu_cur->n == TBL_RCU_MAX)) {
+		tbl_rcu_advance();
+		if (tbl_rcu_cur->n == TBL_RCU_MAX)
+			tbl_rcu_flush();
+	}
+
+	e = &tbl_rcu_cur->ent[tbl_rcu_cur->n++];
+	e->fn = fn;
+	e->obj = obj;
+}
+
+void
+tbl_rcu_poll(void)
+{
+	/* Nothing retired: stay off the lock */
+	if (tbl_rcu_cur->n == 0 && tbl_rcu_wait->n == 0)
+		return;
+
+	rte_spinlock_lock(&tbl_lock);
+	tbl_rcu_advance();
+	rte_spinlock_unlock(&tbl_lock);
+}
+
+void
+tbl_rcu_barrier(void)
+{
+	rte_spinlock_lock(&tbl_lock);
+	tbl_rcu_flush();
+	rte_spinlock_unlock(&tbl_lock);
+}
+
+uint32_t
+tbl_rcu_pending(void)
+{
+	return tbl_rcu_cur->n + tbl_rcu_wait->n;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TBL_RCU_H_
+#define _TBL_RCU_H_
+/**
+ * @file
+ * Writer side of the DP session, PCC and ADC tables.
+ *
+ * Workers look the tables up without locks. Writers (CP message
+ * handlers, SIMU_CP, DNS snooping) serialize on one table lock, so each
+ * table has a single writer at a time, as rte_hash and the TEID index
+ * expect. A writer unlinks an entry from its table, then retires it
+ * with tbl_rcu_defer instead of freeing it: the entry is freed after
+ * a grace period, once every worker went through a quiescent state
+ * (epc_qs_quiescent, once per poll loop burst) and so dropped the
+ * references it got from its lookups.
+ *
+ * Retired entries are freed in batches, by tbl_wr_unlock and
+ * tbl_rcu_poll, without waiting; a writer only waits for a grace
+ * period when TBL_RCU_MAX entries are waiting.
+ */
+#include <stdint.h>
+
+/* Retired entries waiting for a grace period, per batch */
+#define TBL_RCU_MAX	8192
+
+/**
+ * Free function of a retired entry.
+ */
+typedef void (*tbl_rcu_free_t)(void *obj);
+
+/**
+ * Take the table write lock.
+ */
+void
+tbl_wr_lock(void);
+
+/**
+ * Free the retired entries whose grace period is over, and release the
+ * table write lock.
+ */
+void
+tbl_wr_unlock(void);
+
+/**
+ * Retire an entry unlinked from its table. Caller holds the table
+ * write lock.
+ * @param fn
+ *	function freeing the entry after the grace period.
+ * @param obj
+ *	entry, passed to fn as is.
+ */
+void
+tbl_rcu_defer(tbl_rcu_free_t fn, void *obj);
+
+/**
+ * Free the retired entries whose grace period is over, without
+ * waiting. Called from the writer poll loops, to drain retired entries
+ * when no table update comes.
+ */
+void
+tbl_rcu_poll(void);
+
+/**
+ * Wait for a grace period and free all retired entries.
+ */
+void
+tbl_rcu_barrier(void);
+
+/**
+ * Retired entries not freed yet.
+ * @return
+ *	number of entries.
+ */
+uint32_t
+tbl_rcu_pending(void);
+
+#endif /* _TBL_RCU_H_ */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+
+#include "teid_index.h"
+#include "ngic_rtc_framework.h"
+
+struct teid_index *
+teid_index_create(const char *name, uint32_t order)
+{
+	struct teid_index *idx;
+
+	if (order < 8 || order > 28)
+		return NULL;
+
+	idx = rte_zmalloc_socket(name, sizeof(*idx), RTE_CACHE_LINE_SIZE,
+			rte_socket_id());
+	if (idx == NULL)
+		return NULL;
+
+	idx->slot = rte_zmalloc_socket(name,
+			sizeof(struct teid_index_entry) << order,
+			RTE_CACHE_LINE_SIZE, rte_socket_id());
+	if (idx->slot == NULL) {
+		rte_free(idx);
+		return NULL;
+	}
+
+	idx->order = order;
+	idx->mask = (1U << order) - 1;
+	return idx;
+}
+
+void
+teid_index_free(struct teid_index *idx)
+{
+	if (idx == NULL)
+		return;
+
+	rte_free(idx->slot);
+	rte_free(idx);
+}
+
+/**
+ * Rewrite slot between generation bumps.
+ */
+static void
+teid_index_set(struct teid_index_entry *e, uint32_t teid, uint32_t rid,
+		void *data)
+{
+	e->gen++;
+	rte_smp_wmb();
+	e->teid = teid;
+	e->rid = rid;
+	e->data = data;
+	rte_smp_wmb();
+	e->gen++;
+}
+
+int
+teid_index_add(struct teid_index *idx, uint32_t teid, uint32_t rid,
+		void *data)
+{
+	struct teid_index_entry *e = &idx->slot[teid_index_slot(idx, teid)];
+
+	if (e->teid != 0 && (e->teid != teid || e->rid != rid)) {
+		idx->nb_collisions++;
+		return -1;
+	}
+
+	if (e->teid == 0)
+		idx->nb_entries++;
+	teid_index_set(e, teid, rid, data);
+	return 0;
+}
+
+void
+teid_index_del(struct teid_index *idx, uint32_t teid, uint32_t rid)
+{
+	struct teid_index_entry *e = &idx->slot[teid_index_slot(idx, teid)];
+
+	if (e->teid != teid || e->rid != rid)
+		return;
+
+	teid_index_set(e, 0, 0, NULL);
+	idx->nb_entries--;
+}
+
+uint32_t
+teid_index_lookup_bulk(const struct teid_index *idx, const void **key,
+		uint32_t n, uint64_t *hit_mask, void **data)
+{
+	const struct ul_bm_key *k;
+	uint64_t hits = 0;
+	uint32_t i;
+
+	/* Slots are random: issue all loads before the first compare */
+	for (i = 0; i < n; i++) {
+		k = key[i];
+		rte_prefetch0(&idx->slot[teid_index_slot(idx, k->s1u_sgw_teid)]);
+	}
+
+	for (i = 0; i < n; i++) {
+		k = key[i];
+		data[i] = teid_index_lookup(idx, k->s1u_sgw_teid, k->rid);
+		if (data[i] != NULL)
+			hits |= 1ULL << i;
+	}
+
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TEID_INDEX_H_
+#define _TEID_INDEX_H_
+/**
+ * @file
+ * Direct indexed UL session table. The CP builds S1U TEIDs as
+ * (0xf0 + bearer index) << 24 | low 24 bits of a monotonic S11 TEID,
+ * so folding the bearer nibble, bit reversed, into the top of the low
+ * TEID bits gives a dense slot number: default bearers fill the table
+ * from the bottom, the 2nd bearers from the middle, and so on. One slot,
+ * one cache line access per lookup.
+ *
+ * The index sits in front of the uplink hash, which stays the table of
+ * record: a key whose slot is taken by another TEID is only in the hash,
+ * and index misses are looked up there.
+ *
+ * Single writer (session add/del on the CP interface core), many
+ * readers (workers). A slot generation count, odd while the slot is
+ * being written, lets readers detect and skip a slot being rewritten.
+ */
+#include <stdint.h>
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+
+/* Default slots, as a power of two: 1M, 32MB */
+#define TEID_INDEX_ORDER	20
+
+/**
+ * Index slot.
+ */
+struct teid_index_entry {
+	/** generation: odd while slot is written */
+	volatile uint32_t gen;
+	/** S1U SGW TEID, 0 if slot is free */
+	uint32_t teid;
+	/** rule id */
+	uint32_t rid;
+	/** uplink hash data */
+	void *data;
+} __rte_aligned(32);
+
+/**
+ * Index table.
+ */
+struct teid_index {
+	/** slots - 1 */
+	uint32_t mask;
+	/** slot bits */
+	uint32_t order;
+	/** keys in index */
+	uint32_t nb_entries;
+	/** keys not indexed, slot taken */
+	uint32_t nb_collisions;
+	struct teid_index_entry *slot;
+};
+
+/**
+ * Slot of a TEID: low TEID bits, reversed bearer nibble xored into the
+ * top four.
+ */
+static inline uint32_t
+teid_index_slot(const struct teid_index *idx, uint32_t teid)
+{
+	static const uint8_t rev4[16] = {
+		0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15,
+	};
+
+	return (teid ^ ((uint32_t)rev4[(teid >> 24) & 0xf] <<
+			(idx->order - 4))) & idx->mask;
+}
+
+/**
+ * Look up a key.
+ * @param idx
+ *	index table.
+ * @param teid
+ *	S1U SGW TEID.
+ * @param rid
+ *	rule id.
+ * @return
+ *	data, NULL if not indexed: look up the uplink hash.
+ */
+static inline void *
+teid_index_lookup(const struct teid_index *idx, uint32_t teid, uint32_t rid)
+{
+	const struct teid_index_entry *e =
+		&idx->slot[teid_index_slot(idx, teid)];
+	uint32_t gen;
+	void *data;
+
+	gen = e->gen;
+	rte_smp_rmb();
+	if (unlikely(e->teid != teid || e->rid != rid))
+		return NULL;
+	data = e->data;
+	rte_smp_rmb();
+	if (unlikely((gen & 1) || gen != e->gen))
+		return NULL;
+
+	return data;
+}
+
+/**
+ * Create index table.
+ * @param name
+ *	allocation name.
+ * @param order
+ *	slots as a power of two, 8 to 28.
+ * @return
+ *	table, NULL on failure.
+ */
+struct teid_index *
+teid_index_create(const char *name, uint32_t order);
+
+/**
+ * Free index table.
+ * @param idx
+ *	index table.
+ */
+void
+teid_index_free(struct teid_index *idx);
+
+/**
+ * Index a key.
+ * @param idx
+ *	index table.
+ * @param teid
+ *	S1U SGW TEID, non zero.
+ * @param rid
+ *	rule id.
+ * @param data
+ *	uplink hash data.
+ * @return
+ *	\- 0 if indexed
+ *	\- -1 if slot is taken by another key
+ */
+int
+teid_index_add(struct teid_index *idx, uint32_t teid, uint32_t rid,
+		void *data);
+
+/**
+ * Remove a key, if indexed.
+ * @param idx
+ *	index table.
+ * @param teid
+ *	S1U SGW TEID.
+ * @param rid
+ *	rule id.
+ */
+void
+teid_index_del(struct teid_index *idx, uint32_t teid, uint32_t rid);
+
+/**
+ * Look up a burst of struct ul_bm_key.
+ * @param idx
+ *	index table.
+ * @param key
+ *	keys.
+ * @param n
+ *	number of keys, at most 64.
+ * @param hit_mask
+ *	bit set for each key found.
+ * @param data
+ *	data of keys found.
+ * @return
+ *	number of keys found.
+ */
+uint32_t
+teid_index_lookup_bulk(const struct teid_index *idx, const void **key,
+		uint32_t n, uint64_t *hit_mask, void **data);
+
+#endif /* _TEID_INDEX_H_ */
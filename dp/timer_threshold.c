@@ -1,205 +1,271 @@
-#include <stdlib.h>
-#include <unistd.h>
-#include <signal.h>
-#include <time.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <sys/queue.h>
+
+#include <rte_cycles.h>
+#include <rte_mempool.h>
 
 #include "main.h"
 
-#define CREATE_TIMER 1
-#define UPDATE_TIMER 0
+/* Wheel resolution */
+#define ATS_TICK_MS		100
 
-extern struct rte_ring *cdr_ring;
+/* Slots per wheel level, as bits of the tick count */
+#define ATS_WHEEL_BITS		6
+#define ATS_WHEEL_SIZE		(1 << ATS_WHEEL_BITS)
+#define ATS_WHEEL_MASK		(ATS_WHEEL_SIZE - 1)
 
-typedef struct session {
-	uint64_t session_id;
-	time_t ts;
-	struct session *next;
-	struct session *last;
-} session_t;
+/* Levels: 2^(6*4) ticks of 100ms, ~19 days of range */
+#define ATS_WHEEL_LEVELS	4
+#define ATS_WHEEL_RANGE		(1ULL << (ATS_WHEEL_BITS * ATS_WHEEL_LEVELS))
 
+/* Expired session ids handed to cdr_ring per enqueue */
+#define ATS_EXPIRE_BURST	64
 
+/* Timers are only touched by one thread: single producer and consumer,
+ * no cache line alignment or channel spread padding. */
+#define ATS_POOL_FLAGS		(MEMPOOL_F_SP_PUT | MEMPOOL_F_SC_GET | \
+				 MEMPOOL_F_NO_CACHE_ALIGN | MEMPOOL_F_NO_SPREAD)
+
+extern struct rte_ring *cdr_ring;
 
-typedef struct apn_timer_struct {
-	session_t list_head;
-	timer_t timer_id;
-	char lock;
-	int idx;
-	int timer_threshold;
-} apn_timer_struct_t;
+/**
+ * Session time threshold timer, periodic.
+ */
+struct ats_timer {
+	LIST_ENTRY(ats_timer) next;
+	/** session to report on expiry */
+	uint64_t sess_id;
+	/** expiry, in wheel ticks */
+	uint64_t expire;
+	/** period, in wheel ticks */
+	uint64_t period;
+};
+
+LIST_HEAD(ats_list, ats_timer);
+
+/**
+ * Hierarchical timing wheel. Level n slots cover 2^(6*n) ticks each;
+ * timers cascade to the level below when their slot comes due.
+ * Only touched from the CP interface thread, which also creates and
+ * deletes sessions: no locking.
+ */
+static struct {
+	struct ats_list slot[ATS_WHEEL_LEVELS][ATS_WHEEL_SIZE];
+	/** current tick */
+	uint64_t cur;
+	/** TSC cycles per tick */
+	uint64_t tick_cycles;
+	/** TSC of next tick */
+	uint64_t next_tsc;
+	/** timer slab */
+	struct rte_mempool *pool;
+	/** expired session ids not yet in cdr_ring */
+	void *expired[ATS_EXPIRE_BURST];
+	/** hot records of the expired sessions */
+	struct dp_session_hot *expired_hot[ATS_EXPIRE_BURST];
+	uint32_t nb_expired;
+} ats_wheel;
+
+/**
+ * Place timer in the slot of its expiry tick.
+ */
+static void
+ats_wheel_insert(struct ats_timer *tmr)
+{
+	uint64_t delta;
+	uint32_t lvl;
 
+	if (tmr->expire <= ats_wheel.cur)
+		tmr->expire = ats_wheel.cur + 1;
 
-apn_timer_struct_t apn_timers[MAX_NB_APN] = {{{0,0,NULL,NULL},0,0,0,0},};
+	delta = tmr->expire - ats_wheel.cur;
+	if (delta >= ATS_WHEEL_RANGE) {
+		tmr->expire = ats_wheel.cur + ATS_WHEEL_RANGE - 1;
+		delta = ATS_WHEEL_RANGE - 1;
+	}
 
-static void ats_handler(int sig, siginfo_t *si, void *uc);
-static void ats_manage_per_apn_timer(int interval_in_secs, int create_timer, int apn_idx);
+	for (lvl = 0; lvl < ATS_WHEEL_LEVELS - 1; lvl++)
+		if (delta < (1ULL << (ATS_WHEEL_BITS * (lvl + 1))))
+			break;
 
-long ats_is_apn_timer_initialized(int apn_idx) {
-	apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	return (long)(apn_timer_struct->timer_id);
+	LIST_INSERT_HEAD(&ats_wheel.slot[lvl]
+			[(tmr->expire >> (ATS_WHEEL_BITS * lvl)) & ATS_WHEEL_MASK],
+			tmr, next);
 }
 
-void ats_init(int timer_threshold, int apn_idx) {
-	apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	session_t *head = &apn_timer_struct->list_head;
-	head->next = NULL;
-	head->last = head;
-	head->session_id = -1;
-	apn_timer_struct->lock = 0;
-	apn_timer_struct->idx = apn_idx;
-	apn_timer_struct->timer_threshold = timer_threshold;;
-	ats_manage_per_apn_timer(0, CREATE_TIMER, apn_idx);//Create the timer, don't start
+/**
+ * Push batched expired session ids to the CDR ring.
+ */
+static void
+ats_expired_flush(void)
+{
+	uint32_t i, sent;
+
+	if (ats_wheel.nb_expired == 0)
+		return;
+
+	sent = rte_ring_enqueue_burst(cdr_ring, ats_wheel.expired,
+			ats_wheel.nb_expired, NULL);
+	if (sent < ats_wheel.nb_expired) {
+		RTE_LOG_DP(ERR, DP, "Failed to enqueue %u time threshold "
+				"CDRs into cdr_ring\n",
+				ats_wheel.nb_expired - sent);
+		for (i = sent; i < ats_wheel.nb_expired; i++)
+			dp_session_cdr_dequeued(ats_wheel.expired_hot[i]);
+	}
+	ats_wheel.nb_expired = 0;
 }
 
+/**
+ * Queue the time threshold record of the timer session and re-arm.
+ * A volume threshold report already queued closes on time instead.
+ */
+static void
+ats_timer_expire(struct ats_timer *tmr)
+{
+	struct dp_session_info *session;
+
+	session = get_session_data(tmr->sess_id, SESS_MODIFY);
+	if (session == NULL) {
+		RTE_LOG_DP(ERR, DP, "Session id 0x%"PRIx64" not found\n",
+				tmr->sess_id);
+		rte_mempool_put(ats_wheel.pool, tmr);
+		return;
+	}
 
-void ats_list_add_to_tail(uint64_t session_id, int apn_idx) {
-	apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	session_t *head = &apn_timer_struct->list_head;
-	session_t* new = malloc(sizeof(session_t));
-	if (head->next == NULL) { //Indicates first node add condition
-		ats_manage_per_apn_timer(apn_timer_struct->timer_threshold,
-				UPDATE_TIMER, apn_idx);
+	if (dp_session_cdr_queue(session->hot, DP_SESS_F_CDR_TIME)) {
+		ats_wheel.expired[ats_wheel.nb_expired] = (void *)tmr->sess_id;
+		ats_wheel.expired_hot[ats_wheel.nb_expired++] = session->hot;
+		if (ats_wheel.nb_expired == ATS_EXPIRE_BURST)
+			ats_expired_flush();
 	}
-	new->session_id = session_id;
-	new->ts = time(NULL);
-	new->next = NULL;
-	new->last = new;
-	apn_timer_struct->lock = 1;
-	head->last->next = new;
-	head->last = new;
-	apn_timer_struct->lock = 0;
+
+	tmr->expire += tmr->period;
+	ats_wheel_insert(tmr);
 }
 
-void ats_list_del_node(uint64_t session_id, int apn_idx) {
-	apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	session_t *head = &apn_timer_struct->list_head;
-	session_t *prev;
-	session_t *ptr = head;
-	apn_timer_struct->lock = 1;
-	do {
-		prev = ptr;
-		ptr = ptr->next;
-	} while ((ptr != NULL) && (ptr->session_id != session_id));
-	if (ptr != NULL) {
-		prev->next = ptr->next; //Check of for head->last asjustment
-		if (prev->next == NULL) { //tail node condition
-			head->last = prev;
+/**
+ * Advance the wheel one tick: cascade due upper level slots, then
+ * expire the level 0 slot of the new tick.
+ */
+static void
+ats_wheel_tick(void)
+{
+	struct ats_list due;
+	struct ats_timer *tmr;
+	uint32_t lvl, idx;
+
+	ats_wheel.cur++;
+
+	for (lvl = 1; lvl < ATS_WHEEL_LEVELS; lvl++) {
+		if (ats_wheel.cur & ((1ULL << (ATS_WHEEL_BITS * lvl)) - 1))
+			break;
+		idx = (ats_wheel.cur >> (ATS_WHEEL_BITS * lvl)) & ATS_WHEEL_MASK;
+		LIST_INIT(&due);
+		while ((tmr = LIST_FIRST(&ats_wheel.slot[lvl][idx])) != NULL) {
+			LIST_REMOVE(tmr, next);
+			LIST_INSERT_HEAD(&due, tmr, next);
 		}
-		if (head->next == NULL) {  //Indicates empty list
-			ats_manage_per_apn_timer(0,	UPDATE_TIMER, apn_idx);
+		while ((tmr = LIST_FIRST(&due)) != NULL) {
+			LIST_REMOVE(tmr, next);
+			ats_wheel_insert(tmr);
 		}
-		free(ptr);
 	}
-	apn_timer_struct->lock = 0;
+
+	/* Re-armed timers land at least one tick ahead, never here */
+	idx = ats_wheel.cur & ATS_WHEEL_MASK;
+	while ((tmr = LIST_FIRST(&ats_wheel.slot[0][idx])) != NULL) {
+		LIST_REMOVE(tmr, next);
+		ats_timer_expire(tmr);
+	}
 }
 
-void ats_list_move_to_tail(int apn_idx) {
-	apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	session_t *head = &apn_timer_struct->list_head;
-	apn_timer_struct->lock = 1;
-	head->last->next = head->next;
-	head->next = head->next->next;
-	head->last = head->last->next;
-	head->last->next = NULL;
-	head->last->last = head->last;
-	apn_timer_struct->lock = 0;
+void
+ats_init(uint32_t nb_timers)
+{
+	uint32_t lvl, idx;
 
-}
+	if (ats_wheel.pool != NULL)
+		return;
 
-void print_list(session_t *head) {
-	session_t *ptr = head;
-	printf("\n************************\n");
-	while (ptr != NULL) {
-		printf("session %ld\n", ptr->session_id);
-		ptr = ptr->next;
-	}
-	printf("************************\n");
-}
+	ats_wheel.pool = rte_mempool_create("ATS_TIMERS", nb_timers,
+			sizeof(struct ats_timer), 0, 0, NULL, NULL, NULL, NULL,
+			rte_socket_id(), ATS_POOL_FLAGS);
+	if (ats_wheel.pool == NULL)
+		rte_panic("Failed to create session timer pool\n");
 
+	for (lvl = 0; lvl < ATS_WHEEL_LEVELS; lvl++)
+		for (idx = 0; idx < ATS_WHEEL_SIZE; idx++)
+			LIST_INIT(&ats_wheel.slot[lvl][idx]);
 
-static void ats_manage_per_apn_timer(int interval_in_secs, int create_timer, int apn_idx) {
+	ats_wheel.tick_cycles = rte_get_tsc_hz() * ATS_TICK_MS / 1000;
+	ats_wheel.next_tsc = rte_rdtsc() + ats_wheel.tick_cycles;
+}
 
-	   apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-	   struct itimerspec timer_spec;
+uint64_t
+ats_budget(uint32_t nb_timers)
+{
+	struct rte_mempool_objsz sz;
 
-	   if (create_timer) {
-	      struct sigaction signal_action;
-	      struct sigevent signal_event;
-	      signal_action.sa_flags = SA_SIGINFO;
-	      signal_action.sa_sigaction = ats_handler;
-	      sigemptyset(&signal_action.sa_mask);
-	      if (sigaction(SIGRTMIN, &signal_action, NULL) == -1)
-		      perror("sigaction");
+	rte_mempool_calc_obj_size(sizeof(struct ats_timer), ATS_POOL_FLAGS,
+			&sz);
+	return (uint64_t)nb_timers * sz.total_size;
+}
 
+int
+ats_timer_arm(struct dp_session_info *session)
+{
+	struct ats_timer *tmr = session->ats_tmr;
 
-		  signal_event.sigev_notify = SIGEV_SIGNAL;
-		  signal_event.sigev_signo = SIGRTMIN;
-		  signal_event.sigev_value.sival_int = apn_idx;  //APN IDX
-			  if (timer_create(CLOCK_REALTIME, &signal_event, &apn_timer_struct->timer_id) == -1)
-				 perror("timer_create");
+	if (ats_wheel.pool == NULL)
+		return -1;
 
-		  printf("added timer for APN ID %d for interval %d\n", apn_timer_struct->idx, interval_in_secs);
+	if (tmr == NULL) {
+		if (rte_mempool_get(ats_wheel.pool, (void **)&tmr) < 0) {
+			RTE_LOG_DP(ERR, DP, "No session timer for session id "
+					"0x%"PRIx64"\n", session->sess_id);
+			return -1;
 		}
+		session->ats_tmr = tmr;
+	} else {
+		LIST_REMOVE(tmr, next);
+	}
 
-	   timer_spec.it_value.tv_sec = interval_in_secs; //time threshold from CP for this particular APN
-	   timer_spec.it_value.tv_nsec = 0;
-	   timer_spec.it_interval.tv_sec = timer_spec.it_value.tv_sec;
-	   timer_spec.it_interval.tv_nsec = timer_spec.it_value.tv_nsec;
+	tmr->sess_id = session->sess_id;
+	tmr->period = RTE_MAX(session->ipcan_dp_bearer_cdr.tmr_trshld *
+			1000 / ATS_TICK_MS, 1ULL);
+	tmr->expire = ats_wheel.cur + tmr->period;
+	ats_wheel_insert(tmr);
 
-	   if (timer_settime(apn_timer_struct->timer_id, 0, &timer_spec, NULL) == -1)
-			perror("timer_settime");
+	return 0;
+}
 
+void
+ats_timer_cancel(struct dp_session_info *session)
+{
+	struct ats_timer *tmr = session->ats_tmr;
 
-}
+	if (tmr == NULL)
+		return;
 
+	LIST_REMOVE(tmr, next);
+	rte_mempool_put(ats_wheel.pool, tmr);
+	session->ats_tmr = NULL;
+}
 
-static void ats_handler(int sig, siginfo_t *si, void *uc)
-	   {
-		   int apn_idx = si->si_value.sival_int;
-		   apn_timer_struct_t *apn_timer_struct = &apn_timers[apn_idx];
-		   session_t *head = &apn_timer_struct->list_head;
-		   struct dp_session_info *session;
-		   time_t ts = 0;
-
-		   printf("Timer expired for APN IDX %d on lcore %u\n", apn_timer_struct->idx, rte_lcore_id());
-
-		   if ((!apn_timer_struct->lock) && (head->next != NULL))	{
-				  ts = head->next->ts;
-
-				  while (head->next->ts == ts) {
-					 head->next->ts = time(NULL);
-					 session = get_session_data(head->next->session_id, SESS_MODIFY);
-					 if (session == NULL) {
-						 printf("Session id 0x%"PRIx64" not found\n", head->next->session_id);
-						 continue;
-					 }
-					 update_vol_on_rec_close(session, CDR_REC_TIME);
-					 int ret = rte_ring_enqueue(cdr_ring, (void *)head->next->session_id);
-					 if (ret == -ENOBUFS)
-						 printf("Failed to Enqueue into cdr_ring after timer threshold\n");
-					 ats_list_move_to_tail(apn_idx);
-					 ats_manage_per_apn_timer(head->next->ts - ts, UPDATE_TIMER, apn_idx);
-				  }
-
-			}
-	   }
-
-#if 0
-int main(void)
+void
+ats_poll(void)
 {
-	int session_id, apn_id;
-	for (apn_id = 0 ; apn_id < MAX_NB_APN ; apn_id++) {
-		ats_init(6, apn_id); //Timer threahold 6 seconds
-
-		for (session_id = 0; session_id < MAX_SESSIONS; session_id++ ) {
-			ats_list_add_to_tail(session_id, apn_id);
-			printf("added session: %d to apn_id %d: \n", session_id, apn_id);
-			sleep(rand()%10);
-		}
-	}
+	uint64_t now;
+
+	if (ats_wheel.pool == NULL)
+		return;
 
-	while(getchar());
-return 0;
+	now = rte_rdtsc();
+	while (now >= ats_wheel.next_tsc) {
+		ats_wheel_tick();
+		ats_wheel.next_tsc += ats_wheel.tick_cycles;
+	}
+	ats_expired_flush();
 }
-#endif
@@ -49,13 +49,13 @@ notification_handler(struct rte_mbuf **pkts, uint32_t n)
 	struct rte_mbuf *buf_pkt = NULL;
 	struct rte_ring *ring;
 	struct dp_session_info *data;
-	struct dp_session_info *sess_info[MAX_BURST_SZ];
+	struct dp_session_hot *sess_info[MAX_BURST_SZ];
 	unsigned int *ring_entry = NULL;
 	uint64_t pkt_mask = 0, pkts_queue_mask = 0;
 	int64_t *sess = NULL;
 	unsigned int ret = 32, num = 32, i;
 
-	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ];
+	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ] = {NULL};
 
 	for (i = 0; i < n; ++i) {
 		buf_pkt = pkts[i];
@@ -68,7 +68,7 @@ notification_handler(struct rte_mbuf **pkts, uint32_t n)
 		rte_ctrlmbuf_free(buf_pkt);
 		ring = data->dl_ring;
 		if (data->sess_state != CONNECTED)
-			data->sess_state = CONNECTED;
+			dp_session_set_state(data, CONNECTED);
 
 		if (!ring)
 			continue; /* No dl ring*/
@@ -78,7 +78,7 @@ notification_handler(struct rte_mbuf **pkts, uint32_t n)
 					(void **)pkts, num, ring_entry);
 			pkt_mask = (1 << ret) - 1;
 			for (i = 0; i < ret; ++i)
-				sess_info[i] = data;
+				sess_info[i] = data->hot;
 			gtpu_encap(&sess_info[0], (struct rte_mbuf **)pkts, ret,
 					&pkt_mask, &pkts_queue_mask);
 			if (pkts_queue_mask != 0)
@@ -89,8 +89,8 @@ notification_handler(struct rte_mbuf **pkts, uint32_t n)
 					&pkt_mask, app.s1u_port, &sdf_info[0]);
 			uint32_t pkt_indx = 0;
 
-			epc_app.dl_params[SGI_PORT_ID].pkts_in += ret;
-			epc_app.dl_params[SGI_PORT_ID].ddn -= ret;
+			EPC_DL_PARAMS.pkts_in += ret;
+			EPC_DL_PARAMS.ddn -= ret;
 
 			while (ret) {
 				uint16_t pkt_cnt = PKT_BURST_SZ;
@@ -203,10 +203,6 @@ filter_ul_traffic(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 	 * ul_perf_stats.op_time[8] = ul_sess_hash */
 	SET_PERF_MAX_MIN_TIME(ul_perf_stats.op_time[8], _init_time, n, 0);
 
-  /*update_sdf_cdr(&adc_ue_info[0], &sdf_bearer_info[0], pkts, n,
-  		&adc_pkts_mask, pkts_mask, UL_FLOW);*/
-	update_pcc_cdr(&sdf_bearer_info[0], pkts, n, pkts_mask,
-			&pcc_rule_id[0], UL_FLOW);
 #else
 	sdf_rule_id = sdf_lookup(pkts, n);
 
@@ -230,12 +226,20 @@ filter_ul_traffic(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 	pcc_gating(&sdf_info[0], &adc_info[0], n, pkts_mask, &pcc_rule_id[0]);
 
 	ul_sess_info_get(pkts, n, pkts_mask, &sdf_bearer_info[0]);
+#endif /* PERF_ANALYSIS */
+#ifdef SDF_MTR
+	/* MBR policing, per ADC UE or SDF bearer meter */
+	sdf_mtr_process_pkt(&sdf_bearer_info[0], &adc_ue_info[0], NULL,
+			UL_FLOW, pkts, n, pkts_mask);
+#endif /* SDF_MTR */
+#ifdef APN_MTR
+	/* APN-AMBR policing for non-GBR bearers */
+	apn_mtr_process_pkt(&sdf_bearer_info[0], UL_FLOW, pkts, n, pkts_mask);
+#endif /* APN_MTR */
 
   /*update_sdf_cdr(&adc_ue_info[0], &sdf_bearer_info[0], pkts, n,
   		&adc_pkts_mask, pkts_mask, UL_FLOW);*/
-	update_pcc_cdr(&sdf_bearer_info[0], pkts, n, pkts_mask,
-			&pcc_rule_id[0], UL_FLOW);
-#endif /* PERF_ANALYSIS */
+	update_pcc_cdr(&sdf_bearer_info[0], pkts, n, pkts_mask, UL_FLOW);
 	return;
 }
 
@@ -252,7 +256,7 @@ s1u_pkt_handler(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 	uint32_t next_port = 0; //GCC_Security flag
 
 	/* ASR-Probe:: Log(struct rte_mbuf **pkts, uint32_t n) */
-	epc_app.ul_params[S1U_PORT_ID].nb_pkts += (uint64_t)n;
+	EPC_UL_PARAMS.nb_pkts += (uint64_t)n;
 
 	switch(app.spgw_cfg) {
 		case SPGWU: {
@@ -327,7 +331,7 @@ int
 sgw_s5_s8_pkt_handler(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 {
 	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ] = {NULL};
-	struct dp_session_info *si[MAX_BURST_SZ] = {NULL};
+	struct dp_session_hot *si[MAX_BURST_SZ] = {NULL};
 
 	/* Get downlink session info */
 	dl_sess_info_get(pkts, n, pkts_mask, &sdf_info[0], &si[0]);
@@ -373,7 +377,7 @@ pgw_s5_s8_pkt_handler(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 static void
 filter_dl_traffic(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
 		struct dp_sdf_per_bearer_info *sdf_info[],
-		struct dp_session_info *si[])
+		struct dp_session_hot *si[])
 {
 	uint32_t *sdf_rule_id = NULL;
 	struct pcc_id_precedence sdf_info_dl[MAX_BURST_SZ];
@@ -488,11 +492,19 @@ filter_dl_traffic(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
 	dl_sess_info_get(pkts, n, pkts_mask, &sdf_info[0], &si[0]);
 
 #endif /* PERF_ANALYSIS */
+#ifdef SDF_MTR
+	/* MBR policing, per SDF bearer meter */
+	sdf_mtr_process_pkt(&sdf_info[0], NULL, NULL, DL_FLOW, pkts, n,
+			pkts_mask);
+#endif /* SDF_MTR */
+#ifdef APN_MTR
+	/* APN-AMBR policing for non-GBR bearers */
+	apn_mtr_process_pkt(&sdf_info[0], DL_FLOW, pkts, n, pkts_mask);
+#endif /* APN_MTR */
 	/*update_sdf_cdr(&adc_ue_info[0], &sdf_info[0], pkts, n,
 			&adc_pkts_mask, pkts_mask, DL_FLOW);*/
 
-	update_pcc_cdr(&sdf_info[0], pkts, n, pkts_mask,
-			&pcc_rule_id[0], DL_FLOW);
+	update_pcc_cdr(&sdf_info[0], pkts, n, pkts_mask, DL_FLOW);
 
 #ifdef HYPERSCAN_DPI
 #ifdef PERF_ANALYSIS
@@ -524,12 +536,12 @@ sgi_pkt_handler(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask)
 	TIMER_GET_CURRENT_TP(_sgi_init_time);
 #endif /* PERF_ANALYSIS */
 	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ] = {NULL};
-	struct dp_session_info *si[MAX_BURST_SZ] = {NULL};
+	struct dp_session_hot *si[MAX_BURST_SZ] = {NULL};
 	uint64_t pkts_queue_mask = 0;
 	uint32_t next_port = 0; //GCC_Security flag
 
 	/* ASR-Probe:: Log(struct rte_mbuf **pkts, uint32_t n) */
-	epc_app.dl_params[SGI_PORT_ID].nb_pkts += (uint64_t)n;
+	EPC_DL_PARAMS.nb_pkts += (uint64_t)n;
 
 	/**
 	 * TODO : filter_dl_traffic and gtpu_encap can be called irrespective
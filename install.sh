@@ -204,17 +204,6 @@ download_dpdk_zip()
 		echo "AVX patch successfully applied to dpdk."
 	fi
 
-	echo ""
-	echo "Applying KNI Mbuf allloc patch for resolved DP freeze issue(VCCCCB-42).."
-	patch $DPDK_DIR/lib/librte_kni/rte_kni.c $NGIC_DIR/patches/kni_mbuf_alloc.patch
-
-	if [ $? -ne 0 ] ; then
-		echo "Failed to apply KNI mbuf alloc patch, please check the errors."
-		return
-	else
-		echo "KNI mbuf alloc patch successfully applied to dpdk."
-	fi
-
 }
 
 install_dpdk()
@@ -230,24 +219,9 @@ install_dpdk()
 		return
 	fi
 
-	if lsmod | grep rte_kni >&/dev/null; then
-		echo -e "\n*************************************"
-		echo "rte_kni.ko module already loaded..!!!"
-		echo -e "*************************************\n"
-	else
-		sudo $INSMOD "$RTE_TARGET"/kmod/rte_kni.ko
-
-		if lsmod | grep rte_kni >&/dev/null; then
-			echo -e "\n*********************************"
-			echo "Inserted 'rte_kni.ko' module..!!!"
-			echo -e "*********************************\n"
-		else
-			echo -e "\n**********************************************"
-			echo "ERROR: 'rte_kni.ko' module failed to load..!!!"
-			echo -e "**********************************************\n"
-		fi
-
-	fi
+	# Kernel exception path: TAP PMD, or virtio-user on vhost-net
+	sudo $MODPROBE -v tun
+	sudo $MODPROBE -v vhost_net
 
 	sudo modinfo igb_uio
 	if [ $? -ne 0 ] ; then
@@ -637,8 +637,8 @@ int process_cdr_queue(void)
 			struct resp_msgbuf resp = {0};
 			resp.dp_id.id = DPN_ID;
 			resp.mtype = CDR_UPDATE;
-			create_cdr_report(&resp, sess_id);
-			zmq_mbuf_push((void *)&resp, sizeof(resp));
+			if (close_cdr_report(&resp, sess_id) == 0)
+				zmq_mbuf_push((void *)&resp, sizeof(resp));
 		}
 	return 0;
 }
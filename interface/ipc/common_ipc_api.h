@@ -82,6 +82,9 @@ struct resp_msgbuf {
 };
 struct resp_msgbuf r_buf;
 int create_cdr_report(struct resp_msgbuf *resp, uint64_t sess_id);
+/* Close the volume or time threshold record of a session dequeued from
+ * cdr_ring and report it. CP interface thread only. */
+int close_cdr_report(struct resp_msgbuf *resp, uint64_t sess_id);
 
 /*
  * Message Structure
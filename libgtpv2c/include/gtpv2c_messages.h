@@ -199,4 +199,10 @@ int
 decode_delete_session_response_t(uint8_t *msg,
 		delete_session_response_t *ds_resp);
 
+int
+decode_gtpv2c_msg_view_t(uint8_t *msg, gtpv2c_msg_view_t *view);
+
+gtpv2c_ie_view_t *
+gtpv2c_view_ie(gtpv2c_msg_view_t *view, uint8_t type, uint8_t instance);
+
 #endif /* _LIBGTPV2C_MESSAGES_H_ */
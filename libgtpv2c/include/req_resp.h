@@ -91,4 +91,24 @@ typedef struct delete_session_response_t {
 
 #pragma pack()
 
+/* Max IEs located by a message view */
+#define GTPV2C_VIEW_MAX_IES 32
+
+/* Instance bits of the IE header instance octet */
+#define IE_INSTANCE_MASK 0x0f
+
+typedef struct gtpv2c_ie_view_t {
+	uint8_t type;
+	uint8_t instance;
+	uint16_t len;
+	/* IE value, in the received message buffer */
+	uint8_t *val;
+} gtpv2c_ie_view_t;
+
+typedef struct gtpv2c_msg_view_t {
+	gtpv2c_header_t header;
+	uint8_t nb_ies;
+	gtpv2c_ie_view_t ies[GTPV2C_VIEW_MAX_IES];
+} gtpv2c_msg_view_t;
+
 #endif /* __LIBGTPV2C_REQ_RESP_H_ */
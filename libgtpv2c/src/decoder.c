@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -990,8 +992,45 @@ decode_gtpv2c_header_t(uint8_t *buf, gtpv2c_header_t *header)
 	return count;
 }
 
+/* IE decoders in table form: decoded member passed as void * */
+typedef int (*ie_decoder_t)(uint8_t *buf, void *val);
+
+#define IE_DECODER(name, type_t) \
+static int \
+ie_##name(uint8_t *buf, void *val) \
+{ \
+	return decode_##name(buf, (type_t *) val); \
+}
+
+IE_DECODER(imsi_ie_t, imsi_ie_t)
+IE_DECODER(msisdn_ie_t, msisdn_ie_t)
+IE_DECODER(mei_ie_t, mei_ie_t)
+IE_DECODER(serving_network_ie_t, serving_network_ie_t)
+IE_DECODER(rat_type_ie_t, rat_type_ie_t)
+IE_DECODER(indication_ie_t, indication_ie_t)
+IE_DECODER(fteid_ie_t, fteid_ie_t)
+IE_DECODER(apn_ie_t, apn_ie_t)
+IE_DECODER(ambr_ie_t, ambr_ie_t)
+IE_DECODER(pco_ie_t, pco_ie_t)
+IE_DECODER(selection_mode_ie_t, selection_mode_ie_t)
+IE_DECODER(pdn_type_ie_t, pdn_type_ie_t)
+IE_DECODER(paa_ie_t, paa_ie_t)
+IE_DECODER(apn_restriction_ie_t, apn_restriction_ie_t)
+IE_DECODER(charging_char_ie_t, charging_char_ie_t)
+IE_DECODER(recover_ie_t, recovery_ie_t)
+IE_DECODER(ue_timezone_ie_t, ue_timezone_ie_t)
+IE_DECODER(eps_bearer_id_ie_t, eps_bearer_id_ie_t)
+IE_DECODER(cause_ie_t, cause_ie_t)
+IE_DECODER(bearer_context_to_be_created_ie_t,
+		bearer_context_to_be_created_ie_t)
+IE_DECODER(bearer_context_created_ie_t, bearer_context_created_ie_t)
+IE_DECODER(bearer_context_to_be_modified_ie_t,
+		bearer_context_to_be_modified_ie_t)
+IE_DECODER(bearer_context_modified_ie_t, bearer_context_modified_ie_t)
+
 /**
- * decodes buffer to create session request.
+ * decodes create session request ULI both as octet string, for CDRs,
+ * and into the ULI struct based on flags.
  * @param buf
  *   buffer to be decoded
  * @param val
@@ -999,114 +1038,202 @@ decode_gtpv2c_header_t(uint8_t *buf, gtpv2c_header_t *header)
  * @return
  *   number of decoded bytes.
  */
-int
-decode_create_session_request_t(uint8_t *msg,
-		create_session_request_t *cs_req)
+static int
+ie_cs_req_uli(uint8_t *buf, void *val)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
+	create_session_request_t *cs_req = val;
+
+	decode_uli_info_ie_t(buf, &cs_req->uli_info);
+	return decode_uli_ie_t(buf, &cs_req->uli);
+}
+
+/* IE instances decoded into message structs, higher ones are skipped */
+#define IE_DECODE_INSTANCES 2
+
+/**
+ * IE decoder and decoded member of a message struct.
+ */
+struct ie_decode_desc {
+	ie_decoder_t decode;
+	uint16_t offset;
+};
+
+/* Message IE dispatch, indexed by IE type and instance */
+typedef struct ie_decode_desc ie_decode_table_t[UINT8_MAX + 1]
+		[IE_DECODE_INSTANCES];
+
+#define IE_DECODE(type, instance, msg_t, member, name) \
+	[type][instance] = { ie_##name, offsetof(msg_t, member) }
+
+static const ie_decode_table_t cs_req_ies = {
+	IE_DECODE(IE_IMSI, IE_INSTANCE_ZERO,
+			create_session_request_t, imsi, imsi_ie_t),
+	IE_DECODE(IE_MSISDN, IE_INSTANCE_ZERO,
+			create_session_request_t, msisdn, msisdn_ie_t),
+	IE_DECODE(IE_MEI, IE_INSTANCE_ZERO,
+			create_session_request_t, mei, mei_ie_t),
+	[IE_ULI][IE_INSTANCE_ZERO] = { ie_cs_req_uli, 0 },
+	IE_DECODE(IE_SERVING_NETWORK, IE_INSTANCE_ZERO,
+			create_session_request_t, serving_nw, serving_network_ie_t),
+	IE_DECODE(IE_RAT_TYPE, IE_INSTANCE_ZERO,
+			create_session_request_t, rat_type, rat_type_ie_t),
+	IE_DECODE(IE_INDICATION, IE_INSTANCE_ZERO,
+			create_session_request_t, indication, indication_ie_t),
+	IE_DECODE(IE_FTEID, IE_INSTANCE_ZERO,
+			create_session_request_t, sender_ftied, fteid_ie_t),
+	IE_DECODE(IE_FTEID, IE_INSTANCE_ONE,
+			create_session_request_t, s5s8pgw_pmip, fteid_ie_t),
+	IE_DECODE(IE_APN, IE_INSTANCE_ZERO,
+			create_session_request_t, apn, apn_ie_t),
+	IE_DECODE(IE_AMBR, IE_INSTANCE_ZERO,
+			create_session_request_t, ambr, ambr_ie_t),
+	IE_DECODE(IE_PCO, IE_INSTANCE_ZERO,
+			create_session_request_t, pco, pco_ie_t),
+	IE_DECODE(IE_SELECTION_MODE, IE_INSTANCE_ZERO,
+			create_session_request_t, seletion_mode, selection_mode_ie_t),
+	IE_DECODE(IE_PDN_TYPE, IE_INSTANCE_ZERO,
+			create_session_request_t, pdn_type, pdn_type_ie_t),
+	IE_DECODE(IE_PAA, IE_INSTANCE_ZERO,
+			create_session_request_t, paa, paa_ie_t),
+	IE_DECODE(IE_APN_RESTRICTION, IE_INSTANCE_ZERO,
+			create_session_request_t, apn_restriction,
+			apn_restriction_ie_t),
+	IE_DECODE(IE_CHARGING_CHARACTERISTICS, IE_INSTANCE_ZERO,
+			create_session_request_t, charging_characteristics,
+			charging_char_ie_t),
+	IE_DECODE(IE_BEARER_CONTEXT, IE_INSTANCE_ZERO,
+			create_session_request_t, bearer_context,
+			bearer_context_to_be_created_ie_t),
+	IE_DECODE(IE_RECOVERY, IE_INSTANCE_ZERO,
+			create_session_request_t, recovery, recover_ie_t),
+	IE_DECODE(IE_UE_TIME_ZONE, IE_INSTANCE_ZERO,
+			create_session_request_t, ue_timezone, ue_timezone_ie_t),
+};
+
+static const ie_decode_table_t cs_resp_ies = {
+	IE_DECODE(IE_CAUSE, IE_INSTANCE_ZERO,
+			create_session_response_t, cause, cause_ie_t),
+	IE_DECODE(IE_FTEID, IE_INSTANCE_ZERO,
+			create_session_response_t, s11_ftied, fteid_ie_t),
+	IE_DECODE(IE_FTEID, IE_INSTANCE_ONE,
+			create_session_response_t, pgws5s8_pmip, fteid_ie_t),
+	IE_DECODE(IE_PAA, IE_INSTANCE_ZERO,
+			create_session_response_t, paa, paa_ie_t),
+	IE_DECODE(IE_APN_RESTRICTION, IE_INSTANCE_ZERO,
+			create_session_response_t, apn_restriction,
+			apn_restriction_ie_t),
+	IE_DECODE(IE_BEARER_CONTEXT, IE_INSTANCE_ZERO,
+			create_session_response_t, bearer_context,
+			bearer_context_created_ie_t),
+};
+
+static const ie_decode_table_t mb_req_ies = {
+	IE_DECODE(IE_INDICATION, IE_INSTANCE_ZERO,
+			modify_bearer_request_t, indication, indication_ie_t),
+	IE_DECODE(IE_FTEID, IE_INSTANCE_ZERO,
+			modify_bearer_request_t, s11_mme_fteid, fteid_ie_t),
+	IE_DECODE(IE_BEARER_CONTEXT, IE_INSTANCE_ZERO,
+			modify_bearer_request_t, bearer_context,
+			bearer_context_to_be_modified_ie_t),
+};
+
+static const ie_decode_table_t mb_resp_ies = {
+	IE_DECODE(IE_CAUSE, IE_INSTANCE_ZERO,
+			modify_bearer_response_t, cause, cause_ie_t),
+	IE_DECODE(IE_BEARER_CONTEXT, IE_INSTANCE_ZERO,
+			modify_bearer_response_t, bearer_context,
+			bearer_context_modified_ie_t),
+};
+
+static const ie_decode_table_t ds_req_ies = {
+	IE_DECODE(IE_EBI, IE_INSTANCE_ZERO,
+			delete_session_request_t, linked_ebi, eps_bearer_id_ie_t),
+	IE_DECODE(IE_INDICATION, IE_INSTANCE_ZERO,
+			delete_session_request_t, indication_flags, indication_ie_t),
+};
+
+static const ie_decode_table_t ds_resp_ies = {
+	IE_DECODE(IE_CAUSE, IE_INSTANCE_ZERO,
+			delete_session_response_t, cause, cause_ie_t),
+};
+
+/**
+ * IE payload length of a message, i.e. message length less teid
+ * and sequence number.
+ * @param header
+ *   decoded gtpv2c header
+ * @return
+ *   IE payload length.
+ */
+static inline uint16_t
+gtpv2c_ies_len(gtpv2c_header_t *header)
+{
+	if (header->gtpc.teid_flag)
+		return header->gtpc.message_len - 8;
+	return header->gtpc.message_len - 4;
+}
 
-	count = decode_gtpv2c_header_t(msg + count, &cs_req->header);
+/**
+ * decodes message header, then each IE through the message dispatch
+ * table; IEs without a decoder are skipped.
+ * @param msg
+ *   buffer to be decoded
+ * @param val
+ *   message struct, starting with its gtpv2c header
+ * @param header
+ *   gtpv2c header of val
+ * @param ies
+ *   message dispatch table
+ * @return
+ *   number of decoded bytes.
+ */
+static int
+decode_msg_ies(uint8_t *msg, void *val, gtpv2c_header_t *header,
+		const ie_decode_table_t ies)
+{
+	const struct ie_decode_desc *desc;
+	ie_header_t *ie_header;
+	uint16_t count;
+	uint16_t msg_len;
 
-	if (cs_req->header.gtpc.teid_flag)
-		msg_len = cs_req->header.gtpc.message_len - 8;
-	else
-		msg_len = cs_req->header.gtpc.message_len - 4;
+	count = decode_gtpv2c_header_t(msg, header);
+	msg_len = gtpv2c_ies_len(header);
 
 	msg = msg + count;
 	count = 0;
 
 	while (count < msg_len) {
-
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
-
-		if (ie_header->type == IE_IMSI &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_imsi_ie_t(msg + count, &cs_req->imsi);
-		} else if (ie_header->type == IE_MSISDN &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_msisdn_ie_t(msg + count, &cs_req->msisdn);
-		} else if (ie_header->type == IE_MEI &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_mei_ie_t(msg + count, &cs_req->mei);
-		} else if (ie_header->type == IE_ULI &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			//Decode ULI Info as it is (in Octet string format for CDR's
-			decode_uli_info_ie_t(msg + count, &cs_req->uli_info);
-			//Decode ULI info into the ULI struct based on flags
-			count += decode_uli_ie_t(msg + count, &cs_req->uli);
-		} else if (ie_header->type == IE_SERVING_NETWORK &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_serving_network_ie_t(msg + count,
-					&cs_req->serving_nw);
-		} else if (ie_header->type == IE_RAT_TYPE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_rat_type_ie_t(msg + count,
-					&cs_req->rat_type);
-		} else if (ie_header->type == IE_INDICATION &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_indication_ie_t(msg + count,
-								&cs_req->indication);
-		} else if (ie_header->type == IE_FTEID &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_fteid_ie_t(msg + count,
-								&cs_req->sender_ftied);
-		} else if (ie_header->type == IE_FTEID &&
-				ie_header->instance == IE_INSTANCE_ONE) {
-			count += decode_fteid_ie_t(msg + count,
-								&cs_req->s5s8pgw_pmip);
-		} else if (ie_header->type == IE_APN &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_apn_ie_t(msg + count,
-								&cs_req->apn);
-		} else if (ie_header->type == IE_AMBR &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_ambr_ie_t(msg + count,
-								&cs_req->ambr);
-		} else if (ie_header->type == IE_PCO &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_pco_ie_t(msg + count,
-								 &cs_req->pco);
-		} else if (ie_header->type == IE_SELECTION_MODE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_selection_mode_ie_t(msg + count,
-								&cs_req->seletion_mode);
-		} else if (ie_header->type == IE_PDN_TYPE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_pdn_type_ie_t(msg + count,
-								&cs_req->pdn_type);
-		} else if (ie_header->type == IE_PAA &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_paa_ie_t(msg + count,
-								&cs_req->paa);
-		} else if (ie_header->type == IE_APN_RESTRICTION &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_apn_restriction_ie_t(msg + count,
-								&cs_req->apn_restriction);
-		} else if (ie_header->type == IE_CHARGING_CHARACTERISTICS &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_charging_char_ie_t(msg + count,
-								&cs_req->charging_characteristics);
-		} else if (ie_header->type == IE_BEARER_CONTEXT &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_bearer_context_to_be_created_ie_t(msg + count,
-								&cs_req->bearer_context);
-		} else if (ie_header->type == IE_RECOVERY &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_recover_ie_t(msg + count,
-								&cs_req->recovery);
-		} else if (ie_header->type == IE_UE_TIME_ZONE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_ue_timezone_ie_t(msg + count,
-								&cs_req->ue_timezone);
-		} else {
+		ie_header = (ie_header_t *) (msg + count);
+		desc = NULL;
+		if (ie_header->instance < IE_DECODE_INSTANCES)
+			desc = &ies[ie_header->type][ie_header->instance];
+
+		if (desc != NULL && desc->decode != NULL)
+			count += desc->decode(msg + count,
+					(uint8_t *) val + desc->offset);
+		else
 			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
 	}
 
 	return count;
 }
 
+/**
+ * decodes buffer to create session request.
+ * @param buf
+ *   buffer to be decoded
+ * @param val
+ *   create session request
+ * @return
+ *   number of decoded bytes.
+ */
+int
+decode_create_session_request_t(uint8_t *msg,
+		create_session_request_t *cs_req)
+{
+	return decode_msg_ies(msg, cs_req, &cs_req->header, cs_req_ies);
+}
+
 /**
  * decodes buffer to create session response.
  * @param buf
@@ -1120,52 +1247,7 @@ int
 decode_create_session_response_t(uint8_t *msg,
 		create_session_response_t *cs_resp)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
-
-	count = decode_gtpv2c_header_t(msg + count, &cs_resp->header);
-
-	if (cs_resp->header.gtpc.teid_flag)
-		msg_len = cs_resp->header.gtpc.message_len - 8;
-	else
-		msg_len = cs_resp->header.gtpc.message_len - 4;
-
-	msg = msg + count;
-	count = 0;
-
-	while (count < msg_len) {
-
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
-
-		if (ie_header->type == IE_CAUSE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_cause_ie_t(msg + count, &cs_resp->cause);
-		} else if (ie_header->type == IE_FTEID &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_fteid_ie_t(msg + count,
-								&cs_resp->s11_ftied);
-		} else if (ie_header->type == IE_FTEID &&
-				ie_header->instance == IE_INSTANCE_ONE) {
-			count += decode_fteid_ie_t(msg + count,
-								&cs_resp->pgws5s8_pmip);
-		} else if (ie_header->type == IE_PAA &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_paa_ie_t(msg + count,
-								&cs_resp->paa);
-		} else if (ie_header->type == IE_APN_RESTRICTION &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_apn_restriction_ie_t(msg + count,
-								&cs_resp->apn_restriction);
-		} else if (ie_header->type == IE_BEARER_CONTEXT &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_bearer_context_created_ie_t(msg + count,
-								&cs_resp->bearer_context);
-		} else {
-			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
-	}
-
-	return count;
+	return decode_msg_ies(msg, cs_resp, &cs_resp->header, cs_resp_ies);
 }
 
 /**
@@ -1181,40 +1263,7 @@ int
 decode_modify_bearer_request_t(uint8_t *msg,
 		modify_bearer_request_t *mb_req)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
-
-	count = decode_gtpv2c_header_t(msg + count, &mb_req->header);
-
-	if (mb_req->header.gtpc.teid_flag)
-		msg_len = mb_req->header.gtpc.message_len - 8;
-	else
-		msg_len = mb_req->header.gtpc.message_len - 4;
-
-	msg = msg + count;
-	count = 0;
-
-	while (count < msg_len) {
-
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
-
-		if (ie_header->type == IE_INDICATION &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_indication_ie_t(msg + count, &mb_req->indication);
-		} else if (ie_header->type == IE_FTEID &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_fteid_ie_t(msg + count,
-								&mb_req->s11_mme_fteid);
-		} else if (ie_header->type == IE_BEARER_CONTEXT &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_bearer_context_to_be_modified_ie_t(msg + count,
-					&mb_req->bearer_context);
-		} else {
-			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
-	}
-
-	return count;
+	return decode_msg_ies(msg, mb_req, &mb_req->header, mb_req_ies);
 }
 
 /**
@@ -1230,36 +1279,7 @@ int
 decode_modify_bearer_response_t(uint8_t *msg,
 		modify_bearer_response_t *mb_resp)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
-
-	count = decode_gtpv2c_header_t(msg + count, &mb_resp->header);
-
-	if (mb_resp->header.gtpc.teid_flag)
-		msg_len = mb_resp->header.gtpc.message_len - 8;
-	else
-		msg_len = mb_resp->header.gtpc.message_len - 4;
-
-	msg = msg + count;
-	count = 0;
-
-	while (count < msg_len) {
-
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
-
-		if (ie_header->type == IE_CAUSE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_cause_ie_t(msg + count, &mb_resp->cause);
-		} else if (ie_header->type == IE_BEARER_CONTEXT &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_bearer_context_modified_ie_t(msg + count,
-								&mb_resp->bearer_context);
-		} else {
-			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
-	}
-
-	return count;
+	return decode_msg_ies(msg, mb_resp, &mb_resp->header, mb_resp_ies);
 }
 
 /**
@@ -1267,7 +1287,7 @@ decode_modify_bearer_response_t(uint8_t *msg,
  * @param buf
  *   buffer to be decoded
  * @param val
- *   modify delete session request
+ *   delete session request
  * @return
  *   number of decoded bytes.
  */
@@ -1275,37 +1295,7 @@ int
 decode_delete_session_request_t(uint8_t *msg,
 		delete_session_request_t *ds_req)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
-
-	count = decode_gtpv2c_header_t(msg + count, &ds_req->header);
-
-	if (ds_req->header.gtpc.teid_flag)
-		msg_len = ds_req->header.gtpc.message_len - 8;
-	else
-		msg_len = ds_req->header.gtpc.message_len - 4;
-
-	msg = msg + count;
-	count = 0;
-
-	while (count < msg_len) {
-
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
-
-		if (ie_header->type == IE_EBI &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_eps_bearer_id_ie_t(msg + count,
-					&ds_req->linked_ebi);
-		} else if (ie_header->type == IE_INDICATION &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_indication_ie_t(msg + count,
-					&ds_req->indication_flags);
-		} else {
-			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
-	}
-
-	return count;
+	return decode_msg_ies(msg, ds_req, &ds_req->header, ds_req_ies);
 }
 
 /**
@@ -1313,7 +1303,7 @@ decode_delete_session_request_t(uint8_t *msg,
  * @param buf
  *   buffer to be decoded
  * @param val
- *   modify delete session response
+ *   delete session response
  * @return
  *   number of decoded bytes.
  */
@@ -1321,31 +1311,75 @@ int
 decode_delete_session_response_t(uint8_t *msg,
 		delete_session_response_t *ds_resp)
 {
-	uint16_t count = 0;
-	uint16_t msg_len;
+	return decode_msg_ies(msg, ds_resp, &ds_resp->header, ds_resp_ies);
+}
 
-	count = decode_gtpv2c_header_t(msg + count, &ds_resp->header);
+/**
+ * decodes buffer to a zero-copy message view: header is decoded, IEs
+ * are only located and point into the buffer, which must outlive the
+ * view. Decoding stops at a truncated IE or after GTPV2C_VIEW_MAX_IES.
+ * @param msg
+ *   buffer to be decoded
+ * @param view
+ *   message view
+ * @return
+ *   number of decoded bytes.
+ */
+int
+decode_gtpv2c_msg_view_t(uint8_t *msg, gtpv2c_msg_view_t *view)
+{
+	ie_header_t *ie_header;
+	gtpv2c_ie_view_t *ie;
+	uint16_t count;
+	uint16_t msg_len;
+	uint16_t ie_len;
 
-	if (ds_resp->header.gtpc.teid_flag)
-		msg_len = ds_resp->header.gtpc.message_len - 8;
-	else
-		msg_len = ds_resp->header.gtpc.message_len - 4;
+	count = decode_gtpv2c_header_t(msg, &view->header);
+	msg_len = gtpv2c_ies_len(&view->header);
 
 	msg = msg + count;
 	count = 0;
+	view->nb_ies = 0;
+
+	while ((count + IE_HEADER_SIZE <= msg_len) &&
+			(view->nb_ies < GTPV2C_VIEW_MAX_IES)) {
+		ie_header = (ie_header_t *) (msg + count);
+		ie_len = ntohs(ie_header->len);
+		if (count + IE_HEADER_SIZE + ie_len > msg_len)
+			break;
+
+		ie = &view->ies[view->nb_ies++];
+		ie->type = ie_header->type;
+		ie->instance = ie_header->instance & IE_INSTANCE_MASK;
+		ie->len = ie_len;
+		ie->val = msg + count + IE_HEADER_SIZE;
+
+		count += IE_HEADER_SIZE + ie_len;
+	}
 
-	while (count < msg_len) {
+	return count;
+}
 
-		ie_header_t *ie_header = (ie_header_t *) (msg + count);
+/**
+ * finds an IE of a message view.
+ * @param view
+ *   decoded message view
+ * @param type
+ *   IE type
+ * @param instance
+ *   IE instance
+ * @return
+ *   first IE of type and instance, NULL if absent.
+ */
+gtpv2c_ie_view_t *
+gtpv2c_view_ie(gtpv2c_msg_view_t *view, uint8_t type, uint8_t instance)
+{
+	uint8_t i;
 
-		if (ie_header->type == IE_CAUSE &&
-				ie_header->instance == IE_INSTANCE_ZERO) {
-			count += decode_cause_ie_t(msg + count,
-					&ds_resp->cause);
-		} else {
-			count += sizeof(ie_header_t) + ntohs(ie_header->len);
-		}
-	}
+	for (i = 0; i < view->nb_ies; i++)
+		if (view->ies[i].type == type &&
+				view->ies[i].instance == instance)
+			return &view->ies[i];
 
-	return count;
+	return NULL;
 }
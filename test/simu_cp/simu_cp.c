@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_eal.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
@@ -38,6 +39,9 @@
 #include "util.h"
 
 #include "cp_stats.h"
+#ifdef DP_BUILD
+#include "mem_budget.h"
+#endif /* DP_BUILD */
 
 #define RTE_LOGTYPE_CP RTE_LOGTYPE_USER4
 
@@ -287,9 +291,15 @@ process_cs_mb_req(struct simu_params *param)
 				 * initial val. cp_stats.create_session = 0; */
 				context=
 					generate_uecontext(cp_stats.create_session, param->max_ue_sess, param->num_enb);
-#endif /* CP_BUILD */
 				sess = rte_zmalloc_socket(NULL, sizeof(struct session_info),
 									RTE_CACHE_LINE_SIZE, rte_socket_id());
+#else /* DP_BUILD */
+				/* DP copies the request: nothing to keep per session */
+				struct session_info sess_req;
+
+				memset(&sess_req, 0, sizeof(struct session_info));
+				sess = &sess_req;
+#endif /* CP_BUILD */
 
 				/*generate teid for each create session */
 				generate_sessteid(&s1u_teid);
@@ -362,8 +372,8 @@ process_cs_mb_req(struct simu_params *param)
 				/* session_info: CP CDR collation handle */
 #ifdef CP_BUILD
 				context->dp_session = sess;
-#endif /* CP_BUILD */
 				sess->dp_session = sess;
+#endif /* CP_BUILD */
 			}
 			if(second_expired)
 				break;
@@ -562,11 +572,18 @@ int simu_cp(void)
 #endif /* CP_BUILD */
 {
 		struct simu_params cfg = {0};
+		uint64_t start;
+		double secs;
 
 		/* Parsing simu config parameters. */
 		int ret = parse_agrs(&cfg);
 		if (ret < 0)
 			exit(1);
+#ifdef DP_BUILD
+		if (cfg.max_ue_sess > app.max_sessions)
+			rte_exit(EXIT_FAILURE, "MAX_UE_SESS %u over --max_sessions %u\n",
+					cfg.max_ue_sess, app.max_sessions);
+#endif /* DP_BUILD */
 		base_imsi = cfg.base_imsi;
 		base_mei = cfg.base_mei;
 		base_msisdn = cfg.base_msisdn;
@@ -587,13 +604,22 @@ int simu_cp(void)
 		sleep(5);
 
 		/* Form and send CS and MB request to DP. */
+		start = rte_rdtsc();
 		ret = process_cs_mb_req(&cfg);
 		if (ret < 0)
 			exit(1);
+		secs = (double)(rte_rdtsc() - start) / rte_get_tsc_hz();
 
 		/* Show CS and MB requests STATS. */
 		sleep(5);
 		print_stats(&cfg);
+		printf("CS+MB: %u sessions in %.1f s, %.0f sessions/s\n",
+				cfg.max_ue_sess, secs,
+				secs > 0 ? cfg.max_ue_sess / secs : 0.0);
+#ifdef DP_BUILD
+		/* Table memory per session at this load */
+		mem_budget_report();
+#endif /* DP_BUILD */
 
 #ifdef DEL_SESS_REQ
 		sleep(cfg.duration);
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_udp.h>
+
+#include "acl_dp.h"
+#include "acl_swap.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+static volatile int acl_swap_stop;
+static uint64_t acl_swap_lookups;
+static uint64_t acl_swap_misses;
+static uint64_t acl_swap_max_cycles;
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Build UL DNS response: ether + ipv4 + udp sport 53.
+ */
+static struct rte_mbuf *acl_swap_probe(struct rte_mempool *mp)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(mp);
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m, sizeof(*eth) +
+			sizeof(*ip) + sizeof(*udp));
+	memset(eth, 0, sizeof(*eth) + sizeof(*ip) + sizeof(*udp));
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *)(eth + 1);
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(8, 8, 8, 8));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(16, 0, 0, 1));
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + sizeof(*udp));
+
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = rte_cpu_to_be_16(53);
+	udp->dst_port = rte_cpu_to_be_16(33000);
+	udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp));
+
+	return m;
+}
+
+/**
+ * Reader: classify probe on active ADC UL table until stopped.
+ */
+static int acl_swap_reader(void *arg)
+{
+	struct rte_mbuf *m = arg;
+	uint64_t start, cycles;
+	uint32_t *res;
+
+	epc_qs_online();
+	while (!acl_swap_stop) {
+		start = rte_rdtsc();
+		res = adc_ul_lookup(&m, 1);
+		cycles = rte_rdtsc() - start;
+
+		if (res[0] != DNS_RULE_ID)
+			acl_swap_misses++;
+		if (cycles > acl_swap_max_cycles)
+			acl_swap_max_cycles = cycles;
+		acl_swap_lookups++;
+
+		epc_qs_quiescent();
+	}
+	epc_qs_offline();
+
+	return 0;
+}
+
+/**
+ * Add or delete storm rules, none of them matches the probe.
+ */
+static int acl_swap_storm(struct dp_id dp_id, int add)
+{
+	struct pkt_filter pktf;
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < ACL_SWAP_NB_RULES; i++) {
+		pktf.pcc_rule_id = ACL_SWAP_RULE_BASE + i;
+		snprintf(pktf.u.rule_str, MAX_LEN, "10.255.%u.0/24 0.0.0.0/0 "
+			"0 : 65535 0 : 65535 0x0/0x0\n", i);
+		ret = add ? dp_adc_filter_entry_add(dp_id, &pktf) :
+			dp_adc_filter_entry_delete(dp_id, &pktf);
+		if (ret < 0)
+			return -1;
+	}
+	dp_acl_rules_sync();
+
+	return 0;
+}
+
+int acl_swap_test(void)
+{
+	unsigned lcore = epc_app.core_ul[0];
+	struct rte_mempool *mp;
+	struct rte_mbuf *m;
+	struct dp_id dp_id;
+	int i, ret = 0;
+
+	mp = rte_pktmbuf_pool_create("acl_swap_pool", 63, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL)
+		return -1;
+
+	m = acl_swap_probe(mp);
+	if (m == NULL)
+		return -1;
+
+	sprintf(dp_id.name, "ADC_Filter_Table");
+	acl_swap_stop = 0;
+	if (rte_eal_remote_launch(acl_swap_reader, m, lcore) < 0)
+		return -1;
+
+	for (i = 0; i < ACL_SWAP_ROUNDS && ret == 0; i++) {
+		ret = acl_swap_storm(dp_id, 1);
+		if (ret == 0)
+			ret = acl_swap_storm(dp_id, 0);
+	}
+
+	acl_swap_stop = 1;
+	rte_eal_wait_lcore(lcore);
+	rte_pktmbuf_free(m);
+
+	if (ret == 0 && (acl_swap_misses || !acl_swap_lookups))
+		ret = -1;
+
+	printf("ACL swap test %s: lookups %"PRIu64", misses %"PRIu64
+			", max cycles %"PRIu64"\n", ret ? "FAIL" : "PASS",
+			acl_swap_lookups, acl_swap_misses, acl_swap_max_cycles);
+
+	return ret;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACL_SWAP_H_
+#define _ACL_SWAP_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Rules added and deleted per storm round */
+#define ACL_SWAP_NB_RULES	64
+
+/* Storm rounds while the reader is classifying */
+#define ACL_SWAP_ROUNDS		8
+
+/* Rule ids of storm rules, out of the CP rule id range */
+#define ACL_SWAP_RULE_BASE	1000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Rule storm on ADC tables while a worker runs lookups.
+ * Every lookup of the reader must hit the DNS rule, whichever
+ * ADC context is active.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int acl_swap_test(void);
+#endif
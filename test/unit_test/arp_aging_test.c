@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <time.h>
+
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+
+#include "mngtplane_handler.h"
+#include "arp_aging_test.h"
+
+#ifndef STATIC_ARP
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Test entries, by age */
+enum arp_aging_entry {
+	ARP_AGING_FRESH,
+	ARP_AGING_STALE,
+	ARP_AGING_EXPIRED,
+	ARP_AGING_NB
+};
+
+/* Resolver polls of one next hop before giving up, ~1 ms each */
+#define ARP_AGING_MAX_POLLS	((ARP_MAX_RETRY + 2) * ARP_TIMEOUT * 1000)
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Add entry e of the ARP table, last confirmed age seconds ago.
+ *
+ * @return
+ *	entry, NULL on failure.
+ */
+static struct arp_entry_data *
+arp_aging_add(uint32_t e, time_t now, time_t age)
+{
+	struct arp_entry_data *data;
+	uint32_t ip = htonl(ARP_AGING_NH_IP + 1 + e);
+
+	data = rte_zmalloc("arp aging", sizeof(*data), RTE_CACHE_LINE_SIZE);
+	if (data == NULL)
+		return NULL;
+	data->ip = ip;
+	data->port = S1U_PORT_ID;
+	data->status = COMPLETE;
+	data->last_update = now - age;
+	data->eth_addr.addr_bytes[0] = 0x02;
+	data->eth_addr.addr_bytes[5] = e;
+
+	if (rte_hash_add_key_data(arp_hash_handle[S1U_PORT_ID], &ip,
+				data) < 0) {
+		rte_free(data);
+		return NULL;
+	}
+	return data;
+}
+
+/**
+ * Whether entry e is in the ARP table.
+ */
+static int
+arp_aging_present(uint32_t e)
+{
+	uint32_t ip = htonl(ARP_AGING_NH_IP + 1 + e);
+	void *data;
+
+	return rte_hash_lookup_data(arp_hash_handle[S1U_PORT_ID], &ip,
+			&data) >= 0;
+}
+
+/**
+ * Aging of a fresh, an unconfirmed and an expired entry.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+arp_aging_age(void)
+{
+	struct arp_entry_data *data[ARP_AGING_NB];
+	time_t now = time(NULL);
+	time_t age[ARP_AGING_NB] = {
+		[ARP_AGING_FRESH] = 0,
+		[ARP_AGING_STALE] = (app.arp_refresh + app.arp_max_age) / 2,
+		[ARP_AGING_EXPIRED] = app.arp_max_age,
+	};
+	uint32_t gen = nh_gen, i, passes;
+	int err = 0;
+
+	for (i = 0; i < ARP_AGING_NB; i++) {
+		data[i] = arp_aging_add(i, now, age[i]);
+		if (data[i] == NULL)
+			return -1;
+	}
+
+	/* Until the scan went over the test entries */
+	for (passes = 0; passes < ARP_AGING_MAX_PASSES; passes++) {
+		arp_age(now);
+		if (!arp_aging_present(ARP_AGING_EXPIRED) &&
+				data[ARP_AGING_STALE]->next_probe != 0)
+			break;
+	}
+	/* Frees the expired entry, workers are not running */
+	arp_age(now);
+
+	if (passes == ARP_AGING_MAX_PASSES || nh_gen == gen ||
+			!arp_aging_present(ARP_AGING_FRESH) ||
+			!arp_aging_present(ARP_AGING_STALE) ||
+			data[ARP_AGING_FRESH]->next_probe != 0 ||
+			data[ARP_AGING_STALE]->next_probe !=
+			now + ARP_PROBE_INTERVAL)
+		err = -1;
+
+	printf("ARP aging test %s: max age %u, refresh %u, %u passes\n",
+			err ? "FAIL" : "PASS", app.arp_max_age,
+			app.arp_refresh, passes + 1);
+
+	/* Entries aging deleted were freed by it */
+	for (i = 0; i < ARP_AGING_NB; i++) {
+		uint32_t ip = htonl(ARP_AGING_NH_IP + 1 + i);
+
+		if (rte_hash_del_key(arp_hash_handle[S1U_PORT_ID], &ip) >= 0)
+			rte_free(data[i]);
+	}
+
+	return err;
+}
+
+/**
+ * Hand pkt off to the resolver and poll it once.
+ *
+ * @return
+ *	1 if the resolver holds the pkt, 0 if it dropped it, -1 on failure.
+ */
+static int
+arp_aging_queue(struct rte_mbuf *m)
+{
+	if (arp_queue_unresolved(m, htonl(ARP_AGING_NH_IP),
+				S1U_PORT_ID) < 0)
+		return -1;
+	arp_resolver_core();
+	return rte_mbuf_refcnt_read(m) > 1;
+}
+
+/**
+ * Poll the resolver until it drops pkt m.
+ *
+ * @return
+ *	seconds waited, -1 if it did not drop it.
+ */
+static int
+arp_aging_wait_drop(struct rte_mbuf *m)
+{
+	uint64_t start = rte_get_timer_cycles();
+	uint32_t i;
+
+	for (i = 0; i < ARP_AGING_MAX_POLLS; i++) {
+		if (rte_mbuf_refcnt_read(m) == 1)
+			return (rte_get_timer_cycles() - start) /
+				rte_get_timer_hz();
+		rte_delay_ms(1);
+		arp_resolver_core();
+	}
+	return -1;
+}
+
+/**
+ * Negative cache of a next hop that never resolves.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+arp_aging_neg(void)
+{
+	struct rte_mempool *mp;
+	struct rte_mbuf *m;
+	int unresolved, held, requeued, err;
+
+	mp = rte_pktmbuf_pool_create("arp_aging_pool", 63, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL)
+		return -1;
+	m = rte_pktmbuf_alloc(mp);
+	if (m == NULL)
+		return -1;
+
+	/* Requests exhausted */
+	unresolved = arp_aging_queue(m) == 1 ? arp_aging_wait_drop(m) : -1;
+	/* Dropped without requests while held */
+	held = arp_aging_queue(m);
+	/* Queued again once the hold is over */
+	rte_delay_ms(ARP_AGING_NEG_HOLD * 1000 + 100);
+	requeued = arp_aging_queue(m);
+	if (requeued == 1 && arp_aging_wait_drop(m) < 0)
+		requeued = -1;
+
+	err = (unresolved < 0 || held != 0 || requeued != 1) ? -1 : 0;
+	printf("ARP negative cache test %s: unresolved after %d s, "
+			"held %d, requeued %d\n", err ? "FAIL" : "PASS",
+			unresolved, held, requeued);
+
+	rte_pktmbuf_free(m);
+	return err;
+}
+
+int arp_aging_test(void)
+{
+	uint32_t max_age = app.arp_max_age;
+	uint32_t refresh = app.arp_refresh;
+	uint32_t neg_hold = app.arp_neg_hold;
+	int ret = 0;
+
+	app.arp_max_age = DEFAULT_ARP_MAX_AGE;
+	app.arp_refresh = DEFAULT_ARP_REFRESH;
+	app.arp_neg_hold = ARP_AGING_NEG_HOLD;
+
+	if (arp_aging_age() < 0)
+		ret = -1;
+	if (arp_aging_neg() < 0)
+		ret = -1;
+
+	app.arp_max_age = max_age;
+	app.arp_refresh = refresh;
+	app.arp_neg_hold = neg_hold;
+
+	return ret;
+}
+#endif	/* STATIC_ARP */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ARP_AGING_TEST_H_
+#define _ARP_AGING_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Next hop address, host order */
+#define ARP_AGING_NH_IP		0xcb007101	/* 203.0.113.1 */
+
+/* Aging passes before giving up, each covers ARP_AGE_SCAN_MAX entries */
+#define ARP_AGING_MAX_PASSES	4096
+
+/* Negative cache hold of the test, seconds */
+#define ARP_AGING_NEG_HOLD	1
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * ARP aging and negative cache: of a fresh, an unconfirmed and an
+ * expired entry, aging must probe the unconfirmed entry only, delete
+ * the expired entry and bump the next hop generation. Then a next hop
+ * that never resolves must have its pkts dropped without being queued
+ * for ARP_AGING_NEG_HOLD seconds once its requests are exhausted, and
+ * queued again after. Runs the resolver in real time, for about twice
+ * ARP_MAX_RETRY * ARP_TIMEOUT seconds.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int arp_aging_test(void);
+#endif
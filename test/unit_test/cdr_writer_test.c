@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+
+#include "cdr_writer_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Record number, id, volume counters in enum cdr_vol order, name */
+static const struct cdr_field_t cdr_wr_test_fields[] = {
+	{"record", CDR_U64, CDR_OFF(seq), NULL},
+	{"id", CDR_U32, CDR_OFF(id), NULL},
+	{"dl_pkt_cnt", CDR_U64, CDR_OFF(vol[CDR_DL_PKTS]), NULL},
+	{"dl_bytes", CDR_U64, CDR_OFF(vol[CDR_DL_BYTES]), NULL},
+	{"dl_drop_cnt", CDR_U64, CDR_OFF(vol[CDR_DL_DROP_PKTS]), NULL},
+	{"dl_drop_bytes", CDR_U64, CDR_OFF(vol[CDR_DL_DROP_BYTES]), NULL},
+	{"ul_pkt_cnt", CDR_U64, CDR_OFF(vol[CDR_UL_PKTS]), NULL},
+	{"ul_bytes", CDR_U64, CDR_OFF(vol[CDR_UL_BYTES]), NULL},
+	{"ul_drop_cnt", CDR_U64, CDR_OFF(vol[CDR_UL_DROP_PKTS]), NULL},
+	{"ul_drop_bytes", CDR_U64, CDR_OFF(vol[CDR_UL_DROP_BYTES]), NULL},
+	{"name", CDR_CHARS, CDR_OFF(name), NULL},
+};
+
+static const char cdr_wr_test_header[] = "#record,id,"
+	"dl_pkt_cnt,dl_bytes,dl_drop_cnt,dl_drop_bytes,"
+	"ul_pkt_cnt,ul_bytes,ul_drop_cnt,ul_drop_bytes,name\n";
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Volume counter 'vol' of record 'id': distinct per counter, so a
+ * counter in the wrong column is caught.
+ */
+static inline uint64_t
+cdr_wr_test_vol(uint32_t id, uint32_t vol)
+{
+	return (uint64_t)id * CDR_REC_VOL_MAX + vol;
+}
+
+/**
+ * Queue a record, or a reset, of the test stream. Waits for a free
+ * record while the writer catches up.
+ *
+ * @param id
+ *	record id.
+ * @param op
+ *	enum cdr_op.
+ */
+static void
+cdr_wr_test_submit(uint32_t id, uint8_t op)
+{
+	struct chrg_data_vol vol = {0};
+	struct cdr_rec *rec;
+
+	while ((rec = cdr_rec_alloc(CDR_STREAM_EXT)) == NULL)
+		usleep(CDR_WR_IDLE_US);
+
+	rec->op = op;
+	if (op == CDR_OP_RESET) {
+		cdr_rec_submit(rec);
+		return;
+	}
+
+	vol.dl_cdr.pkt_count = cdr_wr_test_vol(id, CDR_DL_PKTS);
+	vol.dl_cdr.bytes = cdr_wr_test_vol(id, CDR_DL_BYTES);
+	vol.dl_drop.pkt_count = cdr_wr_test_vol(id, CDR_DL_DROP_PKTS);
+	vol.dl_drop.bytes = cdr_wr_test_vol(id, CDR_DL_DROP_BYTES);
+	vol.ul_cdr.pkt_count = cdr_wr_test_vol(id, CDR_UL_PKTS);
+	vol.ul_cdr.bytes = cdr_wr_test_vol(id, CDR_UL_BYTES);
+	vol.ul_drop.pkt_count = cdr_wr_test_vol(id, CDR_UL_DROP_PKTS);
+	vol.ul_drop.bytes = cdr_wr_test_vol(id, CDR_UL_DROP_BYTES);
+
+	rec->id = id;
+	cdr_rec_set_vol(rec, &vol);
+	cdr_rec_strcpy(rec->name, CDR_WR_TEST_NAME);
+	cdr_rec_submit(rec);
+}
+
+/**
+ * Start the writer with the test stream and the empty header stream.
+ */
+static void
+cdr_wr_test_open(void)
+{
+	cdr_writer_init();
+	cdr_writer_open(CDR_STREAM_EXT, CDR_WR_TEST_FILE, cdr_wr_test_fields,
+			RTE_DIM(cdr_wr_test_fields), "#", RECORD_TIME_FORMAT);
+	cdr_writer_open(CDR_STREAM_MTR, CDR_WR_TEST_EMPTY_FILE, NULL, 0, "",
+			RECORD_TIME_FORMAT);
+}
+
+/**
+ * Check the test stream file: header line, then records numbered from 0
+ * with ids from first_id.
+ *
+ * @param first_id
+ *	id of the first record.
+ * @param nb
+ *	records expected.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+cdr_wr_test_check(uint32_t first_id, uint32_t nb)
+{
+	char line[CDR_WR_TEST_LINE_MAX];
+	char name[CDR_NAME_LEN + 1];
+	uint64_t seq, vol[CDR_REC_VOL_MAX];
+	uint32_t id, n = 0, i;
+	int ret = 0;
+	FILE *file;
+
+	file = fopen(CDR_WR_TEST_FILE, "r");
+	if (file == NULL)
+		return -1;
+
+	if (fgets(line, sizeof(line), file) == NULL ||
+			strcmp(line, cdr_wr_test_header) != 0) {
+		printf("CDR writer test: bad header line\n");
+		fclose(file);
+		return -1;
+	}
+
+	while (ret == 0 && fgets(line, sizeof(line), file) != NULL) {
+		if (sscanf(line, "%"SCNu64",%"SCNu32",%"SCNu64",%"SCNu64
+				",%"SCNu64",%"SCNu64",%"SCNu64",%"SCNu64
+				",%"SCNu64",%"SCNu64",%64[^\n]", &seq, &id,
+				&vol[0], &vol[1], &vol[2], &vol[3], &vol[4],
+				&vol[5], &vol[6], &vol[7], name) != 11 ||
+				seq != n || id != first_id + n ||
+				strcmp(name, CDR_WR_TEST_NAME) != 0)
+			ret = -1;
+		for (i = 0; ret == 0 && i < CDR_REC_VOL_MAX; i++)
+			if (vol[i] != cdr_wr_test_vol(id, i))
+				ret = -1;
+		if (ret < 0)
+			printf("CDR writer test: bad record %u: %s", n, line);
+		n++;
+	}
+	fclose(file);
+
+	if (ret == 0 && n != nb) {
+		printf("CDR writer test: %u records, expected %u\n", n, nb);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+int cdr_writer_test(void)
+{
+	struct stat st;
+	uint32_t i;
+	int ret = 0;
+
+#ifdef CDR_BINARY
+	printf("CDR writer test skipped: CDR_BINARY records\n");
+	return 0;
+#endif /* CDR_BINARY */
+
+	/* Rotation: records span several page swaps */
+	cdr_wr_test_open();
+	for (i = 0; i < CDR_WR_TEST_RECORDS; i++)
+		cdr_wr_test_submit(i, CDR_OP_RECORD);
+	cdr_writer_stop();
+
+	if (cdr_wr_test_check(0, CDR_WR_TEST_RECORDS) < 0)
+		ret = -1;
+	if (stat(CDR_WR_TEST_EMPTY_FILE, &st) < 0 || st.st_size != 0) {
+		printf("CDR writer test: header written with no column\n");
+		ret = -1;
+	}
+
+	/* Reset: only records queued after it are kept, numbered from 0 */
+	cdr_wr_test_open();
+	for (i = 0; i < CDR_WR_TEST_PRE_RESET; i++)
+		cdr_wr_test_submit(i, CDR_OP_RECORD);
+	cdr_wr_test_submit(0, CDR_OP_RESET);
+	for (i = 0; i < CDR_WR_TEST_POST_RESET; i++)
+		cdr_wr_test_submit(CDR_WR_TEST_PRE_RESET + i, CDR_OP_RECORD);
+	cdr_writer_stop();
+
+	if (cdr_wr_test_check(CDR_WR_TEST_PRE_RESET,
+				CDR_WR_TEST_POST_RESET) < 0)
+		ret = -1;
+
+	unlink(CDR_WR_TEST_FILE);
+	unlink(CDR_WR_TEST_EMPTY_FILE);
+
+	printf("CDR writer test %s: %u records, %u after reset, "
+			"%"PRIu64" allocs retried\n", ret ? "FAIL" : "PASS",
+			CDR_WR_TEST_RECORDS, CDR_WR_TEST_POST_RESET,
+			cdr_writer_drops());
+
+	return ret;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CDR_WRITER_TEST_H_
+#define _CDR_WRITER_TEST_H_
+
+#include "cdr.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Record and empty header stream files */
+#define CDR_WR_TEST_FILE	"/tmp/ngic_cdr_writer_test.csv"
+#define CDR_WR_TEST_EMPTY_FILE	"/tmp/ngic_cdr_writer_test_empty.csv"
+
+/* Records of the rotation run, several CDR_WR_PAGE_SIZE pages of lines */
+#define CDR_WR_TEST_RECORDS	100000
+
+/* Records queued before and after the reset */
+#define CDR_WR_TEST_PRE_RESET	10
+#define CDR_WR_TEST_POST_RESET	3
+
+/* Name field of test records */
+#define CDR_WR_TEST_NAME	"cdr_writer_test"
+
+/* Test file line buffer */
+#define CDR_WR_TEST_LINE_MAX	512
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Queue CDR_WR_TEST_RECORDS records to the CDR writer, with their volume
+ * set by cdr_rec_set_vol, and stop it: the file must hold the CSV header
+ * line and every record in order, across page swaps, with each volume
+ * counter in its column. A stream with no header prefix and no column
+ * must stay empty.
+ * Then queue records, a reset and more records: the file must hold the
+ * header and the records after the reset only, numbered from 0.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int cdr_writer_test(void);
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_eal.h>
+
+#include "ip_pool_bench.h"
+#include "static_paa_test.h"
+#include "gtpv2c_decode_bench.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * CP unit test suite: test function and name printed on failure.
+ */
+struct cp_unit_test {
+	int (*func)(void);
+	const char *name;
+};
+
+static const struct cp_unit_test cp_unit_tests[] = {
+	{ip_pool_bench_test, "IP pool bench"},
+	{static_paa_test, "Static PAA test"},
+	{gtpv2c_decode_bench_test, "GTPv2c decode bench"},
+};
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * CP unit test main: runs all suites on the master lcore, exits non-zero
+ * if any failed.
+ */
+int main(int argc, char **argv)
+{
+	unsigned int i, failed = 0;
+
+	if (rte_eal_init(argc, argv) < 0)
+		rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
+
+	for (i = 0; i < RTE_DIM(cp_unit_tests); i++) {
+		if (cp_unit_tests[i].func() < 0) {
+			printf("%s failed\n", cp_unit_tests[i].name);
+			failed++;
+		}
+	}
+
+	printf("CP unit tests: %u run, %u failed\n",
+			(unsigned int)RTE_DIM(cp_unit_tests), failed);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
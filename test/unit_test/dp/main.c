@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+
+#include "main.h"
+#include "acl_swap.h"
+#include "mtr_bench.h"
+#include "teid_index_bench.h"
+#include "sess_churn.h"
+#include "encap_tmpl_test.h"
+#include "ipv4_cksum_test.h"
+#include "gtpu_relay_test.h"
+#include "gtpu_sport_test.h"
+#include "route_fib_test.h"
+#include "nh_cache_test.h"
+#include "arp_aging_test.h"
+#include "gtpu_echo_test.h"
+#include "cdr_writer_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+struct rte_ring *cdr_ring;
+
+/**
+ * DP unit test suite: test function and name printed on failure.
+ */
+struct dp_unit_test {
+	int (*func)(void);
+	const char *name;
+};
+
+static const struct dp_unit_test dp_unit_tests[] = {
+	{acl_swap_test, "ACL swap test"},
+	{mtr_bench_test, "Meter bench"},
+	{teid_index_bench_test, "TEID index bench"},
+	{sess_churn_test, "Session churn test"},
+	{encap_tmpl_test, "Encap template test"},
+	{ipv4_cksum_test, "IPv4 checksum test"},
+	{gtpu_relay_test, "GTP-U relay test"},
+	{gtpu_sport_test, "GTP-U source port test"},
+	{route_fib_test, "Route FIB test"},
+	{nh_cache_test, "Next hop cache test"},
+#ifndef STATIC_ARP
+	{arp_aging_test, "ARP aging test"},
+#endif	/* STATIC_ARP */
+	{gtpu_echo_test, "GTP-U echo test"},
+	{cdr_writer_test, "CDR writer test"},
+};
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * DP unit test main: same EAL args and DP config as ngic_dataplane.
+ * Tables and ports are set up as the DP does, but no worker is launched:
+ * the suites own every slave lcore. Runs all suites, exits non-zero if
+ * any failed.
+ */
+int main(int argc, char **argv)
+{
+	unsigned int i, failed = 0;
+	int ret;
+
+	cdr_ring = NULL;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
+	argc -= ret;
+	argv += ret;
+
+	dp_init(argc, argv);
+	dp_port_init();
+
+#ifdef DP_DDN
+	dp_ddn_init();
+#endif
+
+	switch (app.spgw_cfg) {
+		case SGWU:
+			init_ngic_rtc_framework(app.s5s8_sgwu_port,
+					app.s1u_port);
+			break;
+
+		case PGWU:
+			init_ngic_rtc_framework(app.sgi_port, app.s5s8_pgwu_port);
+			break;
+
+		case SPGWU:
+			init_ngic_rtc_framework(app.sgi_port, app.s1u_port);
+			break;
+
+		default:
+			rte_exit(EXIT_FAILURE, "Invalid DP type(SPGW_CFG).\n");
+	}
+
+	iface_module_constructor();
+	dp_table_init();
+
+	for (i = 0; i < RTE_DIM(dp_unit_tests); i++) {
+		if (dp_unit_tests[i].func() < 0) {
+			printf("%s failed\n", dp_unit_tests[i].name);
+			failed++;
+		}
+	}
+
+	printf("DP unit tests: %u run, %u failed\n",
+			(unsigned int)RTE_DIM(dp_unit_tests), failed);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+
+#include "gtpu.h"
+#include "ipv4.h"
+#include "util.h"
+#include "encap_tmpl_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Frame lengths of the compared pkts */
+static const uint16_t encap_tmpl_frame_len[] = {60, 64, 128, 512, 1400, 1514};
+
+/* Frame length of benchmark pkts */
+#define ENCAP_TMPL_PKT_LEN	128
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Field by field DL encap, as gtpu_encap did before templates.
+ */
+static int
+encap_tmpl_legacy(struct rte_mbuf *m, const struct dp_session_hot *si)
+{
+	uint32_t src_addr, dst_addr;
+	uint16_t len;
+	int ret;
+
+	if (app.gtpu_seqnb_out == 1)
+		ret = encap_gtpu_hdr_with_seqnb(m, si->enb_teid);
+	else
+		ret = encap_gtpu_hdr_without_seqnb(m, si->enb_teid);
+	if (ret < 0)
+		return -1;
+
+	if (app.spgw_cfg == PGWU) {
+		src_addr = app.s5s8_pgwu_ip;
+		dst_addr = si->s5s8_sgwu_ipv4;
+	} else {
+		src_addr = app.s1u_ip;
+		dst_addr = si->enb_ipv4;
+	}
+
+	len = rte_pktmbuf_data_len(m) - ETH_HDR_SIZE;
+	construct_ipv4_hdr(m, len, IP_PROTO_UDP, ntohl(src_addr), dst_addr);
+	construct_udp_hdr(m, len - IPv4_HDR_SIZE, UDP_PORT_GTPU, UDP_PORT_GTPU);
+
+	return 0;
+}
+
+/**
+ * Reset a pkt to an ether + inner IPv4 frame.
+ */
+static void
+encap_tmpl_fill(struct rte_mbuf *m, uint16_t frame_len)
+{
+	struct ipv4_hdr *ip;
+	uint8_t *p;
+	uint16_t i;
+
+	rte_pktmbuf_reset(m);
+	p = (uint8_t *)rte_pktmbuf_append(m, frame_len);
+	for (i = 0; i < frame_len; i++)
+		p[i] = (uint8_t)i;
+
+	ip = (struct ipv4_hdr *)(p + ETH_HDR_SIZE);
+	ip->version_ihl = 0x45;
+	ip->total_length = htons(frame_len - ETH_HDR_SIZE);
+}
+
+/**
+ * Compare encapsulated pkts from the outer IPv4 header on, but for the
+ * GTP-U sequence number (and IP id under FRAG), and check the outer IPv4
+ * checksum.
+ */
+static int
+encap_tmpl_cmp(struct rte_mbuf *m, struct rte_mbuf *ref)
+{
+	const uint8_t *p = rte_pktmbuf_mtod(m, uint8_t *);
+	const uint8_t *r = rte_pktmbuf_mtod(ref, uint8_t *);
+	uint16_t seq = ETH_HDR_SIZE + IPv4_HDR_SIZE + UDP_HDR_SIZE +
+		GPDU_HDR_SIZE_WITHOUT_SEQNB;
+	uint16_t i;
+
+	if (rte_pktmbuf_data_len(m) != rte_pktmbuf_data_len(ref))
+		return -1;
+
+	for (i = ETH_HDR_SIZE; i < rte_pktmbuf_data_len(m); i++) {
+		if (app.gtpu_seqnb_out == 1 && (i == seq || i == seq + 1))
+			continue;
+#ifdef FRAG
+		/* IP id differs per pkt, and with it the checksum */
+		if ((i >= ETH_HDR_SIZE + 4 && i < ETH_HDR_SIZE + 6) ||
+				(i >= ETH_HDR_SIZE + 10 && i < ETH_HDR_SIZE + 12))
+			continue;
+#endif /* FRAG */
+		if (p[i] != r[i])
+			return -1;
+	}
+
+	if (rte_raw_cksum(p + ETH_HDR_SIZE, IPv4_HDR_SIZE) != 0xffff)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * Encap one burst ENCAP_TMPL_ITERS times, stripping the outer headers
+ * again after each burst.
+ *
+ * @return
+ *	cycles per pkt.
+ */
+static uint64_t
+encap_tmpl_bench(struct dp_session_hot **si, struct rte_mbuf **pkts,
+		uint32_t n, int tmpl)
+{
+	uint16_t outer = ((app.gtpu_seqnb_out == 1) ?
+			ENCAP_TMPL_SIZE_SEQNB : ENCAP_TMPL_SIZE) - ETH_HDR_SIZE;
+	uint64_t start, pkts_mask, queue_mask;
+	uint32_t i, j;
+
+	start = rte_rdtsc();
+	for (i = 0; i < ENCAP_TMPL_ITERS; i++) {
+		if (tmpl) {
+			pkts_mask = (~0LLU) >> (64 - n);
+			queue_mask = 0;
+			gtpu_encap(si, pkts, n, &pkts_mask, &queue_mask);
+		} else {
+			for (j = 0; j < n; j++)
+				encap_tmpl_legacy(pkts[j], si[j]);
+		}
+		for (j = 0; j < n; j++)
+			rte_pktmbuf_adj(pkts[j], outer);
+	}
+
+	return (rte_rdtsc() - start) / ((uint64_t)ENCAP_TMPL_ITERS * n);
+}
+
+int encap_tmpl_test(void)
+{
+	struct dp_session_hot *si[MAX_BURST_SZ];
+	struct rte_mbuf *pkts[MAX_BURST_SZ], *ref[MAX_BURST_SZ];
+	uint32_t nb_len = RTE_DIM(encap_tmpl_frame_len);
+	uint32_t seqnb_out = app.gtpu_seqnb_out;
+	uint32_t sport = app.gtpu_sport;
+	uint32_t i, n = MAX_BURST_SZ, seqnb;
+	uint64_t pkts_mask, queue_mask, tmpl, field;
+	struct dp_session_hot *hot;
+	struct rte_mempool *mp;
+	int ret = 0, err;
+
+	mp = rte_pktmbuf_pool_create("encap_tmpl_pool", 4 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL)
+		return -1;
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0 ||
+			rte_pktmbuf_alloc_bulk(mp, ref, n) < 0)
+		return -1;
+
+	hot = rte_zmalloc("encap tmpl hot", sizeof(*hot), RTE_CACHE_LINE_SIZE);
+	if (hot == NULL)
+		return -1;
+	hot->enb_ipv4 = ENCAP_TMPL_ENB_IP;
+	hot->s5s8_sgwu_ipv4 = ENCAP_TMPL_SGWU_IP;
+	hot->enb_teid = ENCAP_TMPL_ENB_TEID;
+	for (i = 0; i < n; i++)
+		si[i] = hot;
+
+	/* Field by field encap has the fixed source port */
+	app.gtpu_sport = GTPU_SPORT_FIXED;
+	for (seqnb = 0; seqnb <= 1; seqnb++) {
+		app.gtpu_seqnb_out = seqnb;
+		gtpu_encap_tmpl_build(hot);
+		err = 0;
+
+		for (i = 0; i < nb_len; i++) {
+			encap_tmpl_fill(pkts[i], encap_tmpl_frame_len[i]);
+			encap_tmpl_fill(ref[i], encap_tmpl_frame_len[i]);
+		}
+		pkts_mask = (~0LLU) >> (64 - nb_len);
+		queue_mask = 0;
+		gtpu_encap(si, pkts, nb_len, &pkts_mask, &queue_mask);
+		for (i = 0; i < nb_len; i++) {
+			/* Left to the NIC on offloading ports */
+			if (pkts[i]->ol_flags & PKT_TX_IP_CKSUM)
+				update_ckcum(pkts[i]);
+			if (!ISSET_BIT(pkts_mask, i) ||
+					encap_tmpl_legacy(ref[i], hot) < 0 ||
+					encap_tmpl_cmp(pkts[i], ref[i]) < 0)
+				err = -1;
+		}
+
+		for (i = 0; i < n; i++)
+			encap_tmpl_fill(pkts[i], ENCAP_TMPL_PKT_LEN);
+		tmpl = encap_tmpl_bench(si, pkts, n, 1);
+		field = encap_tmpl_bench(si, pkts, n, 0);
+
+		printf("Encap template test %s: seqnb %u, burst %u, template %"
+				PRIu64" cycles/pkt, field by field %"PRIu64
+				" cycles/pkt\n", err ? "FAIL" : "PASS", seqnb, n,
+				tmpl, field);
+		if (err)
+			ret = -1;
+	}
+
+	app.gtpu_seqnb_out = seqnb_out;
+	app.gtpu_sport = sport;
+	rte_free(hot);
+	for (i = 0; i < n; i++) {
+		rte_pktmbuf_free(pkts[i]);
+		rte_pktmbuf_free(ref[i]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ENCAP_TMPL_TEST_H_
+#define _ENCAP_TMPL_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Bursts timed per run */
+#define ENCAP_TMPL_ITERS	100000
+
+/* Test bearer addresses and TEID, host order */
+#define ENCAP_TMPL_ENB_IP	0x0b070165	/* 11.7.1.101 */
+#define ENCAP_TMPL_SGWU_IP	0x0c030165	/* 12.3.1.101 */
+#define ENCAP_TMPL_ENB_TEID	0x00abcdef
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * DL encap from the bearer template against field by field encap
+ * (ENCAP_GTPU_HDR, construct_ipv4_hdr, construct_udp_hdr), with and
+ * without GTP-U sequence numbers, over a range of pkt lengths: outer
+ * IP, UDP and GTP-U headers must be equal but for the sequence number.
+ * Then times both per pkt.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int encap_tmpl_test(void);
+#endif
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+#include <rte_udp.h>
+
+#include "gtpu.h"
+#include "ipv4.h"
+#include "util.h"
+#include "gtpu_echo_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Offset of the GTP-U header */
+#define GTPU_ECHO_OFF	(ETH_HDR_SIZE + IPv4_HDR_SIZE + UDP_HDR_SIZE)
+
+/* Echo request of a case */
+struct gtpu_echo_case {
+	const char *name;
+	/** GTP-U flags octet */
+	uint8_t flags;
+	/** GTP-U message after the mandatory header */
+	uint8_t msg[8];
+	uint8_t msg_len;
+	/** ether padding */
+	uint8_t pad;
+	/** IPv4 version_ihl */
+	uint8_t version_ihl;
+	/** frame bytes dropped */
+	uint8_t cut;
+	/** 1 if a response is expected */
+	uint8_t ok;
+};
+
+static const struct gtpu_echo_case gtpu_echo_cases[] = {
+	{"no seqnb, padded", 0x30, {0}, 0, 6, 0x45, 0, 1},
+	{"seqnb", 0x32, {0x12, 0x34, 0, 0}, 4, 0, 0x45, 0, 1},
+	{"seqnb, recovery IE", 0x32, {0x56, 0x78, 0, 0, 14, 5}, 6, 0, 0x45, 0, 1},
+	{"truncated", 0x32, {0x12, 0x34, 0, 0}, 4, 0, 0x45, 3, 0},
+	{"IPv4 options", 0x30, {0}, 0, 0, 0x46, 0, 0},
+};
+
+/* Mac addresses of the request */
+static const struct ether_addr gtpu_echo_enb_mac = {
+	.addr_bytes = {0x02, 0, 0, 0, 0, 0x01}};
+static const struct ether_addr gtpu_echo_s1u_mac = {
+	.addr_bytes = {0x02, 0, 0, 0, 0, 0x02}};
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Reset a pkt to the echo request of case c.
+ */
+static void
+gtpu_echo_fill(struct rte_mbuf *m, const struct gtpu_echo_case *c)
+{
+	uint16_t len = GTPU_ECHO_OFF + GTPU_HDR_SIZE + c->msg_len;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	uint8_t *gtpu;
+
+	rte_pktmbuf_reset(m);
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m, len + c->pad);
+	memset(eth, 0, len + c->pad);
+	ether_addr_copy(&gtpu_echo_s1u_mac, &eth->d_addr);
+	ether_addr_copy(&gtpu_echo_enb_mac, &eth->s_addr);
+	eth->ether_type = htons(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *)(eth + 1);
+	ip->version_ihl = c->version_ihl;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->total_length = htons(len - ETH_HDR_SIZE);
+	ip->src_addr = htonl(GTPU_ECHO_ENB_IP);
+	ip->dst_addr = htonl(GTPU_ECHO_S1U_IP);
+
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = htons(UDP_PORT_GTPU + 1);
+	udp->dst_port = htons(UDP_PORT_GTPU);
+	udp->dgram_len = htons(len - ETH_HDR_SIZE - IPv4_HDR_SIZE);
+
+	gtpu = (uint8_t *)(udp + 1);
+	gtpu[0] = c->flags;
+	gtpu[1] = GTPU_ECHO_REQUEST;
+	*(uint16_t *)&gtpu[2] = htons(c->msg_len);
+	memcpy(&gtpu[GTPU_HDR_SIZE], c->msg, c->msg_len);
+
+	rte_pktmbuf_trim(m, c->cut);
+}
+
+/**
+ * Check the response to the request of case c.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+gtpu_echo_check(struct rte_mbuf *m, const struct gtpu_echo_case *c)
+{
+	uint16_t opt = (c->flags & 0x07) ? 4 : 0;
+	uint16_t len = GTPU_ECHO_OFF + GTPU_HDR_SIZE + opt + 2;
+	struct ether_hdr *eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	struct ipv4_hdr *ip = (struct ipv4_hdr *)(eth + 1);
+	struct udp_hdr *udp = (struct udp_hdr *)(ip + 1);
+	uint8_t *gtpu = (uint8_t *)(udp + 1);
+
+	/* IPv4 checksum is left to TX */
+	update_ckcum(m);
+
+	if (rte_pktmbuf_data_len(m) != len ||
+			!is_same_ether_addr(&eth->d_addr, &gtpu_echo_enb_mac) ||
+			!is_same_ether_addr(&eth->s_addr, &gtpu_echo_s1u_mac) ||
+			ip->src_addr != htonl(GTPU_ECHO_S1U_IP) ||
+			ip->dst_addr != htonl(GTPU_ECHO_ENB_IP) ||
+			ntohs(ip->total_length) != len - ETH_HDR_SIZE ||
+			rte_raw_cksum(ip, IPv4_HDR_SIZE) != 0xffff ||
+			udp->src_port != htons(UDP_PORT_GTPU) ||
+			udp->dst_port != htons(UDP_PORT_GTPU + 1) ||
+			ntohs(udp->dgram_len) != len - ETH_HDR_SIZE -
+			IPv4_HDR_SIZE || udp->dgram_cksum != 0)
+		return -1;
+
+	if (gtpu[0] != c->flags || gtpu[1] != GTPU_ECHO_RESPONSE ||
+			ntohs(*(uint16_t *)&gtpu[2]) != opt + 2 ||
+			memcmp(&gtpu[GTPU_HDR_SIZE], c->msg, opt) ||
+			gtpu[GTPU_HDR_SIZE + opt] != GTPU_ECHO_RECOVERY ||
+			gtpu[GTPU_HDR_SIZE + opt + 1] != 0)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * Echo response as mngt_ingress and mngt_egress did: copy to a heap
+ * buffer handed off through a ring, copy back into a new mbuf.
+ *
+ * @return
+ *	response, NULL on failure.
+ */
+static struct rte_mbuf *
+gtpu_echo_legacy(struct rte_mbuf *m, struct rte_ring *r,
+		struct rte_mempool *mp)
+{
+	uint32_t size = rte_pktmbuf_pkt_len(m);
+	struct rte_mbuf *rsp;
+	char *buf;
+
+	buf = rte_zmalloc("echo legacy", size + sizeof(uint32_t),
+			RTE_CACHE_LINE_SIZE);
+	if (buf == NULL)
+		return NULL;
+	*(uint32_t *)buf = size;
+	memcpy(buf + sizeof(uint32_t), rte_pktmbuf_mtod(m, char *), size);
+	if (rte_ring_enqueue(r, buf) < 0 ||
+			rte_ring_dequeue(r, (void **)&buf) < 0) {
+		rte_free(buf);
+		return NULL;
+	}
+
+	rsp = rte_pktmbuf_alloc(mp);
+	if (rsp != NULL) {
+		size = *(uint32_t *)buf;
+		memcpy(rte_pktmbuf_mtod(rsp, char *), buf + sizeof(uint32_t),
+				size);
+		rsp->pkt_len = rsp->data_len = size;
+		process_echo_request(rsp);
+	}
+	rte_free(buf);
+	return rsp;
+}
+
+/**
+ * Answer one burst of echo requests GTPU_ECHO_ITERS times, refilling
+ * the requests before each burst.
+ *
+ * @return
+ *	cycles per response, 0 on failure.
+ */
+static uint64_t
+gtpu_echo_bench(struct rte_mbuf **pkts, uint32_t n, struct rte_ring *r,
+		struct rte_mempool *mp, int in_place)
+{
+	const struct gtpu_echo_case *c = &gtpu_echo_cases[1];
+	struct rte_mbuf *rsp[MAX_BURST_SZ];
+	uint64_t start, cycles = 0;
+	uint32_t i, j;
+
+	for (i = 0; i < GTPU_ECHO_ITERS; i++) {
+		for (j = 0; j < n; j++)
+			gtpu_echo_fill(pkts[j], c);
+
+		start = rte_rdtsc();
+		if (in_place) {
+			for (j = 0; j < n; j++)
+				process_echo_request(pkts[j]);
+			ipv4_cksum_tx_prep(pkts, n, (~0LLU) >> (64 - n),
+					app.s1u_port);
+		} else {
+			for (j = 0; j < n; j++) {
+				rsp[j] = gtpu_echo_legacy(pkts[j], r, mp);
+				if (rsp[j] == NULL)
+					return 0;
+			}
+		}
+		cycles += rte_rdtsc() - start;
+
+		if (!in_place)
+			for (j = 0; j < n; j++)
+				rte_pktmbuf_free(rsp[j]);
+	}
+
+	return cycles / ((uint64_t)GTPU_ECHO_ITERS * n);
+}
+
+int gtpu_echo_test(void)
+{
+	struct rte_mbuf *pkts[MAX_BURST_SZ];
+	uint32_t i, n = MAX_BURST_SZ;
+	uint64_t in_place, legacy;
+	struct rte_mempool *mp;
+	struct rte_ring *r;
+	int ret = 0, err;
+
+	mp = rte_pktmbuf_pool_create("gtpu_echo_pool", 4 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	r = rte_ring_create("gtpu_echo_ring", 64, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (mp == NULL || r == NULL)
+		return -1;
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0)
+		return -1;
+
+	for (i = 0; i < RTE_DIM(gtpu_echo_cases); i++) {
+		const struct gtpu_echo_case *c = &gtpu_echo_cases[i];
+
+		gtpu_echo_fill(pkts[0], c);
+		if (process_echo_request(pkts[0]) < 0)
+			err = c->ok ? -1 : 0;
+		else
+			err = c->ok ? gtpu_echo_check(pkts[0], c) : -1;
+
+		printf("GTP-U echo test %s: %s\n", err ? "FAIL" : "PASS",
+				c->name);
+		if (err)
+			ret = -1;
+	}
+
+	in_place = gtpu_echo_bench(pkts, n, r, mp, 1);
+	legacy = gtpu_echo_bench(pkts, n, r, mp, 0);
+	if (in_place == 0 || legacy == 0)
+		ret = -1;
+	printf("GTP-U echo rate %s: burst %u, in place %"PRIu64
+			" cycles/rsp (%"PRIu64" rsp/s), copy %"PRIu64
+			" cycles/rsp (%"PRIu64" rsp/s)\n",
+			ret ? "FAIL" : "PASS", n, in_place,
+			in_place ? rte_get_tsc_hz() / in_place : 0, legacy,
+			legacy ? rte_get_tsc_hz() / legacy : 0);
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+	rte_ring_free(r);
+
+	return ret;
+}
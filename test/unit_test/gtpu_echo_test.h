@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GTPU_ECHO_TEST_H_
+#define _GTPU_ECHO_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Bursts timed per run */
+#define GTPU_ECHO_ITERS		100000
+
+/* Test eNB and S1U addresses, host order */
+#define GTPU_ECHO_ENB_IP	0x0b070165	/* 11.7.1.101 */
+#define GTPU_ECHO_S1U_IP	0x0b070101	/* 11.7.1.1 */
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * In place GTP-U echo responses: requests without and with a sequence
+ * number, padded or carrying a request IE, must become responses with
+ * swapped addresses and ports, the sequence number kept, a Recovery IE,
+ * consistent lengths, a zero UDP checksum and a valid IPv4 checksum.
+ * Truncated requests and IPv4 options must be refused. Then times the
+ * echo response rate of a burst in place, against the former copy to a
+ * heap buffer, ring hand off and copy back into a new mbuf.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int gtpu_echo_test(void);
+#endif
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <pcap.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_malloc.h>
+
+#include "gtpu.h"
+#include "ipv4.h"
+#include "util.h"
+#include "gtpu_relay_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+static struct rte_mbuf *relay_orig[MAX_BURST_SZ];
+static struct rte_mbuf *relay_pkts[MAX_BURST_SZ];
+static struct rte_mbuf *relay_exp[MAX_BURST_SZ];
+static struct dp_sdf_per_bearer_info *relay_sdf[MAX_BURST_SZ];
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Read up to MAX_BURST_SZ pkts of the capture into relay_orig.
+ *
+ * @return
+ *	number of pkts read, -1 if the capture can't be opened.
+ */
+static int
+gtpu_relay_load(void)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+	struct pcap_pkthdr *hdr;
+	const u_char *data;
+	uint8_t *p;
+	pcap_t *pcap;
+	int n = 0;
+
+	pcap = pcap_open_offline(GTPU_RELAY_PCAP, errbuf);
+	if (pcap == NULL)
+		return -1;
+
+	while (n < MAX_BURST_SZ && pcap_next_ex(pcap, &hdr, &data) == 1) {
+		if (hdr->caplen < ETH_HDR_SIZE + IPv4_HDR_SIZE +
+				UDP_HDR_SIZE + GPDU_HDR_SIZE_WITHOUT_SEQNB)
+			continue;
+		rte_pktmbuf_reset(relay_orig[n]);
+		p = (uint8_t *)rte_pktmbuf_append(relay_orig[n], hdr->caplen);
+		if (p == NULL)
+			continue;
+		memcpy(p, data, hdr->caplen);
+		n++;
+	}
+
+	pcap_close(pcap);
+	return n;
+}
+
+/**
+ * Copy the captured pkts to a burst.
+ */
+static void
+gtpu_relay_copy(struct rte_mbuf **pkts, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		rte_pktmbuf_reset(pkts[i]);
+		memcpy(rte_pktmbuf_append(pkts[i],
+					rte_pktmbuf_data_len(relay_orig[i])),
+				rte_pktmbuf_mtod(relay_orig[i], void *),
+				rte_pktmbuf_data_len(relay_orig[i]));
+	}
+}
+
+/**
+ * Expected relay of a pkt: fields written, then full IPv4 checksum.
+ */
+static void
+gtpu_relay_expect(struct rte_mbuf *m, uint32_t src_addr, uint32_t dst_addr,
+		const uint32_t *teid)
+{
+	struct ipv4_hdr *ip = get_mtoip(m);
+	struct udp_hdr *udp = (struct udp_hdr *)(ip + 1);
+
+	ip->src_addr = src_addr;
+	ip->dst_addr = dst_addr;
+	udp->dgram_cksum = 0;
+	if (teid != NULL)
+		((struct gtpu_hdr *)(udp + 1))->teid = *teid;
+	update_ckcum(m);
+}
+
+/**
+ * Compare relayed pkts from the outer IPv4 header on, but for the IPv4
+ * checksum, which must be valid: 0 and 0xffff are both.
+ */
+static int
+gtpu_relay_cmp(struct rte_mbuf **pkts, struct rte_mbuf **exp, uint32_t n)
+{
+	const uint8_t *p, *e;
+	uint16_t i, cksum = ETH_HDR_SIZE +
+		offsetof(struct ipv4_hdr, hdr_checksum);
+	uint32_t j;
+
+	for (j = 0; j < n; j++) {
+		if (rte_pktmbuf_data_len(pkts[j]) !=
+				rte_pktmbuf_data_len(exp[j]))
+			return -1;
+		p = rte_pktmbuf_mtod(pkts[j], uint8_t *);
+		e = rte_pktmbuf_mtod(exp[j], uint8_t *);
+		for (i = ETH_HDR_SIZE; i < rte_pktmbuf_data_len(pkts[j]); i++)
+			if ((i < cksum || i > cksum + 1) && p[i] != e[i])
+				return -1;
+		if (rte_raw_cksum(p + ETH_HDR_SIZE, IPv4_HDR_SIZE) != 0xffff)
+			return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Full outer IPv4 header rebuild, as the relay did before.
+ */
+static void
+gtpu_relay_rebuild_burst(struct rte_mbuf **pkts, uint32_t n)
+{
+	struct dp_session_hot *hot;
+	uint16_t len;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		hot = relay_sdf[i]->bear_hot;
+		len = rte_pktmbuf_data_len(pkts[i]) - ETH_HDR_SIZE;
+		construct_ipv4_hdr(pkts[i], len, IP_PROTO_UDP,
+				ntohl(app.s1u_ip), hot->enb_ipv4);
+		((struct gtpu_hdr *)get_mtogtpu(pkts[i]))->teid =
+			htonl(hot->enb_teid);
+	}
+}
+
+int gtpu_relay_test(void)
+{
+	uint8_t hw_s1u, hw_s5s8;
+	uint64_t start, pkts_mask, relay, rebuild;
+	struct dp_sdf_per_bearer_info *sdf;
+	struct dp_session_hot *hot;
+	struct rte_mempool *mp;
+	enum dp_config spgw_cfg = app.spgw_cfg;
+	uint32_t i, n, teid;
+	int ret = 0, nb;
+
+	mp = rte_pktmbuf_pool_create("gtpu_relay_pool", 4 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL ||
+			rte_pktmbuf_alloc_bulk(mp, relay_orig, MAX_BURST_SZ) < 0 ||
+			rte_pktmbuf_alloc_bulk(mp, relay_pkts, MAX_BURST_SZ) < 0 ||
+			rte_pktmbuf_alloc_bulk(mp, relay_exp, MAX_BURST_SZ) < 0)
+		return -1;
+
+	nb = gtpu_relay_load();
+	if (nb <= 0) {
+		printf("GTP-U relay test skipped: no pkts in %s\n",
+				GTPU_RELAY_PCAP);
+		goto out;
+	}
+	n = nb;
+	pkts_mask = (~0LLU) >> (64 - n);
+
+	hot = rte_zmalloc("relay hot", sizeof(*hot), RTE_CACHE_LINE_SIZE);
+	sdf = rte_zmalloc("relay sdf", sizeof(*sdf), RTE_CACHE_LINE_SIZE);
+	if (hot == NULL || sdf == NULL)
+		return -1;
+	hot->enb_ipv4 = GTPU_RELAY_ENB_IP;
+	hot->enb_teid = GTPU_RELAY_ENB_TEID;
+	hot->s5s8_pgwu_ipv4 = GTPU_RELAY_PGWU_IP;
+	sdf->bear_hot = hot;
+	for (i = 0; i < n; i++)
+		relay_sdf[i] = sdf;
+
+	/* RFC 1624 path: checksums in SW */
+	hw_s1u = ipv4_cksum_offload[app.s1u_port];
+	hw_s5s8 = ipv4_cksum_offload[app.s5s8_sgwu_port];
+	ipv4_cksum_offload[app.s1u_port] = 0;
+	ipv4_cksum_offload[app.s5s8_sgwu_port] = 0;
+	app.spgw_cfg = SGWU;
+
+	/* S5/S8 to S1U: eNB address and TEID */
+	teid = htonl(GTPU_RELAY_ENB_TEID);
+	gtpu_relay_copy(relay_pkts, n);
+	gtpu_relay_copy(relay_exp, n);
+	update_enb_info(relay_pkts, n, &pkts_mask, relay_sdf);
+	for (i = 0; i < n; i++)
+		gtpu_relay_expect(relay_exp[i], app.s1u_ip,
+				htonl(GTPU_RELAY_ENB_IP), &teid);
+	if (gtpu_relay_cmp(relay_pkts, relay_exp, n) < 0)
+		ret = -1;
+
+	/* S1U to S5/S8: PGWU address, TEID kept */
+	gtpu_relay_copy(relay_pkts, n);
+	gtpu_relay_copy(relay_exp, n);
+	update_nexts5s8_info(relay_pkts, n, &pkts_mask, relay_sdf);
+	for (i = 0; i < n; i++)
+		gtpu_relay_expect(relay_exp[i], app.s5s8_sgwu_ip,
+				htonl(GTPU_RELAY_PGWU_IP), NULL);
+	if (gtpu_relay_cmp(relay_pkts, relay_exp, n) < 0)
+		ret = -1;
+
+	start = rte_rdtsc();
+	for (i = 0; i < GTPU_RELAY_ITERS; i++)
+		update_enb_info(relay_pkts, n, &pkts_mask, relay_sdf);
+	relay = (rte_rdtsc() - start) / ((uint64_t)GTPU_RELAY_ITERS * n);
+
+	start = rte_rdtsc();
+	for (i = 0; i < GTPU_RELAY_ITERS; i++)
+		gtpu_relay_rebuild_burst(relay_pkts, n);
+	rebuild = (rte_rdtsc() - start) / ((uint64_t)GTPU_RELAY_ITERS * n);
+
+	printf("GTP-U relay test %s: %u pkts of %s, in place %"PRIu64
+			" cycles/pkt, rebuild %"PRIu64" cycles/pkt\n",
+			ret ? "FAIL" : "PASS", n, GTPU_RELAY_PCAP, relay,
+			rebuild);
+
+	app.spgw_cfg = spgw_cfg;
+	ipv4_cksum_offload[app.s1u_port] = hw_s1u;
+	ipv4_cksum_offload[app.s5s8_sgwu_port] = hw_s5s8;
+	rte_free(sdf);
+	rte_free(hot);
+out:
+	for (i = 0; i < MAX_BURST_SZ; i++) {
+		rte_pktmbuf_free(relay_orig[i]);
+		rte_pktmbuf_free(relay_pkts[i]);
+		rte_pktmbuf_free(relay_exp[i]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GTPU_RELAY_TEST_H_
+#define _GTPU_RELAY_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* S1U capture replayed, relative to dp/ */
+#define GTPU_RELAY_PCAP		"../pcap/uplink_100flows.pcap"
+
+/* Bursts timed per run */
+#define GTPU_RELAY_ITERS	100000
+
+/* Test bearer addresses and TEID, host order */
+#define GTPU_RELAY_ENB_IP	0x0b070165	/* 11.7.1.101 */
+#define GTPU_RELAY_PGWU_IP	0x0d030165	/* 13.3.1.101 */
+#define GTPU_RELAY_ENB_TEID	0x00abcdef
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Replays GTPU_RELAY_PCAP through the SGWU relay paths, update_enb_info
+ * and update_nexts5s8_info, with SW checksums: outer headers must be the
+ * captured ones but for the new addresses, TEID and a zero UDP checksum,
+ * with a valid IPv4 checksum. Then times the in place relay against a
+ * full outer IPv4 header rebuild per pkt. Skipped if the capture is not
+ * found.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int gtpu_relay_test(void);
+#endif
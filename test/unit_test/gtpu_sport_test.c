@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <string.h>
+
+#include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_thash.h>
+#include <rte_udp.h>
+
+#include "ipv4.h"
+#include "util.h"
+#include "gtpu_sport_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Default RSS key of Intel NICs */
+static const uint8_t sport_rss_key[40] = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+/* Inner pkts of the flow scheme: UE 16.0.0.0/8 to 13.1.1.1 */
+#define SPORT_UE_IP		0x10000001
+#define SPORT_SRV_IP		0x0d010101
+#define SPORT_PKT_LEN		64
+
+static uint32_t sport_queue_cnt[GTPU_SPORT_NB_QUEUES];
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Count an outer source port in the receiver queue its tuple hashes to.
+ *
+ * @return
+ *	- 0 if the port is in the dynamic range
+ *	- -1 if not
+ */
+static int
+gtpu_sport_count(uint16_t sport)
+{
+	uint32_t tuple[3];
+
+	sport = ntohs(sport);
+	if ((sport & ~GTPU_SPORT_MASK) != GTPU_SPORT_BASE)
+		return -1;
+
+	tuple[0] = ntohl(app.s1u_ip);
+	tuple[1] = GTPU_SPORT_ENB_IP;
+	tuple[2] = ((uint32_t)sport << 16) | UDP_PORT_GTPU;
+	sport_queue_cnt[rte_softrss(tuple, RTE_DIM(tuple), sport_rss_key) &
+		(GTPU_SPORT_NB_QUEUES - 1)]++;
+
+	return 0;
+}
+
+/**
+ * Largest deviation of a queue from the mean, in %, and reset counts.
+ */
+static uint32_t
+gtpu_sport_skew(void)
+{
+	uint32_t mean = GTPU_SPORT_NB_FLOWS / GTPU_SPORT_NB_QUEUES;
+	uint32_t q, dev, skew = 0;
+
+	for (q = 0; q < GTPU_SPORT_NB_QUEUES; q++) {
+		dev = (sport_queue_cnt[q] > mean) ?
+			sport_queue_cnt[q] - mean : mean - sport_queue_cnt[q];
+		skew = RTE_MAX(skew, dev * 100 / mean);
+		sport_queue_cnt[q] = 0;
+	}
+
+	return skew;
+}
+
+/**
+ * Outer UDP header of a bearer template.
+ */
+static struct udp_hdr *
+gtpu_sport_tmpl_udp(struct dp_session_hot *hot)
+{
+	return (struct udp_hdr *)(hot->tmpl.hdr + ETH_HDR_SIZE +
+			IPv4_HDR_SIZE);
+}
+
+/**
+ * Ether + IPv4 + UDP pkt of inner flow i.
+ */
+static void
+gtpu_sport_fill(struct rte_mbuf *m, uint32_t i)
+{
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+
+	rte_pktmbuf_reset(m);
+	memset(rte_pktmbuf_append(m, SPORT_PKT_LEN), 0, SPORT_PKT_LEN);
+
+	ip = get_mtoip(m);
+	ip->version_ihl = 0x45;
+	ip->total_length = htons(SPORT_PKT_LEN - ETH_HDR_SIZE);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = htonl(SPORT_UE_IP + i);
+	ip->dst_addr = htonl(SPORT_SRV_IP);
+
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = htons(1024 + (i & 0x3fff));
+	udp->dst_port = htons(80);
+}
+
+int gtpu_sport_test(void)
+{
+	struct dp_session_hot *si[MAX_BURST_SZ];
+	struct rte_mbuf *pkts[MAX_BURST_SZ];
+	uint32_t sport = app.gtpu_sport;
+	uint32_t i, j, n = MAX_BURST_SZ;
+	uint32_t teid_skew, flow_skew;
+	uint64_t pkts_mask, queue_mask;
+	struct dp_session_hot *hot;
+	struct rte_mempool *mp;
+	int ret = 0;
+
+	hot = rte_zmalloc("sport hot", sizeof(*hot), RTE_CACHE_LINE_SIZE);
+	if (hot == NULL)
+		return -1;
+	hot->enb_ipv4 = GTPU_SPORT_ENB_IP;
+
+	/* Fixed: one port for all */
+	app.gtpu_sport = GTPU_SPORT_FIXED;
+	hot->enb_teid = 1;
+	gtpu_encap_tmpl_build(hot);
+	if (gtpu_sport_tmpl_udp(hot)->src_port != htons(UDP_PORT_GTPU))
+		ret = -1;
+
+	/* TEID: dense TEIDs as the CP allocates them */
+	app.gtpu_sport = GTPU_SPORT_TEID;
+	for (i = 0; i < GTPU_SPORT_NB_FLOWS; i++) {
+		hot->enb_teid = i + 1;
+		gtpu_encap_tmpl_build(hot);
+		if (gtpu_sport_count(gtpu_sport_tmpl_udp(hot)->src_port) < 0)
+			ret = -1;
+	}
+	teid_skew = gtpu_sport_skew();
+
+	/* Flow: inner flows of one bearer */
+	app.gtpu_sport = GTPU_SPORT_FLOW;
+	hot->enb_teid = 1;
+	gtpu_encap_tmpl_build(hot);
+	for (j = 0; j < n; j++)
+		si[j] = hot;
+
+	mp = rte_pktmbuf_pool_create("gtpu_sport_pool", 2 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL || rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0)
+		return -1;
+
+	for (i = 0; i < GTPU_SPORT_NB_FLOWS; i += n) {
+		for (j = 0; j < n; j++)
+			gtpu_sport_fill(pkts[j], i + j);
+		pkts_mask = (~0LLU) >> (64 - n);
+		queue_mask = 0;
+		gtpu_encap(si, pkts, n, &pkts_mask, &queue_mask);
+		for (j = 0; j < n; j++) {
+			if (!ISSET_BIT(pkts_mask, j) || gtpu_sport_count(
+					(rte_pktmbuf_mtod_offset(pkts[j],
+					 struct udp_hdr *, ETH_HDR_SIZE +
+					 IPv4_HDR_SIZE))->src_port) < 0)
+				ret = -1;
+		}
+	}
+	flow_skew = gtpu_sport_skew();
+
+	if (teid_skew > GTPU_SPORT_MAX_SKEW || flow_skew > GTPU_SPORT_MAX_SKEW)
+		ret = -1;
+
+	printf("GTP-U sport test %s: %u bearers/flows over %u queues, max "
+			"skew TEID %u%%, flow %u%%\n", ret ? "FAIL" : "PASS",
+			GTPU_SPORT_NB_FLOWS, GTPU_SPORT_NB_QUEUES, teid_skew,
+			flow_skew);
+
+	app.gtpu_sport = sport;
+	rte_free(hot);
+	for (j = 0; j < n; j++)
+		rte_pktmbuf_free(pkts[j]);
+
+	return ret;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GTPU_SPORT_TEST_H_
+#define _GTPU_SPORT_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Bearers (TEID scheme) and inner flows (flow scheme) encapsulated */
+#define GTPU_SPORT_NB_FLOWS	65536
+
+/* RSS queues of the emulated receiver, a power of 2 */
+#define GTPU_SPORT_NB_QUEUES	16
+
+/* Max. deviation of a queue from the mean load, in % */
+#define GTPU_SPORT_MAX_SKEW	10
+
+/* Test eNB address, host order */
+#define GTPU_SPORT_ENB_IP	0x0b070165	/* 11.7.1.101 */
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Outer UDP source ports of GTP-U encap for the TEID scheme over
+ * GTPU_SPORT_NB_FLOWS bearers with dense TEIDs, and for the flow scheme
+ * over as many inner flows of one bearer. Ports must be in the dynamic
+ * range, and spread over GTPU_SPORT_NB_QUEUES receiver queues by the
+ * Toeplitz RSS hash of the outer tuple within GTPU_SPORT_MAX_SKEW.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int gtpu_sport_test(void);
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pcap.h>
+
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+
+#include "gtpv2c_messages.h"
+#include "gtpv2c_decode_bench.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Decode targets, one message at a time */
+static union {
+	create_session_request_t cs_req;
+	modify_bearer_request_t mb_req;
+	delete_session_request_t ds_req;
+} decode_bench_msg;
+
+static gtpv2c_msg_view_t decode_bench_view;
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Struct decode of msg by message type.
+ *
+ * @return
+ *	decoded bytes, -1 if type has no struct decoder.
+ */
+static int
+decode_bench_struct(uint8_t *msg)
+{
+	switch (msg[1]) {
+	case 32:	/* Create Session Request */
+		return decode_create_session_request_t(msg,
+				&decode_bench_msg.cs_req);
+	case 34:	/* Modify Bearer Request */
+		return decode_modify_bearer_request_t(msg,
+				&decode_bench_msg.mb_req);
+	case 36:	/* Delete Session Request */
+		return decode_delete_session_request_t(msg,
+				&decode_bench_msg.ds_req);
+	default:
+		return -1;
+	}
+}
+
+int gtpv2c_decode_bench_test(void)
+{
+	const uint32_t hdr_len = sizeof(struct ether_hdr) +
+			sizeof(struct ipv4_hdr) + sizeof(struct udp_hdr);
+	char errbuf[PCAP_ERRBUF_SIZE];
+	struct pcap_pkthdr *pkthdr;
+	const u_char *pkt;
+	uint8_t msg[UINT16_MAX];
+	uint64_t start, t_struct, t_view;
+	uint32_t i, nb_msgs = 0;
+	int ret = 0, len_struct, len_view;
+	pcap_t *pcap;
+
+	pcap = pcap_open_offline(GTPV2C_DECODE_BENCH_PCAP, errbuf);
+	if (pcap == NULL) {
+		printf("GTPv2c decode bench: %s\n", errbuf);
+		return -1;
+	}
+
+	while (pcap_next_ex(pcap, &pkthdr, &pkt) > 0) {
+		if ((pkthdr->caplen <= hdr_len) ||
+				(pkthdr->caplen - hdr_len > sizeof(msg)))
+			continue;
+		memcpy(msg, pkt + hdr_len, pkthdr->caplen - hdr_len);
+
+		len_struct = decode_bench_struct(msg);
+		if (len_struct < 0)
+			continue;
+		len_view = decode_gtpv2c_msg_view_t(msg, &decode_bench_view);
+		if (len_view != len_struct)
+			ret = -1;
+
+		start = rte_rdtsc();
+		for (i = 0; i < GTPV2C_DECODE_BENCH_ITERS; i++)
+			decode_bench_struct(msg);
+		t_struct = rte_rdtsc() - start;
+
+		start = rte_rdtsc();
+		for (i = 0; i < GTPV2C_DECODE_BENCH_ITERS; i++)
+			decode_gtpv2c_msg_view_t(msg, &decode_bench_view);
+		t_view = rte_rdtsc() - start;
+
+		printf("GTPv2c decode bench: msg type %u, %u bytes, %u IEs: "
+				"struct %"PRIu64" cycles/msg, view %"PRIu64
+				" cycles/msg\n", msg[1], pkthdr->caplen - hdr_len,
+				decode_bench_view.nb_ies,
+				t_struct / GTPV2C_DECODE_BENCH_ITERS,
+				t_view / GTPV2C_DECODE_BENCH_ITERS);
+		nb_msgs++;
+	}
+	pcap_close(pcap);
+
+	if (nb_msgs == 0)
+		ret = -1;
+	printf("GTPv2c decode bench %s: %u msgs from %s\n",
+			ret ? "FAIL" : "PASS", nb_msgs, GTPV2C_DECODE_BENCH_PCAP);
+
+	return ret;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GTPV2C_DECODE_BENCH_H_
+#define _GTPV2C_DECODE_BENCH_H_
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Captured GTPv2c messages, Ether/IPv4/UDP framed */
+#ifndef GTPV2C_DECODE_BENCH_PCAP
+#define GTPV2C_DECODE_BENCH_PCAP	"pcap/cp_in.pcap"
+#endif
+
+/* Decodes timed per message */
+#define GTPV2C_DECODE_BENCH_ITERS	100000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Time libgtpv2c decode of each captured message with a struct
+ * decoder (create session, modify bearer, delete session request)
+ * against the zero-copy view decode of the same message.
+ * Fails if the capture cannot be read, or if the view does not
+ * cover the bytes consumed by the struct decoder.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int gtpv2c_decode_bench_test(void);
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+
+#include "ip_pool_bench.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+int ip_pool_bench_test(void)
+{
+	struct ip_pool pool;
+	uint32_t *idx, *seen;
+	uint64_t start, fill, drain, churn, churn_max = 0, t;
+	uint32_t i, k, lcg = 1;
+	int ret = 0;
+
+	if (ip_pool_init(&pool, IP_POOL_BENCH_HOSTS) < 0)
+		return -1;
+	idx = rte_zmalloc(NULL, IP_POOL_BENCH_HOSTS * sizeof(*idx), 0);
+	seen = rte_zmalloc(NULL, IP_POOL_BENCH_HOSTS * sizeof(*seen), 0);
+	if (idx == NULL || seen == NULL) {
+		ret = -1;
+		goto out;
+	}
+
+	/* Fill */
+	start = rte_rdtsc();
+	for (i = 0; i < IP_POOL_BENCH_HOSTS; i++)
+		if (ip_pool_alloc(&pool, &idx[i]) < 0)
+			break;
+	fill = rte_rdtsc() - start;
+	if (i != IP_POOL_BENCH_HOSTS || ip_pool_alloc(&pool, &k) == 0) {
+		ret = -1;
+		goto out;
+	}
+	for (i = 0; i < IP_POOL_BENCH_HOSTS; i++)
+		if (idx[i] >= IP_POOL_BENCH_HOSTS || seen[idx[i]]++) {
+			ret = -1;
+			goto out;
+		}
+
+	/* Churn on the full pool: release a random address, allocate */
+	churn = 0;
+	for (i = 0; i < IP_POOL_BENCH_CHURN; i++) {
+		lcg = lcg * 1103515245 + 12345;
+		k = lcg % IP_POOL_BENCH_HOSTS;
+		start = rte_rdtsc();
+		ip_pool_release(&pool, idx[k]);
+		if (ip_pool_alloc(&pool, &idx[k]) < 0)
+			ret = -1;
+		t = rte_rdtsc() - start;
+		churn += t;
+		churn_max = RTE_MAX(churn_max, t);
+	}
+
+	/* Drain */
+	start = rte_rdtsc();
+	if (ip_pool_release_bulk(&pool, idx, IP_POOL_BENCH_HOSTS) !=
+			IP_POOL_BENCH_HOSTS)
+		ret = -1;
+	drain = rte_rdtsc() - start;
+	if (pool.nb_free != IP_POOL_BENCH_HOSTS)
+		ret = -1;
+
+	printf("IP pool bench %s: hosts %u, alloc %"PRIu64" cycles/op, "
+			"release %"PRIu64" cycles/op, full pool release+alloc "
+			"%"PRIu64" cycles/op (max %"PRIu64")\n",
+			ret ? "FAIL" : "PASS", IP_POOL_BENCH_HOSTS,
+			fill / IP_POOL_BENCH_HOSTS, drain / IP_POOL_BENCH_HOSTS,
+			churn / IP_POOL_BENCH_CHURN, churn_max);
+
+out:
+	rte_free(seen);
+	rte_free(idx);
+	ip_pool_free(&pool);
+	return ret;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _IP_POOL_BENCH_H_
+#define _IP_POOL_BENCH_H_
+
+#include "ip_pool.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Benchmark pool size: a /16 */
+#define IP_POOL_BENCH_HOSTS	(1U << 16)
+
+/* Release/allocate pairs timed on the full pool */
+#define IP_POOL_BENCH_CHURN	100000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Fill and drain a /16 pool and report cycles per allocate and
+ * release, both on an empty pool and on a pool kept one address
+ * short of full. Fails if an allocation is refused before the pool
+ * is full, or if any address is handed out twice.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int ip_pool_bench_test(void);
+#endif
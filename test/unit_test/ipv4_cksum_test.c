@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_random.h>
+
+#include "ipv4.h"
+#include "ipv4_cksum_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Port with no checksum offload */
+#define IPV4_CKSUM_PORT		(RTE_MAX_ETHPORTS - 1)
+
+/* Checksum of pkts ipv4_cksum_tx_prep must not touch */
+#define IPV4_CKSUM_KEEP		0x1234
+
+static struct ipv4_hdr cksum_hdr[MAX_BURST_SZ];
+static struct ipv4_hdr *cksum_ip[MAX_BURST_SZ];
+static uint16_t cksum_ref[MAX_BURST_SZ];
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Fill n headers with a byte value, or random bytes if fill < 0, and
+ * take their reference checksums.
+ */
+static void
+ipv4_cksum_fill(uint32_t n, int fill)
+{
+	uint64_t *w;
+	uint32_t i, j;
+
+	for (i = 0; i < n; i++) {
+		if (fill >= 0) {
+			memset(&cksum_hdr[i], fill, sizeof(cksum_hdr[i]));
+		} else {
+			w = (uint64_t *)&cksum_hdr[i];
+			for (j = 0; j < sizeof(cksum_hdr[i]) / sizeof(*w); j++)
+				w[j] = rte_rand();
+			*(uint32_t *)&w[j] = (uint32_t)rte_rand();
+		}
+		cksum_hdr[i].hdr_checksum = 0;
+		cksum_ref[i] = rte_ipv4_cksum(&cksum_hdr[i]);
+	}
+}
+
+/**
+ * Bulk checksum of n headers against the references.
+ */
+static int
+ipv4_cksum_check(uint32_t n)
+{
+	uint32_t i;
+
+	ipv4_cksum_bulk(cksum_ip, n);
+	for (i = 0; i < n; i++)
+		if (cksum_hdr[i].hdr_checksum != cksum_ref[i])
+			return -1;
+
+	return 0;
+}
+
+/**
+ * TX prep of a burst of even sized MAX_BURST_SZ: deferred (odd) pkts get
+ * their checksum, others and pkts out of the mask are left as they are.
+ */
+static int
+ipv4_cksum_tx_prep_check(struct rte_mbuf **pkts, uint32_t n)
+{
+	uint64_t pkts_mask = (~0LLU) >> (64 - n + 1);
+	struct ipv4_hdr *ip;
+	uint16_t ref[MAX_BURST_SZ];
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		rte_pktmbuf_reset(pkts[i]);
+		rte_pktmbuf_append(pkts[i], ETH_HDR_SIZE + IPv4_HDR_SIZE);
+		ip = get_mtoip(pkts[i]);
+		ipv4_cksum_fill(1, -1);
+		memcpy(ip, &cksum_hdr[0], sizeof(*ip));
+		ref[i] = cksum_ref[0];
+		if (!(i & 1))
+			ip->hdr_checksum = IPV4_CKSUM_KEEP;
+		else
+			ipv4_cksum_defer(pkts[i]);
+	}
+
+	/* Last pkt is out of the mask */
+	ipv4_cksum_tx_prep(pkts, n, pkts_mask, IPV4_CKSUM_PORT);
+
+	for (i = 0; i < n; i++) {
+		ip = get_mtoip(pkts[i]);
+		if (!(i & 1)) {
+			if (ip->hdr_checksum != IPV4_CKSUM_KEEP)
+				return -1;
+		} else if (i == n - 1) {
+			if (ip->hdr_checksum != 0 ||
+					!(pkts[i]->ol_flags & PKT_TX_IP_CKSUM))
+				return -1;
+		} else if (ip->hdr_checksum != ref[i] ||
+				(pkts[i]->ol_flags & PKT_TX_IP_CKSUM)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int ipv4_cksum_test(void)
+{
+	struct rte_mbuf *pkts[MAX_BURST_SZ];
+	uint64_t start, bulk, scalar;
+	uint32_t i, j, n = MAX_BURST_SZ;
+	struct rte_mempool *mp;
+	int ret = 0;
+
+	for (i = 0; i < n; i++)
+		cksum_ip[i] = &cksum_hdr[i];
+
+	/* Every burst size, for the vector and scalar tails */
+	for (i = 0; i < IPV4_CKSUM_ROUNDS && ret == 0; i++) {
+		ipv4_cksum_fill(i % n + 1, -1);
+		ret = ipv4_cksum_check(i % n + 1);
+	}
+	ipv4_cksum_fill(n, 0);
+	if (ipv4_cksum_check(n) < 0)
+		ret = -1;
+	ipv4_cksum_fill(n, 0xff);
+	if (ipv4_cksum_check(n) < 0)
+		ret = -1;
+
+	if (ipv4_cksum_offload[IPV4_CKSUM_PORT])
+		return -1;
+	mp = rte_pktmbuf_pool_create("ipv4_cksum_pool", 2 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL || rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0)
+		return -1;
+	if (ipv4_cksum_tx_prep_check(pkts, n) < 0)
+		ret = -1;
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	ipv4_cksum_fill(n, -1);
+	start = rte_rdtsc();
+	for (i = 0; i < IPV4_CKSUM_ITERS; i++)
+		ipv4_cksum_bulk(cksum_ip, n);
+	bulk = (rte_rdtsc() - start) / ((uint64_t)IPV4_CKSUM_ITERS * n);
+
+	start = rte_rdtsc();
+	for (i = 0; i < IPV4_CKSUM_ITERS; i++)
+		for (j = 0; j < n; j++)
+			cksum_hdr[j].hdr_checksum =
+				rte_ipv4_cksum(&cksum_hdr[j]);
+	scalar = (rte_rdtsc() - start) / ((uint64_t)IPV4_CKSUM_ITERS * n);
+
+	printf("IPv4 checksum test %s: burst %u, bulk %"PRIu64
+			" cycles/hdr, rte_ipv4_cksum %"PRIu64" cycles/hdr\n",
+			ret ? "FAIL" : "PASS", n, bulk, scalar);
+
+	return ret;
+}
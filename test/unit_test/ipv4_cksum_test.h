@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _IPV4_CKSUM_TEST_H_
+#define _IPV4_CKSUM_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Random header bursts compared */
+#define IPV4_CKSUM_ROUNDS	10000
+
+/* Bursts timed per run */
+#define IPV4_CKSUM_ITERS	100000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * ipv4_cksum_bulk against rte_ipv4_cksum of each header: random headers
+ * in bursts of 1..MAX_BURST_SZ, plus all 0 and all 0xff headers. Then
+ * ipv4_cksum_tx_prep on a port without offload, which must complete
+ * deferred checksums only. Times bulk and scalar per header.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int ipv4_cksum_test(void);
+#endif
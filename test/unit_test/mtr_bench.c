@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+
+#include "ngic_rtc_framework.h"
+#include "mtr_bench.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+#if defined(SDF_MTR) && defined(APN_MTR)
+static struct mtr_entry mtr_bench_profile = {
+	.mtr_profile_index = MTR_BENCH_PROFILE,
+	.mtr_param = {
+		.cir = 100000000000ULL,	/* 100 GBps */
+		.cbs = 1 << 20,
+		.ebs = 1 << 20,
+	},
+};
+
+static struct mtr_entry mtr_rate_profile = {
+	.mtr_profile_index = MTR_RATE_PROFILE,
+	.mtr_param = {
+		.cir = MTR_RATE_CIR,
+		.cbs = MTR_RATE_CBS,
+		.ebs = MTR_RATE_CBS,
+	},
+};
+
+/* Meter rate test: meter owner, pkts and TSC end of the test */
+static struct dp_sdf_per_bearer_info *mtr_rate_sdf;
+static struct rte_mbuf **mtr_rate_pkts;
+static uint64_t mtr_rate_end;
+/* pkts let through by all lcores */
+static rte_atomic64_t mtr_rate_passed;
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Run UL metering stage on one burst MTR_BENCH_ITERS times.
+ *
+ * @return
+ *	cycles per pkt.
+ */
+static uint64_t
+mtr_bench_run(struct dp_sdf_per_bearer_info **sdf_info,
+		struct rte_mbuf **pkts, uint32_t n, uint64_t *drops)
+{
+	uint64_t start, pkts_mask;
+	uint32_t i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < MTR_BENCH_ITERS; i++) {
+		pkts_mask = (~0LLU) >> (64 - n);
+		sdf_mtr_process_pkt(sdf_info, NULL, NULL, UL_FLOW, pkts, n,
+				&pkts_mask);
+		apn_mtr_process_pkt(sdf_info, UL_FLOW, pkts, n, &pkts_mask);
+		*drops += n - __builtin_popcountll(pkts_mask);
+	}
+
+	return (rte_rdtsc() - start) / ((uint64_t)MTR_BENCH_ITERS * n);
+}
+
+/**
+ * Police full bursts with the meter share of worker 'arg' until the
+ * test ends. Pkts are only read, all lcores share them.
+ */
+static int
+mtr_rate_lcore(void *arg)
+{
+	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ];
+	uint64_t pkts_mask, passed = 0;
+	uint32_t i;
+
+	RTE_PER_LCORE(epc_wrk_id) = (uint32_t)(uintptr_t)arg;
+	for (i = 0; i < MAX_BURST_SZ; i++)
+		sdf_info[i] = mtr_rate_sdf;
+
+	while (rte_rdtsc() < mtr_rate_end) {
+		pkts_mask = ~0LLU;
+		sdf_mtr_process_pkt(sdf_info, NULL, NULL, UL_FLOW,
+				mtr_rate_pkts, MAX_BURST_SZ, &pkts_mask);
+		passed += __builtin_popcountll(pkts_mask);
+	}
+
+	rte_atomic64_add(&mtr_rate_passed, passed);
+	return 0;
+}
+
+/**
+ * Police one SDF meter from one lcore per worker share for MTR_RATE_MS,
+ * check the bytes let through are the rate of the shares used over that
+ * time plus their committed bursts, within MTR_RATE_TOL percent.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+mtr_rate_test(struct dp_sdf_per_bearer_info *psdf, struct rte_mbuf **pkts)
+{
+	uint32_t nb_wrk = epc_app.nb_workers;
+	uint32_t nb_used = 1;
+	uint64_t start, bytes, expect;
+	unsigned int lcore;
+	int ret = 0;
+
+	mtr_cfg_entry(MTR_RATE_PROFILE, CDR_VOL_SDF, psdf->vol_slot, UL_FLOW);
+	mtr_rate_sdf = psdf;
+	mtr_rate_pkts = pkts;
+	rte_atomic64_init(&mtr_rate_passed);
+
+	start = rte_rdtsc();
+	mtr_rate_end = start + rte_get_tsc_hz() / 1000 * MTR_RATE_MS;
+	RTE_LCORE_FOREACH_SLAVE(lcore) {
+		if (nb_used == nb_wrk)
+			break;
+		rte_eal_remote_launch(mtr_rate_lcore,
+				(void *)(uintptr_t)nb_used++, lcore);
+	}
+	mtr_rate_lcore((void *)0);
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		rte_eal_wait_lcore(lcore);
+
+	/* Meters count the frame without its Ethernet header */
+	bytes = rte_atomic64_read(&mtr_rate_passed) *
+		(MTR_BENCH_PKT_LEN - sizeof(struct ether_hdr));
+	expect = nb_used * (MTR_RATE_CIR / nb_wrk * MTR_RATE_MS / 1000 +
+			MTR_RATE_CBS / nb_wrk);
+	if (bytes > expect * (100 + MTR_RATE_TOL) / 100 ||
+			bytes < expect * (100 - MTR_RATE_TOL) / 100)
+		ret = -1;
+
+	printf("Meter rate test %s: %u of %u worker shares, %"PRIu64
+			" bytes in %u ms, expected %"PRIu64", drops %"PRIu64"\n",
+			ret ? "FAIL" : "PASS", nb_used, nb_wrk, bytes,
+			MTR_RATE_MS, expect,
+			mtr_shard_drops(CDR_VOL_SDF, psdf->vol_slot, UL_FLOW));
+
+	mtr_cfg_entry(0, CDR_VOL_SDF, psdf->vol_slot, UL_FLOW);
+	return ret;
+}
+#endif	/* SDF_MTR && APN_MTR */
+
+int mtr_bench_test(void)
+{
+#if defined(SDF_MTR) && defined(APN_MTR)
+	struct dp_sdf_per_bearer_info *psdf[MTR_BENCH_NB_BEARERS];
+	struct dp_sdf_per_bearer_info *sdf_info[MAX_BURST_SZ];
+	struct dp_session_hot *si[MTR_BENCH_NB_BEARERS];
+	struct ue_session_info *ue;
+	struct rte_mbuf *pkts[MAX_BURST_SZ];
+	struct rte_mempool *mp;
+	struct dp_id dp_id = {0};
+	uint64_t base, metered, drops = 0;
+	uint32_t i, n = MAX_BURST_SZ;
+	int ret = 0;
+
+	mp = rte_pktmbuf_pool_create("mtr_bench_pool", 2 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL)
+		return -1;
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0)
+		return -1;
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_append(pkts[i], MTR_BENCH_PKT_LEN);
+
+	/* No session is up yet: the first vol slots are free */
+	ue = rte_zmalloc("mtr bench ue", sizeof(*ue), RTE_CACHE_LINE_SIZE);
+	if (ue == NULL)
+		return -1;
+	ue->rg_vol_slot = 0;
+	for (i = 0; i < MTR_BENCH_NB_BEARERS; i++) {
+		si[i] = rte_zmalloc("mtr bench si", sizeof(*si[i]),
+				RTE_CACHE_LINE_SIZE);
+		psdf[i] = rte_zmalloc("mtr bench sdf", sizeof(*psdf[i]),
+				RTE_CACHE_LINE_SIZE);
+		if (si[i] == NULL || psdf[i] == NULL)
+			return -1;
+		si[i]->ue_info_ptr = ue;
+		psdf[i]->bear_hot = si[i];
+		psdf[i]->vol_slot = i;
+	}
+	for (i = 0; i < n; i++)
+		sdf_info[i] = psdf[i % MTR_BENCH_NB_BEARERS];
+
+	/* Baseline: stage runs, no meter configured */
+	base = mtr_bench_run(sdf_info, pkts, n, &drops);
+
+	sprintf(dp_id.name, METER_PROFILE_SDF_TABLE);
+	dp_meter_profile_entry_add(dp_id, &mtr_bench_profile);
+	dp_meter_profile_entry_add(dp_id, &mtr_rate_profile);
+	for (i = 0; i < MTR_BENCH_NB_BEARERS; i++)
+		mtr_cfg_entry(MTR_BENCH_PROFILE, CDR_VOL_SDF,
+				psdf[i]->vol_slot, UL_FLOW);
+	mtr_cfg_entry(MTR_BENCH_PROFILE, CDR_VOL_RG, ue->rg_vol_slot,
+			UL_FLOW);
+
+	metered = mtr_bench_run(sdf_info, pkts, n, &drops);
+
+	if (drops)
+		ret = -1;
+
+	printf("Meter bench %s: burst %u, bearers %u, unmetered %"PRIu64
+			" cycles/pkt, metered %"PRIu64" cycles/pkt, drops %"PRIu64"\n",
+			ret ? "FAIL" : "PASS", n, MTR_BENCH_NB_BEARERS,
+			base, metered, drops);
+
+	if (mtr_rate_test(psdf[0], pkts) < 0)
+		ret = -1;
+
+	for (i = 0; i < MTR_BENCH_NB_BEARERS; i++) {
+		mtr_cfg_entry(0, CDR_VOL_SDF, psdf[i]->vol_slot, UL_FLOW);
+		rte_free(psdf[i]);
+		rte_free(si[i]);
+	}
+	mtr_cfg_entry(0, CDR_VOL_RG, ue->rg_vol_slot, UL_FLOW);
+	dp_meter_profile_entry_delete(dp_id, &mtr_bench_profile);
+	dp_meter_profile_entry_delete(dp_id, &mtr_rate_profile);
+	rte_free(ue);
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	return ret;
+#else
+	printf("Meter bench skipped: build with SDF_MTR and APN_MTR\n");
+	return 0;
+#endif	/* SDF_MTR && APN_MTR */
+}
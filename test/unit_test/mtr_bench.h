@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MTR_BENCH_H_
+#define _MTR_BENCH_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Bearers sharing the benchmark bursts, pkts are spread round robin */
+#define MTR_BENCH_NB_BEARERS	8
+
+/* Bursts timed per run */
+#define MTR_BENCH_ITERS		100000
+
+/* Frame length of benchmark pkts */
+#define MTR_BENCH_PKT_LEN	128
+
+/* Meter profile indexes of the benchmark and the rate test */
+#define MTR_BENCH_PROFILE	1
+#define MTR_RATE_PROFILE	2
+
+/* Meter rate test: rate in bytes/s, committed burst in bytes */
+#define MTR_RATE_CIR		100000000ULL
+#define MTR_RATE_CBS		(64 << 10)
+
+/* Meter rate test duration, in ms */
+#define MTR_RATE_MS		200
+
+/* Meter rate test tolerance on the enforced rate, in percent */
+#define MTR_RATE_TOL		5
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Time the burst metering stage per pkt, SDF and APN meters,
+ * against the same stage with no meter configured.
+ * Meters are configured far above the offered load, any drop
+ * is a failure.
+ * Then police one SDF meter from one lcore per worker, each with its
+ * own share as workers do for a UE whose flows RSS spreads, and check
+ * the bytes let through against the rate of the shares used.
+ * Needs a build with SDF_MTR and APN_MTR, skipped otherwise.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int mtr_bench_test(void);
+#endif
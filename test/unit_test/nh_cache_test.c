@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_cycles.h>
+#include <rte_ip.h>
+
+#include "ether.h"
+#include "mngtplane_handler.h"
+#include "nh_cache_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/* Frame length of test pkts */
+#define NH_CACHE_PKT_LEN	128
+
+static struct arp_entry_data *nh_cache_arp[NH_CACHE_NB_BEARERS];
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Add the ARP entry of bearer b's eNB, mac address 02:00:00:00:<v>:<b>.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+nh_cache_arp_add(uint32_t b, uint8_t v)
+{
+	struct arp_entry_data *data;
+	uint32_t ip = htonl(NH_CACHE_ENB_IP + b);
+
+	data = rte_zmalloc("nh cache arp", sizeof(*data), RTE_CACHE_LINE_SIZE);
+	if (data == NULL)
+		return -1;
+	data->ip = ip;
+	data->port = S1U_PORT_ID;
+	data->status = COMPLETE;
+	data->eth_addr.addr_bytes[0] = 0x02;
+	data->eth_addr.addr_bytes[4] = v;
+	data->eth_addr.addr_bytes[5] = b;
+
+	if (rte_hash_add_key_data(arp_hash_handle[S1U_PORT_ID], &ip,
+				data) < 0) {
+		rte_free(data);
+		return -1;
+	}
+	nh_cache_arp[b] = data;
+	return 0;
+}
+
+/**
+ * Delete the ARP entry of bearer b's eNB. Workers are not running.
+ */
+static void
+nh_cache_arp_del(uint32_t b)
+{
+	uint32_t ip = htonl(NH_CACHE_ENB_IP + b);
+
+	if (nh_cache_arp[b] == NULL)
+		return;
+	rte_hash_del_key(arp_hash_handle[S1U_PORT_ID], &ip);
+	rte_free(nh_cache_arp[b]);
+	nh_cache_arp[b] = NULL;
+}
+
+/**
+ * Reset pkt i to an ether + IPv4 frame to bearer i % NH_CACHE_NB_BEARERS.
+ */
+static void
+nh_cache_fill(struct rte_mbuf *m, uint32_t i)
+{
+	struct ipv4_hdr *ip;
+	uint8_t *p;
+
+	rte_pktmbuf_reset(m);
+	p = (uint8_t *)rte_pktmbuf_append(m, NH_CACHE_PKT_LEN);
+	memset(p, 0, NH_CACHE_PKT_LEN);
+
+	ip = (struct ipv4_hdr *)(p + ETH_HDR_SIZE);
+	ip->version_ihl = 0x45;
+	ip->total_length = htons(NH_CACHE_PKT_LEN - ETH_HDR_SIZE);
+	ip->dst_addr = htonl(NH_CACHE_ENB_IP + i % NH_CACHE_NB_BEARERS);
+}
+
+/**
+ * Check the L2 headers of a burst: pkts of bearers with an ARP entry
+ * sent to the mac address of version v, the others dropped.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+nh_cache_check(struct rte_mbuf **pkts, uint32_t n, uint64_t pkts_mask,
+		uint8_t v)
+{
+	struct ether_hdr *eth;
+	uint32_t i, b;
+
+	for (i = 0; i < n; i++) {
+		b = i % NH_CACHE_NB_BEARERS;
+		if (nh_cache_arp[b] == NULL) {
+			if (ISSET_BIT(pkts_mask, i))
+				return -1;
+			continue;
+		}
+
+		eth = rte_pktmbuf_mtod(pkts[i], struct ether_hdr *);
+		if (!ISSET_BIT(pkts_mask, i) ||
+				eth->ether_type != htons(ETH_TYPE_IPv4) ||
+				!is_same_ether_addr(&eth->s_addr,
+					&ports_eth_addr[S1U_PORT_ID]) ||
+				eth->d_addr.addr_bytes[4] != v ||
+				eth->d_addr.addr_bytes[5] != b)
+			return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Construct the L2 headers of one burst NH_CACHE_ITERS times.
+ *
+ * @return
+ *	cycles per pkt.
+ */
+static uint64_t
+nh_cache_bench(struct rte_mbuf **pkts, uint32_t n,
+		struct dp_sdf_per_bearer_info **sess_info)
+{
+	uint64_t start, pkts_mask;
+	uint32_t i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < NH_CACHE_ITERS; i++) {
+		pkts_mask = RTE_LEN2MASK(n, uint64_t);
+		construct_ether_hdr_bulk(pkts, n, &pkts_mask, S1U_PORT_ID,
+				sess_info);
+	}
+
+	return (rte_rdtsc() - start) / ((uint64_t)NH_CACHE_ITERS * n);
+}
+
+int nh_cache_test(void)
+{
+	struct dp_sdf_per_bearer_info *sdf, *sess_info[MAX_BURST_SZ];
+	struct dp_sdf_per_bearer_info *no_info[MAX_BURST_SZ] = {NULL};
+	struct rte_mbuf *pkts[MAX_BURST_SZ];
+	struct dp_session_hot *hot;
+	enum dp_config spgw_cfg = app.spgw_cfg;
+	uint32_t s1u_gw_ip = app.s1u_gw_ip;
+	uint32_t i, b, n = MAX_BURST_SZ;
+	uint64_t pkts_mask, cached, uncached;
+	struct rte_mempool *mp;
+	int err = 0;
+
+	mp = rte_pktmbuf_pool_create("nh_cache_pool", 2 * MAX_BURST_SZ - 1,
+			0, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL || rte_pktmbuf_alloc_bulk(mp, pkts, n) < 0)
+		return -1;
+
+	hot = rte_zmalloc("nh cache hot", sizeof(*hot) * NH_CACHE_NB_BEARERS,
+			RTE_CACHE_LINE_SIZE);
+	sdf = rte_zmalloc("nh cache sdf", sizeof(*sdf) * NH_CACHE_NB_BEARERS,
+			RTE_CACHE_LINE_SIZE);
+	if (hot == NULL || sdf == NULL)
+		return -1;
+	for (b = 0; b < NH_CACHE_NB_BEARERS; b++) {
+		hot[b].enb_ipv4 = NH_CACHE_ENB_IP + b;
+		sdf[b].bear_hot = &hot[b];
+		if (nh_cache_arp_add(b, 1) < 0)
+			err = -1;
+	}
+	for (i = 0; i < n; i++) {
+		sess_info[i] = &sdf[i % NH_CACHE_NB_BEARERS];
+		nh_cache_fill(pkts[i], i);
+	}
+	nh_gen_bump();
+
+	/* DL to eNBs on the S1U network */
+	app.spgw_cfg = SPGWU;
+	app.s1u_gw_ip = 0;
+
+	/* Resolved by ARP lookup, then cached */
+	pkts_mask = RTE_LEN2MASK(n, uint64_t);
+	construct_ether_hdr_bulk(pkts, n, &pkts_mask, S1U_PORT_ID, sess_info);
+	if (nh_cache_check(pkts, n, pkts_mask, 1) < 0)
+		err = -1;
+	for (b = 0; b < NH_CACHE_NB_BEARERS; b++) {
+		if (hot[b].nh[S1U_PORT_ID].gen != nh_gen ||
+				hot[b].nh[S1U_PORT_ID].ip !=
+				htonl(NH_CACHE_ENB_IP + b))
+			err = -1;
+	}
+
+	/* Mac addresses rewritten behind the cache's back: still served
+	 * from the cache, until the generation is bumped */
+	for (b = 0; b < NH_CACHE_NB_BEARERS; b++)
+		nh_cache_arp[b]->eth_addr.addr_bytes[4] = 2;
+	pkts_mask = RTE_LEN2MASK(n, uint64_t);
+	construct_ether_hdr_bulk(pkts, n, &pkts_mask, S1U_PORT_ID, sess_info);
+	if (nh_cache_check(pkts, n, pkts_mask, 1) < 0)
+		err = -1;
+
+	nh_gen_bump();
+	pkts_mask = RTE_LEN2MASK(n, uint64_t);
+	construct_ether_hdr_bulk(pkts, n, &pkts_mask, S1U_PORT_ID, sess_info);
+	if (nh_cache_check(pkts, n, pkts_mask, 2) < 0)
+		err = -1;
+
+	/* Next hop gone: its pkts are dropped, the others still sent.
+	 * Dropped pkts are also handed to the ARP resolver, which frees
+	 * them once it gives up on the next hop */
+	nh_cache_arp_del(0);
+	nh_gen_bump();
+	pkts_mask = RTE_LEN2MASK(n, uint64_t);
+	construct_ether_hdr_bulk(pkts, n, &pkts_mask, S1U_PORT_ID, sess_info);
+	if (nh_cache_check(pkts, n, pkts_mask, 2) < 0)
+		err = -1;
+
+	if (nh_cache_arp_add(0, 2) < 0)
+		err = -1;
+	nh_gen_bump();
+	cached = nh_cache_bench(pkts, n, sess_info);
+	uncached = nh_cache_bench(pkts, n, no_info);
+
+	printf("Next hop cache test %s: %u bearers, burst %u, cached %"PRIu64
+			" cycles/pkt, ARP lookup %"PRIu64" cycles/pkt\n",
+			err ? "FAIL" : "PASS", NH_CACHE_NB_BEARERS, n,
+			cached, uncached);
+
+	app.spgw_cfg = spgw_cfg;
+	app.s1u_gw_ip = s1u_gw_ip;
+	for (b = 0; b < NH_CACHE_NB_BEARERS; b++)
+		nh_cache_arp_del(b);
+	nh_gen_bump();
+	rte_free(sdf);
+	rte_free(hot);
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	return err;
+}
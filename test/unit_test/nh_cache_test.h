@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _NH_CACHE_TEST_H_
+#define _NH_CACHE_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Bearers, each with its own eNB next hop */
+#define NH_CACHE_NB_BEARERS	8
+
+/* First eNB address, host order */
+#define NH_CACHE_ENB_IP		0xc6336401	/* 198.51.100.1 */
+
+/* Bursts timed per run */
+#define NH_CACHE_ITERS		100000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * DL L2 header construction of bursts spread over NH_CACHE_NB_BEARERS
+ * bearers: destination mac addresses must match the ARP table, be
+ * taken from the bearer next hop cache while the next hop generation
+ * is unchanged, follow ARP changes once it is bumped, and pkts to a
+ * deleted next hop must be dropped. Then times a burst with and
+ * without bearer caches.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int nh_cache_test(void);
+#endif
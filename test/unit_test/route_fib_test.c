@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_cycles.h>
+#include <rte_random.h>
+
+#include "route_fib.h"
+#include "route_fib_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Test route, host order.
+ */
+struct route_fib_test_rt {
+	uint32_t prefix;
+	uint8_t depth;
+	/* gateway, 0 if on-link */
+	uint32_t gw;
+	/* in the FIB */
+	uint8_t present;
+};
+
+/* Nested routes of 198.18.0.0/15 */
+static struct route_fib_test_rt route_fib_test_rt[] = {
+	{0xc6120000, 15, 0x0aff0001, 0},	/* 198.18.0.0/15 */
+	{0xc6120000, 16, 0x0aff0002, 0},	/* 198.18.0.0/16 */
+	{0xc6120100, 24, 0, 0},			/* 198.18.1.0/24 */
+	{0xc6120180, 25, 0x0aff0003, 0},	/* 198.18.1.128/25 */
+	{0xc612014d, 32, 0x0aff0004, 0},	/* 198.18.1.77/32 */
+	{0xc613c800, 22, 0x0aff0005, 0},	/* 198.19.200.0/22 */
+	{0xc613c840, 26, 0, 0},			/* 198.19.200.64/26 */
+};
+
+/* Destinations, network order, and their next hop before the test */
+static uint32_t route_fib_dst[ROUTE_FIB_NB_DST];
+static uint32_t route_fib_base_nh[ROUTE_FIB_NB_DST];
+static uint8_t route_fib_base_hit[ROUTE_FIB_NB_DST];
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Next hop of a destination by linear longest match on the test
+ * routes, falling back to the FIB content before the test.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 if no route
+ */
+static int
+route_fib_ref(uint32_t i, uint32_t *nh_ip)
+{
+	const struct route_fib_test_rt *best = NULL, *rt;
+	uint32_t dst = ntohl(route_fib_dst[i]);
+	uint32_t j, mask;
+
+	for (j = 0; j < RTE_DIM(route_fib_test_rt); j++) {
+		rt = &route_fib_test_rt[j];
+		mask = UINT32_MAX << (32 - rt->depth);
+		if (!rt->present || (dst & mask) != rt->prefix)
+			continue;
+		if (best == NULL || rt->depth > best->depth)
+			best = rt;
+	}
+
+	if (best == NULL) {
+		*nh_ip = route_fib_base_nh[i];
+		return route_fib_base_hit[i] ? 0 : -1;
+	}
+
+	*nh_ip = best->gw ? htonl(best->gw) : route_fib_dst[i];
+	return 0;
+}
+
+/**
+ * Check single and bulk lookups of all destinations against the
+ * reference.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+static int
+route_fib_check(void)
+{
+	uint32_t nh_ip[MAX_BURST_SZ];
+	uint32_t i, j, n, ref_nh, nh;
+	uint64_t hits;
+	int ref;
+
+	for (i = 0; i < ROUTE_FIB_NB_DST; i += n) {
+		n = RTE_MIN((uint32_t)MAX_BURST_SZ, ROUTE_FIB_NB_DST - i);
+		hits = route_fib_lookup_bulk(&route_fib_dst[i], n, nh_ip);
+
+		for (j = 0; j < n; j++) {
+			ref = route_fib_ref(i + j, &ref_nh);
+			if ((route_fib_lookup(route_fib_dst[i + j], &nh) == 0) !=
+					(ref == 0) ||
+					ISSET_BIT(hits, j) != (ref == 0))
+				return -1;
+			if (ref == 0 && (nh != ref_nh || nh_ip[j] != ref_nh))
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Add or delete a test route, in the FIB and the reference.
+ */
+static int
+route_fib_test_set(uint32_t j, int add)
+{
+	struct route_fib_test_rt *rt = &route_fib_test_rt[j];
+	int ret;
+
+	if (add)
+		ret = route_fib_add(htonl(rt->prefix), rt->depth, htonl(rt->gw));
+	else
+		ret = route_fib_del(htonl(rt->prefix), rt->depth);
+	if (ret == 0)
+		rt->present = add;
+
+	return ret;
+}
+
+/**
+ * Look all destinations up ROUTE_FIB_ITERS / (ROUTE_FIB_NB_DST /
+ * MAX_BURST_SZ) times, in bursts or one by one.
+ *
+ * @return
+ *	cycles per destination.
+ */
+static uint64_t
+route_fib_bench(int bulk)
+{
+	uint32_t nb_burst = ROUTE_FIB_NB_DST / MAX_BURST_SZ;
+	uint32_t iters = ROUTE_FIB_ITERS / nb_burst;
+	uint32_t nh_ip[MAX_BURST_SZ];
+	uint64_t start, sum = 0;
+	uint32_t i, j, k;
+
+	start = rte_rdtsc();
+	for (i = 0; i < iters; i++) {
+		for (j = 0; j < ROUTE_FIB_NB_DST; j += MAX_BURST_SZ) {
+			if (bulk) {
+				sum += route_fib_lookup_bulk(&route_fib_dst[j],
+						MAX_BURST_SZ, nh_ip);
+				continue;
+			}
+			for (k = 0; k < MAX_BURST_SZ; k++)
+				sum += route_fib_lookup(route_fib_dst[j + k],
+						&nh_ip[k]);
+		}
+	}
+	/* Keep the lookups */
+	if (sum == UINT64_MAX)
+		printf("\n");
+
+	return (rte_rdtsc() - start) / ((uint64_t)iters * ROUTE_FIB_NB_DST);
+}
+
+int route_fib_test(void)
+{
+	const struct route_fib_test_rt *rt;
+	uint32_t nb_rt = RTE_DIM(route_fib_test_rt);
+	uint32_t i, j, nh;
+	uint64_t bulk, single;
+	int err = 0;
+
+	/* Destinations in and around each route */
+	for (i = 0; i < ROUTE_FIB_NB_DST; i++) {
+		rt = &route_fib_test_rt[i % nb_rt];
+		route_fib_dst[i] = htonl(rt->prefix ^ (uint32_t)(rte_rand() &
+					((1ULL << (33 - rt->depth)) - 1)));
+		route_fib_base_hit[i] = route_fib_lookup(route_fib_dst[i],
+				&route_fib_base_nh[i]) == 0;
+	}
+
+	for (j = 0; j < nb_rt; j++) {
+		if (route_fib_test_set(j, 1) < 0)
+			err = -1;
+	}
+
+	/* Shadow table updates only */
+	for (i = 0; i < ROUTE_FIB_NB_DST; i++) {
+		if ((route_fib_lookup(route_fib_dst[i], &nh) == 0) !=
+				route_fib_base_hit[i] ||
+				(route_fib_base_hit[i] &&
+				nh != route_fib_base_nh[i]))
+			err = -1;
+	}
+
+	route_fib_commit();
+	if (route_fib_check() < 0)
+		err = -1;
+
+	/* New gateway of the /16, the /24 on-link route gone */
+	route_fib_test_rt[1].gw = 0x0aff0006;
+	if (route_fib_test_set(1, 1) < 0 || route_fib_test_set(2, 0) < 0)
+		err = -1;
+	route_fib_commit();
+	if (route_fib_check() < 0)
+		err = -1;
+
+	/* Deleting a missing route fails */
+	if (route_fib_del(htonl(route_fib_test_rt[2].prefix),
+				route_fib_test_rt[2].depth) == 0)
+		err = -1;
+
+	bulk = route_fib_bench(1);
+	single = route_fib_bench(0);
+
+	for (j = 0; j < nb_rt; j++) {
+		if (route_fib_test_rt[j].present && route_fib_test_set(j, 0) < 0)
+			err = -1;
+	}
+	route_fib_commit();
+	if (route_fib_check() < 0)
+		err = -1;
+
+	printf("Route FIB test %s: %u routes, %u destinations, bulk %"PRIu64
+			" cycles/lookup, single %"PRIu64" cycles/lookup\n",
+			err ? "FAIL" : "PASS", nb_rt, ROUTE_FIB_NB_DST, bulk,
+			single);
+
+	return err;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ROUTE_FIB_TEST_H_
+#define _ROUTE_FIB_TEST_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Destinations looked up, in the test routes' 198.18.0.0/15 */
+#define ROUTE_FIB_NB_DST	4096
+
+/* Lookup bursts timed per run */
+#define ROUTE_FIB_ITERS		100000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Route FIB with nested routes of mixed prefix lengths in the benchmark
+ * range 198.18.0.0/15: updates stay invisible until committed, single
+ * and bulk lookups give the longest match of a linear reference, also
+ * after replacing and deleting routes. Then times bulk against single
+ * lookups per destination. Test routes are deleted on return.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int route_fib_test(void);
+#endif
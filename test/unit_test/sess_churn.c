@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_cycles.h>
+#include <rte_launch.h>
+
+#include "sess_pool.h"
+#include "tbl_rcu.h"
+#include "sess_churn.h"
+
+extern struct rte_hash *rte_pcc_hash;
+
+/* ****************************************************************************
+ * ****    Unit Test Data Initialization    ****
+ * ****************************************************************************
+ **/
+
+#define SESS_CHURN_NB_KEYS	(SESS_CHURN_NB_SESS * SESS_CHURN_ROUNDS)
+
+static struct ul_bm_key sess_churn_keys[SESS_CHURN_NB_KEYS];
+static volatile int sess_churn_stop;
+static uint64_t sess_churn_lookups;
+static uint64_t sess_churn_hits;
+static uint64_t sess_churn_errors;
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * S1U TEID of the i-th churn session, as set_s1u_sgw_teid builds it for
+ * a default bearer.
+ */
+static uint32_t
+sess_churn_teid(uint32_t i)
+{
+	return ((SESS_CHURN_UE_BASE + i) & 0x00ffffff) | (0xf0 << 24);
+}
+
+/**
+ * Reader: UL bulk lookups over the keys of all rounds until stopped,
+ * checking the session data of every hit.
+ */
+static int
+sess_churn_reader(__rte_unused void *arg)
+{
+	const void *key[MAX_BURST_SZ];
+	void *data[MAX_BURST_SZ];
+	struct dp_sdf_per_bearer_info *psdf;
+	uint64_t hit_mask;
+	uint32_t i, teid, off = 0;
+
+	epc_qs_online();
+	while (!sess_churn_stop) {
+		for (i = 0; i < MAX_BURST_SZ; i++)
+			key[i] = &sess_churn_keys[off + i];
+		off = (off + MAX_BURST_SZ) % SESS_CHURN_NB_KEYS;
+
+		iface_lookup_uplink_bulk_data(key, MAX_BURST_SZ, &hit_mask,
+				data);
+		sess_churn_lookups += MAX_BURST_SZ;
+
+		while (hit_mask) {
+			i = __builtin_ctzll(hit_mask);
+			hit_mask &= hit_mask - 1;
+			teid = ((const struct ul_bm_key *)key[i])->s1u_sgw_teid;
+			psdf = data[i];
+			if (psdf->pcc_info.rule_id != SESS_CHURN_PCC_ID ||
+					psdf->bear_hot->s1u_sgw_teid != teid ||
+					psdf->bear_sess_info->ul_s1_info.sgw_teid != teid)
+				sess_churn_errors++;
+			sess_churn_hits++;
+		}
+
+		epc_qs_quiescent();
+	}
+	epc_qs_offline();
+
+	return 0;
+}
+
+/**
+ * Create or delete the sessions of a round.
+ */
+static int
+sess_churn_round(struct dp_id dp_id, uint32_t round, int add)
+{
+	struct session_info sess;
+	uint32_t i, n;
+	int ret;
+
+	for (i = 0; i < SESS_CHURN_NB_SESS; i++) {
+		n = round * SESS_CHURN_NB_SESS + i;
+		memset(&sess, 0, sizeof(sess));
+		sess.sess_id = ((uint64_t)(SESS_CHURN_UE_BASE + n) << 4) |
+			DEFAULT_BEARER;
+		sess.ue_addr.iptype = IPTYPE_IPV4;
+		sess.ue_addr.u.ipv4_addr = IPv4(16, 128, 0, 0) + n;
+		sess.ul_s1_info.sgw_teid = sess_churn_teid(n);
+		sess.num_ul_pcc_rules = 1;
+		sess.ul_pcc_rule_id[0] = SESS_CHURN_PCC_ID;
+
+		ret = add ? dp_session_create(dp_id, &sess) :
+			dp_session_delete(dp_id, &sess);
+		if (ret < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+int
+sess_churn_test(void)
+{
+	unsigned lcore = epc_app.core_ul[0];
+	struct pcc_rules *pcc, rule = {0};
+	uint32_t bearers, round, i;
+	struct dp_id dp_id;
+	uint32_t key32 = SESS_CHURN_PCC_ID;
+	int ret = 0;
+
+	for (i = 0; i < SESS_CHURN_NB_KEYS; i++) {
+		sess_churn_keys[i].s1u_sgw_teid = sess_churn_teid(i);
+		sess_churn_keys[i].rid = SESS_CHURN_PCC_ID;
+	}
+
+	/* PCC rule only: no SDF/ADC filter association */
+	pcc = rte_zmalloc("sess_churn_pcc", sizeof(*pcc), RTE_CACHE_LINE_SIZE);
+	if (pcc == NULL)
+		return -1;
+	pcc->rule_id = SESS_CHURN_PCC_ID;
+	if (rte_hash_add_key_data(rte_pcc_hash, &key32, pcc) < 0) {
+		rte_free(pcc);
+		return -1;
+	}
+
+	bearers = sess_pool_in_use(SESS_POOL_BEARER);
+	sprintf(dp_id.name, "Session_Churn");
+	sess_churn_stop = 0;
+	if (rte_eal_remote_launch(sess_churn_reader, NULL, lcore) < 0)
+		return -1;
+
+	ret = sess_churn_round(dp_id, 0, 1);
+	for (round = 1; round < SESS_CHURN_ROUNDS && ret == 0; round++) {
+		ret = sess_churn_round(dp_id, round, 1);
+		if (ret == 0)
+			ret = sess_churn_round(dp_id, round - 1, 0);
+	}
+	if (ret == 0)
+		ret = sess_churn_round(dp_id, SESS_CHURN_ROUNDS - 1, 0);
+
+	sess_churn_stop = 1;
+	rte_eal_wait_lcore(lcore);
+
+	rule.rule_id = SESS_CHURN_PCC_ID;
+	dp_pcc_entry_delete(dp_id, &rule);
+	tbl_rcu_barrier();
+
+	if (ret == 0 && (sess_churn_errors || !sess_churn_hits ||
+			sess_pool_in_use(SESS_POOL_BEARER) != bearers ||
+			tbl_rcu_pending()))
+		ret = -1;
+
+	printf("Session churn test %s: sessions %u, lookups %"PRIu64
+			", hits %"PRIu64", errors %"PRIu64"\n",
+			ret ? "FAIL" : "PASS", SESS_CHURN_NB_KEYS,
+			sess_churn_lookups, sess_churn_hits, sess_churn_errors);
+
+	return ret;
+}
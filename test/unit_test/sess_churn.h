@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SESS_CHURN_H_
+#define _SESS_CHURN_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Sessions created, then deleted, per round */
+#define SESS_CHURN_NB_SESS	256
+
+/* Create/delete rounds while the reader is looking up */
+#define SESS_CHURN_ROUNDS	64
+
+/* PCC rule of the churn sessions, out of the CP rule id range */
+#define SESS_CHURN_PCC_ID	1000
+
+/* First UE id of the churn sessions */
+#define SESS_CHURN_UE_BASE	0x80000
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Session create/delete storm while a worker runs UL bulk lookups on
+ * the keys of all churn sessions. Every round uses new TEIDs, and a
+ * recycled session object is zeroed, so a hit on memory freed too early
+ * shows as session data of another TEID. The reader must see none, and
+ * all session objects must be back in their pools at the end.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int sess_churn_test(void);
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "static_paa_test.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+int static_paa_test(void)
+{
+	ue_ippool ue_pool;
+	apn an_apn;
+	struct in_addr paa, static_ip, pdn_ip, ue_ip;
+	int i, ret = -1;
+
+	memset(&ue_pool, 0, sizeof(ue_pool));
+	memset(&an_apn, 0, sizeof(an_apn));
+	if (!inet_aton(STATIC_PAA_NETID, &ue_pool.netid) ||
+			!inet_aton(STATIC_PAA_NETMASK, &ue_pool.netmask) ||
+			!inet_aton(STATIC_PAA_ADDR, &paa))
+		return -1;
+	ue_pool.hosts = htonl(~ue_pool.netmask.s_addr) + 1;
+	an_apn.ue_pool = &ue_pool;
+	init_ue_ip_pool(&an_apn);
+
+	/* create_session: reserve a host order copy, keep the PAA as is */
+	static_ip.s_addr = ntohl(paa.s_addr);
+	if (reserve_ip(&an_apn, &static_ip) != 0)
+		goto out;
+	if (reserve_ip(&an_apn, &static_ip) == 0)
+		goto out;
+	ue_ip = paa;
+	pdn_ip.s_addr = htonl(ue_ip.s_addr);
+
+	for (i = 1; i < ue_pool.hosts; i++) {
+		if (acquire_ip(&an_apn, &ue_ip) != 0 ||
+				ue_ip.s_addr == paa.s_addr)
+			goto out;
+	}
+	if (acquire_ip(&an_apn, &ue_ip) == 0)
+		goto out;
+
+	/* delete_session: release pdn->ipv4, the only free address */
+	if (release_ip(&an_apn, &pdn_ip) != 0)
+		goto out;
+	if (acquire_ip(&an_apn, &ue_ip) != 0 || ue_ip.s_addr != paa.s_addr)
+		goto out;
+
+	ret = 0;
+out:
+	printf("Static PAA test %s: %s in %s/%s\n", ret ? "FAIL" : "PASS",
+			STATIC_PAA_ADDR, STATIC_PAA_NETID, STATIC_PAA_NETMASK);
+	ip_pool_free(&an_apn.ip_pool);
+	return ret;
+}
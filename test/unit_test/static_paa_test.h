@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STATIC_PAA_TEST_H_
+#define _STATIC_PAA_TEST_H_
+
+#include "ue.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* APN pool: a /24 */
+#define STATIC_PAA_NETID	"10.10.10.0"
+#define STATIC_PAA_NETMASK	"255.255.255.0"
+
+/* Static UE address, as carried by the PAA of a Create Session Request */
+#define STATIC_PAA_ADDR		"10.10.10.42"
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Static PAA life cycle, in the byte order create_session and
+ * delete_session use: reserve the PAA address, fill the rest of the
+ * pool with dynamic UEs, release the PAA address and acquire it back.
+ * Fails if the address is reserved twice, handed to a dynamic UE, or
+ * not the one acquired once released into a full pool.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int static_paa_test(void);
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_cycles.h>
+#include <rte_hash.h>
+
+#include "teid_index.h"
+#include "teid_index_bench.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Functions    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * S1U TEID of the i-th session, as set_s1u_sgw_teid builds it for the
+ * default bearer of the i-th UE.
+ */
+static uint32_t
+teid_bench_teid(uint32_t i)
+{
+	return ((0xC0FFEE + i) & 0x00ffffff) | (0xf0 << 24);
+}
+
+/**
+ * Bulk look up all keys, in bursts, until TEID_BENCH_LOOKUPS.
+ *
+ * @return
+ *	lookups per second.
+ */
+static uint64_t
+teid_bench_run(struct rte_hash *hash, struct teid_index *idx,
+		const void **key, uint32_t nb_keys, uint64_t *errors)
+{
+	void *data[MAX_BURST_SZ];
+	const struct ul_bm_key *k;
+	uint64_t start, cycles, hit_mask;
+	uint32_t i, j, off = 0;
+
+	start = rte_rdtsc();
+	for (i = 0; i < TEID_BENCH_LOOKUPS / MAX_BURST_SZ; i++) {
+		if (idx != NULL)
+			teid_index_lookup_bulk(idx, &key[off], MAX_BURST_SZ,
+					&hit_mask, data);
+		else if (rte_hash_lookup_bulk_data(hash, &key[off],
+				MAX_BURST_SZ, &hit_mask, data) < 0)
+			hit_mask = 0;
+
+		if (unlikely(hit_mask != ~0ULL >> (64 - MAX_BURST_SZ))) {
+			*errors += MAX_BURST_SZ - __builtin_popcountll(hit_mask);
+		} else {
+			for (j = 0; j < MAX_BURST_SZ; j++) {
+				k = key[off + j];
+				if (data[j] != (void *)(uintptr_t)k->s1u_sgw_teid)
+					(*errors)++;
+			}
+		}
+
+		off += MAX_BURST_SZ;
+		if (off + MAX_BURST_SZ > nb_keys)
+			off = 0;
+	}
+	cycles = rte_rdtsc() - start;
+
+	return (uint64_t)TEID_BENCH_LOOKUPS * rte_get_tsc_hz() / cycles;
+}
+
+/**
+ * Benchmark nb_keys sessions.
+ */
+static int
+teid_bench_sessions(uint32_t nb_keys)
+{
+	char name[RTE_HASH_NAMESIZE];
+	struct ul_bm_key *keys;
+	const void **key;
+	struct rte_hash *hash = NULL;
+	struct teid_index *idx;
+	uint64_t hash_lps, idx_lps, errors = 0;
+	const void *tmp;
+	uint32_t i, j;
+	int ret = 0;
+
+	keys = rte_malloc(NULL, nb_keys * sizeof(*keys), RTE_CACHE_LINE_SIZE);
+	key = rte_malloc(NULL, nb_keys * sizeof(*key), RTE_CACHE_LINE_SIZE);
+	snprintf(name, sizeof(name), "teid_bench_%u", nb_keys);
+	idx = teid_index_create(name, TEID_INDEX_ORDER);
+	if (keys == NULL || key == NULL || idx == NULL) {
+		ret = -1;
+		goto out;
+	}
+	hash_create(name, &hash, nb_keys * 2, sizeof(struct ul_bm_key));
+
+	for (i = 0; i < nb_keys; i++) {
+		keys[i].s1u_sgw_teid = teid_bench_teid(i);
+		keys[i].rid = 1;
+		key[i] = &keys[i];
+		if (rte_hash_add_key_data(hash, &keys[i],
+				(void *)(uintptr_t)keys[i].s1u_sgw_teid) < 0 ||
+				teid_index_add(idx, keys[i].s1u_sgw_teid, 1,
+				(void *)(uintptr_t)keys[i].s1u_sgw_teid) < 0) {
+			ret = -1;
+			goto out;
+		}
+	}
+
+	/* Random lookup order */
+	srand(nb_keys);
+	for (i = nb_keys - 1; i > 0; i--) {
+		j = rand() % (i + 1);
+		tmp = key[i];
+		key[i] = key[j];
+		key[j] = tmp;
+	}
+
+	hash_lps = teid_bench_run(hash, NULL, key, nb_keys, &errors);
+	idx_lps = teid_bench_run(NULL, idx, key, nb_keys, &errors);
+	if (errors)
+		ret = -1;
+
+	printf("TEID index bench %s: sessions %u, hash %"PRIu64
+			" lookups/s, index %"PRIu64" lookups/s, errors %"PRIu64"\n",
+			ret ? "FAIL" : "PASS", nb_keys, hash_lps, idx_lps, errors);
+
+out:
+	rte_hash_free(hash);
+	teid_index_free(idx);
+	rte_free(key);
+	rte_free(keys);
+	return ret;
+}
+
+int teid_index_bench_test(void)
+{
+	if (teid_bench_sessions(TEID_BENCH_SMALL) < 0)
+		return -1;
+	return teid_bench_sessions(TEID_BENCH_LARGE);
+}
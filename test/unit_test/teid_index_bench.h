@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TEID_INDEX_BENCH_H_
+#define _TEID_INDEX_BENCH_H_
+
+#include "main.h"
+
+/* ****************************************************************************
+ * ****    Unit Test Defines    ****
+ * ****************************************************************************
+ **/
+
+/* Session counts benchmarked */
+#define TEID_BENCH_SMALL	50000
+#define TEID_BENCH_LARGE	1000000
+
+/* Lookups timed per run */
+#define TEID_BENCH_LOOKUPS	(1 << 24)
+
+/* ****************************************************************************
+ * ****    Unit Test Function Prototypes    ****
+ * ****************************************************************************
+ **/
+
+/**
+ * Compare UL session bulk lookups per second through the uplink hash and
+ * through the TEID index, at TEID_BENCH_SMALL and TEID_BENCH_LARGE
+ * sessions with CP style TEIDs, keys in random order.
+ * Any miss or wrong data is a failure.
+ *
+ * @return
+ *	- 0 on success
+ *	- -1 on failure
+ */
+int teid_index_bench_test(void);
+#endif